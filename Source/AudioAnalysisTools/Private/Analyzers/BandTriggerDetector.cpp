@@ -0,0 +1,309 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/BandTriggerDetector.h"
+#include "Analyzers/BeatDetection.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "Math/UnrealMathUtility.h"
+
+namespace
+{
+	/** The damping of the sliding DFT per audio frame, so the rounding errors of the recursion decay instead of accumulating */
+	constexpr double SlidingDFTDamping = 0.99999;
+
+	/**
+	 * The maximum number of DFT bins tracked per band
+	 * Each band gets the longest window, up to the window size, whose bins span it in at most this many bins, so the cost does not grow with the band width
+	 */
+	constexpr int32 MaxBinsPerBand = 4;
+
+	/** The shortest window of a band, which still leaves a bin between DC and Nyquist */
+	constexpr int64 MinBandWindowSize = 4;
+}
+
+UBandTriggerDetector::UBandTriggerDetector()
+	: BeatDetection(nullptr),
+	  WindowPosition(0),
+	  FramesSinceEvaluation(0),
+	  NumOfEvaluations(0),
+	  SampleRate(0),
+	  WindowSize(0),
+	  HopSize(0),
+	  EnergyHistorySize(0)
+{
+}
+
+UBandTriggerDetector* UBandTriggerDetector::CreateBandTriggerDetector(int32 InSampleRate, const TArray<FBandTriggerRange>& InBands, int64 InWindowSize, int64 InHopSize, float InEnergyHistoryDuration)
+{
+	UBandTriggerDetector* BandTriggerDetector = NewObject<UBandTriggerDetector>();
+	if (!BandTriggerDetector->Configure(InSampleRate, InBands.Num() > 0 ? InBands : GetDefaultBands(), InWindowSize, InHopSize, InEnergyHistoryDuration))
+	{
+		return nullptr;
+	}
+	return BandTriggerDetector;
+}
+
+TArray<FBandTriggerRange> UBandTriggerDetector::GetDefaultBands()
+{
+	TArray<FBandTriggerRange> DefaultBands;
+	DefaultBands.SetNum(3);
+	DefaultBands[KICK_BAND] = FBandTriggerRange(40, 120);
+	DefaultBands[SNARE_BAND] = FBandTriggerRange(200, 3000);
+	DefaultBands[HIHAT_BAND] = FBandTriggerRange(8000, 16000);
+	return DefaultBands;
+}
+
+bool UBandTriggerDetector::Configure(int32 InSampleRate, const TArray<FBandTriggerRange>& InBands, int64 InWindowSize, int64 InHopSize, float InEnergyHistoryDuration)
+{
+	if (InSampleRate <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the band trigger detector: the sample rate is '%d', expected > '0'"), InSampleRate);
+		return false;
+	}
+
+	if (InWindowSize < 4)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the band trigger detector: the window size is '%lld', expected >= '4'"), InWindowSize);
+		return false;
+	}
+
+	if (!(InHopSize > 0 && InHopSize <= InWindowSize))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the band trigger detector: the hop size is '%lld', expected > '0' and <= '%lld'"), InHopSize, InWindowSize);
+		return false;
+	}
+
+	if (InEnergyHistoryDuration <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the band trigger detector: the energy history duration is '%f', expected > '0'"), InEnergyHistoryDuration);
+		return false;
+	}
+
+	const float NyquistFrequency = InSampleRate * 0.5f;
+
+	for (int32 BandIndex = 0; BandIndex < InBands.Num(); ++BandIndex)
+	{
+		const FBandTriggerRange& Band = InBands[BandIndex];
+		if (!(Band.LowFrequency >= 0 && Band.LowFrequency <= Band.HighFrequency && Band.LowFrequency < NyquistFrequency))
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the band trigger detector: the band '%d' is '%f'-'%f' Hz, expected >= '0', low <= high and low < '%f'"), BandIndex, Band.LowFrequency, Band.HighFrequency, NyquistFrequency);
+			return false;
+		}
+	}
+
+	SampleRate = InSampleRate;
+	WindowSize = InWindowSize;
+	HopSize = InHopSize;
+	Bands = InBands;
+
+	BandBinOffsets.Reset(Bands.Num() + 1);
+	BandWindowSizes.Reset(Bands.Num());
+	BandWindowDampings.Reset(Bands.Num());
+	BinRotationReal.Reset();
+	BinRotationImaginary.Reset();
+
+	for (const FBandTriggerRange& Band : Bands)
+	{
+		BandBinOffsets.Add(BinRotationReal.Num());
+
+		// Rounding both band edges adds up to two bins, so a bin width of at least the band width / (MaxBinsPerBand - 2) keeps the band within MaxBinsPerBand bins
+		const double BandWidth = Band.HighFrequency - Band.LowFrequency;
+		const double MaxBandWindowSize = BandWidth > 0 ? (MaxBinsPerBand - 2) * static_cast<double>(SampleRate) / BandWidth : static_cast<double>(WindowSize);
+		const int64 BandWindowSize = FMath::Max<int64>(static_cast<int64>(FMath::Min<double>(MaxBandWindowSize, static_cast<double>(WindowSize))), MinBandWindowSize);
+
+		BandWindowSizes.Add(BandWindowSize);
+		BandWindowDampings.Add(static_cast<float>(FMath::Pow(SlidingDFTDamping, static_cast<double>(BandWindowSize))));
+
+		// Map the band to all the bins of its window it covers, excluding DC and Nyquist
+		const double BinWidth = static_cast<double>(SampleRate) / BandWindowSize;
+		const int64 MaxBin = BandWindowSize / 2 - 1;
+		const int64 FirstBin = FMath::Clamp<int64>(FMath::RoundToInt(Band.LowFrequency / BinWidth), 1, MaxBin);
+		const int64 LastBin = FMath::Clamp<int64>(FMath::RoundToInt(Band.HighFrequency / BinWidth), FirstBin, MaxBin);
+
+		for (int64 Bin = FirstBin; Bin <= LastBin; ++Bin)
+		{
+			const double Phase = 2 * PI * Bin / BandWindowSize;
+			BinRotationReal.Add(SlidingDFTDamping * FMath::Cos(Phase));
+			BinRotationImaginary.Add(SlidingDFTDamping * FMath::Sin(Phase));
+		}
+	}
+
+	BandBinOffsets.Add(BinRotationReal.Num());
+
+	Window.SetNumUninitialized(WindowSize);
+	FrameDeltas.SetNumUninitialized(HopSize);
+	BandMagnitudes.SetNumUninitialized(Bands.Num());
+
+	EnergyHistorySize = FMath::Max<int64>(FMath::RoundToInt(InEnergyHistoryDuration * SampleRate / HopSize), 1);
+
+	Reset();
+
+	return true;
+}
+
+void UBandTriggerDetector::Reset()
+{
+	BinReal.SetNumZeroed(BinRotationReal.Num());
+	BinImaginary.SetNumZeroed(BinRotationReal.Num());
+	FMemory::Memzero(Window.GetData(), Window.Num() * sizeof(float));
+	FMemory::Memzero(BandMagnitudes.GetData(), BandMagnitudes.Num() * sizeof(float));
+
+	WindowPosition = 0;
+	FramesSinceEvaluation = 0;
+	NumOfEvaluations = 0;
+
+	// The band magnitudes are fed as a magnitude spectrum of one bin per sub-band, so the beat detection compares each band to its own energy history
+	if (Bands.Num() > 0)
+	{
+		BeatDetection = UBeatDetection::CreateBeatDetection(Bands.Num(), EnergyHistorySize);
+	}
+}
+
+void UBandTriggerDetector::ProcessAudioFrames(const TArray<float>& AudioFrames)
+{
+	ProcessAudioFrames(TArrayView64<const float>(AudioFrames));
+}
+
+void UBandTriggerDetector::ProcessAudioFrames(TArrayView64<const float> AudioFrames)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_BandTriggerUpdate);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_BandTriggerUpdate);
+
+	if (!BeatDetection)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process audio frames: the band trigger detector is not configured"));
+		return;
+	}
+
+	int64 FrameIndex = 0;
+
+	// The audio is split at the hop boundaries, so the bands are evaluated after every hop regardless of the block size
+	while (FrameIndex < AudioFrames.Num())
+	{
+		const int64 NumOfFrames = FMath::Min<int64>(AudioFrames.Num() - FrameIndex, HopSize - FramesSinceEvaluation);
+
+		UpdateBins(AudioFrames.GetData() + FrameIndex, NumOfFrames);
+
+		FrameIndex += NumOfFrames;
+		FramesSinceEvaluation += NumOfFrames;
+
+		if (FramesSinceEvaluation == HopSize)
+		{
+			EvaluateBands();
+			FramesSinceEvaluation = 0;
+		}
+	}
+}
+
+void UBandTriggerDetector::UpdateBins(const float* AudioFrames, int64 NumOfFrames)
+{
+	float* RESTRICT FrameDeltasData = FrameDeltas.GetData();
+	float* RESTRICT WindowData = Window.GetData();
+
+	for (int32 BandIndex = 0; BandIndex < Bands.Num(); ++BandIndex)
+	{
+		const int64 BandWindowSize = BandWindowSizes[BandIndex];
+		const float BandWindowDamping = BandWindowDampings[BandIndex];
+
+		// The difference between the incoming audio frame and the damped audio frame leaving the window of the band is shared by all the bins of the band
+		// The leaving audio frame is taken from this block if the window of the band is shorter than the processed part of it, from the ring otherwise
+		for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+		{
+			float LeavingFrame;
+			if (FrameIndex >= BandWindowSize)
+			{
+				LeavingFrame = AudioFrames[FrameIndex - BandWindowSize];
+			}
+			else
+			{
+				const int64 LeavingPosition = WindowPosition + FrameIndex - BandWindowSize;
+				LeavingFrame = WindowData[LeavingPosition < 0 ? LeavingPosition + WindowSize : LeavingPosition];
+			}
+
+			FrameDeltasData[FrameIndex] = AudioFrames[FrameIndex] - BandWindowDamping * LeavingFrame;
+		}
+
+		// Sliding DFT recursion per bin: X = r * e^(j * 2 * pi * k / N) * X + delta
+		// The phase factor of the delta is left out since it only rotates the bin, which does not change its magnitude
+		for (int32 BinIndex = BandBinOffsets[BandIndex]; BinIndex < BandBinOffsets[BandIndex + 1]; ++BinIndex)
+		{
+			const double RotationReal = BinRotationReal[BinIndex];
+			const double RotationImaginary = BinRotationImaginary[BinIndex];
+
+			double Real = BinReal[BinIndex];
+			double Imaginary = BinImaginary[BinIndex];
+
+			for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+			{
+				const double RotatedReal = RotationReal * Real - RotationImaginary * Imaginary + FrameDeltasData[FrameIndex];
+				Imaginary = RotationReal * Imaginary + RotationImaginary * Real;
+				Real = RotatedReal;
+			}
+
+			BinReal[BinIndex] = Real;
+			BinImaginary[BinIndex] = Imaginary;
+		}
+	}
+
+	// The ring only advances once all the bands have read the audio frames leaving their windows
+	for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+	{
+		WindowData[WindowPosition] = AudioFrames[FrameIndex];
+		WindowPosition = WindowPosition + 1 == WindowSize ? 0 : WindowPosition + 1;
+	}
+}
+
+void UBandTriggerDetector::EvaluateBands()
+{
+	for (int32 BandIndex = 0; BandIndex < Bands.Num(); ++BandIndex)
+	{
+		const float MagnitudeScale = 2.f / BandWindowSizes[BandIndex];
+		const int32 FirstBin = BandBinOffsets[BandIndex];
+		const int32 EndBin = BandBinOffsets[BandIndex + 1];
+
+		double MagnitudeSum = 0;
+		for (int32 BinIndex = FirstBin; BinIndex < EndBin; ++BinIndex)
+		{
+			MagnitudeSum += FMath::Sqrt(BinReal[BinIndex] * BinReal[BinIndex] + BinImaginary[BinIndex] * BinImaginary[BinIndex]);
+		}
+
+		BandMagnitudes[BandIndex] = static_cast<float>(MagnitudeSum / (EndBin - FirstBin)) * MagnitudeScale;
+	}
+
+	BeatDetection->ProcessMagnitude(TArrayView64<const float>(BandMagnitudes));
+	++NumOfEvaluations;
+}
+
+bool UBandTriggerDetector::IsBandTriggered(int32 Band) const
+{
+	if (!(Band >= 0 && Band < Bands.Num()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to detect a band trigger: the band is '%d', expected >= '0' and < '%d'"), Band, Bands.Num());
+		return false;
+	}
+	return BeatDetection->IsBeat(Band);
+}
+
+bool UBandTriggerDetector::IsKick() const
+{
+	return IsBandTriggered(KICK_BAND);
+}
+
+bool UBandTriggerDetector::IsSnare() const
+{
+	return IsBandTriggered(SNARE_BAND);
+}
+
+bool UBandTriggerDetector::IsHiHat() const
+{
+	return IsBandTriggered(HIHAT_BAND);
+}
+
+float UBandTriggerDetector::GetBandMagnitude(int32 Band) const
+{
+	if (!(Band >= 0 && Band < Bands.Num()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to obtain the band magnitude: the band is '%d', expected >= '0' and < '%d'"), Band, Bands.Num());
+		return -1;
+	}
+	return BandMagnitudes[Band];
+}
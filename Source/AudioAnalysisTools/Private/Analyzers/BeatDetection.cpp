@@ -6,7 +6,8 @@
 #include "Math/NumericLimits.h"
 
 UBeatDetection::UBeatDetection()
-	: HistoryPosition(0),
+	: SubbandStride(0),
+	  HistoryPosition(0),
 	  FFTSubbandSize(0),
 	  EnergyHistorySize(0)
 {
@@ -33,17 +34,15 @@ void UBeatDetection::UpdateFFTSubbandSize(int64 InFFTSubbandSize)
 	}
 
 	UE_LOG(LogAudioAnalysis, Log, TEXT("Updating Beat Detection FFT subbands size from '%lld' to '%lld'"), FFTSubbandSize, InFFTSubbandSize);
-	
-	FFTSubbandSize = InFFTSubbandSize;
 
-	FFTSubbands.SetNum(FFTSubbandSize);
-	FFTAverageEnergy.SetNum(FFTSubbandSize);
-	FFTVariance.SetNum(FFTSubbandSize);
-	FFTBeatValues.SetNum(FFTSubbandSize);
-	EnergyHistory.SetNum(FFTSubbandSize);
+	const int64 PreviousFFTSubbandSize = FFTSubbandSize;
+	FFTSubbandSize = InFFTSubbandSize;
 
-	// We resized the external array, so we have to resize the new array
-	UpdateEnergyHistorySize(EnergyHistorySize);
+	if (!ResizeStorage())
+	{
+		FFTSubbandSize = PreviousFFTSubbandSize;
+		ResizeStorage();
+	}
 }
 
 void UBeatDetection::UpdateEnergyHistorySize(int64 InEnergyHistorySize)
@@ -57,35 +56,139 @@ void UBeatDetection::UpdateEnergyHistorySize(int64 InEnergyHistorySize)
 	}
 
 	UE_LOG(LogAudioAnalysis, Log, TEXT("Updating Beat Detection energy history size from '%lld' to '%lld'"), EnergyHistorySize, InEnergyHistorySize);
-	
+
+	const int64 PreviousEnergyHistorySize = EnergyHistorySize;
 	EnergyHistorySize = InEnergyHistorySize;
 
+	if (!ResizeStorage())
+	{
+		EnergyHistorySize = PreviousEnergyHistorySize;
+		ResizeStorage();
+	}
+}
+
+bool UBeatDetection::ResizeStorage()
+{
+	constexpr int64 NumFloatsPerCacheLine = PLATFORM_CACHE_LINE_SIZE / sizeof(float);
+	const int64 NewSubbandStride = Align(FFTSubbandSize, NumFloatsPerCacheLine);
+
+	if (NewSubbandStride * FMath::Max(EnergyHistorySize, NumBandRows) > TNumericLimits<FCacheAlignedFloatArray::SizeType>::Max())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to resize the Beat Detection storage: the FFT subbands size '%lld' and the energy history size '%lld' exceed the maximum storage size '%d'"), FFTSubbandSize, EnergyHistorySize, TNumericLimits<FCacheAlignedFloatArray::SizeType>::Max());
+		return false;
+	}
+
+	if (NewSubbandStride != SubbandStride)
+	{
+		// The rows are laid out by the sub-band stride, so the values of the remaining sub-bands are moved row by row
+		auto Relayout = [this, NewSubbandStride](FCacheAlignedFloatArray& Rows, int64 NumOfRows)
+		{
+			const int64 NumOfKeptRows = SubbandStride > 0 ? FMath::Min<int64>(Rows.Num() / SubbandStride, NumOfRows) : 0;
+			const int64 NumOfKeptFloats = FMath::Min<int64>(SubbandStride, NewSubbandStride);
+
+			FCacheAlignedFloatArray NewRows;
+			NewRows.SetNumZeroed(NumOfRows * NewSubbandStride);
+
+			for (int64 RowIndex = 0; RowIndex < NumOfKeptRows; ++RowIndex)
+			{
+				FMemory::Memcpy(NewRows.GetData() + RowIndex * NewSubbandStride, Rows.GetData() + RowIndex * SubbandStride, sizeof(float) * NumOfKeptFloats);
+			}
+
+			Rows = MoveTemp(NewRows);
+		};
+
+		Relayout(BandRows, NumBandRows);
+		Relayout(EnergyHistory, EnergyHistorySize);
+		SubbandStride = NewSubbandStride;
+	}
+	else
+	{
+		// Growing only appends zeroed rows and shrinking drops the last rows, so the history of the remaining frames is kept in place
+		BandRows.SetNumZeroed(NumBandRows * SubbandStride);
+		EnergyHistory.SetNumZeroed(EnergyHistorySize * SubbandStride);
+	}
+
+	EnergyHistorySums.SetNumZeroed(FFTSubbandSize);
+	BeatMask.SetNumZeroed(FMath::DivideAndRoundUp<int64>(FFTSubbandSize, 64));
+
+	// The row padding may contain the values of sub-bands that no longer exist, which would otherwise reappear if the sub-band size grows again
+	const int64 NumOfPaddingFloats = SubbandStride - FFTSubbandSize;
+	if (NumOfPaddingFloats > 0)
+	{
+		for (int64 RowIndex = 0; RowIndex < NumBandRows; ++RowIndex)
+		{
+			FMemory::Memzero(BandRows.GetData() + RowIndex * SubbandStride + FFTSubbandSize, sizeof(float) * NumOfPaddingFloats);
+		}
+		for (int64 RowIndex = 0; RowIndex < EnergyHistorySize; ++RowIndex)
+		{
+			FMemory::Memzero(EnergyHistory.GetData() + RowIndex * SubbandStride + FFTSubbandSize, sizeof(float) * NumOfPaddingFloats);
+		}
+	}
+
+	// The history may have shrunk below the current position
+	if (EnergyHistorySize > 0)
+	{
+		HistoryPosition %= EnergyHistorySize;
+	}
+
+	RecomputeEnergyHistorySums();
+	UpdateBeatMask();
+
+	return true;
+}
+
+void UBeatDetection::RecomputeEnergyHistorySums()
+{
+	double* EnergyHistorySumsData = EnergyHistorySums.GetData();
+
 	for (int64 SubbandIndex = 0; SubbandIndex < FFTSubbandSize; ++SubbandIndex)
 	{
-		EnergyHistory[SubbandIndex].SetNum(EnergyHistorySize);
+		EnergyHistorySumsData[SubbandIndex] = 0;
+	}
+
+	// Row by row, so the whole history is read sequentially
+	for (int64 EnergyHistoryIndex = 0; EnergyHistoryIndex < EnergyHistorySize; ++EnergyHistoryIndex)
+	{
+		const float* EnergyHistoryRow = EnergyHistory.GetData() + EnergyHistoryIndex * SubbandStride;
+
+		for (int64 SubbandIndex = 0; SubbandIndex < FFTSubbandSize; ++SubbandIndex)
+		{
+			EnergyHistorySumsData[SubbandIndex] += EnergyHistoryRow[SubbandIndex];
+		}
 	}
 }
 
-void UBeatDetection::UpdateFFT(const TArray64<float>& MagnitudeSpectrum)
+void UBeatDetection::UpdateFFT(TArrayView64<const float> MagnitudeSpectrum)
 {
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_BeatDetectionUpdate);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_BeatDetectionUpdate);
+
 	const int64 MagnitudeSpectrumSize{MagnitudeSpectrum.Num()};
+	const int64 SubbandWidth = MagnitudeSpectrumSize / FFTSubbandSize;
+
+	float* RESTRICT FFTSubbands = GetBandRow(SubbandsRow).GetData();
+	float* RESTRICT FFTAverageEnergy = GetBandRow(AverageEnergyRow).GetData();
+	float* RESTRICT FFTVariance = GetBandRow(VarianceRow).GetData();
+	float* RESTRICT FFTBeatValues = GetBandRow(BeatValuesRow).GetData();
 
 	// Sub-band calculation
 	for (int64 SubbandIndex = 0; SubbandIndex < FFTSubbandSize; ++SubbandIndex)
 	{
+		const float* SubbandMagnitudes = MagnitudeSpectrum.GetData() + SubbandIndex * SubbandWidth;
+
 		FFTSubbands[SubbandIndex] = 0;
 
-		for (int64 SubbandInternalIndex = 0; SubbandInternalIndex < MagnitudeSpectrumSize / FFTSubbandSize; ++SubbandInternalIndex)
+		for (int64 SubbandInternalIndex = 0; SubbandInternalIndex < SubbandWidth; ++SubbandInternalIndex)
 		{
-			FFTSubbands[SubbandIndex] += MagnitudeSpectrum[SubbandIndex * (MagnitudeSpectrumSize / FFTSubbandSize) + SubbandInternalIndex];
+			FFTSubbands[SubbandIndex] += SubbandMagnitudes[SubbandInternalIndex];
 		}
 		// After summing the subband values, divide the added number of times to get the average value
 		FFTSubbands[SubbandIndex] *= static_cast<float>(FFTSubbandSize) / MagnitudeSpectrumSize;
 
 		// Calculation of subband variance value
-		for (int64 SubbandInternalIndex = 0; SubbandInternalIndex < MagnitudeSpectrumSize / FFTSubbandSize; ++SubbandInternalIndex)
+		for (int64 SubbandInternalIndex = 0; SubbandInternalIndex < SubbandWidth; ++SubbandInternalIndex)
 		{
-			FFTVariance[SubbandIndex] += FMath::Pow(MagnitudeSpectrum[SubbandIndex * (MagnitudeSpectrumSize / FFTSubbandSize) + SubbandInternalIndex] - FFTSubbands[SubbandIndex], 2);
+			FFTVariance[SubbandIndex] += FMath::Pow(SubbandMagnitudes[SubbandInternalIndex] - FFTSubbands[SubbandIndex], 2);
 		}
 		FFTVariance[SubbandIndex] *= static_cast<float>(FFTSubbandSize) / MagnitudeSpectrumSize;
 
@@ -93,37 +196,60 @@ void UBeatDetection::UpdateFFT(const TArray64<float>& MagnitudeSpectrum)
 		FFTBeatValues[SubbandIndex] = (-0.0025714 * FFTVariance[SubbandIndex]) + 1.15142857;
 	}
 
-	// Calculation of energy average
+	// The oldest frame of the energy history is replaced with the calculated subbands as a single contiguous row
+	float* RESTRICT EnergyHistoryRow = EnergyHistory.GetData() + HistoryPosition * SubbandStride;
+	double* RESTRICT EnergyHistorySumsData = EnergyHistorySums.GetData();
+
 	for (int64 SubbandIndex = 0; SubbandIndex < FFTSubbandSize; ++SubbandIndex)
 	{
-		FFTAverageEnergy[SubbandIndex] = 0;
-		for (int64 EnergyHistoryIndex = 0; EnergyHistoryIndex < EnergyHistorySize; ++EnergyHistoryIndex)
-		{
-			// Average of total energy += Energy history of each subband
-			FFTAverageEnergy[SubbandIndex] += EnergyHistory[SubbandIndex][EnergyHistoryIndex];
-		}
+		// The energy average is taken from the running sum of the history before the new value is added
+		FFTAverageEnergy[SubbandIndex] = static_cast<float>(EnergyHistorySumsData[SubbandIndex] / EnergyHistorySize);
 
-		// Divide the sum by the history energy to get a weighted average
-		FFTAverageEnergy[SubbandIndex] /= EnergyHistorySize;
+		EnergyHistorySumsData[SubbandIndex] += static_cast<double>(FFTSubbands[SubbandIndex]) - EnergyHistoryRow[SubbandIndex];
+		EnergyHistoryRow[SubbandIndex] = FFTSubbands[SubbandIndex];
 	}
 
-	// Put new values into the energy history
-	for (int64 SubbandIndex = 0; SubbandIndex < FFTSubbandSize; ++SubbandIndex)
+	// A pseudo-cyclic list is represented by circular array indexes
+	HistoryPosition = (HistoryPosition + 1) % EnergyHistorySize;
+
+	// Once per history cycle, the running sums are renormalized to bound the rounding drift. This keeps the amortized cost per frame independent of the history size
+	if (HistoryPosition == 0)
 	{
-		// Add the calculated subband to the HistoryPosition in the energy history
-		EnergyHistory[SubbandIndex][HistoryPosition] = FFTSubbands[SubbandIndex];
+		RecomputeEnergyHistorySums();
 	}
 
-	// A pseudo-cyclic list is represented by circular array indexes
-	HistoryPosition = (HistoryPosition + 1) % EnergyHistorySize;
+	UpdateBeatMask();
+}
+
+void UBeatDetection::UpdateBeatMask()
+{
+	const float* RESTRICT FFTSubbands = GetBandRow(SubbandsRow).GetData();
+	const float* RESTRICT FFTAverageEnergy = GetBandRow(AverageEnergyRow).GetData();
+	const float* RESTRICT FFTBeatValues = GetBandRow(BeatValuesRow).GetData();
+
+	for (int64 WordIndex = 0; WordIndex < BeatMask.Num(); ++WordIndex)
+	{
+		const int64 FirstSubbandIndex = WordIndex * 64;
+		const int64 NumOfWordSubbands = FMath::Min<int64>(FFTSubbandSize - FirstSubbandIndex, 64);
+
+		// Branchless comparisons of all the sub-bands of the word, which the compiler can vectorize
+		uint64 Word = 0;
+		for (int64 BitIndex = 0; BitIndex < NumOfWordSubbands; ++BitIndex)
+		{
+			const int64 SubbandIndex = FirstSubbandIndex + BitIndex;
+			Word |= static_cast<uint64>(FFTSubbands[SubbandIndex] > FFTAverageEnergy[SubbandIndex] * FFTBeatValues[SubbandIndex]) << BitIndex;
+		}
+
+		BeatMask[WordIndex] = Word;
+	}
 }
 
 void UBeatDetection::ProcessMagnitude(const TArray<float>& MagnitudeSpectrum)
 {
-	ProcessMagnitude(TArray64<float>(MagnitudeSpectrum));
+	ProcessMagnitude(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-void UBeatDetection::ProcessMagnitude(const TArray64<float>& MagnitudeSpectrum)
+void UBeatDetection::ProcessMagnitude(TArrayView64<const float> MagnitudeSpectrum)
 {
 	UpdateFFT(MagnitudeSpectrum);
 }
@@ -131,12 +257,12 @@ void UBeatDetection::ProcessMagnitude(const TArray64<float>& MagnitudeSpectrum)
 bool UBeatDetection::IsBeat(int64 SubBand) const
 {
 	// Prevent out of array exception
-	if (SubBand >= FFTSubbandSize)
+	if (!(SubBand >= 0 && SubBand < FFTSubbandSize))
 	{
-		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot detect a beat: FFT sub-band ('%lld') must not exceed the sub-band size ('%lld')"), SubBand, FFTSubbandSize);
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot detect a beat: FFT sub-band ('%lld') must be >= '0' and must not exceed the sub-band size ('%lld')"), SubBand, FFTSubbandSize);
 		return false;
 	}
-	return FFTSubbands[SubBand] > FFTAverageEnergy[SubBand] * FFTBeatValues[SubBand];
+	return (BeatMask[SubBand / 64] >> (SubBand % 64)) & 1;
 }
 
 bool UBeatDetection::IsKick() const
@@ -182,17 +308,34 @@ bool UBeatDetection::IsBeatRange(int64 Low, int64 High, int64 Threshold) const
 		return false;
 	}
 
+	return CountBeats(BeatMask, Low, High) > Threshold;
+}
+
+int64 UBeatDetection::CountBeats(TArrayView64<const uint64> InBeatMask, int64 Low, int64 High)
+{
+	const int64 FirstWordIndex = Low / 64;
+	const int64 LastWordIndex = High / 64;
+
 	int64 NumOfBeats = 0;
 
-	for (int64 Index = Low; Index < High + 1; ++Index)
+	for (int64 WordIndex = FirstWordIndex; WordIndex <= LastWordIndex; ++WordIndex)
 	{
-		if (IsBeat(Index))
+		uint64 Word = InBeatMask[WordIndex];
+
+		// Mask out the sub-bands of the boundary words outside the span
+		if (WordIndex == FirstWordIndex)
+		{
+			Word &= ~static_cast<uint64>(0) << (Low % 64);
+		}
+		if (WordIndex == LastWordIndex)
 		{
-			NumOfBeats++;
+			Word &= ~static_cast<uint64>(0) >> (63 - High % 64);
 		}
+
+		NumOfBeats += FMath::CountBits(Word);
 	}
 
-	return NumOfBeats > Threshold;
+	return NumOfBeats;
 }
 
 float UBeatDetection::GetBand(int64 Subband) const
@@ -202,45 +345,53 @@ float UBeatDetection::GetBand(int64 Subband) const
 		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot obtain FFT sub-band: the specified sub-band is '%lld', but it is expected to be >= '0' and < '%lld'"), Subband, FFTSubbandSize);
 		return -1;
 	}
-	return FFTSubbands[Subband];
+	return GetBandRow(SubbandsRow)[Subband];
 }
 
 TArray<float> UBeatDetection::GetFFTSubbands_BP() const
 {
+	const TArrayView64<const float> FFTSubbands = GetBandRow(SubbandsRow);
+
 	if (FFTSubbands.Num() > TNumericLimits<int32>::Max())
 	{
 		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to obtain FFT sub-bands: array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)\nA standard byte array can hold a maximum of 2 GB of data"), TNumericLimits<int32>::Max(), FFTSubbands.Num());
 		return TArray<float>();
 	}
-	return TArray<float>(FFTSubbands);
+	return TArray<float>(FFTSubbands.GetData(), FFTSubbands.Num());
 }
 
 TArray<float> UBeatDetection::GetFFTAverageEnergy_BP() const
 {
+	const TArrayView64<const float> FFTAverageEnergy = GetBandRow(AverageEnergyRow);
+
 	if (FFTAverageEnergy.Num() > TNumericLimits<int32>::Max())
 	{
 		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to obtain FFT average energy: array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)\nA standard byte array can hold a maximum of 2 GB of data"), TNumericLimits<int32>::Max(), FFTAverageEnergy.Num());
 		return TArray<float>();
 	}
-	return TArray<float>(FFTAverageEnergy);
+	return TArray<float>(FFTAverageEnergy.GetData(), FFTAverageEnergy.Num());
 }
 
 TArray<float> UBeatDetection::GetFFTVariance_BP() const
 {
+	const TArrayView64<const float> FFTVariance = GetBandRow(VarianceRow);
+
 	if (FFTVariance.Num() > TNumericLimits<int32>::Max())
 	{
 		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to obtain FFT variance: array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)\nA standard byte array can hold a maximum of 2 GB of data"), TNumericLimits<int32>::Max(), FFTVariance.Num());
 		return TArray<float>();
 	}
-	return TArray<float>(FFTVariance);
+	return TArray<float>(FFTVariance.GetData(), FFTVariance.Num());
 }
 
 TArray<float> UBeatDetection::GetFFTBeatValues_BP() const
 {
+	const TArrayView64<const float> FFTBeatValues = GetBandRow(BeatValuesRow);
+
 	if (FFTBeatValues.Num() > TNumericLimits<int32>::Max())
 	{
 		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to obtain FFT beat values: array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)\nA standard byte array can hold a maximum of 2 GB of data"), TNumericLimits<int32>::Max(), FFTBeatValues.Num());
 		return TArray<float>();
 	}
-	return TArray<float>(FFTBeatValues);
+	return TArray<float>(FFTBeatValues.GetData(), FFTBeatValues.Num());
 }
@@ -6,17 +6,17 @@
 
 float UCoreFrequencyDomainFeatures::GetSpectralCentroid(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetSpectralCentroid(TArray64<float>(MagnitudeSpectrum));
+	return GetSpectralCentroid(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UCoreFrequencyDomainFeatures::GetSpectralCentroid(const TArray64<float>& MagnitudeSpectrum)
+float UCoreFrequencyDomainFeatures::GetSpectralCentroid(TArrayView64<const float> MagnitudeSpectrum)
 {
 	float SumAmplitudes = 0;
 
 	float SumWeightedAmplitudes = 0;
 
 	// For each bin in the first half of the magnitude spectrum
-	for (TArray64<float>::SizeType MagnitudeIndex = 0; MagnitudeIndex < MagnitudeSpectrum.Num(); MagnitudeIndex++)
+	for (int64 MagnitudeIndex = 0; MagnitudeIndex < MagnitudeSpectrum.Num(); MagnitudeIndex++)
 	{
 		// Sum amplitudes
 		SumAmplitudes += MagnitudeSpectrum[MagnitudeIndex];
@@ -32,10 +32,10 @@ float UCoreFrequencyDomainFeatures::GetSpectralCentroid(const TArray64<float>& M
 
 float UCoreFrequencyDomainFeatures::GetSpectralFlatness(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetSpectralFlatness(TArray64<float>(MagnitudeSpectrum));
+	return GetSpectralFlatness(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UCoreFrequencyDomainFeatures::GetSpectralFlatness(const TArray64<float>& MagnitudeSpectrum)
+float UCoreFrequencyDomainFeatures::GetSpectralFlatness(TArrayView64<const float> MagnitudeSpectrum)
 {
 	float SumValue = 0;
 	float LogSumValue = 0;
@@ -59,10 +59,10 @@ float UCoreFrequencyDomainFeatures::GetSpectralFlatness(const TArray64<float>& M
 
 float UCoreFrequencyDomainFeatures::GetSpectralCrest(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetSpectralCrest(TArray64<float>(MagnitudeSpectrum));
+	return GetSpectralCrest(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UCoreFrequencyDomainFeatures::GetSpectralCrest(const TArray64<float>& MagnitudeSpectrum)
+float UCoreFrequencyDomainFeatures::GetSpectralCrest(TArrayView64<const float> MagnitudeSpectrum)
 {
 	float SumValue = 0;
 	float MaxValue = 0;
@@ -97,12 +97,12 @@ float UCoreFrequencyDomainFeatures::GetSpectralCrest(const TArray64<float>& Magn
 
 float UCoreFrequencyDomainFeatures::GetSpectralRolloff(const TArray<float>& MagnitudeSpectrum, const float Percentile)
 {
-	return GetSpectralRolloff(TArray64<float>(MagnitudeSpectrum), Percentile);
+	return GetSpectralRolloff(TArrayView64<const float>(MagnitudeSpectrum), Percentile);
 }
 
-float UCoreFrequencyDomainFeatures::GetSpectralRolloff(const TArray64<float>& MagnitudeSpectrum, const float Percentile)
+float UCoreFrequencyDomainFeatures::GetSpectralRolloff(TArrayView64<const float> MagnitudeSpectrum, const float Percentile)
 {
-	TArray64<float>::SizeType Index{0};
+	int64 Index{0};
 
 	{
 		const float SumOfMagnitudeSpectrum{Algo::Accumulate<float>(MagnitudeSpectrum, 0.f)};
@@ -110,7 +110,7 @@ float UCoreFrequencyDomainFeatures::GetSpectralRolloff(const TArray64<float>& Ma
 
 		float CumulativeSum{0};
 
-		for (TArray64<float>::SizeType i = 0; i < MagnitudeSpectrum.Num(); ++i)
+		for (int64 i = 0; i < MagnitudeSpectrum.Num(); ++i)
 		{
 			CumulativeSum += MagnitudeSpectrum[i];
 
@@ -129,10 +129,10 @@ float UCoreFrequencyDomainFeatures::GetSpectralRolloff(const TArray64<float>& Ma
 
 float UCoreFrequencyDomainFeatures::GetSpectralKurtosis(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetSpectralKurtosis(TArray64<float>(MagnitudeSpectrum));
+	return GetSpectralKurtosis(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UCoreFrequencyDomainFeatures::GetSpectralKurtosis(const TArray64<float>& MagnitudeSpectrum)
+float UCoreFrequencyDomainFeatures::GetSpectralKurtosis(TArrayView64<const float> MagnitudeSpectrum)
 {
 	float Moment2{0.f};
 	float Moment4{0.f};
@@ -159,5 +159,137 @@ float UCoreFrequencyDomainFeatures::GetSpectralKurtosis(const TArray64<float>& M
 		return -3.f;
 	}
 
-	return (Moment4 / FMath::Pow(Moment4, 2)) - 3.f;
+	return (Moment4 / FMath::Pow(Moment2, 2)) - 3.f;
+}
+
+FSpectralFeatureSet UCoreFrequencyDomainFeatures::GetSpectralFeatures(const TArray<float>& MagnitudeSpectrum, int32 FeatureMask, const float RolloffPercentile)
+{
+	return GetSpectralFeatures(MagnitudeSpectrum.GetData(), MagnitudeSpectrum.Num(), FeatureMask, RolloffPercentile);
+}
+
+FSpectralFeatureSet UCoreFrequencyDomainFeatures::GetSpectralFeatures(TArrayView64<const float> MagnitudeSpectrum, int32 FeatureMask, const float RolloffPercentile)
+{
+	return GetSpectralFeatures(MagnitudeSpectrum.GetData(), MagnitudeSpectrum.Num(), FeatureMask, RolloffPercentile);
+}
+
+FSpectralFeatureSet UCoreFrequencyDomainFeatures::GetSpectralFeatures(const float* MagnitudeSpectrum, int64 NumOfBins, int32 FeatureMask, const float RolloffPercentile)
+{
+	FSpectralFeatureSet FeatureSet;
+	FeatureSet.FeatureMask = FeatureMask & AllSpectralFeatures;
+
+	if (!MagnitudeSpectrum || NumOfBins <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get spectral features: the number of bins is '%lld', expected > '0'"), NumOfBins);
+		FeatureSet.FeatureMask = 0;
+		return FeatureSet;
+	}
+
+	const bool bFlatness = FeatureSet.HasFeature(ESpectralFeature::Flatness);
+	const bool bKurtosis = FeatureSet.HasFeature(ESpectralFeature::Kurtosis);
+
+	float SumAmplitudes = 0;
+	float SumWeightedAmplitudes = 0;
+	float SumSquaredAmplitudes = 0;
+	float MaxSquaredAmplitude = 0;
+
+	// Flatness, offset by one to stop zero values making it always zero
+	float SumFlatnessValues = 0;
+	float LogSumFlatnessValues = 0;
+
+	// Raw moments for the kurtosis, accumulated in double precision since the central moments are derived from their differences
+	double RawMoment1 = 0;
+	double RawMoment2 = 0;
+	double RawMoment3 = 0;
+	double RawMoment4 = 0;
+
+	// The feature flags are loop invariant, so the compiler can unswitch the loop into a version per requested subset
+	for (int64 MagnitudeIndex = 0; MagnitudeIndex < NumOfBins; ++MagnitudeIndex)
+	{
+		const float MagnitudeValue = MagnitudeSpectrum[MagnitudeIndex];
+		const float SquaredValue = MagnitudeValue * MagnitudeValue;
+
+		SumAmplitudes += MagnitudeValue;
+		SumWeightedAmplitudes += MagnitudeValue * MagnitudeIndex;
+		SumSquaredAmplitudes += SquaredValue;
+		MaxSquaredAmplitude = FMath::Max(MaxSquaredAmplitude, SquaredValue);
+
+		if (bFlatness)
+		{
+			SumFlatnessValues += 1 + MagnitudeValue;
+			LogSumFlatnessValues += FGenericPlatformMath::Loge(1 + MagnitudeValue);
+		}
+
+		if (bKurtosis)
+		{
+			const double Value = MagnitudeValue;
+			const double SquaredDoubleValue = Value * Value;
+
+			RawMoment1 += Value;
+			RawMoment2 += SquaredDoubleValue;
+			RawMoment3 += SquaredDoubleValue * Value;
+			RawMoment4 += SquaredDoubleValue * SquaredDoubleValue;
+		}
+	}
+
+	const float NumOfBinsFloat = static_cast<float>(NumOfBins);
+
+	if (FeatureSet.HasFeature(ESpectralFeature::Centroid))
+	{
+		FeatureSet.SpectralCentroid = SumAmplitudes > 0 ? SumWeightedAmplitudes / SumAmplitudes : 0.f;
+	}
+
+	if (bFlatness)
+	{
+		const float MeanValue = SumFlatnessValues / NumOfBinsFloat;
+		FeatureSet.SpectralFlatness = MeanValue > 0 ? FGenericPlatformMath::Exp(LogSumFlatnessValues / NumOfBinsFloat) / MeanValue : 0.f;
+	}
+
+	if (FeatureSet.HasFeature(ESpectralFeature::Crest))
+	{
+		// This is a ratio so it is 1.0 if the buffer is just zeros
+		FeatureSet.SpectralCrest = SumSquaredAmplitudes > 0 ? MaxSquaredAmplitude / (SumSquaredAmplitudes / NumOfBinsFloat) : 1.f;
+	}
+
+	if (FeatureSet.HasFeature(ESpectralFeature::Rolloff))
+	{
+		// The threshold depends on the total sum, so the cumulative sum needs another pass, which stops at the rolloff bin
+		const float Threshold = SumAmplitudes * RolloffPercentile;
+
+		int64 RolloffIndex = 0;
+		float CumulativeSum = 0;
+
+		for (int64 MagnitudeIndex = 0; MagnitudeIndex < NumOfBins; ++MagnitudeIndex)
+		{
+			CumulativeSum += MagnitudeSpectrum[MagnitudeIndex];
+
+			if (CumulativeSum > Threshold)
+			{
+				RolloffIndex = MagnitudeIndex;
+				break;
+			}
+		}
+
+		FeatureSet.SpectralRolloff = static_cast<float>(RolloffIndex) / NumOfBinsFloat;
+	}
+
+	if (bKurtosis)
+	{
+		const double Mean = RawMoment1 / NumOfBins;
+		const double MeanSquared = Mean * Mean;
+
+		const double Moment2 = RawMoment2 / NumOfBins - MeanSquared;
+		const double Moment4 = RawMoment4 / NumOfBins - 4 * Mean * (RawMoment3 / NumOfBins) + 6 * MeanSquared * (RawMoment2 / NumOfBins) - 3 * MeanSquared * MeanSquared;
+
+		// A constant spectrum may leave a rounding residue instead of zero variance
+		if (Moment2 <= RawMoment2 / NumOfBins * 1e-12)
+		{
+			FeatureSet.SpectralKurtosis = -3.f;
+		}
+		else
+		{
+			FeatureSet.SpectralKurtosis = static_cast<float>(FMath::Max(Moment4, 0.) / (Moment2 * Moment2) - 3.);
+		}
+	}
+
+	return FeatureSet;
 }
@@ -3,77 +3,111 @@
 #include "Analyzers/CoreTimeDomainFeatures.h"
 #include "AudioAnalysisToolsDefines.h"
 
+#include "Math/VectorRegister.h"
+#include "Misc/EngineVersionComparison.h"
+
+#if UE_VERSION_OLDER_THAN(5, 0, 0)
+using VectorRegister4Float = VectorRegister;
+#endif
+
 float UCoreTimeDomainFeatures::GetRootMeanSquare(const TArray<float>& AudioFrame)
 {
-	return GetRootMeanSquare(TArray64<float>(AudioFrame));
+	return GetRootMeanSquare(TArrayView64<const float>(AudioFrame));
 }
 
-float UCoreTimeDomainFeatures::GetRootMeanSquare(const TArray64<float>& AudioFrame)
+float UCoreTimeDomainFeatures::GetRootMeanSquare(TArrayView64<const float> AudioFrame)
 {
-	float Sum = 0;
-
-	// Sum the squared samples
-	for (const float Frame : AudioFrame)
-	{
-		Sum += FMath::Pow(Frame, 2);
-	}
-
-	// Return the square root of the mean of squared samples
-	return FMath::Sqrt(Sum / static_cast<float>(AudioFrame.Num()));
+	return GetTimeDomainFeatures(AudioFrame).RootMeanSquare;
 }
 
 float UCoreTimeDomainFeatures::GetPeakEnergy(const TArray<float>& AudioFrame)
 {
-	return GetPeakEnergy(TArray64<float>(AudioFrame));
+	return GetPeakEnergy(TArrayView64<const float>(AudioFrame));
 }
 
-float UCoreTimeDomainFeatures::GetPeakEnergy(const TArray64<float>& AudioFrame)
+float UCoreTimeDomainFeatures::GetPeakEnergy(TArrayView64<const float> AudioFrame)
 {
-	// Create variable with very small value to hold the peak value
-	float Peak = -10000.f;
-
-	for (const float Frame : AudioFrame)
-	{
-		// Store the absolute value of the sample
-		const float AbsSample = FMath::Abs(Frame);
+	return GetTimeDomainFeatures(AudioFrame).PeakEnergy;
+}
 
-		// If the absolute value is larger than the peak
-		if (AbsSample > Peak)
-		{
-			// The peak takes on the sample value
-			Peak = AbsSample;
-		}
-	}
+float UCoreTimeDomainFeatures::GetZeroCrossingRate(const TArray<float>& AudioFrame)
+{
+	return GetZeroCrossingRate(TArrayView64<const float>(AudioFrame));
+}
 
-	return Peak;
+float UCoreTimeDomainFeatures::GetZeroCrossingRate(TArrayView64<const float> AudioFrame)
+{
+	return GetTimeDomainFeatures(AudioFrame).ZeroCrossingRate;
 }
 
-float UCoreTimeDomainFeatures::GetZeroCrossingRate(const TArray<float>& AudioFrame)
+FTimeDomainFeatureSet UCoreTimeDomainFeatures::GetTimeDomainFeatures(const TArray<float>& AudioFrame)
 {
-	return GetZeroCrossingRate(TArray64<float>(AudioFrame));
+	return GetTimeDomainFeatures(TArrayView64<const float>(AudioFrame));
 }
 
-float UCoreTimeDomainFeatures::GetZeroCrossingRate(const TArray64<float>& AudioFrame)
+FTimeDomainFeatureSet UCoreTimeDomainFeatures::GetTimeDomainFeatures(TArrayView64<const float> AudioFrame)
 {
-	// Create a variable to hold the zero crossing rate
-	float ZeroCrossingRateValue{0.f};
+	const float* RESTRICT Samples = AudioFrame.GetData();
+	const int64 NumOfSamples = AudioFrame.Num();
+
+	float SumOfSquares = 0;
+	float Peak = 0;
+	float NumOfCrossings = 0;
+
+	int64 Index = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	const VectorRegister4Float Zero = VectorSetFloat1(0.f);
+	const VectorRegister4Float One = VectorSetFloat1(1.f);
+
+	VectorRegister4Float SumOfSquaresLanes = Zero;
+	VectorRegister4Float PeakLanes = Zero;
+	VectorRegister4Float NumOfCrossingsLanes = Zero;
+
+	// Each iteration also reads the sample after the four, to count the sign changes from each of them to the next
+	for (; Index + 4 < NumOfSamples; Index += 4)
+	{
+		const VectorRegister4Float CurrentSamples = VectorLoad(Samples + Index);
+		const VectorRegister4Float NextSamples = VectorLoad(Samples + Index + 1);
+
+		SumOfSquaresLanes = VectorMultiplyAdd(CurrentSamples, CurrentSamples, SumOfSquaresLanes);
+		PeakLanes = VectorMax(PeakLanes, VectorAbs(CurrentSamples));
+
+		// The positive masks differ where the sign changes, and the differing lanes add one crossing each
+		const VectorRegister4Float SignChanges = VectorBitwiseXor(VectorCompareGT(CurrentSamples, Zero), VectorCompareGT(NextSamples, Zero));
+		NumOfCrossingsLanes = VectorAdd(NumOfCrossingsLanes, VectorBitwiseAnd(SignChanges, One));
+	}
+
+	alignas(16) float SumOfSquaresValues[4];
+	alignas(16) float PeakValues[4];
+	alignas(16) float NumOfCrossingsValues[4];
+	VectorStoreAligned(SumOfSquaresLanes, SumOfSquaresValues);
+	VectorStoreAligned(PeakLanes, PeakValues);
+	VectorStoreAligned(NumOfCrossingsLanes, NumOfCrossingsValues);
+
+	SumOfSquares = (SumOfSquaresValues[0] + SumOfSquaresValues[1]) + (SumOfSquaresValues[2] + SumOfSquaresValues[3]);
+	Peak = FMath::Max(FMath::Max(PeakValues[0], PeakValues[1]), FMath::Max(PeakValues[2], PeakValues[3]));
+	NumOfCrossings = (NumOfCrossingsValues[0] + NumOfCrossingsValues[1]) + (NumOfCrossingsValues[2] + NumOfCrossingsValues[3]);
+#endif
 
-	// For each audio sample, starting from the second one
-	for (TArray64<float>::SizeType FrameIndex = 1; FrameIndex < AudioFrame.Num(); ++FrameIndex)
+	for (; Index < NumOfSamples; ++Index)
 	{
-		// Initialise two booleans indicating whether or not
-		// The current and previous sample are positive
+		const float Sample = Samples[Index];
 
-		const bool bIsCurrentPositive{AudioFrame[FrameIndex] > 0};
-		const bool bIsPreviousPositive{AudioFrame[FrameIndex - 1] > 0};
+		SumOfSquares += Sample * Sample;
+		Peak = FMath::Max(Peak, FMath::Abs(Sample));
 
-		// If the sign is different
-		if (bIsCurrentPositive != bIsPreviousPositive)
+		// A sample is either positive or not, so zeros count as negative samples
+		if (Index + 1 < NumOfSamples && (Sample > 0) != (Samples[Index + 1] > 0))
 		{
-			// Add one to the zero crossing rate
-			ZeroCrossingRateValue += 1.0;
+			NumOfCrossings += 1;
 		}
 	}
 
-	return ZeroCrossingRateValue;
+	FTimeDomainFeatureSet Features;
+	Features.SumOfSquares = SumOfSquares;
+	Features.RootMeanSquare = FMath::Sqrt(SumOfSquares / static_cast<float>(NumOfSamples));
+	Features.PeakEnergy = Peak;
+	Features.ZeroCrossingRate = NumOfCrossings;
+	return Features;
 }
@@ -7,6 +7,18 @@
 #include "Misc/EngineVersionComparison.h"
 
 #include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+#if UE_VERSION_OLDER_THAN(5, 0, 0)
+using VectorRegister4Float = VectorRegister;
+#endif
+
+static TAutoConsoleVariable<bool> CVarFFTVectorKernels(
+	TEXT("au.AudioAnalysis.FFT.VectorKernels"),
+	true,
+	TEXT("Whether the split-complex FFT engine uses the vector (SSE/NEON) butterfly kernels. Read once at startup, the scalar kernels are used otherwise"),
+	ECVF_ReadOnly);
 
 void MultiplySamples(FFTComplexSamples& SamplesOut, const FFTComplexSamples& SamplesA, const FFTComplexSamples& SamplesB)
 {
@@ -44,6 +56,54 @@ void ApplyExponent(FFTComplexSamples* Samples, double Phase)
 	Samples->Imaginary = FMath::Sin(Phase);
 }
 
+/**
+ * Get the scratch memory of the calling thread, used by the FFTs performed without a caller-provided scratch buffer
+ * It only grows, so nothing is allocated once the largest FFT performed on the thread has been seen
+ */
+template <typename SampleType>
+SampleType* GetThreadScratch(int64 ScratchLength)
+{
+	thread_local TArray64<SampleType> Scratch;
+
+	if (Scratch.Num() < ScratchLength)
+	{
+		Scratch.SetNumUninitialized(ScratchLength);
+	}
+
+	return Scratch.GetData();
+}
+
+/**
+ * Calculate the number of samples the generic butterflies need as scratch memory
+ * The first stage may run in parallel, so each of its sub-transforms gets its own slot
+ *
+ * @param Factors The factors of the FFT, see CalculateFactors
+ * @param GenericScratchSlotLength The length of each slot, which is the largest generic radix
+ * @return The number of samples for all slots
+ */
+int64 CalculateGenericScratchLength(const int64* Factors, int64& GenericScratchSlotLength)
+{
+	const int64 FirstRadix = Factors[0];
+
+	GenericScratchSlotLength = 0;
+
+	int64 StageFFTLength;
+	do
+	{
+		const int64 Radix = *Factors++;
+		StageFFTLength = *Factors++;
+
+		// Radix 1 only happens for the FFT of size 1, which also goes through the generic butterfly
+		if (Radix < 2 || Radix > 5)
+		{
+			GenericScratchSlotLength = FMath::Max(GenericScratchSlotLength, Radix);
+		}
+	}
+	while (StageFFTLength > 1);
+
+	return (FirstRadix <= 5 ? FirstRadix : 1) * GenericScratchSlotLength;
+}
+
 void CalculateButterfly2(FFTComplexSamples* SamplesOut, int64 Stride, const FFTStateStruct* FFTState, int64 StageFFTLength)
 {
 	const FFTComplexSamples* SamplesTwiddles = FFTState->Twiddles;
@@ -209,14 +269,12 @@ void CalculateButterfly5(FFTComplexSamples* SamplesOut, int64 Stride, const FFTS
 	}
 }
 
-void CalculateButterfly_Generic(FFTComplexSamples* Samples, int64 Stride, const FFTStateStruct* FFTState, int64 StageFFTLength, int64 Radix)
+void CalculateButterfly_Generic(FFTComplexSamples* Samples, int64 Stride, const FFTStateStruct* FFTState, int64 StageFFTLength, int64 Radix, FFTComplexSamples* Scratch)
 {
 	const FFTComplexSamples* Twiddles = FFTState->Twiddles;
 
 	const int64 Norig = FFTState->NFFT;
 
-	FFTComplexSamples* Scratch = static_cast<FFTComplexSamples*>(FMemory::Malloc(sizeof(FFTComplexSamples) * Radix));
-
 	for (int64 StageFFTIndex = 0; StageFFTIndex < StageFFTLength; ++StageFFTIndex)
 	{
 		int64 RadixIndex;
@@ -251,11 +309,14 @@ void CalculateButterfly_Generic(FFTComplexSamples* Samples, int64 Stride, const
 			TempStageFFTIndex += StageFFTLength;
 		}
 	}
-
-	FMemory::Free(Scratch);
 }
 
-void DoWork(FFTComplexSamples* SamplesOut, const FFTComplexSamples* SamplesIn, int64 Stride, int64 InStride, int64* Factors, const FFTStateStruct* FFTState)
+/**
+ * Perform the mixed-radix FFT recursively
+ *
+ * @param Scratch The scratch memory of the generic butterflies, GenericScratchSlotLength samples per sub-transform of the first stage
+ */
+void DoWork(FFTComplexSamples* SamplesOut, const FFTComplexSamples* SamplesIn, int64 Stride, int64 InStride, const int64* Factors, const FFTStateStruct* FFTState, bool bParallel, FFTComplexSamples* Scratch, int64 GenericScratchSlotLength)
 {
 	FFTComplexSamples* SamplesOut_Beg = SamplesOut;
 
@@ -264,12 +325,13 @@ void DoWork(FFTComplexSamples* SamplesOut, const FFTComplexSamples* SamplesIn, i
 
 	const FFTComplexSamples* SamplesOut_End = SamplesOut + Radix * StageFFTLength;
 
-	if (Stride == 1 && Radix <= 5 && StageFFTLength != 1)
+	// Only the first stage is split, and only when requested, since the task dispatch costs more than a typical frame-sized sub-transform
+	if (bParallel && Stride == 1 && Radix <= 5 && StageFFTLength != 1)
 	{
 		ParallelFor(
 			Radix, [&](int64 RadixIndex)
 			{
-				DoWork(SamplesOut + RadixIndex * StageFFTLength, SamplesIn + Stride * InStride * RadixIndex, Stride * Radix, InStride, Factors, FFTState);
+				DoWork(SamplesOut + RadixIndex * StageFFTLength, SamplesIn + Stride * InStride * RadixIndex, Stride * Radix, InStride, Factors, FFTState, false, Scratch + RadixIndex * GenericScratchSlotLength, GenericScratchSlotLength);
 			},
 			false);
 	}
@@ -288,7 +350,7 @@ void DoWork(FFTComplexSamples* SamplesOut, const FFTComplexSamples* SamplesIn, i
 	{
 		do
 		{
-			DoWork(SamplesOut, SamplesIn, Stride * Radix, InStride, Factors, FFTState);
+			DoWork(SamplesOut, SamplesIn, Stride * Radix, InStride, Factors, FFTState, false, Scratch, GenericScratchSlotLength);
 			SamplesIn += Stride * InStride;
 		}
 		while ((SamplesOut += StageFFTLength) != SamplesOut_End);
@@ -311,31 +373,55 @@ void DoWork(FFTComplexSamples* SamplesOut, const FFTComplexSamples* SamplesIn, i
 		CalculateButterfly5(SamplesOut, Stride, FFTState, StageFFTLength);
 		break;
 	default:
-		CalculateButterfly_Generic(SamplesOut, Stride, FFTState, StageFFTLength, Radix);
+		CalculateButterfly_Generic(SamplesOut, Stride, FFTState, StageFFTLength, Radix, Scratch);
 		break;
 	}
 }
 
-void UFFTAudioAnalyzer::PerformFFTStride(FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut, int64 Stride)
+void UFFTAudioAnalyzer::PerformFFTStride(const FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut, int64 Stride, bool bParallel, FFTComplexSamples* Scratch)
 {
-	if (SamplesIn == SamplesOut)
+	// DoWork is recursive, so the transform is measured here once
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_FFTTransform);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_FFTTransform);
+
+	if (!Scratch)
 	{
-		FFTComplexSamples* TempBuffer = static_cast<FFTComplexSamples*>(FMemory::Malloc(sizeof(FFTComplexSamples) * FFTState->NFFT));
+		Scratch = GetThreadScratch<FFTComplexSamples>(FFTState->ScratchLength);
+	}
+
+	// The first NFFT samples of the scratch memory hold the result of the in-place FFT, the rest is for the generic butterflies
+	FFTComplexSamples* GenericScratch = Scratch + FFTState->NFFT;
 
-		DoWork(TempBuffer, SamplesIn, 1, Stride, FFTState->Factors, FFTState);
+	int64 GenericScratchSlotLength;
+	CalculateGenericScratchLength(FFTState->Factors, GenericScratchSlotLength);
 
-		FMemory::Memcpy(SamplesOut, TempBuffer, sizeof(FFTComplexSamples) * FFTState->NFFT);
-		FMemory::Free(TempBuffer);
+	if (SamplesIn == SamplesOut)
+	{
+		DoWork(Scratch, SamplesIn, 1, Stride, FFTState->Factors, FFTState, bParallel, GenericScratch, GenericScratchSlotLength);
+
+		FMemory::Memcpy(SamplesOut, Scratch, sizeof(FFTComplexSamples) * FFTState->NFFT);
 	}
 	else
 	{
-		DoWork(SamplesOut, SamplesIn, 1, Stride, FFTState->Factors, FFTState);
+		DoWork(SamplesOut, SamplesIn, 1, Stride, FFTState->Factors, FFTState, bParallel, GenericScratch, GenericScratchSlotLength);
 	}
 }
 
-void UFFTAudioAnalyzer::PerformFFT(FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut)
+void UFFTAudioAnalyzer::PerformFFT(const FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut, bool bParallel, FFTComplexSamples* Scratch)
+{
+	PerformFFTStride(FFTState, SamplesIn, SamplesOut, 1, bParallel, Scratch);
+}
+
+bool UFFTAudioAnalyzer::ShouldRunInParallel(EFFTExecutionPolicy ExecutionPolicy, int64 NFFT, int64 ParallelThreshold)
 {
-	PerformFFTStride(FFTState, SamplesIn, SamplesOut, 1);
+	switch (ExecutionPolicy)
+	{
+	case EFFTExecutionPolicy::ParallelAboveThreshold:
+		return NFFT >= ParallelThreshold;
+	case EFFTExecutionPolicy::Inline:
+	default:
+		return false;
+	}
 }
 
 void CalculateFactors(int64 Number, int64* Factors)
@@ -418,7 +504,823 @@ FFTStateStruct* UFFTAudioAnalyzer::PerformFFTAlloc(int64 NFFT, int64 Inverse_FFT
 		}
 
 		CalculateFactors(NFFT, FFTState->Factors);
+
+		int64 GenericScratchSlotLength;
+		FFTState->ScratchLength = NFFT + CalculateGenericScratchLength(FFTState->Factors, GenericScratchSlotLength);
 	}
 
 	return FFTState;
 }
+
+void UFFTAudioAnalyzer::PerformFFTReal(const FFTRealStateStruct* FFTRealState, const float* SamplesIn, FFTComplexSamples* SamplesOut, bool bParallel, FFTComplexSamples* Scratch)
+{
+	const int64 NCFFT = FFTRealState->SubState->NFFT;
+
+	// Treat the real samples as NFFT / 2 complex samples (even samples are real parts, odd samples are imaginary parts)
+	PerformFFT(FFTRealState->SubState, reinterpret_cast<const FFTComplexSamples*>(SamplesIn), SamplesOut, bParallel, Scratch);
+
+	// Split the packed result into the real spectrum. Bins K and NCFFT - K depend on each other only, so this is done in place
+	const FFTComplexSamples DCSamples = SamplesOut[0];
+	SamplesOut[0].Real = DCSamples.Real + DCSamples.Imaginary;
+	SamplesOut[NCFFT].Real = DCSamples.Real - DCSamples.Imaginary;
+	SamplesOut[NCFFT].Imaginary = SamplesOut[0].Imaginary = 0;
+
+	for (int64 Index = 1; Index <= NCFFT / 2; ++Index)
+	{
+		const FFTComplexSamples FPK = SamplesOut[Index];
+		const FFTComplexSamples FPNK{SamplesOut[NCFFT - Index].Real, -SamplesOut[NCFFT - Index].Imaginary};
+
+		FFTComplexSamples F1K, F2K, Twiddled;
+		AddSamples(F1K, FPK, FPNK);
+		RemoveSamples(F2K, FPK, FPNK);
+		MultiplySamples(Twiddled, F2K, FFTRealState->SuperTwiddles[Index - 1]);
+
+		SamplesOut[Index].Real = 0.5f * (F1K.Real + Twiddled.Real);
+		SamplesOut[Index].Imaginary = 0.5f * (F1K.Imaginary + Twiddled.Imaginary);
+		SamplesOut[NCFFT - Index].Real = 0.5f * (F1K.Real - Twiddled.Real);
+		SamplesOut[NCFFT - Index].Imaginary = 0.5f * (Twiddled.Imaginary - F1K.Imaginary);
+	}
+}
+
+FFTRealStateStruct* UFFTAudioAnalyzer::PerformFFTRealAlloc(int64 NFFT, int64 Inverse_FFT, void* MemoryPtr, int64* MemoryLength)
+{
+	if (NFFT <= 0 || NFFT % 2 != 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to allocate the real FFT state: the FFT size is '%lld', expected an even value greater than '0'"), NFFT);
+		return nullptr;
+	}
+
+	// PerformFFTReal only implements the forward packing and post-processing, so an inverse state would silently produce a wrong result
+	if (Inverse_FFT)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to allocate the real FFT state: the inverse real FFT is not supported, use the complex inverse FFT instead"));
+		return nullptr;
+	}
+
+	FFTRealStateStruct* FFTRealState = nullptr;
+
+	const int64 NCFFT = NFFT / 2;
+
+	int64 SubStateMemoryLength = 0;
+	PerformFFTAlloc(NCFFT, Inverse_FFT, nullptr, &SubStateMemoryLength);
+
+	// The sub state and the super twiddles are placed right after the real state in a single block
+	const int64 MemoryRequired = sizeof(FFTRealStateStruct) + SubStateMemoryLength + sizeof(FFTComplexSamples) * NCFFT;
+
+	if (MemoryLength == nullptr)
+	{
+		FFTRealState = static_cast<FFTRealStateStruct*>(FMemory::Malloc(MemoryRequired));
+	}
+	else
+	{
+		if (MemoryPtr && *MemoryLength >= MemoryRequired)
+		{
+			FFTRealState = static_cast<FFTRealStateStruct*>(MemoryPtr);
+		}
+
+		*MemoryLength = MemoryRequired;
+	}
+
+	if (FFTRealState)
+	{
+		FFTRealState->SubState = reinterpret_cast<FFTStateStruct*>(FFTRealState + 1);
+		FFTRealState->SuperTwiddles = reinterpret_cast<FFTComplexSamples*>(reinterpret_cast<uint8*>(FFTRealState->SubState) + SubStateMemoryLength);
+
+		PerformFFTAlloc(NCFFT, Inverse_FFT, FFTRealState->SubState, &SubStateMemoryLength);
+
+		for (int64 NFFT_Index = 0; NFFT_Index < NCFFT; ++NFFT_Index)
+		{
+			const double Phase = -PI * (static_cast<double>(NFFT_Index + 1) / NCFFT + 0.5);
+			ApplyExponent(FFTRealState->SuperTwiddles + NFFT_Index, Phase);
+		}
+	}
+
+	return FFTRealState;
+}
+
+/** Scalar lane operations of the split-complex FFT engine. Also used for the tails of the vectorized loops */
+struct FSplitScalarOps
+{
+	using FRegister = float;
+	static constexpr int64 Width = 1;
+
+	static FORCEINLINE FRegister Load(const float* Ptr) { return *Ptr; }
+	static FORCEINLINE void Store(float* Ptr, FRegister Value) { *Ptr = Value; }
+	static FORCEINLINE FRegister Set(float Value) { return Value; }
+	static FORCEINLINE FRegister Add(FRegister A, FRegister B) { return A + B; }
+	static FORCEINLINE FRegister Subtract(FRegister A, FRegister B) { return A - B; }
+	static FORCEINLINE FRegister Multiply(FRegister A, FRegister B) { return A * B; }
+	static FORCEINLINE FRegister MultiplyAdd(FRegister A, FRegister B, FRegister C) { return A * B + C; }
+};
+
+/** Vector lane operations of the split-complex FFT engine. Resolved to SSE or NEON by the Unreal vector abstraction */
+struct FSplitVectorOps
+{
+	using FRegister = VectorRegister4Float;
+	static constexpr int64 Width = 4;
+
+	static FORCEINLINE FRegister Load(const float* Ptr) { return VectorLoad(Ptr); }
+	static FORCEINLINE void Store(float* Ptr, const FRegister& Value) { VectorStore(Value, Ptr); }
+	static FORCEINLINE FRegister Set(float Value) { return VectorSetFloat1(Value); }
+	static FORCEINLINE FRegister Add(const FRegister& A, const FRegister& B) { return VectorAdd(A, B); }
+	static FORCEINLINE FRegister Subtract(const FRegister& A, const FRegister& B) { return VectorSubtract(A, B); }
+	static FORCEINLINE FRegister Multiply(const FRegister& A, const FRegister& B) { return VectorMultiply(A, B); }
+	static FORCEINLINE FRegister MultiplyAdd(const FRegister& A, const FRegister& B, const FRegister& C) { return VectorMultiplyAdd(A, B, C); }
+};
+
+/** Load Width samples of the given sub-sequence of the stage and multiply them by the stage twiddles */
+template <typename Ops>
+FORCEINLINE void LoadTwiddledSplitSamples(typename Ops::FRegister& OutReal, typename Ops::FRegister& OutImaginary, const float* Real, const float* Imaginary, const float* TwiddlesReal, const float* TwiddlesImaginary, int64 Index)
+{
+	const typename Ops::FRegister SampleReal = Ops::Load(Real + Index);
+	const typename Ops::FRegister SampleImaginary = Ops::Load(Imaginary + Index);
+	const typename Ops::FRegister TwiddleReal = Ops::Load(TwiddlesReal + Index);
+	const typename Ops::FRegister TwiddleImaginary = Ops::Load(TwiddlesImaginary + Index);
+
+	OutReal = Ops::Subtract(Ops::Multiply(SampleReal, TwiddleReal), Ops::Multiply(SampleImaginary, TwiddleImaginary));
+	OutImaginary = Ops::MultiplyAdd(SampleReal, TwiddleImaginary, Ops::Multiply(SampleImaginary, TwiddleReal));
+}
+
+/**
+ * Split-complex butterflies. Real/Imaginary point to the beginning of the stage, the stage twiddles are laid out as (Radix - 1) rows of StageFFTLength values
+ * Each kernel processes the sub-sequence indices [Begin, End) in steps of Ops::Width
+ */
+template <typename Ops>
+void CalculateSplitButterfly2(float* Real, float* Imaginary, const float* TwiddlesReal, const float* TwiddlesImaginary, int64 Begin, int64 End, int64 StageFFTLength, const FFTStateStruct* FFTState, int64 Stride)
+{
+	float* Real1 = Real + StageFFTLength;
+	float* Imaginary1 = Imaginary + StageFFTLength;
+
+	for (int64 Index = Begin; Index < End; Index += Ops::Width)
+	{
+		typename Ops::FRegister TempReal, TempImaginary;
+		LoadTwiddledSplitSamples<Ops>(TempReal, TempImaginary, Real1, Imaginary1, TwiddlesReal, TwiddlesImaginary, Index);
+
+		const typename Ops::FRegister Real0 = Ops::Load(Real + Index);
+		const typename Ops::FRegister Imaginary0 = Ops::Load(Imaginary + Index);
+
+		Ops::Store(Real1 + Index, Ops::Subtract(Real0, TempReal));
+		Ops::Store(Imaginary1 + Index, Ops::Subtract(Imaginary0, TempImaginary));
+		Ops::Store(Real + Index, Ops::Add(Real0, TempReal));
+		Ops::Store(Imaginary + Index, Ops::Add(Imaginary0, TempImaginary));
+	}
+}
+
+template <typename Ops>
+void CalculateSplitButterfly3(float* Real, float* Imaginary, const float* TwiddlesReal, const float* TwiddlesImaginary, int64 Begin, int64 End, int64 StageFFTLength, const FFTStateStruct* FFTState, int64 Stride)
+{
+	using FRegister = typename Ops::FRegister;
+
+	const FRegister EPI3 = Ops::Set(FFTState->Twiddles[Stride * StageFFTLength].Imaginary);
+	const FRegister Half = Ops::Set(0.5f);
+
+	float* Real1 = Real + StageFFTLength;
+	float* Imaginary1 = Imaginary + StageFFTLength;
+	float* Real2 = Real + 2 * StageFFTLength;
+	float* Imaginary2 = Imaginary + 2 * StageFFTLength;
+
+	for (int64 Index = Begin; Index < End; Index += Ops::Width)
+	{
+		FRegister Scratch1Real, Scratch1Imaginary, Scratch2Real, Scratch2Imaginary;
+		LoadTwiddledSplitSamples<Ops>(Scratch1Real, Scratch1Imaginary, Real1, Imaginary1, TwiddlesReal, TwiddlesImaginary, Index);
+		LoadTwiddledSplitSamples<Ops>(Scratch2Real, Scratch2Imaginary, Real2, Imaginary2, TwiddlesReal + StageFFTLength, TwiddlesImaginary + StageFFTLength, Index);
+
+		const FRegister Scratch3Real = Ops::Add(Scratch1Real, Scratch2Real);
+		const FRegister Scratch3Imaginary = Ops::Add(Scratch1Imaginary, Scratch2Imaginary);
+		const FRegister Scratch0Real = Ops::Multiply(Ops::Subtract(Scratch1Real, Scratch2Real), EPI3);
+		const FRegister Scratch0Imaginary = Ops::Multiply(Ops::Subtract(Scratch1Imaginary, Scratch2Imaginary), EPI3);
+
+		const FRegister Real0 = Ops::Load(Real + Index);
+		const FRegister Imaginary0 = Ops::Load(Imaginary + Index);
+
+		const FRegister MidReal = Ops::Subtract(Real0, Ops::Multiply(Scratch3Real, Half));
+		const FRegister MidImaginary = Ops::Subtract(Imaginary0, Ops::Multiply(Scratch3Imaginary, Half));
+
+		Ops::Store(Real + Index, Ops::Add(Real0, Scratch3Real));
+		Ops::Store(Imaginary + Index, Ops::Add(Imaginary0, Scratch3Imaginary));
+
+		Ops::Store(Real2 + Index, Ops::Add(MidReal, Scratch0Imaginary));
+		Ops::Store(Imaginary2 + Index, Ops::Subtract(MidImaginary, Scratch0Real));
+
+		Ops::Store(Real1 + Index, Ops::Subtract(MidReal, Scratch0Imaginary));
+		Ops::Store(Imaginary1 + Index, Ops::Add(MidImaginary, Scratch0Real));
+	}
+}
+
+template <typename Ops>
+void CalculateSplitButterfly4(float* Real, float* Imaginary, const float* TwiddlesReal, const float* TwiddlesImaginary, int64 Begin, int64 End, int64 StageFFTLength, const FFTStateStruct* FFTState, int64 Stride)
+{
+	using FRegister = typename Ops::FRegister;
+
+	const bool bInverse = FFTState->Inverse != 0;
+
+	float* Real1 = Real + StageFFTLength;
+	float* Imaginary1 = Imaginary + StageFFTLength;
+	float* Real2 = Real + 2 * StageFFTLength;
+	float* Imaginary2 = Imaginary + 2 * StageFFTLength;
+	float* Real3 = Real + 3 * StageFFTLength;
+	float* Imaginary3 = Imaginary + 3 * StageFFTLength;
+
+	for (int64 Index = Begin; Index < End; Index += Ops::Width)
+	{
+		FRegister Scratch0Real, Scratch0Imaginary, Scratch1Real, Scratch1Imaginary, Scratch2Real, Scratch2Imaginary;
+		LoadTwiddledSplitSamples<Ops>(Scratch0Real, Scratch0Imaginary, Real1, Imaginary1, TwiddlesReal, TwiddlesImaginary, Index);
+		LoadTwiddledSplitSamples<Ops>(Scratch1Real, Scratch1Imaginary, Real2, Imaginary2, TwiddlesReal + StageFFTLength, TwiddlesImaginary + StageFFTLength, Index);
+		LoadTwiddledSplitSamples<Ops>(Scratch2Real, Scratch2Imaginary, Real3, Imaginary3, TwiddlesReal + 2 * StageFFTLength, TwiddlesImaginary + 2 * StageFFTLength, Index);
+
+		const FRegister Real0 = Ops::Load(Real + Index);
+		const FRegister Imaginary0 = Ops::Load(Imaginary + Index);
+
+		const FRegister Scratch5Real = Ops::Subtract(Real0, Scratch1Real);
+		const FRegister Scratch5Imaginary = Ops::Subtract(Imaginary0, Scratch1Imaginary);
+		const FRegister SumReal = Ops::Add(Real0, Scratch1Real);
+		const FRegister SumImaginary = Ops::Add(Imaginary0, Scratch1Imaginary);
+		const FRegister Scratch3Real = Ops::Add(Scratch0Real, Scratch2Real);
+		const FRegister Scratch3Imaginary = Ops::Add(Scratch0Imaginary, Scratch2Imaginary);
+		const FRegister Scratch4Real = Ops::Subtract(Scratch0Real, Scratch2Real);
+		const FRegister Scratch4Imaginary = Ops::Subtract(Scratch0Imaginary, Scratch2Imaginary);
+
+		Ops::Store(Real2 + Index, Ops::Subtract(SumReal, Scratch3Real));
+		Ops::Store(Imaginary2 + Index, Ops::Subtract(SumImaginary, Scratch3Imaginary));
+		Ops::Store(Real + Index, Ops::Add(SumReal, Scratch3Real));
+		Ops::Store(Imaginary + Index, Ops::Add(SumImaginary, Scratch3Imaginary));
+
+		if (bInverse)
+		{
+			Ops::Store(Real1 + Index, Ops::Subtract(Scratch5Real, Scratch4Imaginary));
+			Ops::Store(Imaginary1 + Index, Ops::Add(Scratch5Imaginary, Scratch4Real));
+			Ops::Store(Real3 + Index, Ops::Add(Scratch5Real, Scratch4Imaginary));
+			Ops::Store(Imaginary3 + Index, Ops::Subtract(Scratch5Imaginary, Scratch4Real));
+		}
+		else
+		{
+			Ops::Store(Real1 + Index, Ops::Add(Scratch5Real, Scratch4Imaginary));
+			Ops::Store(Imaginary1 + Index, Ops::Subtract(Scratch5Imaginary, Scratch4Real));
+			Ops::Store(Real3 + Index, Ops::Subtract(Scratch5Real, Scratch4Imaginary));
+			Ops::Store(Imaginary3 + Index, Ops::Add(Scratch5Imaginary, Scratch4Real));
+		}
+	}
+}
+
+template <typename Ops>
+void CalculateSplitButterfly5(float* Real, float* Imaginary, const float* TwiddlesReal, const float* TwiddlesImaginary, int64 Begin, int64 End, int64 StageFFTLength, const FFTStateStruct* FFTState, int64 Stride)
+{
+	using FRegister = typename Ops::FRegister;
+
+	const FFTComplexSamples YaSamples = FFTState->Twiddles[Stride * StageFFTLength];
+	const FFTComplexSamples YbSamples = FFTState->Twiddles[Stride * 2 * StageFFTLength];
+
+	const FRegister YaReal = Ops::Set(YaSamples.Real);
+	const FRegister YaImaginary = Ops::Set(YaSamples.Imaginary);
+	const FRegister YbReal = Ops::Set(YbSamples.Real);
+	const FRegister YbImaginary = Ops::Set(YbSamples.Imaginary);
+
+	float* Real1 = Real + StageFFTLength;
+	float* Imaginary1 = Imaginary + StageFFTLength;
+	float* Real2 = Real + 2 * StageFFTLength;
+	float* Imaginary2 = Imaginary + 2 * StageFFTLength;
+	float* Real3 = Real + 3 * StageFFTLength;
+	float* Imaginary3 = Imaginary + 3 * StageFFTLength;
+	float* Real4 = Real + 4 * StageFFTLength;
+	float* Imaginary4 = Imaginary + 4 * StageFFTLength;
+
+	for (int64 Index = Begin; Index < End; Index += Ops::Width)
+	{
+		const FRegister Scratch0Real = Ops::Load(Real + Index);
+		const FRegister Scratch0Imaginary = Ops::Load(Imaginary + Index);
+
+		FRegister Scratch1Real, Scratch1Imaginary, Scratch2Real, Scratch2Imaginary, Scratch3Real, Scratch3Imaginary, Scratch4Real, Scratch4Imaginary;
+		LoadTwiddledSplitSamples<Ops>(Scratch1Real, Scratch1Imaginary, Real1, Imaginary1, TwiddlesReal, TwiddlesImaginary, Index);
+		LoadTwiddledSplitSamples<Ops>(Scratch2Real, Scratch2Imaginary, Real2, Imaginary2, TwiddlesReal + StageFFTLength, TwiddlesImaginary + StageFFTLength, Index);
+		LoadTwiddledSplitSamples<Ops>(Scratch3Real, Scratch3Imaginary, Real3, Imaginary3, TwiddlesReal + 2 * StageFFTLength, TwiddlesImaginary + 2 * StageFFTLength, Index);
+		LoadTwiddledSplitSamples<Ops>(Scratch4Real, Scratch4Imaginary, Real4, Imaginary4, TwiddlesReal + 3 * StageFFTLength, TwiddlesImaginary + 3 * StageFFTLength, Index);
+
+		const FRegister Scratch7Real = Ops::Add(Scratch1Real, Scratch4Real);
+		const FRegister Scratch7Imaginary = Ops::Add(Scratch1Imaginary, Scratch4Imaginary);
+		const FRegister Scratch10Real = Ops::Subtract(Scratch1Real, Scratch4Real);
+		const FRegister Scratch10Imaginary = Ops::Subtract(Scratch1Imaginary, Scratch4Imaginary);
+		const FRegister Scratch8Real = Ops::Add(Scratch2Real, Scratch3Real);
+		const FRegister Scratch8Imaginary = Ops::Add(Scratch2Imaginary, Scratch3Imaginary);
+		const FRegister Scratch9Real = Ops::Subtract(Scratch2Real, Scratch3Real);
+		const FRegister Scratch9Imaginary = Ops::Subtract(Scratch2Imaginary, Scratch3Imaginary);
+
+		Ops::Store(Real + Index, Ops::Add(Scratch0Real, Ops::Add(Scratch7Real, Scratch8Real)));
+		Ops::Store(Imaginary + Index, Ops::Add(Scratch0Imaginary, Ops::Add(Scratch7Imaginary, Scratch8Imaginary)));
+
+		const FRegister Scratch5Real = Ops::MultiplyAdd(Scratch8Real, YbReal, Ops::MultiplyAdd(Scratch7Real, YaReal, Scratch0Real));
+		const FRegister Scratch5Imaginary = Ops::MultiplyAdd(Scratch8Imaginary, YbReal, Ops::MultiplyAdd(Scratch7Imaginary, YaReal, Scratch0Imaginary));
+		const FRegister Scratch6Real = Ops::MultiplyAdd(Scratch10Imaginary, YaImaginary, Ops::Multiply(Scratch9Imaginary, YbImaginary));
+		const FRegister Scratch6Imaginary = Ops::Subtract(Ops::Set(0.f), Ops::MultiplyAdd(Scratch10Real, YaImaginary, Ops::Multiply(Scratch9Real, YbImaginary)));
+
+		Ops::Store(Real1 + Index, Ops::Subtract(Scratch5Real, Scratch6Real));
+		Ops::Store(Imaginary1 + Index, Ops::Subtract(Scratch5Imaginary, Scratch6Imaginary));
+		Ops::Store(Real4 + Index, Ops::Add(Scratch5Real, Scratch6Real));
+		Ops::Store(Imaginary4 + Index, Ops::Add(Scratch5Imaginary, Scratch6Imaginary));
+
+		const FRegister Scratch11Real = Ops::MultiplyAdd(Scratch8Real, YaReal, Ops::MultiplyAdd(Scratch7Real, YbReal, Scratch0Real));
+		const FRegister Scratch11Imaginary = Ops::MultiplyAdd(Scratch8Imaginary, YaReal, Ops::MultiplyAdd(Scratch7Imaginary, YbReal, Scratch0Imaginary));
+		const FRegister Scratch12Real = Ops::Subtract(Ops::Multiply(Scratch9Imaginary, YaImaginary), Ops::Multiply(Scratch10Imaginary, YbImaginary));
+		const FRegister Scratch12Imaginary = Ops::Subtract(Ops::Multiply(Scratch10Real, YbImaginary), Ops::Multiply(Scratch9Real, YaImaginary));
+
+		Ops::Store(Real2 + Index, Ops::Add(Scratch11Real, Scratch12Real));
+		Ops::Store(Imaginary2 + Index, Ops::Add(Scratch11Imaginary, Scratch12Imaginary));
+		Ops::Store(Real3 + Index, Ops::Subtract(Scratch11Real, Scratch12Real));
+		Ops::Store(Imaginary3 + Index, Ops::Subtract(Scratch11Imaginary, Scratch12Imaginary));
+	}
+}
+
+void CalculateSplitButterfly_Generic(float* Real, float* Imaginary, int64 Stride, const FFTStateStruct* FFTState, int64 StageFFTLength, int64 Radix, float* Scratch)
+{
+	const FFTComplexSamples* Twiddles = FFTState->Twiddles;
+
+	const int64 Norig = FFTState->NFFT;
+
+	float* ScratchReal = Scratch;
+	float* ScratchImaginary = Scratch + Radix;
+
+	for (int64 StageFFTIndex = 0; StageFFTIndex < StageFFTLength; ++StageFFTIndex)
+	{
+		int64 RadixIndex;
+
+		int64 TempStageFFTIndex = StageFFTIndex;
+		for (RadixIndex = 0; RadixIndex < Radix; ++RadixIndex)
+		{
+			ScratchReal[RadixIndex] = Real[TempStageFFTIndex];
+			ScratchImaginary[RadixIndex] = Imaginary[TempStageFFTIndex];
+			TempStageFFTIndex += StageFFTLength;
+		}
+
+		TempStageFFTIndex = StageFFTIndex;
+		for (RadixIndex = 0; RadixIndex < Radix; ++RadixIndex)
+		{
+			int64 Twidx = 0;
+			FFTComplexSamples Sum{ScratchReal[0], ScratchImaginary[0]};
+
+			for (int64 RadixIndex1 = 1; RadixIndex1 < Radix; ++RadixIndex1)
+			{
+				FFTComplexSamples OutSamples;
+
+				Twidx += Stride * TempStageFFTIndex;
+
+				if (Twidx >= Norig)
+				{
+					Twidx -= Norig;
+				}
+
+				MultiplySamples(OutSamples, FFTComplexSamples{ScratchReal[RadixIndex1], ScratchImaginary[RadixIndex1]}, Twiddles[Twidx]);
+				AddSamplesTo(Sum, OutSamples);
+			}
+
+			Real[TempStageFFTIndex] = Sum.Real;
+			Imaginary[TempStageFFTIndex] = Sum.Imaginary;
+			TempStageFFTIndex += StageFFTLength;
+		}
+	}
+}
+
+using FSplitButterflyFunction = void (*)(float* Real, float* Imaginary, const float* TwiddlesReal, const float* TwiddlesImaginary, int64 Begin, int64 End, int64 StageFFTLength, const FFTStateStruct* FFTState, int64 Stride);
+
+/**
+ * Butterfly kernels of the split-complex FFT engine (radix 2 to 5)
+ */
+struct FSplitButterflyKernels
+{
+	/** Kernels for the main loop, processing Width sub-sequences at a time */
+	FSplitButterflyFunction Main[4];
+
+	/** Scalar kernels for the sub-sequences left over by the main loop */
+	FSplitButterflyFunction Tail[4];
+
+	/** The number of sub-sequences processed at a time by the main kernels */
+	int64 Width;
+};
+
+template <typename Ops>
+FSplitButterflyKernels MakeSplitButterflyKernels()
+{
+	return FSplitButterflyKernels{
+		{&CalculateSplitButterfly2<Ops>, &CalculateSplitButterfly3<Ops>, &CalculateSplitButterfly4<Ops>, &CalculateSplitButterfly5<Ops>},
+		{&CalculateSplitButterfly2<FSplitScalarOps>, &CalculateSplitButterfly3<FSplitScalarOps>, &CalculateSplitButterfly4<FSplitScalarOps>, &CalculateSplitButterfly5<FSplitScalarOps>},
+		Ops::Width
+	};
+}
+
+const FSplitButterflyKernels& GetSplitButterflyKernels()
+{
+	static const FSplitButterflyKernels Kernels = []()
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		if (CVarFFTVectorKernels.GetValueOnAnyThread())
+		{
+			UE_LOG(LogAudioAnalysis, Log, TEXT("Using the vector butterfly kernels for the split-complex FFT"));
+			return MakeSplitButterflyKernels<FSplitVectorOps>();
+		}
+#endif
+		UE_LOG(LogAudioAnalysis, Log, TEXT("Using the scalar butterfly kernels for the split-complex FFT"));
+		return MakeSplitButterflyKernels<FSplitScalarOps>();
+	}();
+
+	return Kernels;
+}
+
+/**
+ * Perform the split-complex mixed-radix FFT recursively
+ *
+ * @param Scratch The scratch memory of the generic butterflies, 2 * GenericScratchSlotLength floats per sub-transform of the first stage
+ */
+void DoWorkSplit(float* OutReal, float* OutImaginary, const float* InReal, const float* InImaginary, int64 Stride, const int64* Factors, int64 StageIndex, const FFTSplitStateStruct* FFTSplitState, bool bParallel, float* Scratch, int64 GenericScratchSlotLength)
+{
+	const int64 Radix = *Factors++;
+	const int64 StageFFTLength = *Factors++;
+
+	if (StageFFTLength == 1)
+	{
+		for (int64 RadixIndex = 0; RadixIndex < Radix; ++RadixIndex)
+		{
+			OutReal[RadixIndex] = InReal[RadixIndex * Stride];
+			OutImaginary[RadixIndex] = InImaginary[RadixIndex * Stride];
+		}
+	}
+	else if (bParallel && Stride == 1 && Radix <= 5)
+	{
+		ParallelFor(
+			Radix, [&](int64 RadixIndex)
+			{
+				DoWorkSplit(OutReal + RadixIndex * StageFFTLength, OutImaginary + RadixIndex * StageFFTLength, InReal + RadixIndex * Stride, InImaginary + RadixIndex * Stride, Stride * Radix, Factors, StageIndex + 1, FFTSplitState, false, Scratch + RadixIndex * 2 * GenericScratchSlotLength, GenericScratchSlotLength);
+			},
+			false);
+	}
+	else
+	{
+		for (int64 RadixIndex = 0; RadixIndex < Radix; ++RadixIndex)
+		{
+			DoWorkSplit(OutReal + RadixIndex * StageFFTLength, OutImaginary + RadixIndex * StageFFTLength, InReal + RadixIndex * Stride, InImaginary + RadixIndex * Stride, Stride * Radix, Factors, StageIndex + 1, FFTSplitState, false, Scratch, GenericScratchSlotLength);
+		}
+	}
+
+	// Radix 1 only happens for the FFT of size 1
+	if (Radix < 2 || Radix > 5)
+	{
+		CalculateSplitButterfly_Generic(OutReal, OutImaginary, Stride, FFTSplitState->State, StageFFTLength, Radix, Scratch);
+		return;
+	}
+
+	const FSplitButterflyKernels& Kernels = GetSplitButterflyKernels();
+
+	const float* TwiddlesReal = FFTSplitState->StageTwiddlesReal + FFTSplitState->StageTwiddleOffsets[StageIndex];
+	const float* TwiddlesImaginary = FFTSplitState->StageTwiddlesImaginary + FFTSplitState->StageTwiddleOffsets[StageIndex];
+
+	const int64 MainEnd = StageFFTLength - StageFFTLength % Kernels.Width;
+
+	if (MainEnd > 0)
+	{
+		Kernels.Main[Radix - 2](OutReal, OutImaginary, TwiddlesReal, TwiddlesImaginary, 0, MainEnd, StageFFTLength, FFTSplitState->State, Stride);
+	}
+
+	if (MainEnd < StageFFTLength)
+	{
+		Kernels.Tail[Radix - 2](OutReal, OutImaginary, TwiddlesReal, TwiddlesImaginary, MainEnd, StageFFTLength, StageFFTLength, FFTSplitState->State, Stride);
+	}
+}
+
+/**
+ * Perform the split-complex FFT with the Bluestein algorithm
+ *
+ * @param Scratch 4 * BluesteinSize floats of scratch memory
+ */
+void PerformBluesteinSplit(const FFTSplitStateStruct* FFTSplitState, const float* InReal, const float* InImaginary, float* OutReal, float* OutImaginary, bool bParallel, float* Scratch)
+{
+	const FFTSplitStateStruct* BluesteinState = FFTSplitState->BluesteinState;
+
+	const int64 NFFT = FFTSplitState->State->NFFT;
+	const int64 BluesteinSize = BluesteinState->State->NFFT;
+
+	const float* ChirpReal = FFTSplitState->ChirpReal;
+	const float* ChirpImaginary = FFTSplitState->ChirpImaginary;
+	const float* ChirpFilterReal = FFTSplitState->ChirpFilterReal;
+	const float* ChirpFilterImaginary = FFTSplitState->ChirpFilterImaginary;
+
+	float* ScratchReal = Scratch;
+	float* ScratchImaginary = ScratchReal + BluesteinSize;
+	float* SpectrumReal = ScratchImaginary + BluesteinSize;
+	float* SpectrumImaginary = SpectrumReal + BluesteinSize;
+
+	// Modulate the input by the chirp and zero-pad it to the Bluestein size
+	for (int64 Index = 0; Index < NFFT; ++Index)
+	{
+		ScratchReal[Index] = InReal[Index] * ChirpReal[Index] - InImaginary[Index] * ChirpImaginary[Index];
+		ScratchImaginary[Index] = InReal[Index] * ChirpImaginary[Index] + InImaginary[Index] * ChirpReal[Index];
+	}
+	FMemory::Memzero(ScratchReal + NFFT, sizeof(float) * (BluesteinSize - NFFT));
+	FMemory::Memzero(ScratchImaginary + NFFT, sizeof(float) * (BluesteinSize - NFFT));
+
+	DoWorkSplit(SpectrumReal, SpectrumImaginary, ScratchReal, ScratchImaginary, 1, BluesteinState->State->Factors, 0, BluesteinState, bParallel, nullptr, 0);
+
+	// Convolve with the chirp filter. The result is conjugated, so that the inverse FFT can be done with the same forward plan
+	for (int64 Index = 0; Index < BluesteinSize; ++Index)
+	{
+		ScratchReal[Index] = SpectrumReal[Index] * ChirpFilterReal[Index] - SpectrumImaginary[Index] * ChirpFilterImaginary[Index];
+		ScratchImaginary[Index] = -(SpectrumReal[Index] * ChirpFilterImaginary[Index] + SpectrumImaginary[Index] * ChirpFilterReal[Index]);
+	}
+
+	DoWorkSplit(SpectrumReal, SpectrumImaginary, ScratchReal, ScratchImaginary, 1, BluesteinState->State->Factors, 0, BluesteinState, bParallel, nullptr, 0);
+
+	// Conjugate back and demodulate by the chirp
+	for (int64 Index = 0; Index < NFFT; ++Index)
+	{
+		OutReal[Index] = SpectrumReal[Index] * ChirpReal[Index] + SpectrumImaginary[Index] * ChirpImaginary[Index];
+		OutImaginary[Index] = SpectrumReal[Index] * ChirpImaginary[Index] - SpectrumImaginary[Index] * ChirpReal[Index];
+	}
+}
+
+void UFFTAudioAnalyzer::PerformFFTSplit(const FFTSplitStateStruct* FFTSplitState, const float* InReal, const float* InImaginary, float* OutReal, float* OutImaginary, bool bParallel, float* Scratch)
+{
+	check(InReal != OutReal && InImaginary != OutImaginary);
+
+	// DoWorkSplit is recursive, so the transform is measured here once
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_FFTTransform);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_FFTTransform);
+
+	if (!Scratch)
+	{
+		Scratch = GetThreadScratch<float>(FFTSplitState->ScratchLength);
+	}
+
+	if (FFTSplitState->BluesteinState)
+	{
+		PerformBluesteinSplit(FFTSplitState, InReal, InImaginary, OutReal, OutImaginary, bParallel, Scratch);
+	}
+	else
+	{
+		int64 GenericScratchSlotLength;
+		CalculateGenericScratchLength(FFTSplitState->State->Factors, GenericScratchSlotLength);
+
+		DoWorkSplit(OutReal, OutImaginary, InReal, InImaginary, 1, FFTSplitState->State->Factors, 0, FFTSplitState, bParallel, Scratch, GenericScratchSlotLength);
+	}
+}
+
+void UFFTAudioAnalyzer::PerformFFTRealSplit(const FFTRealStateStruct* FFTRealState, const FFTSplitStateStruct* FFTSplitState, const float* InEven, const float* InOdd, float* OutReal, float* OutImaginary, bool bParallel, float* Scratch)
+{
+	check(FFTSplitState->State == FFTRealState->SubState);
+
+	const int64 NCFFT = FFTRealState->SubState->NFFT;
+
+	// Even samples are the real parts and odd samples are the imaginary parts of the half-sized complex FFT
+	PerformFFTSplit(FFTSplitState, InEven, InOdd, OutReal, OutImaginary, bParallel, Scratch);
+
+	// Split the packed result into the real spectrum, in place. Same as in PerformFFTReal
+	const float DCReal = OutReal[0];
+	const float DCImaginary = OutImaginary[0];
+	OutReal[0] = DCReal + DCImaginary;
+	OutReal[NCFFT] = DCReal - DCImaginary;
+	OutImaginary[NCFFT] = OutImaginary[0] = 0;
+
+	for (int64 Index = 1; Index <= NCFFT / 2; ++Index)
+	{
+		const FFTComplexSamples FPK{OutReal[Index], OutImaginary[Index]};
+		const FFTComplexSamples FPNK{OutReal[NCFFT - Index], -OutImaginary[NCFFT - Index]};
+
+		FFTComplexSamples F1K, F2K, Twiddled;
+		AddSamples(F1K, FPK, FPNK);
+		RemoveSamples(F2K, FPK, FPNK);
+		MultiplySamples(Twiddled, F2K, FFTRealState->SuperTwiddles[Index - 1]);
+
+		OutReal[Index] = 0.5f * (F1K.Real + Twiddled.Real);
+		OutImaginary[Index] = 0.5f * (F1K.Imaginary + Twiddled.Imaginary);
+		OutReal[NCFFT - Index] = 0.5f * (F1K.Real - Twiddled.Real);
+		OutImaginary[NCFFT - Index] = 0.5f * (Twiddled.Imaginary - F1K.Imaginary);
+	}
+}
+
+/**
+ * Count the stages and stage twiddles of the split-complex engine for the given factors
+ * Stages with the generic radix use the twiddles of the FFT state directly
+ */
+void CountSplitStageTwiddles(const int64* Factors, int64& NumStages, int64& NumStageTwiddles)
+{
+	NumStages = 0;
+	NumStageTwiddles = 0;
+
+	int64 StageFFTLength;
+	do
+	{
+		const int64 Radix = *Factors++;
+		StageFFTLength = *Factors++;
+
+		if (Radix <= 5)
+		{
+			NumStageTwiddles += (Radix - 1) * StageFFTLength;
+		}
+		++NumStages;
+	}
+	while (StageFFTLength > 1);
+}
+
+/**
+ * Initialize the stage twiddles of the split state. StageTwiddlesReal and StageTwiddlesImaginary must already point to the allocated memory
+ */
+void FillSplitStageTwiddles(FFTSplitStateStruct* FFTSplitState, const FFTStateStruct* FFTState, int64 NumStages)
+{
+	FFTSplitState->State = FFTState;
+	FFTSplitState->NumStages = NumStages;
+	FFTSplitState->BluesteinState = nullptr;
+	FFTSplitState->ChirpReal = FFTSplitState->ChirpImaginary = nullptr;
+	FFTSplitState->ChirpFilterReal = FFTSplitState->ChirpFilterImaginary = nullptr;
+
+	int64 GenericScratchSlotLength;
+	FFTSplitState->ScratchLength = 2 * CalculateGenericScratchLength(FFTState->Factors, GenericScratchSlotLength);
+
+	const int64* Factors = FFTState->Factors;
+	int64 Stride = 1;
+	int64 Offset = 0;
+
+	for (int64 StageIndex = 0; StageIndex < NumStages; ++StageIndex)
+	{
+		const int64 Radix = *Factors++;
+		const int64 StageFFTLength = *Factors++;
+
+		FFTSplitState->StageTwiddleOffsets[StageIndex] = Offset;
+
+		if (Radix <= 5)
+		{
+			// Row RadixIndex - 1 holds the twiddles applied to the RadixIndex-th sub-sequence of the stage
+			for (int64 RadixIndex = 1; RadixIndex < Radix; ++RadixIndex)
+			{
+				for (int64 StageFFTIndex = 0; StageFFTIndex < StageFFTLength; ++StageFFTIndex)
+				{
+					const FFTComplexSamples& Twiddle = FFTState->Twiddles[RadixIndex * StageFFTIndex * Stride];
+					FFTSplitState->StageTwiddlesReal[Offset] = Twiddle.Real;
+					FFTSplitState->StageTwiddlesImaginary[Offset] = Twiddle.Imaginary;
+					++Offset;
+				}
+			}
+		}
+
+		Stride *= Radix;
+	}
+}
+
+/**
+ * Find out whether the Bluestein algorithm is cheaper than the mixed-radix stages for the given FFT size
+ * The generic butterfly costs about NFFT * (Radix - 1) operations per stage, while Bluestein costs about two power-of-two FFTs of twice the size or more
+ *
+ * @param BluesteinSize The power-of-two FFT size used by the Bluestein algorithm
+ */
+bool ShouldUseBluestein(int64 NFFT, const int64* Factors, int64& BluesteinSize)
+{
+	BluesteinSize = static_cast<int64>(FMath::RoundUpToPowerOfTwo64(static_cast<uint64>(2 * NFFT - 1)));
+
+	int64 MaxRadix = 0;
+	int64 StageFFTLength;
+	do
+	{
+		MaxRadix = FMath::Max(MaxRadix, *Factors++);
+		StageFFTLength = *Factors++;
+	}
+	while (StageFFTLength > 1);
+
+	if (MaxRadix <= 5)
+	{
+		return false;
+	}
+
+	return MaxRadix - 1 > 2 * (BluesteinSize / NFFT) * static_cast<int64>(FMath::FloorLog2_64(static_cast<uint64>(BluesteinSize)));
+}
+
+FFTSplitStateStruct* UFFTAudioAnalyzer::PerformFFTSplitAlloc(const FFTStateStruct* FFTState, void* MemoryPtr, int64* MemoryLength)
+{
+	if (!FFTState)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to allocate the split FFT state: the FFT state is invalid"));
+		return nullptr;
+	}
+
+	const int64 NFFT = FFTState->NFFT;
+
+	int64 BluesteinSize;
+	const bool bBluestein = ShouldUseBluestein(NFFT, FFTState->Factors, BluesteinSize);
+
+	int64 NumStages = 0;
+	int64 NumStageTwiddles = 0;
+
+	// With Bluestein, the memory block also holds the power-of-two FFT state and its split state (its own stage twiddles), the chirp and the chirp filter
+	int64 BluesteinStateMemoryLength = 0;
+	int64 BluesteinNumStages = 0;
+	int64 BluesteinNumStageTwiddles = 0;
+
+	if (bBluestein)
+	{
+		PerformFFTAlloc(BluesteinSize, 0, nullptr, &BluesteinStateMemoryLength);
+
+		int64 BluesteinFactors[2 * MaxFactors];
+		CalculateFactors(BluesteinSize, BluesteinFactors);
+		CountSplitStageTwiddles(BluesteinFactors, BluesteinNumStages, BluesteinNumStageTwiddles);
+	}
+	else
+	{
+		CountSplitStageTwiddles(FFTState->Factors, NumStages, NumStageTwiddles);
+	}
+
+	FFTSplitStateStruct* FFTSplitState = nullptr;
+
+	const int64 MemoryRequired = bBluestein
+		                             ? sizeof(FFTSplitStateStruct) + BluesteinStateMemoryLength + sizeof(FFTSplitStateStruct) + 2 * sizeof(float) * (BluesteinNumStageTwiddles + NFFT + BluesteinSize)
+		                             : sizeof(FFTSplitStateStruct) + 2 * sizeof(float) * NumStageTwiddles;
+
+	if (MemoryLength == nullptr)
+	{
+		FFTSplitState = static_cast<FFTSplitStateStruct*>(FMemory::Malloc(MemoryRequired));
+	}
+	else
+	{
+		if (MemoryPtr && *MemoryLength >= MemoryRequired)
+		{
+			FFTSplitState = static_cast<FFTSplitStateStruct*>(MemoryPtr);
+		}
+
+		*MemoryLength = MemoryRequired;
+	}
+
+	if (!FFTSplitState)
+	{
+		return nullptr;
+	}
+
+	if (!bBluestein)
+	{
+		FFTSplitState->StageTwiddlesReal = reinterpret_cast<float*>(FFTSplitState + 1);
+		FFTSplitState->StageTwiddlesImaginary = FFTSplitState->StageTwiddlesReal + NumStageTwiddles;
+		FillSplitStageTwiddles(FFTSplitState, FFTState, NumStages);
+		return FFTSplitState;
+	}
+
+	// The mixed-radix stages are not used, so there are no stage twiddles of our own
+	FFTSplitState->StageTwiddlesReal = FFTSplitState->StageTwiddlesImaginary = nullptr;
+	FillSplitStageTwiddles(FFTSplitState, FFTState, 0);
+
+	FFTStateStruct* BluesteinFFTState = reinterpret_cast<FFTStateStruct*>(FFTSplitState + 1);
+	PerformFFTAlloc(BluesteinSize, 0, BluesteinFFTState, &BluesteinStateMemoryLength);
+
+	FFTSplitStateStruct* BluesteinState = reinterpret_cast<FFTSplitStateStruct*>(reinterpret_cast<uint8*>(BluesteinFFTState) + BluesteinStateMemoryLength);
+	BluesteinState->StageTwiddlesReal = reinterpret_cast<float*>(BluesteinState + 1);
+	BluesteinState->StageTwiddlesImaginary = BluesteinState->StageTwiddlesReal + BluesteinNumStageTwiddles;
+	FillSplitStageTwiddles(BluesteinState, BluesteinFFTState, BluesteinNumStages);
+
+	FFTSplitState->BluesteinState = BluesteinState;
+	FFTSplitState->ScratchLength = 4 * BluesteinSize;
+	FFTSplitState->ChirpReal = BluesteinState->StageTwiddlesImaginary + BluesteinNumStageTwiddles;
+	FFTSplitState->ChirpImaginary = FFTSplitState->ChirpReal + NFFT;
+	FFTSplitState->ChirpFilterReal = FFTSplitState->ChirpImaginary + NFFT;
+	FFTSplitState->ChirpFilterImaginary = FFTSplitState->ChirpFilterReal + BluesteinSize;
+
+	// Chirp: exp(-i * PI * Index^2 / NFFT). Index^2 is wrapped by 2 * NFFT to keep the phase precise for large indices
+	for (int64 Index = 0; Index < NFFT; ++Index)
+	{
+		double Phase = -PI * static_cast<double>((Index * Index) % (2 * NFFT)) / NFFT;
+
+		if (FFTState->Inverse)
+		{
+			Phase *= -1;
+		}
+
+		FFTSplitState->ChirpReal[Index] = FMath::Cos(Phase);
+		FFTSplitState->ChirpImaginary[Index] = FMath::Sin(Phase);
+	}
+
+	// Chirp filter: the conjugated chirp, wrapped around for negative indices and zero-padded to the Bluestein size
+	float* FilterReal = static_cast<float*>(FMemory::Malloc(sizeof(float) * 2 * BluesteinSize));
+	float* FilterImaginary = FilterReal + BluesteinSize;
+
+	FMemory::Memzero(FilterReal, sizeof(float) * 2 * BluesteinSize);
+
+	for (int64 Index = 0; Index < NFFT; ++Index)
+	{
+		FilterReal[Index] = FFTSplitState->ChirpReal[Index];
+		FilterImaginary[Index] = -FFTSplitState->ChirpImaginary[Index];
+
+		if (Index > 0)
+		{
+			FilterReal[BluesteinSize - Index] = FilterReal[Index];
+			FilterImaginary[BluesteinSize - Index] = FilterImaginary[Index];
+		}
+	}
+
+	DoWorkSplit(FFTSplitState->ChirpFilterReal, FFTSplitState->ChirpFilterImaginary, FilterReal, FilterImaginary, 1, BluesteinFFTState->Factors, 0, BluesteinState, false, nullptr, 0);
+
+	FMemory::Free(FilterReal);
+
+	// Fold the normalization of the inverse power-of-two FFT into the filter
+	const float InverseBluesteinSize = 1.f / BluesteinSize;
+	for (int64 Index = 0; Index < BluesteinSize; ++Index)
+	{
+		FFTSplitState->ChirpFilterReal[Index] *= InverseBluesteinSize;
+		FFTSplitState->ChirpFilterImaginary[Index] *= InverseBluesteinSize;
+	}
+
+	return FFTSplitState;
+}
+
+bool UFFTAudioAnalyzer::IsUsingVectorKernels()
+{
+	return GetSplitButterflyKernels().Width > 1;
+}
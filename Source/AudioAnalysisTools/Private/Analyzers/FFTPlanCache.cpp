@@ -0,0 +1,135 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/FFTPlanCache.h"
+#include "Analyzers/FFTAudioAnalyzer.h"
+#include "AudioAnalysisToolsDefines.h"
+
+#include "Misc/ScopeRWLock.h"
+
+FFFTPlan::FFFTPlan(int64 InNFFT, bool bInInverse, bool bInReal)
+	: NFFT(InNFFT),
+	  bInverse(bInInverse),
+	  bReal(bInReal),
+	  AllocatedSize(0),
+	  State(nullptr),
+	  RealState(nullptr),
+	  SplitState(nullptr)
+{
+	// The memory lengths are queried by passing no memory, which does not allocate
+	int64 StateLength = 0;
+	int64 SplitStateLength = 0;
+
+	if (bReal)
+	{
+		RealState = UFFTAudioAnalyzer::PerformFFTRealAlloc(NFFT, bInverse, nullptr, nullptr);
+		if (RealState)
+		{
+			SplitState = UFFTAudioAnalyzer::PerformFFTSplitAlloc(RealState->SubState, nullptr, nullptr);
+			UFFTAudioAnalyzer::PerformFFTRealAlloc(NFFT, bInverse, nullptr, &StateLength);
+			UFFTAudioAnalyzer::PerformFFTSplitAlloc(RealState->SubState, nullptr, &SplitStateLength);
+		}
+	}
+	else
+	{
+		State = UFFTAudioAnalyzer::PerformFFTAlloc(NFFT, bInverse, nullptr, nullptr);
+		if (State)
+		{
+			SplitState = UFFTAudioAnalyzer::PerformFFTSplitAlloc(State, nullptr, nullptr);
+			UFFTAudioAnalyzer::PerformFFTAlloc(NFFT, bInverse, nullptr, &StateLength);
+			UFFTAudioAnalyzer::PerformFFTSplitAlloc(State, nullptr, &SplitStateLength);
+		}
+	}
+
+	AllocatedSize = StateLength + SplitStateLength;
+}
+
+FFFTPlan::~FFFTPlan()
+{
+	FMemory::Free(SplitState);
+	FMemory::Free(State);
+	FMemory::Free(RealState);
+}
+
+int64 FFFTPlan::GetSplitScratchLength() const
+{
+	return SplitState ? SplitState->ScratchLength : 0;
+}
+
+FFFTPlanCache& FFFTPlanCache::Get()
+{
+	static FFFTPlanCache PlanCache;
+	return PlanCache;
+}
+
+FFFTPlanPtr FFFTPlanCache::FindOrCreatePlan(int64 NFFT, bool bInverse, bool bReal)
+{
+	if (NFFT <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the FFT plan: the FFT size is '%lld', expected > '0'"), NFFT);
+		return nullptr;
+	}
+
+	const FPlanKey Key{NFFT, bInverse, bReal};
+
+	{
+		FReadScopeLock ReadLock(PlansLock);
+		if (const FFFTPlanPtr* FoundPlan = Plans.Find(Key))
+		{
+			return *FoundPlan;
+		}
+	}
+
+	FWriteScopeLock WriteLock(PlansLock);
+
+	// Another thread may have created the plan while the lock was released
+	if (const FFFTPlanPtr* FoundPlan = Plans.Find(Key))
+	{
+		return *FoundPlan;
+	}
+
+	FFFTPlanPtr Plan = MakeShared<FFFTPlan, ESPMode::ThreadSafe>(NFFT, bInverse, bReal);
+	if (!Plan->IsValid())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the FFT plan with size '%lld' (inverse: %s, real: %s)"), NFFT, bInverse ? TEXT("true") : TEXT("false"), bReal ? TEXT("true") : TEXT("false"));
+		return nullptr;
+	}
+
+	UE_LOG(LogAudioAnalysis, Log, TEXT("Created the FFT plan with size '%lld' (inverse: %s, real: %s)"), NFFT, bInverse ? TEXT("true") : TEXT("false"), bReal ? TEXT("true") : TEXT("false"));
+
+	INC_DWORD_STAT(STAT_AudioAnalysis_FFTPlans);
+	INC_MEMORY_STAT_BY(STAT_AudioAnalysis_FFTPlanMemory, Plan->GetAllocatedSize());
+
+	// Analyzers fed with buffers of varying lengths would otherwise leave a plan behind for every length they have seen
+	if (Plans.Num() >= MaxNumOfCachedPlans)
+	{
+		ReleaseUnusedPlansLocked();
+	}
+
+	Plans.Add(Key, Plan);
+	return Plan;
+}
+
+void FFFTPlanCache::ReleaseUnusedPlans()
+{
+	FWriteScopeLock WriteLock(PlansLock);
+	ReleaseUnusedPlansLocked();
+}
+
+void FFFTPlanCache::ReleaseUnusedPlansLocked()
+{
+	for (auto It = Plans.CreateIterator(); It; ++It)
+	{
+		if (It.Value().IsUnique())
+		{
+			DEC_DWORD_STAT(STAT_AudioAnalysis_FFTPlans);
+			DEC_MEMORY_STAT_BY(STAT_AudioAnalysis_FFTPlanMemory, It.Value()->GetAllocatedSize());
+			It.RemoveCurrent();
+		}
+	}
+}
+
+int32 FFFTPlanCache::GetNumPlans() const
+{
+	FReadScopeLock ReadLock(PlansLock);
+	return Plans.Num();
+}
@@ -0,0 +1,83 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/HalfBandDecimator.h"
+#include "Math/UnrealMathUtility.h"
+#include "Misc/EngineVersionComparison.h"
+
+FHalfBandDecimator::FHalfBandDecimator()
+	: Phase(1)
+{
+	constexpr int32 NumOfCoefficients = UE_ARRAY_COUNT(Coefficients);
+
+	double Sum = 0;
+
+	for (int32 CoefficientIndex = 0; CoefficientIndex < NumOfCoefficients; ++CoefficientIndex)
+	{
+		// The nonzero side taps are the odd distances from the center
+		const int32 Distance = 2 * CoefficientIndex + 1;
+		const double Sinc = FMath::Sin(PI * Distance / 2) / (PI * Distance);
+		const double Position = static_cast<double>(Delay + Distance) / (NumOfTaps - 1);
+		const double Blackman = 0.42 - 0.5 * FMath::Cos(2 * PI * Position) + 0.08 * FMath::Cos(4 * PI * Position);
+
+		Coefficients[CoefficientIndex] = static_cast<float>(Sinc * Blackman);
+		Sum += 2 * Coefficients[CoefficientIndex];
+	}
+
+	// The side taps are normalized to sum to a half, so the DC gain is exactly one together with the center tap
+	for (float& Coefficient : Coefficients)
+	{
+		Coefficient = static_cast<float>(Coefficient * 0.5 / Sum);
+	}
+
+	Reset();
+}
+
+void FHalfBandDecimator::Reset()
+{
+	History.SetNumZeroed(NumOfTaps - 1);
+	Phase = 1;
+}
+
+int64 FHalfBandDecimator::Process(const float* Input, int64 NumOfInput, float* Output)
+{
+	constexpr int64 NumOfHistory = NumOfTaps - 1;
+	constexpr int32 NumOfCoefficients = UE_ARRAY_COUNT(Coefficients);
+
+#if UE_VERSION_OLDER_THAN(5, 5, 0)
+	History.SetNumUninitialized(NumOfHistory + NumOfInput, false);
+#else
+	History.SetNumUninitialized(NumOfHistory + NumOfInput, EAllowShrinking::No);
+#endif
+	FMemory::Memcpy(History.GetData() + NumOfHistory, Input, sizeof(float) * NumOfInput);
+
+	const float* RESTRICT Samples = History.GetData();
+	int64 NumOfOutput = 0;
+	int64 Position = NumOfHistory + Phase;
+
+	// Each output is centered on the sample Delay samples before the newest sample it depends on
+	for (; Position < NumOfHistory + NumOfInput; Position += 2)
+	{
+		const float* RESTRICT Center = Samples + Position - Delay;
+
+		float Sample = 0.5f * Center[0];
+		for (int32 CoefficientIndex = 0; CoefficientIndex < NumOfCoefficients; ++CoefficientIndex)
+		{
+			const int32 Distance = 2 * CoefficientIndex + 1;
+			Sample += Coefficients[CoefficientIndex] * (Center[-Distance] + Center[Distance]);
+		}
+
+		Output[NumOfOutput++] = Sample;
+	}
+
+	Phase = static_cast<int32>(Position - NumOfHistory - NumOfInput);
+
+	// Keep the samples the next outputs depend on
+	FMemory::Memmove(History.GetData(), History.GetData() + NumOfInput, sizeof(float) * NumOfHistory);
+#if UE_VERSION_OLDER_THAN(5, 5, 0)
+	History.SetNum(NumOfHistory, false);
+#else
+	History.SetNum(NumOfHistory, EAllowShrinking::No);
+#endif
+
+	return NumOfOutput;
+}
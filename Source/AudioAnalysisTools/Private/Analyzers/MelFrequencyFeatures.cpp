@@ -0,0 +1,306 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/MelFrequencyFeatures.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "Math/UnrealMathUtility.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+	/** The floor of the band energies before taking the logarithm, so silent bands do not produce infinite coefficients */
+	constexpr float MinBandEnergy = 1e-10f;
+
+	/** The maximum number of bands the cepstral coefficients are computed for without allocations */
+	constexpr int32 NumOfInlineBands = 128;
+
+	float HertzToMel(float Frequency)
+	{
+		return 2595 * FMath::LogX(10.f, 1 + Frequency / 700);
+	}
+
+	float MelToHertz(float Mel)
+	{
+		return 700 * (FMath::Pow(10.f, Mel / 2595) - 1);
+	}
+}
+
+FMelFilterbank::FMelFilterbank(int64 InNumOfBins, int32 InSampleRate, int32 InNumOfBands)
+	: NumOfBins(InNumOfBins),
+	  SampleRate(InSampleRate),
+	  NumOfBands(InNumOfBands)
+{
+	// The magnitude spectrum is the first half of the FFT, so each bin is SampleRate / (2 * NumOfBins) Hz wide
+	const double BinWidth = static_cast<double>(SampleRate) / (2 * NumOfBins);
+	const float MaxMel = HertzToMel(SampleRate * 0.5f);
+
+	FirstBins.SetNumUninitialized(NumOfBands);
+	WeightOffsets.SetNumUninitialized(NumOfBands + 1);
+
+	for (int32 BandIndex = 0; BandIndex < NumOfBands; ++BandIndex)
+	{
+		const double LowFrequency = MelToHertz(MaxMel * BandIndex / (NumOfBands + 1));
+		const double CenterFrequency = MelToHertz(MaxMel * (BandIndex + 1) / (NumOfBands + 1));
+		const double HighFrequency = MelToHertz(MaxMel * (BandIndex + 2) / (NumOfBands + 1));
+
+		WeightOffsets[BandIndex] = Weights.Num();
+
+		const int64 FirstBin = FMath::Max<int64>(FMath::FloorToInt(LowFrequency / BinWidth) + 1, 0);
+		const int64 LastBin = FMath::Min<int64>(FMath::CeilToInt(HighFrequency / BinWidth) - 1, NumOfBins - 1);
+
+		FirstBins[BandIndex] = FirstBin;
+
+		for (int64 Bin = FirstBin; Bin <= LastBin; ++Bin)
+		{
+			const double Frequency = Bin * BinWidth;
+			const double Weight = Frequency <= CenterFrequency
+				? (Frequency - LowFrequency) / (CenterFrequency - LowFrequency)
+				: (HighFrequency - Frequency) / (HighFrequency - CenterFrequency);
+
+			Weights.Add(static_cast<float>(FMath::Max(Weight, 0.)));
+		}
+
+		// The lowest filters may be narrower than a bin, in which case they take the nearest bin as a whole
+		if (Weights.Num() == WeightOffsets[BandIndex])
+		{
+			FirstBins[BandIndex] = FMath::Clamp<int64>(FMath::RoundToInt(CenterFrequency / BinWidth), 0, NumOfBins - 1);
+			Weights.Add(1);
+		}
+	}
+
+	WeightOffsets[NumOfBands] = Weights.Num();
+}
+
+void FMelFilterbank::Apply(const float* RESTRICT MagnitudeSpectrum, float* RESTRICT OutBandEnergies) const
+{
+	const float* RESTRICT WeightsData = Weights.GetData();
+
+	for (int32 BandIndex = 0; BandIndex < NumOfBands; ++BandIndex)
+	{
+		const float* RESTRICT BandMagnitudes = MagnitudeSpectrum + FirstBins[BandIndex];
+		const float* RESTRICT BandWeights = WeightsData + WeightOffsets[BandIndex];
+		const int32 NumOfBandWeights = WeightOffsets[BandIndex + 1] - WeightOffsets[BandIndex];
+
+		float BandEnergy = 0;
+		for (int32 WeightIndex = 0; WeightIndex < NumOfBandWeights; ++WeightIndex)
+		{
+			BandEnergy += BandWeights[WeightIndex] * BandMagnitudes[WeightIndex] * BandMagnitudes[WeightIndex];
+		}
+
+		OutBandEnergies[BandIndex] = BandEnergy;
+	}
+}
+
+FMelDCT::FMelDCT(int32 InNumOfBands, int32 InNumOfCoefficients)
+	: NumOfBands(InNumOfBands),
+	  NumOfCoefficients(InNumOfCoefficients)
+{
+	Table.SetNumUninitialized(NumOfBands * NumOfCoefficients);
+
+	for (int32 CoefficientIndex = 0; CoefficientIndex < NumOfCoefficients; ++CoefficientIndex)
+	{
+		const double Scale = FMath::Sqrt((CoefficientIndex == 0 ? 1. : 2.) / NumOfBands);
+
+		for (int32 BandIndex = 0; BandIndex < NumOfBands; ++BandIndex)
+		{
+			Table[CoefficientIndex * NumOfBands + BandIndex] = static_cast<float>(Scale * FMath::Cos(PI * CoefficientIndex * (BandIndex + 0.5) / NumOfBands));
+		}
+	}
+}
+
+void FMelDCT::Apply(const float* RESTRICT LogBandEnergies, float* RESTRICT OutCoefficients) const
+{
+	for (int32 CoefficientIndex = 0; CoefficientIndex < NumOfCoefficients; ++CoefficientIndex)
+	{
+		const float* RESTRICT TableRow = Table.GetData() + CoefficientIndex * NumOfBands;
+
+		float Coefficient = 0;
+		for (int32 BandIndex = 0; BandIndex < NumOfBands; ++BandIndex)
+		{
+			Coefficient += TableRow[BandIndex] * LogBandEnergies[BandIndex];
+		}
+
+		OutCoefficients[CoefficientIndex] = Coefficient;
+	}
+}
+
+FMelFilterbankCache& FMelFilterbankCache::Get()
+{
+	static FMelFilterbankCache FilterbankCache;
+	return FilterbankCache;
+}
+
+FMelFilterbankPtr FMelFilterbankCache::FindOrCreateFilterbank(int64 NumOfBins, int32 SampleRate, int32 NumOfBands)
+{
+	if (NumOfBins <= 0 || SampleRate <= 0 || NumOfBands <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the Mel filterbank: the number of bins is '%lld', the sample rate is '%d' and the number of bands is '%d', expected all > '0'"), NumOfBins, SampleRate, NumOfBands);
+		return nullptr;
+	}
+
+	const TTuple<int64, int32, int32> Key(NumOfBins, SampleRate, NumOfBands);
+
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const FMelFilterbankPtr* FoundFilterbank = Filterbanks.Find(Key))
+		{
+			return *FoundFilterbank;
+		}
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+
+	// Another thread may have created the filterbank while the lock was released
+	if (const FMelFilterbankPtr* FoundFilterbank = Filterbanks.Find(Key))
+	{
+		return *FoundFilterbank;
+	}
+
+	UE_LOG(LogAudioAnalysis, Verbose, TEXT("Created the Mel filterbank with '%lld' bins, sample rate '%d' and '%d' bands"), NumOfBins, SampleRate, NumOfBands);
+
+	// Analyzers fed with buffers of varying lengths would otherwise leave a filterbank behind for every length they have seen
+	if (Filterbanks.Num() >= MaxNumOfCachedFilterbanks)
+	{
+		ReleaseUnusedFilterbanksLocked();
+	}
+
+	FMelFilterbankPtr Filterbank = MakeShared<FMelFilterbank, ESPMode::ThreadSafe>(NumOfBins, SampleRate, NumOfBands);
+	Filterbanks.Add(Key, Filterbank);
+	return Filterbank;
+}
+
+FMelDCTPtr FMelFilterbankCache::FindOrCreateDCT(int32 NumOfBands, int32 NumOfCoefficients)
+{
+	if (!(NumOfBands > 0 && NumOfCoefficients > 0 && NumOfCoefficients <= NumOfBands))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the Mel DCT: the number of coefficients is '%d', expected > '0' and <= the number of bands '%d'"), NumOfCoefficients, NumOfBands);
+		return nullptr;
+	}
+
+	const TTuple<int32, int32> Key(NumOfBands, NumOfCoefficients);
+
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const FMelDCTPtr* FoundDCT = DCTs.Find(Key))
+		{
+			return *FoundDCT;
+		}
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+
+	if (const FMelDCTPtr* FoundDCT = DCTs.Find(Key))
+	{
+		return *FoundDCT;
+	}
+
+	if (DCTs.Num() >= MaxNumOfCachedDCTs)
+	{
+		ReleaseUnusedDCTsLocked();
+	}
+
+	FMelDCTPtr DCT = MakeShared<FMelDCT, ESPMode::ThreadSafe>(NumOfBands, NumOfCoefficients);
+	DCTs.Add(Key, DCT);
+	return DCT;
+}
+
+void FMelFilterbankCache::ReleaseUnusedFilterbanks()
+{
+	FWriteScopeLock WriteLock(CacheLock);
+	ReleaseUnusedFilterbanksLocked();
+	ReleaseUnusedDCTsLocked();
+}
+
+void FMelFilterbankCache::ReleaseUnusedFilterbanksLocked()
+{
+	for (auto It = Filterbanks.CreateIterator(); It; ++It)
+	{
+		if (It.Value().IsUnique())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FMelFilterbankCache::ReleaseUnusedDCTsLocked()
+{
+	for (auto It = DCTs.CreateIterator(); It; ++It)
+	{
+		if (It.Value().IsUnique())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+TArray<float> UMelFrequencyFeatures::GetMelBandEnergies(const TArray<float>& MagnitudeSpectrum, int32 SampleRate, int32 NumOfBands)
+{
+	if (NumOfBands <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the Mel band energies: the number of bands is '%d', expected > '0'"), NumOfBands);
+		return TArray<float>();
+	}
+
+	TArray<float> BandEnergies;
+	BandEnergies.SetNumUninitialized(NumOfBands);
+
+	if (!GetMelBandEnergies(TArrayView64<const float>(MagnitudeSpectrum), SampleRate, BandEnergies))
+	{
+		return TArray<float>();
+	}
+
+	return BandEnergies;
+}
+
+bool UMelFrequencyFeatures::GetMelBandEnergies(TArrayView64<const float> MagnitudeSpectrum, int32 SampleRate, TArrayView<float> OutBandEnergies)
+{
+	const FMelFilterbankPtr Filterbank = FMelFilterbankCache::Get().FindOrCreateFilterbank(MagnitudeSpectrum.Num(), SampleRate, OutBandEnergies.Num());
+	if (!Filterbank.IsValid())
+	{
+		return false;
+	}
+
+	Filterbank->Apply(MagnitudeSpectrum.GetData(), OutBandEnergies.GetData());
+	return true;
+}
+
+TArray<float> UMelFrequencyFeatures::GetMFCC(const TArray<float>& MagnitudeSpectrum, int32 SampleRate, int32 NumOfBands, int32 NumOfCoefficients)
+{
+	if (NumOfCoefficients <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the MFCC: the number of coefficients is '%d', expected > '0'"), NumOfCoefficients);
+		return TArray<float>();
+	}
+
+	TArray<float> Coefficients;
+	Coefficients.SetNumUninitialized(NumOfCoefficients);
+
+	if (!GetMFCC(TArrayView64<const float>(MagnitudeSpectrum), SampleRate, NumOfBands, Coefficients))
+	{
+		return TArray<float>();
+	}
+
+	return Coefficients;
+}
+
+bool UMelFrequencyFeatures::GetMFCC(TArrayView64<const float> MagnitudeSpectrum, int32 SampleRate, int32 NumOfBands, TArrayView<float> OutCoefficients)
+{
+	const FMelFilterbankPtr Filterbank = FMelFilterbankCache::Get().FindOrCreateFilterbank(MagnitudeSpectrum.Num(), SampleRate, NumOfBands);
+	const FMelDCTPtr DCT = FMelFilterbankCache::Get().FindOrCreateDCT(NumOfBands, OutCoefficients.Num());
+	if (!Filterbank.IsValid() || !DCT.IsValid())
+	{
+		return false;
+	}
+
+	TArray<float, TInlineAllocator<NumOfInlineBands>> LogBandEnergies;
+	LogBandEnergies.SetNumUninitialized(NumOfBands);
+
+	Filterbank->Apply(MagnitudeSpectrum.GetData(), LogBandEnergies.GetData());
+
+	for (float& BandEnergy : LogBandEnergies)
+	{
+		BandEnergy = FMath::Loge(FMath::Max(BandEnergy, MinBandEnergy));
+	}
+
+	DCT->Apply(LogBandEnergies.GetData(), OutCoefficients.GetData());
+	return true;
+}
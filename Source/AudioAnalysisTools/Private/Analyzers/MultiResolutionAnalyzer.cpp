@@ -0,0 +1,264 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/MultiResolutionAnalyzer.h"
+#include "Analyzers/BeatDetection.h"
+#include "Analyzers/OnsetDetection.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "Math/UnrealMathUtility.h"
+
+namespace
+{
+	/** The number of full rate audio frames decimated at once, bounding the decimation buffers regardless of the size of the processed audio */
+	constexpr int64 DecimationBlockSize = 1024;
+
+	/** The maximum number of decimation stages, beyond which the low band would be too narrow for any beat */
+	constexpr int32 MaxNumOfDecimationStages = 8;
+
+	/** The minimum size of both FFT frames, so the beat detection has at least one full sub-band */
+	constexpr int64 MinFrameSize = 64;
+}
+
+UMultiResolutionAnalyzer::UMultiResolutionAnalyzer()
+	: LowBandBeatDetection(nullptr),
+	  HighBandBeatDetection(nullptr),
+	  OnsetDetection(nullptr),
+	  PendingLowBandFrames(0),
+	  PendingOnsetFrames(0),
+	  NumOfLowBandFrames(0),
+	  NumOfOnsetFrames(0),
+	  HighFrequencyContent(0),
+	  SpectralDifferenceHWR(0),
+	  ComplexSpectralDifference(0),
+	  SampleRate(0),
+	  LowBandHopSize(0),
+	  OnsetHopSize(0),
+	  LowBandEnergyHistorySize(0),
+	  OnsetEnergyHistorySize(0)
+{
+}
+
+UMultiResolutionAnalyzer* UMultiResolutionAnalyzer::CreateMultiResolutionAnalyzer(int32 InSampleRate, int32 InNumOfDecimationStages, int64 InLowBandFrameSize, int64 InLowBandHopSize,
+	int64 InOnsetFrameSize, int64 InOnsetHopSize, EAnalysisWindowType InWindowType, float InEnergyHistoryDuration)
+{
+	UMultiResolutionAnalyzer* MultiResolutionAnalyzer = NewObject<UMultiResolutionAnalyzer>();
+	if (!MultiResolutionAnalyzer->Configure(InSampleRate, InNumOfDecimationStages, InLowBandFrameSize, InLowBandHopSize, InOnsetFrameSize, InOnsetHopSize, InWindowType, InEnergyHistoryDuration))
+	{
+		return nullptr;
+	}
+	return MultiResolutionAnalyzer;
+}
+
+bool UMultiResolutionAnalyzer::Configure(int32 InSampleRate, int32 InNumOfDecimationStages, int64 InLowBandFrameSize, int64 InLowBandHopSize, int64 InOnsetFrameSize, int64 InOnsetHopSize,
+	EAnalysisWindowType InWindowType, float InEnergyHistoryDuration)
+{
+	if (InSampleRate <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the multi-resolution analyzer: the sample rate is '%d', expected > '0'"), InSampleRate);
+		return false;
+	}
+
+	if (!(InNumOfDecimationStages >= 0 && InNumOfDecimationStages <= MaxNumOfDecimationStages))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the multi-resolution analyzer: the number of decimation stages is '%d', expected >= '0' and <= '%d'"), InNumOfDecimationStages, MaxNumOfDecimationStages);
+		return false;
+	}
+
+	if (InLowBandFrameSize < MinFrameSize || InOnsetFrameSize < MinFrameSize)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the multi-resolution analyzer: the low band frame size is '%lld' and the onset frame size is '%lld', expected both >= '%lld'"), InLowBandFrameSize, InOnsetFrameSize, MinFrameSize);
+		return false;
+	}
+
+	if (!(InLowBandHopSize > 0 && InLowBandHopSize <= InLowBandFrameSize))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the multi-resolution analyzer: the low band hop size is '%lld', expected > '0' and <= '%lld'"), InLowBandHopSize, InLowBandFrameSize);
+		return false;
+	}
+
+	if (!(InOnsetHopSize > 0 && InOnsetHopSize <= InOnsetFrameSize))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the multi-resolution analyzer: the onset hop size is '%lld', expected > '0' and <= '%lld'"), InOnsetHopSize, InOnsetFrameSize);
+		return false;
+	}
+
+	if (InEnergyHistoryDuration <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the multi-resolution analyzer: the energy history duration is '%f', expected > '0'"), InEnergyHistoryDuration);
+		return false;
+	}
+
+	if (!LowBandSpectrumAnalyzer.Configure(InLowBandFrameSize) || !OnsetSpectrumAnalyzer.Configure(InOnsetFrameSize))
+	{
+		return false;
+	}
+
+	LowBandWindow = FWindowCache::Get().FindOrCreateWindow(InLowBandFrameSize, InWindowType);
+	OnsetWindow = FWindowCache::Get().FindOrCreateWindow(InOnsetFrameSize, InWindowType);
+	if (!LowBandWindow.IsValid() || !OnsetWindow.IsValid())
+	{
+		return false;
+	}
+
+	SampleRate = InSampleRate;
+	LowBandHopSize = InLowBandHopSize;
+	OnsetHopSize = InOnsetHopSize;
+
+	Decimators.SetNum(InNumOfDecimationStages);
+	DecimationBuffers[0].SetNumUninitialized(FHalfBandDecimator::GetMaxNumOfOutput(DecimationBlockSize));
+	DecimationBuffers[1].SetNumUninitialized(FHalfBandDecimator::GetMaxNumOfOutput(DecimationBlockSize));
+
+	LowBandFrame.SetNumUninitialized(InLowBandFrameSize);
+	LowBandReal.SetNumUninitialized(InLowBandFrameSize);
+	LowBandImaginary.SetNumUninitialized(InLowBandFrameSize);
+	LowBandMagnitudeSpectrum.SetNumUninitialized(InLowBandFrameSize / 2);
+
+	OnsetFrame.SetNumUninitialized(InOnsetFrameSize);
+	OnsetReal.SetNumUninitialized(InOnsetFrameSize);
+	OnsetImaginary.SetNumUninitialized(InOnsetFrameSize);
+	OnsetMagnitudeSpectrum.SetNumUninitialized(InOnsetFrameSize / 2);
+
+	LowBandEnergyHistorySize = FMath::Max<int64>(FMath::RoundToInt(InEnergyHistoryDuration * GetLowBandSampleRate() / LowBandHopSize), 1);
+	OnsetEnergyHistorySize = FMath::Max<int64>(FMath::RoundToInt(InEnergyHistoryDuration * SampleRate / OnsetHopSize), 1);
+
+	UE_LOG(LogAudioAnalysis, Log, TEXT("Configured the multi-resolution analyzer with the low band at '%f' Hz analyzed by '%lld' point FFTs and the onsets analyzed by '%lld' point FFTs"), GetLowBandSampleRate(), InLowBandFrameSize, InOnsetFrameSize);
+
+	Reset();
+
+	return true;
+}
+
+void UMultiResolutionAnalyzer::Reset()
+{
+	for (FHalfBandDecimator& Decimator : Decimators)
+	{
+		Decimator.Reset();
+	}
+
+	FMemory::Memzero(LowBandFrame.GetData(), LowBandFrame.Num() * sizeof(float));
+	FMemory::Memzero(LowBandMagnitudeSpectrum.GetData(), LowBandMagnitudeSpectrum.Num() * sizeof(float));
+	FMemory::Memzero(OnsetFrame.GetData(), OnsetFrame.Num() * sizeof(float));
+	FMemory::Memzero(OnsetMagnitudeSpectrum.GetData(), OnsetMagnitudeSpectrum.Num() * sizeof(float));
+
+	PendingLowBandFrames = 0;
+	PendingOnsetFrames = 0;
+	NumOfLowBandFrames = 0;
+	NumOfOnsetFrames = 0;
+	HighFrequencyContent = 0;
+	SpectralDifferenceHWR = 0;
+	ComplexSpectralDifference = 0;
+
+	if (SampleRate > 0)
+	{
+		LowBandBeatDetection = UBeatDetection::CreateBeatDetection(32, LowBandEnergyHistorySize);
+		HighBandBeatDetection = UBeatDetection::CreateBeatDetection(32, OnsetEnergyHistorySize);
+
+		// The onset spectrum is always of real audio frames, so the phasor prediction applies
+		OnsetDetection = UOnsetDetection::CreateOnsetDetection(OnsetFrame.Num());
+		OnsetDetection->SetComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode::PhasorPrediction);
+	}
+}
+
+void UMultiResolutionAnalyzer::ProcessAudioFrames(const TArray<float>& AudioFrames)
+{
+	ProcessAudioFrames(TArrayView64<const float>(AudioFrames));
+}
+
+void UMultiResolutionAnalyzer::ProcessAudioFrames(TArrayView64<const float> AudioFrames)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_MultiResolutionUpdate);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_MultiResolutionUpdate);
+
+	if (!LowBandBeatDetection || !HighBandBeatDetection || !OnsetDetection)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process audio frames: the multi-resolution analyzer is not configured"));
+		return;
+	}
+
+	for (int64 BlockStart = 0; BlockStart < AudioFrames.Num(); BlockStart += DecimationBlockSize)
+	{
+		const float* BlockFrames = AudioFrames.GetData() + BlockStart;
+		const int64 NumOfBlockFrames = FMath::Min<int64>(AudioFrames.Num() - BlockStart, DecimationBlockSize);
+
+		AppendToFrame(BlockFrames, NumOfBlockFrames, OnsetFrame, PendingOnsetFrames, OnsetHopSize, [this]() { AnalyzeOnsetFrame(); });
+
+		// Each stage halves the rate of the previous one, alternating between the two buffers
+		const float* LowBandFrames = BlockFrames;
+		int64 NumOfLowBandBlockFrames = NumOfBlockFrames;
+
+		for (int32 StageIndex = 0; StageIndex < Decimators.Num(); ++StageIndex)
+		{
+			float* StageOutput = DecimationBuffers[StageIndex % 2].GetData();
+			NumOfLowBandBlockFrames = Decimators[StageIndex].Process(LowBandFrames, NumOfLowBandBlockFrames, StageOutput);
+			LowBandFrames = StageOutput;
+		}
+
+		AppendToFrame(LowBandFrames, NumOfLowBandBlockFrames, LowBandFrame, PendingLowBandFrames, LowBandHopSize, [this]() { AnalyzeLowBandFrame(); });
+	}
+}
+
+template <typename AnalyzeType>
+void UMultiResolutionAnalyzer::AppendToFrame(const float* AudioFrames, int64 NumOfFrames, TArray64<float>& Frame, int64& PendingFrames, int64 HopSize, AnalyzeType&& Analyze)
+{
+	float* FrameData = Frame.GetData();
+	const int64 FrameSize = Frame.Num();
+
+	// The audio is split at the hop boundaries, so the frame is analyzed after every hop regardless of the block size
+	while (NumOfFrames > 0)
+	{
+		const int64 NumOfAppendedFrames = FMath::Min<int64>(NumOfFrames, HopSize - PendingFrames);
+
+		FMemory::Memmove(FrameData, FrameData + NumOfAppendedFrames, (FrameSize - NumOfAppendedFrames) * sizeof(float));
+		FMemory::Memcpy(FrameData + FrameSize - NumOfAppendedFrames, AudioFrames, NumOfAppendedFrames * sizeof(float));
+
+		AudioFrames += NumOfAppendedFrames;
+		NumOfFrames -= NumOfAppendedFrames;
+		PendingFrames += NumOfAppendedFrames;
+
+		if (PendingFrames == HopSize)
+		{
+			Analyze();
+			PendingFrames = 0;
+		}
+	}
+}
+
+void UMultiResolutionAnalyzer::AnalyzeLowBandFrame()
+{
+	LowBandSpectrumAnalyzer.Process(LowBandFrame.GetData(), LowBandWindow->GetData(), LowBandReal.GetData(), LowBandImaginary.GetData(), LowBandMagnitudeSpectrum.GetData());
+	LowBandBeatDetection->ProcessMagnitude(TArrayView64<const float>(LowBandMagnitudeSpectrum));
+	++NumOfLowBandFrames;
+}
+
+void UMultiResolutionAnalyzer::AnalyzeOnsetFrame()
+{
+	OnsetSpectrumAnalyzer.Process(OnsetFrame.GetData(), OnsetWindow->GetData(), OnsetReal.GetData(), OnsetImaginary.GetData(), OnsetMagnitudeSpectrum.GetData());
+
+	const TArrayView64<const float> MagnitudeSpectrum(OnsetMagnitudeSpectrum);
+
+	HighFrequencyContent = UOnsetDetection::GetHighFrequencyContent(MagnitudeSpectrum);
+	SpectralDifferenceHWR = OnsetDetection->GetSpectralDifferenceHWR(MagnitudeSpectrum);
+	ComplexSpectralDifference = OnsetDetection->GetComplexSpectralDifference(TArrayView64<const float>(OnsetReal), TArrayView64<const float>(OnsetImaginary));
+
+	HighBandBeatDetection->ProcessMagnitude(MagnitudeSpectrum);
+	++NumOfOnsetFrames;
+}
+
+bool UMultiResolutionAnalyzer::IsKick() const
+{
+	return LowBandBeatDetection && LowBandBeatDetection->IsKick();
+}
+
+bool UMultiResolutionAnalyzer::IsSnare() const
+{
+	return LowBandBeatDetection && LowBandBeatDetection->IsSnare();
+}
+
+bool UMultiResolutionAnalyzer::IsHiHat() const
+{
+	return HighBandBeatDetection && HighBandBeatDetection->IsHiHat();
+}
+
+float UMultiResolutionAnalyzer::GetLowBandSampleRate() const
+{
+	return static_cast<float>(SampleRate) / (1 << Decimators.Num());
+}
@@ -1,11 +1,14 @@
 // Georgy Treshchev 2024.
 
 #include "Analyzers/OnsetDetection.h"
+#include "Analyzers/CoreTimeDomainFeatures.h"
 #include "AudioAnalysisToolsDefines.h"
 #include "Math/UnrealMathUtility.h"
 
 UOnsetDetection::UOnsetDetection()
-	: FrameSize(0)
+	: PreviousEnergySum(0),
+	  ComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode::PhaseUnwrapping),
+	  FrameSize(0)
 {
 }
 
@@ -27,53 +30,43 @@ void UOnsetDetection::UpdateFrameSize(int64 InFrameSize)
 	
 	FrameSize = InFrameSize;
 
-	PrevMagnitudeSpectrum_SpectralDifference.SetNum(FrameSize);
-	PrevMagnitudeSpectrum_SpectralDifferenceHWR.SetNum(FrameSize);
-	PrevPhaseSpectrum_ComplexSpectralDifference.SetNum(FrameSize);
-	PrevPhaseSpectrum2_ComplexSpectralDifference.SetNum(FrameSize);
-	PrevMagnitudeSpectrum_ComplexSpectralDifference.SetNum(FrameSize);
+	// Each onset detection function is sized for its own input, so using several of them together never resizes the others
+	SpectralDifferenceState.Reset(FrameSize / 2);
+	SpectralDifferenceHWRState.Reset(FrameSize / 2);
+	ComplexSpectralDifferenceState.Reset(FrameSize);
+	PhasorPredictionState.Reset(FrameSize);
 
 	PreviousEnergySum = 0;
 }
 
 float UOnsetDetection::GetEnergyEnvelope(const TArray<float>& AudioFrames)
 {
-	return GetEnergyEnvelope(TArray64<float>(AudioFrames));
+	return GetEnergyEnvelope(TArrayView64<const float>(AudioFrames));
 }
 
-float UOnsetDetection::GetEnergyEnvelope(const TArray64<float>& AudioFrames)
+float UOnsetDetection::GetEnergyEnvelope(TArrayView64<const float> AudioFrames)
 {
-	float EnergyEnvelopeValue{0};
-
-	// Sum the squares of the samples
-	for (const auto& BufferValue : AudioFrames)
-	{
-		EnergyEnvelopeValue += FMath::Pow(BufferValue, 2);
-	}
-
-	return EnergyEnvelopeValue;
+	// The energy envelope is the sum of the squares of the samples
+	return UCoreTimeDomainFeatures::GetTimeDomainFeatures(AudioFrames).SumOfSquares;
 }
 
 float UOnsetDetection::GetEnergyDifference(const TArray<float>& AudioFrames)
 {
-	return GetEnergyDifference(TArray64<float>(AudioFrames));
+	return GetEnergyDifference(TArrayView64<const float>(AudioFrames));
 }
 
-float UOnsetDetection::GetEnergyDifference(const TArray64<float>& AudioFrames)
+float UOnsetDetection::GetEnergyDifference(TArrayView64<const float> AudioFrames)
 {
-	float EnergyDifferenceValue{0};
-
-	// Sum the squares of the samples
-	for (const auto& BufferValue : AudioFrames)
-	{
-		EnergyDifferenceValue += FMath::Pow(BufferValue, 2);
-	}
+	return GetEnergyDifferenceFromSum(UCoreTimeDomainFeatures::GetTimeDomainFeatures(AudioFrames).SumOfSquares);
+}
 
+float UOnsetDetection::GetEnergyDifferenceFromSum(float EnergySum)
+{
 	// Sample is first order difference in energy
-	const float Difference{EnergyDifferenceValue - PreviousEnergySum};
+	const float Difference{EnergySum - PreviousEnergySum};
 
 	// Store energy value for next calculation
-	PreviousEnergySum = EnergyDifferenceValue;
+	PreviousEnergySum = EnergySum;
 
 	if (Difference > 0)
 	{
@@ -85,22 +78,26 @@ float UOnsetDetection::GetEnergyDifference(const TArray64<float>& AudioFrames)
 
 float UOnsetDetection::GetSpectralDifference(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetSpectralDifference(TArray64<float>(MagnitudeSpectrum));
+	return GetSpectralDifference(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UOnsetDetection::GetSpectralDifference(const TArray64<float>& MagnitudeSpectrum)
+float UOnsetDetection::GetSpectralDifference(TArrayView64<const float> MagnitudeSpectrum)
 {
-	if (MagnitudeSpectrum.Num() != FrameSize)
+	// Only happens when the spectrum size changes, which invalidates the history of this function alone
+	if (MagnitudeSpectrum.Num() != SpectralDifferenceState.Num())
 	{
-		UpdateFrameSize(MagnitudeSpectrum.Num());
+		UE_LOG(LogAudioAnalysis, Log, TEXT("Updating the spectral difference size from '%lld' to '%lld'"), SpectralDifferenceState.Num(), MagnitudeSpectrum.Num());
+		SpectralDifferenceState.Reset(MagnitudeSpectrum.Num());
 	}
 
+	float* PrevMagnitudeSpectrum = SpectralDifferenceState.PrevMagnitudeSpectrum.GetData();
+
 	float SpectralDifferenceValue{0};
 
-	for (TArray64<float>::SizeType Index = 0; Index < MagnitudeSpectrum.Num(); ++Index)
+	for (int64 Index = 0; Index < MagnitudeSpectrum.Num(); ++Index)
 	{
 		// Calculate difference
-		const float Difference{MagnitudeSpectrum[Index] - PrevMagnitudeSpectrum_SpectralDifference[Index]};
+		const float Difference{MagnitudeSpectrum[Index] - PrevMagnitudeSpectrum[Index]};
 
 		// Ensure all difference values are positive
 		FMath::Abs(Difference);
@@ -109,7 +106,7 @@ float UOnsetDetection::GetSpectralDifference(const TArray64<float>& MagnitudeSpe
 		SpectralDifferenceValue += Difference;
 
 		// Store the sample for next time
-		PrevMagnitudeSpectrum_SpectralDifference[Index] = MagnitudeSpectrum[Index];
+		PrevMagnitudeSpectrum[Index] = MagnitudeSpectrum[Index];
 	}
 
 	return SpectralDifferenceValue;
@@ -117,22 +114,26 @@ float UOnsetDetection::GetSpectralDifference(const TArray64<float>& MagnitudeSpe
 
 float UOnsetDetection::GetSpectralDifferenceHWR(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetSpectralDifferenceHWR(TArray64<float>(MagnitudeSpectrum));
+	return GetSpectralDifferenceHWR(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UOnsetDetection::GetSpectralDifferenceHWR(const TArray64<float>& MagnitudeSpectrum)
+float UOnsetDetection::GetSpectralDifferenceHWR(TArrayView64<const float> MagnitudeSpectrum)
 {
-	if (MagnitudeSpectrum.Num() != FrameSize)
+	// Only happens when the spectrum size changes, which invalidates the history of this function alone
+	if (MagnitudeSpectrum.Num() != SpectralDifferenceHWRState.Num())
 	{
-		UpdateFrameSize(MagnitudeSpectrum.Num());
+		UE_LOG(LogAudioAnalysis, Log, TEXT("Updating the half wave rectified spectral difference size from '%lld' to '%lld'"), SpectralDifferenceHWRState.Num(), MagnitudeSpectrum.Num());
+		SpectralDifferenceHWRState.Reset(MagnitudeSpectrum.Num());
 	}
 
+	float* PrevMagnitudeSpectrum = SpectralDifferenceHWRState.PrevMagnitudeSpectrum.GetData();
+
 	float SpectralDifferenceHWRValue{0};
 
-	for (TArray64<float>::SizeType Index = 0; Index < MagnitudeSpectrum.Num(); ++Index)
+	for (int64 Index = 0; Index < MagnitudeSpectrum.Num(); ++Index)
 	{
 		// Calculate difference
-		const float Difference = MagnitudeSpectrum[Index] - PrevMagnitudeSpectrum_SpectralDifferenceHWR[Index];
+		const float Difference = MagnitudeSpectrum[Index] - PrevMagnitudeSpectrum[Index];
 
 		// Only for positive changes
 		if (Difference > 0)
@@ -142,7 +143,7 @@ float UOnsetDetection::GetSpectralDifferenceHWR(const TArray64<float>& Magnitude
 		}
 
 		// Store the sample for next time
-		PrevMagnitudeSpectrum_SpectralDifferenceHWR[Index] = MagnitudeSpectrum[Index];
+		PrevMagnitudeSpectrum[Index] = MagnitudeSpectrum[Index];
 	}
 
 	return SpectralDifferenceHWRValue;
@@ -150,10 +151,10 @@ float UOnsetDetection::GetSpectralDifferenceHWR(const TArray64<float>& Magnitude
 
 float UOnsetDetection::GetComplexSpectralDifference(const TArray<float>& FFTReal, const TArray<float>& FFTImaginary)
 {
-	return GetComplexSpectralDifference(TArray64<float>(FFTReal), TArray64<float>(FFTImaginary));
+	return GetComplexSpectralDifference(TArrayView64<const float>(FFTReal), TArrayView64<const float>(FFTImaginary));
 }
 
-float UOnsetDetection::GetComplexSpectralDifference(const TArray64<float>& FFTReal, const TArray64<float>& FFTImaginary)
+float UOnsetDetection::GetComplexSpectralDifference(TArrayView64<const float> FFTReal, TArrayView64<const float> FFTImaginary)
 {
 	if (FFTReal.Num() != FFTImaginary.Num())
 	{
@@ -161,15 +162,26 @@ float UOnsetDetection::GetComplexSpectralDifference(const TArray64<float>& FFTRe
 		return -1;
 	}
 
-	if (FFTReal.Num() != FrameSize)
+	if (ComplexSpectralDifferenceMode == EComplexSpectralDifferenceMode::PhasorPrediction)
 	{
-		UpdateFrameSize(FFTReal.Num());
+		return GetComplexSpectralDifferenceByPrediction(FFTReal, FFTImaginary);
 	}
 
+	// Only happens when the FFT size changes, which invalidates the history of this function alone
+	if (FFTReal.Num() != ComplexSpectralDifferenceState.Num())
+	{
+		UE_LOG(LogAudioAnalysis, Log, TEXT("Updating the complex spectral difference size from '%lld' to '%lld'"), ComplexSpectralDifferenceState.Num(), FFTReal.Num());
+		ComplexSpectralDifferenceState.Reset(FFTReal.Num());
+	}
+
+	float* PrevPhaseSpectrum = ComplexSpectralDifferenceState.PrevPhaseSpectrum.GetData();
+	float* PrevPhaseSpectrum2 = ComplexSpectralDifferenceState.PrevPhaseSpectrum2.GetData();
+	float* PrevMagnitudeSpectrum = ComplexSpectralDifferenceState.PrevMagnitudeSpectrum.GetData();
+
 	float ComplexSpectralDifferenceValue{0};
 
 	// Compute phase values from fft output and sum deviations
-	for (TArray64<float>::SizeType Index = 0; Index < FFTReal.Num(); ++Index)
+	for (int64 Index = 0; Index < FFTReal.Num(); ++Index)
 	{
 		// Calculate phase value
 		const float PhaseValue{FMath::Atan2(FFTImaginary[Index], FFTReal[Index])};
@@ -178,13 +190,13 @@ float UOnsetDetection::GetComplexSpectralDifference(const TArray64<float>& FFTRe
 		const float MagnitudeValue{FMath::Sqrt(FMath::Pow(FFTReal[Index], 2) + FMath::Pow(FFTImaginary[Index], 2))};
 
 		// Phase deviation
-		const float PhaseDeviation{PhaseValue - (2 * PrevPhaseSpectrum_ComplexSpectralDifference[Index]) + PrevPhaseSpectrum2_ComplexSpectralDifference[Index]};
+		const float PhaseDeviation{PhaseValue - (2 * PrevPhaseSpectrum[Index]) + PrevPhaseSpectrum2[Index]};
 
 		// Wrap into [-pi,pi] range
 		const float PhasePiRange{Princarg(PhaseDeviation)};
 
 		// Calculate magnitude difference (real part of Euclidean distance between complex frames)
-		const float MagnitudeDifference{MagnitudeValue - PrevMagnitudeSpectrum_ComplexSpectralDifference[Index]};
+		const float MagnitudeDifference{MagnitudeValue - PrevMagnitudeSpectrum[Index]};
 
 		// Calculate phase difference (imaginary part of Euclidean distance between complex frames)
 		const float PhaseDifference{-MagnitudeValue * FMath::Sin(PhasePiRange)};
@@ -195,24 +207,106 @@ float UOnsetDetection::GetComplexSpectralDifference(const TArray64<float>& FFTRe
 		ComplexSpectralDifferenceValue += Value;
 
 		// Store values for the next calculation
-		PrevPhaseSpectrum2_ComplexSpectralDifference[Index] = PrevPhaseSpectrum_ComplexSpectralDifference[Index];
-		PrevPhaseSpectrum_ComplexSpectralDifference[Index] = PhaseValue;
-		PrevMagnitudeSpectrum_ComplexSpectralDifference[Index] = MagnitudeValue;
+		PrevPhaseSpectrum2[Index] = PrevPhaseSpectrum[Index];
+		PrevPhaseSpectrum[Index] = PhaseValue;
+		PrevMagnitudeSpectrum[Index] = MagnitudeValue;
+	}
+
+	return ComplexSpectralDifferenceValue;
+}
+
+float UOnsetDetection::GetComplexSpectralDifferenceByPrediction(TArrayView64<const float> FFTReal, TArrayView64<const float> FFTImaginary)
+{
+	if (FFTReal.Num() != PhasorPredictionState.Num())
+	{
+		UE_LOG(LogAudioAnalysis, Log, TEXT("Updating the complex spectral difference size from '%lld' to '%lld'"), PhasorPredictionState.Num(), FFTReal.Num());
+		PhasorPredictionState.Reset(FFTReal.Num());
+	}
+
+	const float* RESTRICT InReal = FFTReal.GetData();
+	const float* RESTRICT InImaginary = FFTImaginary.GetData();
+	float* RESTRICT PrevPhasorReal = PhasorPredictionState.PrevPhasorReal.GetData();
+	float* RESTRICT PrevPhasorImaginary = PhasorPredictionState.PrevPhasorImaginary.GetData();
+	float* RESTRICT PrevPhasorReal2 = PhasorPredictionState.PrevPhasorReal2.GetData();
+	float* RESTRICT PrevPhasorImaginary2 = PhasorPredictionState.PrevPhasorImaginary2.GetData();
+	float* RESTRICT PrevMagnitudeSpectrum = PhasorPredictionState.PrevMagnitudeSpectrum.GetData();
+
+	// Branchless, so the compiler can vectorize the loop over the bins
+	auto ProcessBin = [&](int64 Index) -> float
+	{
+		const float Real = InReal[Index];
+		const float Imaginary = InImaginary[Index];
+		const float MagnitudeValue = FMath::Sqrt(Real * Real + Imaginary * Imaginary);
+
+		// The unit phasor of the bin. A zero bin has a zero phase, as atan2(0, 0)
+		const float InverseMagnitude = MagnitudeValue > 0 ? 1 / MagnitudeValue : 0;
+		const float PhasorReal = MagnitudeValue > 0 ? Real * InverseMagnitude : 1;
+		const float PhasorImaginary = Imaginary * InverseMagnitude;
+
+		// The predicted phasor continues the phase advance of the previous two frames: prev * prev / prev2, where dividing by a unit phasor is multiplying by its conjugate
+		const float PrevSquaredReal = PrevPhasorReal[Index] * PrevPhasorReal[Index] - PrevPhasorImaginary[Index] * PrevPhasorImaginary[Index];
+		const float PrevSquaredImaginary = 2 * PrevPhasorReal[Index] * PrevPhasorImaginary[Index];
+		const float PredictedReal = PrevSquaredReal * PrevPhasorReal2[Index] + PrevSquaredImaginary * PrevPhasorImaginary2[Index];
+		const float PredictedImaginary = PrevSquaredImaginary * PrevPhasorReal2[Index] - PrevSquaredReal * PrevPhasorImaginary2[Index];
+
+		// The sine of the phase deviation is the imaginary part of the phasor times the conjugate of the prediction, which also wraps it into [-pi, pi]
+		const float SinPhaseDeviation = PhasorImaginary * PredictedReal - PhasorReal * PredictedImaginary;
+
+		const float MagnitudeDifference = MagnitudeValue - PrevMagnitudeSpectrum[Index];
+		const float PhaseDifference = -MagnitudeValue * SinPhaseDeviation;
+
+		PrevPhasorReal2[Index] = PrevPhasorReal[Index];
+		PrevPhasorImaginary2[Index] = PrevPhasorImaginary[Index];
+		PrevPhasorReal[Index] = PhasorReal;
+		PrevPhasorImaginary[Index] = PhasorImaginary;
+		PrevMagnitudeSpectrum[Index] = MagnitudeValue;
+
+		return FMath::Sqrt(MagnitudeDifference * MagnitudeDifference + PhaseDifference * PhaseDifference);
+	};
+
+	const int64 FFTSize = FFTReal.Num();
+	if (FFTSize == 0)
+	{
+		return 0;
+	}
+
+	// The bins above the Nyquist bin mirror the bins below it with the same magnitudes and negated phases, so they add the same values once more
+	const int64 NyquistIndex = FFTSize % 2 == 0 ? FFTSize / 2 : -1;
+	const int64 NumOfMirroredBins = (FFTSize - 1) / 2;
+
+	float MirroredValue{0};
+	for (int64 Index = 1; Index <= NumOfMirroredBins; ++Index)
+	{
+		MirroredValue += ProcessBin(Index);
+	}
+
+	float ComplexSpectralDifferenceValue{ProcessBin(0) + 2 * MirroredValue};
+	if (NyquistIndex > 0)
+	{
+		ComplexSpectralDifferenceValue += ProcessBin(NyquistIndex);
 	}
 
 	return ComplexSpectralDifferenceValue;
 }
 
+void UOnsetDetection::SetComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode Mode)
+{
+	ComplexSpectralDifferenceMode = Mode;
+
+	ComplexSpectralDifferenceState.Reset(ComplexSpectralDifferenceState.Num());
+	PhasorPredictionState.Reset(PhasorPredictionState.Num());
+}
+
 float UOnsetDetection::GetHighFrequencyContent(const TArray<float>& MagnitudeSpectrum)
 {
-	return GetHighFrequencyContent(TArray64<float>(MagnitudeSpectrum));
+	return GetHighFrequencyContent(TArrayView64<const float>(MagnitudeSpectrum));
 }
 
-float UOnsetDetection::GetHighFrequencyContent(const TArray64<float>& MagnitudeSpectrum)
+float UOnsetDetection::GetHighFrequencyContent(TArrayView64<const float> MagnitudeSpectrum)
 {
 	float HighFrequencyContentValue{0};
 
-	for (TArray64<float>::SizeType Index = 0; Index < MagnitudeSpectrum.Num(); ++Index)
+	for (int64 Index = 0; Index < MagnitudeSpectrum.Num(); ++Index)
 	{
 		HighFrequencyContentValue += MagnitudeSpectrum[Index] * static_cast<float>(Index + 1);
 	}
@@ -0,0 +1,101 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/OnsetPicker.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "Math/NumericLimits.h"
+
+UOnsetPicker::UOnsetPicker()
+	: PreviousValue(0),
+	  CandidateValue(0),
+	  Threshold(0),
+	  CandidateIndex(-1),
+	  LastOnsetIndex(TNumericLimits<int32>::Lowest()),
+	  LastOnsetTime(-1),
+	  LastOnsetStrength(0),
+	  NumOfOnsets(0),
+	  OnsetFunctionRate(0),
+	  MedianWeight(0),
+	  MeanWeight(0),
+	  Offset(0),
+	  MinIntervalSamples(0)
+{
+}
+
+UOnsetPicker* UOnsetPicker::CreateOnsetPicker(float InOnsetFunctionRate, int32 InWindowSize, float InMedianWeight, float InMeanWeight, float InOffset, float InMinInterval)
+{
+	if (InOnsetFunctionRate <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the onset picker: the onset function rate is '%f', expected > '0'"), InOnsetFunctionRate);
+		return nullptr;
+	}
+
+	if (InMinInterval < 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the onset picker: the minimum interval is '%f', expected >= '0'"), InMinInterval);
+		return nullptr;
+	}
+
+	UOnsetPicker* OnsetPicker = NewObject<UOnsetPicker>();
+	if (!OnsetPicker->SlidingMedian.Configure(InWindowSize))
+	{
+		return nullptr;
+	}
+
+	OnsetPicker->OnsetFunctionRate = InOnsetFunctionRate;
+	OnsetPicker->MedianWeight = InMedianWeight;
+	OnsetPicker->MeanWeight = InMeanWeight;
+	OnsetPicker->Offset = InOffset;
+	OnsetPicker->MinIntervalSamples = FMath::CeilToInt(InMinInterval * InOnsetFunctionRate);
+	return OnsetPicker;
+}
+
+bool UOnsetPicker::ProcessOnsetValue(float OnsetValue)
+{
+	if (SlidingMedian.GetWindowSize() == 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process the onset value: the onset picker is not configured"));
+		return false;
+	}
+
+	// With the next sample known, the candidate can be checked for being a peak above its threshold
+	const bool bOnset = CandidateIndex >= 0
+		&& CandidateValue > PreviousValue
+		&& CandidateValue >= OnsetValue
+		&& CandidateValue > Threshold
+		&& CandidateIndex - LastOnsetIndex >= MinIntervalSamples;
+
+	if (bOnset)
+	{
+		LastOnsetIndex = CandidateIndex;
+		LastOnsetTime = static_cast<float>(CandidateIndex / static_cast<double>(OnsetFunctionRate));
+		LastOnsetStrength = CandidateValue;
+		++NumOfOnsets;
+
+		OnOnsetPickedNative.Broadcast(LastOnsetTime, LastOnsetStrength);
+		OnOnsetPicked.Broadcast(LastOnsetTime, LastOnsetStrength);
+	}
+
+	// The new sample becomes the candidate, thresholded by the window including it
+	SlidingMedian.Add(OnsetValue);
+
+	PreviousValue = CandidateValue;
+	CandidateValue = OnsetValue;
+	Threshold = Offset + MedianWeight * SlidingMedian.GetMedian() + MeanWeight * SlidingMedian.GetMean();
+	++CandidateIndex;
+
+	return bOnset;
+}
+
+void UOnsetPicker::Reset()
+{
+	SlidingMedian.Reset();
+
+	PreviousValue = 0;
+	CandidateValue = 0;
+	Threshold = 0;
+	CandidateIndex = -1;
+	LastOnsetIndex = TNumericLimits<int32>::Lowest();
+	LastOnsetTime = -1;
+	LastOnsetStrength = 0;
+	NumOfOnsets = 0;
+}
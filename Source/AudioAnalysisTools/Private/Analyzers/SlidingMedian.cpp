@@ -0,0 +1,207 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/SlidingMedian.h"
+#include "AudioAnalysisToolsDefines.h"
+
+FSlidingMedian::FSlidingMedian()
+	: HeapSizes{0, 0},
+	  NextSlot(0),
+	  NumOfValues(0),
+	  Sum(0)
+{
+}
+
+bool FSlidingMedian::Configure(int32 WindowSize)
+{
+	if (WindowSize <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the sliding median: the window size is '%d', expected > '0'"), WindowSize);
+		return false;
+	}
+
+	Values.SetNumUninitialized(WindowSize);
+	SlotHeaps.SetNumUninitialized(WindowSize);
+	SlotHeapIndices.SetNumUninitialized(WindowSize);
+
+	// Each heap holds at most half of the window, plus one while an added value is being rebalanced
+	Heaps[LowHeap].SetNumUninitialized(WindowSize / 2 + 2);
+	Heaps[HighHeap].SetNumUninitialized(WindowSize / 2 + 2);
+
+	Reset();
+
+	return true;
+}
+
+void FSlidingMedian::Reset()
+{
+	HeapSizes[LowHeap] = 0;
+	HeapSizes[HighHeap] = 0;
+	NextSlot = 0;
+	NumOfValues = 0;
+	Sum = 0;
+}
+
+void FSlidingMedian::Add(float Value)
+{
+	const int32 WindowSize = Values.Num();
+	if (WindowSize == 0)
+	{
+		return;
+	}
+
+	const int32 Slot = NextSlot;
+
+	if (NumOfValues == WindowSize)
+	{
+		Sum -= Values[Slot];
+		Remove(Slot);
+	}
+	else
+	{
+		++NumOfValues;
+	}
+
+	Values[Slot] = Value;
+	Sum += Value;
+
+	// Every value of the low heap must stay below every value of the high heap, so only the values above the smallest high value go to the high heap
+	Push(HeapSizes[HighHeap] == 0 || Value <= Values[Heaps[HighHeap][0]] ? LowHeap : HighHeap, Slot);
+	Rebalance();
+
+	NextSlot = Slot + 1 == WindowSize ? 0 : Slot + 1;
+
+	// Once per window cycle, the running sum is renormalized to bound the rounding drift
+	if (NextSlot == 0)
+	{
+		RecomputeSum();
+	}
+}
+
+float FSlidingMedian::GetMedian() const
+{
+	if (NumOfValues == 0)
+	{
+		return 0;
+	}
+
+	const float LowTop = Values[Heaps[LowHeap][0]];
+
+	if (HeapSizes[LowHeap] > HeapSizes[HighHeap])
+	{
+		return LowTop;
+	}
+
+	return 0.5f * (LowTop + Values[Heaps[HighHeap][0]]);
+}
+
+void FSlidingMedian::Push(uint8 Heap, int32 Slot)
+{
+	SlotHeaps[Slot] = Heap;
+
+	const int32 HeapIndex = HeapSizes[Heap]++;
+	Place(Heap, HeapIndex, Slot);
+	SiftUp(Heap, HeapIndex);
+}
+
+void FSlidingMedian::Remove(int32 Slot)
+{
+	const uint8 Heap = SlotHeaps[Slot];
+	const int32 HeapIndex = SlotHeapIndices[Slot];
+	const int32 LastHeapIndex = --HeapSizes[Heap];
+
+	if (HeapIndex == LastHeapIndex)
+	{
+		return;
+	}
+
+	// The last entry takes the place of the removed one, and may have to move either way
+	Place(Heap, HeapIndex, Heaps[Heap][LastHeapIndex]);
+
+	if (HeapIndex > 0 && IsHigherPriority(Heap, Heaps[Heap][HeapIndex], Heaps[Heap][(HeapIndex - 1) / 2]))
+	{
+		SiftUp(Heap, HeapIndex);
+	}
+	else
+	{
+		SiftDown(Heap, HeapIndex);
+	}
+}
+
+void FSlidingMedian::SiftUp(uint8 Heap, int32 HeapIndex)
+{
+	TArray<int32>& HeapSlots = Heaps[Heap];
+	const int32 Slot = HeapSlots[HeapIndex];
+
+	while (HeapIndex > 0)
+	{
+		const int32 ParentIndex = (HeapIndex - 1) / 2;
+		if (!IsHigherPriority(Heap, Slot, HeapSlots[ParentIndex]))
+		{
+			break;
+		}
+
+		Place(Heap, HeapIndex, HeapSlots[ParentIndex]);
+		HeapIndex = ParentIndex;
+	}
+
+	Place(Heap, HeapIndex, Slot);
+}
+
+void FSlidingMedian::SiftDown(uint8 Heap, int32 HeapIndex)
+{
+	TArray<int32>& HeapSlots = Heaps[Heap];
+	const int32 HeapSize = HeapSizes[Heap];
+	const int32 Slot = HeapSlots[HeapIndex];
+
+	while (true)
+	{
+		int32 ChildIndex = HeapIndex * 2 + 1;
+		if (ChildIndex >= HeapSize)
+		{
+			break;
+		}
+
+		if (ChildIndex + 1 < HeapSize && IsHigherPriority(Heap, HeapSlots[ChildIndex + 1], HeapSlots[ChildIndex]))
+		{
+			++ChildIndex;
+		}
+
+		if (!IsHigherPriority(Heap, HeapSlots[ChildIndex], Slot))
+		{
+			break;
+		}
+
+		Place(Heap, HeapIndex, HeapSlots[ChildIndex]);
+		HeapIndex = ChildIndex;
+	}
+
+	Place(Heap, HeapIndex, Slot);
+}
+
+void FSlidingMedian::Rebalance()
+{
+	auto MoveTop = [this](uint8 FromHeap, uint8 ToHeap)
+	{
+		const int32 Slot = Heaps[FromHeap][0];
+		Remove(Slot);
+		Push(ToHeap, Slot);
+	};
+
+	if (HeapSizes[LowHeap] > HeapSizes[HighHeap] + 1)
+	{
+		MoveTop(LowHeap, HighHeap);
+	}
+	else if (HeapSizes[HighHeap] > HeapSizes[LowHeap])
+	{
+		MoveTop(HighHeap, LowHeap);
+	}
+}
+
+void FSlidingMedian::RecomputeSum()
+{
+	Sum = 0;
+	for (int32 Slot = 0; Slot < NumOfValues; ++Slot)
+	{
+		Sum += Values[Slot];
+	}
+}
@@ -0,0 +1,150 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/SpectrumAnalyzer.h"
+#include "Analyzers/FFTAudioAnalyzer.h"
+#include "AudioAnalysisToolsDefines.h"
+
+#include "Math/VectorRegister.h"
+#include "Misc/EngineVersionComparison.h"
+
+#if UE_VERSION_OLDER_THAN(5, 0, 0)
+using VectorRegister4Float = VectorRegister;
+#endif
+
+namespace
+{
+	/**
+	 * Multiply the audio frames by the window and split the products into the even and odd samples, in a single pass
+	 */
+	void ApplyWindowDeinterleaved(const float* RESTRICT AudioFrames, const float* RESTRICT WindowFunction, float* RESTRICT OutEven, float* RESTRICT OutOdd, int64 NumOfPairs)
+	{
+		int64 Index = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		for (; Index + 4 <= NumOfPairs; Index += 4)
+		{
+			const VectorRegister4Float FirstProducts = VectorMultiply(VectorLoad(AudioFrames + Index * 2), VectorLoad(WindowFunction + Index * 2));
+			const VectorRegister4Float SecondProducts = VectorMultiply(VectorLoad(AudioFrames + Index * 2 + 4), VectorLoad(WindowFunction + Index * 2 + 4));
+
+			// Gather the even and the odd samples of the four pairs
+			VectorStore(VectorShuffle(FirstProducts, SecondProducts, 0, 2, 0, 2), OutEven + Index);
+			VectorStore(VectorShuffle(FirstProducts, SecondProducts, 1, 3, 1, 3), OutOdd + Index);
+		}
+#endif
+
+		for (; Index < NumOfPairs; ++Index)
+		{
+			OutEven[Index] = AudioFrames[2 * Index] * WindowFunction[2 * Index];
+			OutOdd[Index] = AudioFrames[2 * Index + 1] * WindowFunction[2 * Index + 1];
+		}
+	}
+
+	/**
+	 * Multiply the audio frames by the window
+	 */
+	void ApplyWindow(const float* RESTRICT AudioFrames, const float* RESTRICT WindowFunction, float* RESTRICT OutFrames, int64 NumOfFrames)
+	{
+		int64 Index = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		for (; Index + 4 <= NumOfFrames; Index += 4)
+		{
+			VectorStore(VectorMultiply(VectorLoad(AudioFrames + Index), VectorLoad(WindowFunction + Index)), OutFrames + Index);
+		}
+#endif
+
+		for (; Index < NumOfFrames; ++Index)
+		{
+			OutFrames[Index] = AudioFrames[Index] * WindowFunction[Index];
+		}
+	}
+}
+
+bool FSpectrumAnalyzer::Configure(int64 FrameSize)
+{
+	Reset();
+
+	if (FrameSize <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the spectrum analyzer: the frame size is '%lld', expected > '0'"), FrameSize);
+		return false;
+	}
+
+	// Audio frames are real, so the real FFT computes the same spectrum with about half the work
+	// The complex FFT is only needed for odd frame sizes, which cannot be packed into a half-sized complex FFT
+	const bool bRealFFT = FrameSize % 2 == 0;
+
+	// The plan (twiddles and factors) is shared with all other analyzers of the same frame size
+	Plan = FFFTPlanCache::Get().FindOrCreatePlan(FrameSize, false, bRealFFT);
+
+	if (!Plan.IsValid())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the spectrum analyzer: failed to create the FFT plan of size '%lld'"), FrameSize);
+		return false;
+	}
+
+	const int64 InputSize = bRealFFT ? FrameSize / 2 : FrameSize;
+	InReal.SetNumZeroed(InputSize);
+	InImaginary.SetNumZeroed(InputSize);
+
+	// The plan is shared, so the scratch memory is owned by the analyzer to keep the FFT allocation-free
+	Scratch.SetNumUninitialized(Plan->GetSplitScratchLength());
+
+	return true;
+}
+
+void FSpectrumAnalyzer::Reset()
+{
+	// Release the reference to the shared FFT plan
+	Plan.Reset();
+
+	InReal.Empty();
+	InImaginary.Empty();
+	Scratch.Empty();
+}
+
+void FSpectrumAnalyzer::Process(const float* AudioFrames, const float* WindowFunction, float* OutReal, float* OutImaginary, float* OutMagnitudeSpectrum, bool bParallel)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_PerformFFT);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_PerformFFT);
+
+	if (!Plan.IsValid())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to perform FFT analysis because the FFT plan is invalid"));
+		return;
+	}
+
+	const int64 FrameSize = Plan->GetSize();
+
+	if (Plan->IsReal())
+	{
+		const int64 HalfFrameSize = FrameSize / 2;
+
+		// Windowed even and odd samples are the real and imaginary parts of the half-sized complex FFT
+		ApplyWindowDeinterleaved(AudioFrames, WindowFunction, InReal.GetData(), InImaginary.GetData(), HalfFrameSize);
+
+		// Execute the split-complex real FFT. Only the bins from 0 to FrameSize / 2 are produced
+		UFFTAudioAnalyzer::PerformFFTRealSplit(Plan->GetRealState(), Plan->GetSplitState(), InReal.GetData(), InImaginary.GetData(), OutReal, OutImaginary, bParallel, Scratch.GetData());
+
+		// Restore the redundant half of the FFT by conjugate symmetry
+		for (int64 Index = HalfFrameSize + 1; Index < FrameSize; ++Index)
+		{
+			OutReal[Index] = OutReal[FrameSize - Index];
+			OutImaginary[Index] = -OutImaginary[FrameSize - Index];
+		}
+	}
+	else
+	{
+		// Imaginary parts of the input are always zeros
+		ApplyWindow(AudioFrames, WindowFunction, InReal.GetData(), FrameSize);
+
+		// Execute the split-complex FFT
+		UFFTAudioAnalyzer::PerformFFTSplit(Plan->GetSplitState(), InReal.GetData(), InImaginary.GetData(), OutReal, OutImaginary, bParallel, Scratch.GetData());
+	}
+
+	// Calculate the magnitude spectrum
+	for (int64 Index = 0; Index < FrameSize / 2; ++Index)
+	{
+		OutMagnitudeSpectrum[Index] = FMath::Sqrt(FMath::Pow(OutReal[Index], 2) + FMath::Pow(OutImaginary[Index], 2));
+	}
+}
@@ -0,0 +1,267 @@
+// Georgy Treshchev 2024.
+
+#include "Analyzers/TempoEstimation.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "Math/UnrealMathUtility.h"
+#include "Math/NumericLimits.h"
+
+namespace
+{
+	/** The tempo the estimation is biased towards when the autocorrelation has similar peaks at multiples of the beat period */
+	constexpr float PreferredBPM = 120;
+
+	/** The width of the tempo bias in octaves */
+	constexpr float PreferredBPMOctaveWidth = 1;
+}
+
+UTempoEstimation::UTempoEstimation()
+	: HistoryPosition(0),
+	  NumOfOnsetValues(0),
+	  SamplesSinceEstimation(0),
+	  MinLag(0),
+	  MaxLag(0),
+	  BPM(0),
+	  BeatPhase(0),
+	  BeatPeriod(0),
+	  Confidence(0),
+	  OnsetFunctionRate(0),
+	  HistorySize(0),
+	  UpdateInterval(0)
+{
+}
+
+UTempoEstimation* UTempoEstimation::CreateTempoEstimation(float InOnsetFunctionRate, int64 InHistorySize, int64 InUpdateInterval, float InMinBPM, float InMaxBPM)
+{
+	UTempoEstimation* TempoEstimation = NewObject<UTempoEstimation>();
+	if (!TempoEstimation->Configure(InOnsetFunctionRate, InHistorySize, InUpdateInterval, InMinBPM, InMaxBPM))
+	{
+		return nullptr;
+	}
+	return TempoEstimation;
+}
+
+bool UTempoEstimation::Configure(float InOnsetFunctionRate, int64 InHistorySize, int64 InUpdateInterval, float InMinBPM, float InMaxBPM)
+{
+	if (InOnsetFunctionRate <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the tempo estimation: the onset function rate is '%f', expected > '0'"), InOnsetFunctionRate);
+		return false;
+	}
+
+	if (InUpdateInterval <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the tempo estimation: the update interval is '%lld', expected > '0'"), InUpdateInterval);
+		return false;
+	}
+
+	if (!(InMinBPM > 0 && InMaxBPM > InMinBPM))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the tempo estimation: the tempo range is '%f'-'%f' BPM, expected > '0' and min < max"), InMinBPM, InMaxBPM);
+		return false;
+	}
+
+	const int64 NewMinLag = FMath::Max<int64>(FMath::FloorToInt(60 * InOnsetFunctionRate / InMaxBPM), 1);
+	const int64 NewMaxLag = FMath::Max<int64>(FMath::CeilToInt(60 * InOnsetFunctionRate / InMinBPM), NewMinLag + 1);
+
+	// At least two periods of the slowest tempo are needed to find it in the autocorrelation
+	if (InHistorySize < 2 * NewMaxLag)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the tempo estimation: the history size is '%lld', expected >= '%lld' to cover two beats at '%f' BPM"), InHistorySize, 2 * NewMaxLag, InMinBPM);
+		return false;
+	}
+
+	// Zero-padded to at least twice the history, so the circular autocorrelation of the FFT does not wrap around
+	const int64 NFFT = FMath::RoundUpToPowerOfTwo64(2 * InHistorySize);
+
+	FFFTPlanPtr NewForwardPlan = FFFTPlanCache::Get().FindOrCreatePlan(NFFT, false, false);
+	FFFTPlanPtr NewInversePlan = FFFTPlanCache::Get().FindOrCreatePlan(NFFT, true, false);
+
+	if (!NewForwardPlan.IsValid() || !NewInversePlan.IsValid())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to configure the tempo estimation: failed to create the FFT plans of size '%lld'"), NFFT);
+		return false;
+	}
+
+	ForwardPlan = MoveTemp(NewForwardPlan);
+	InversePlan = MoveTemp(NewInversePlan);
+
+	OnsetFunctionRate = InOnsetFunctionRate;
+	HistorySize = InHistorySize;
+	UpdateInterval = InUpdateInterval;
+	MinLag = NewMinLag;
+	MaxLag = NewMaxLag;
+
+	OnsetHistory.SetNumUninitialized(HistorySize);
+	FFTInput.SetNumUninitialized(NFFT);
+	FFTOutput.SetNumUninitialized(NFFT);
+	FFTScratch.SetNumUninitialized(FMath::Max(ForwardPlan->GetState()->ScratchLength, InversePlan->GetState()->ScratchLength));
+
+	// One more lag than the longest period, for the interpolation of the peak
+	Autocorrelation.SetNumUninitialized(MaxLag + 2);
+
+	Reset();
+
+	return true;
+}
+
+void UTempoEstimation::Reset()
+{
+	FMemory::Memzero(OnsetHistory.GetData(), OnsetHistory.Num() * sizeof(float));
+	FMemory::Memzero(Autocorrelation.GetData(), Autocorrelation.Num() * sizeof(float));
+
+	HistoryPosition = 0;
+	NumOfOnsetValues = 0;
+	SamplesSinceEstimation = 0;
+
+	BPM = 0;
+	BeatPhase = 0;
+	BeatPeriod = 0;
+	Confidence = 0;
+}
+
+void UTempoEstimation::ProcessOnsetValue(float OnsetValue)
+{
+	if (HistorySize <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process the onset value: the tempo estimation is not configured"));
+		return;
+	}
+
+	OnsetHistory[HistoryPosition] = OnsetValue;
+	HistoryPosition = (HistoryPosition + 1) % HistorySize;
+	NumOfOnsetValues = FMath::Min(NumOfOnsetValues + 1, HistorySize);
+
+	// Keep the phase moving between the estimations
+	if (BeatPeriod > 0)
+	{
+		BeatPhase = FMath::Frac(BeatPhase + 1 / BeatPeriod);
+	}
+
+	if (++SamplesSinceEstimation >= UpdateInterval)
+	{
+		SamplesSinceEstimation = 0;
+		EstimateTempo();
+	}
+}
+
+void UTempoEstimation::EstimateTempo()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_TempoEstimation);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_TempoEstimation);
+
+	if (NumOfOnsetValues < 2 * MaxLag)
+	{
+		return;
+	}
+
+	ComputeAutocorrelation();
+
+	// The autocorrelation also peaks at multiples and fractions of the beat period, so the peaks are weighted by a log-Gaussian around the preferred tempo
+	int64 BestLag = 0;
+	float BestScore = 0;
+
+	for (int64 Lag = MinLag; Lag <= MaxLag; ++Lag)
+	{
+		const float LagBPM = 60 * OnsetFunctionRate / Lag;
+		const float Octaves = FMath::Log2(LagBPM / PreferredBPM) / PreferredBPMOctaveWidth;
+		const float Score = Autocorrelation[Lag] * FMath::Exp(-0.5f * Octaves * Octaves);
+
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestLag = Lag;
+		}
+	}
+
+	// No periodicity, such as silence
+	if (BestLag == 0)
+	{
+		return;
+	}
+
+	// Parabolic interpolation of the peak for a fractional beat period
+	const float Previous = Autocorrelation[BestLag - 1];
+	const float Current = Autocorrelation[BestLag];
+	const float Next = Autocorrelation[BestLag + 1];
+	const float Curvature = Previous - 2 * Current + Next;
+	const float Offset = Curvature < 0 ? FMath::Clamp(0.5f * (Previous - Next) / Curvature, -0.5f, 0.5f) : 0;
+
+	BeatPeriod = BestLag + Offset;
+	BPM = 60 * OnsetFunctionRate / BeatPeriod;
+	Confidence = FMath::Clamp(Current, 0.f, 1.f);
+
+	EstimateBeatPhase();
+}
+
+void UTempoEstimation::ComputeAutocorrelation()
+{
+	const int64 NFFT = FFTInput.Num();
+	FFTComplexSamples* RESTRICT FFTInputData = FFTInput.GetData();
+	FFTComplexSamples* RESTRICT FFTOutputData = FFTOutput.GetData();
+
+	double Mean = 0;
+	for (int64 Age = 0; Age < NumOfOnsetValues; ++Age)
+	{
+		Mean += GetOnsetValue(Age);
+	}
+	Mean /= NumOfOnsetValues;
+
+	// The history in chronological order with the mean removed, so the constant part of the onset function does not dominate the autocorrelation
+	for (int64 Index = 0; Index < NumOfOnsetValues; ++Index)
+	{
+		FFTInputData[Index].Real = static_cast<float>(GetOnsetValue(NumOfOnsetValues - 1 - Index) - Mean);
+		FFTInputData[Index].Imaginary = 0;
+	}
+	FMemory::Memzero(FFTInputData + NumOfOnsetValues, (NFFT - NumOfOnsetValues) * sizeof(FFTComplexSamples));
+
+	UFFTAudioAnalyzer::PerformFFT(ForwardPlan->GetState(), FFTInputData, FFTOutputData, false, FFTScratch.GetData());
+
+	// Wiener-Khinchin: the autocorrelation is the inverse FFT of the power spectrum
+	for (int64 Bin = 0; Bin < NFFT; ++Bin)
+	{
+		FFTInputData[Bin].Real = FFTOutputData[Bin].Real * FFTOutputData[Bin].Real + FFTOutputData[Bin].Imaginary * FFTOutputData[Bin].Imaginary;
+		FFTInputData[Bin].Imaginary = 0;
+	}
+
+	UFFTAudioAnalyzer::PerformFFT(InversePlan->GetState(), FFTInputData, FFTOutputData, false, FFTScratch.GetData());
+
+	const float ZeroLag = FFTOutputData[0].Real;
+	if (ZeroLag <= 0)
+	{
+		FMemory::Memzero(Autocorrelation.GetData(), Autocorrelation.Num() * sizeof(float));
+		return;
+	}
+
+	// Normalized by the zero lag and by the number of overlapping samples of each lag, so longer periods are not penalized
+	for (int64 Lag = 0; Lag < Autocorrelation.Num(); ++Lag)
+	{
+		Autocorrelation[Lag] = FFTOutputData[Lag].Real / ZeroLag * NumOfOnsetValues / (NumOfOnsetValues - Lag);
+	}
+}
+
+void UTempoEstimation::EstimateBeatPhase()
+{
+	const int64 NumOfOffsets = FMath::CeilToInt(BeatPeriod);
+
+	int64 BestOffset = 0;
+	float BestSum = -TNumericLimits<float>::Max();
+
+	// Each offset is scored by the onset function at the beats of the period before the latest sample, which reads the whole history once across all the offsets
+	for (int64 Offset = 0; Offset < NumOfOffsets; ++Offset)
+	{
+		float Sum = 0;
+		for (float Age = Offset; Age < NumOfOnsetValues - 0.5f; Age += BeatPeriod)
+		{
+			Sum += GetOnsetValue(FMath::RoundToInt(Age));
+		}
+
+		if (Sum > BestSum)
+		{
+			BestSum = Sum;
+			BestOffset = Offset;
+		}
+	}
+
+	// The latest beat was BestOffset samples ago
+	BeatPhase = FMath::Frac(BestOffset / BeatPeriod);
+}
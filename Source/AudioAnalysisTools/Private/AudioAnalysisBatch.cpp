@@ -0,0 +1,518 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisBatch.h"
+#include "AudioAnalysisCache.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "AudioChannelsLibrary.h"
+
+#include "Analyzers/BeatDetection.h"
+#include "Analyzers/CoreFrequencyDomainFeatures.h"
+#include "Analyzers/CoreTimeDomainFeatures.h"
+#include "Analyzers/OnsetDetection.h"
+#include "Analyzers/SpectrumAnalyzer.h"
+
+#include "Sound/ImportedSoundWave.h"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/StrongObjectPtr.h"
+
+FAudioAnalysisFeatureTracks::FAudioAnalysisFeatureTracks()
+	: FrameSize(0),
+	  HopSize(0),
+	  SampleRate(0),
+	  NumOfHops(0),
+	  FeatureMask(0),
+	  NumOfSubbands(0)
+{
+}
+
+namespace
+{
+	/** The number of consecutive hops processed by a single parallel task */
+	constexpr int64 HopsPerBlock = 8;
+
+	/**
+	 * Objects used by the asynchronous analysis. Created on the game thread and destroyed there after the analysis has finished
+	 */
+	struct FBatchAnalysisObjects
+	{
+		TStrongObjectPtr<UImportedSoundWave> ImportedSoundWave;
+		TStrongObjectPtr<UBeatDetection> BeatDetection;
+		TStrongObjectPtr<UOnsetDetection> OnsetDetection;
+	};
+
+	/**
+	 * Working memory of a single parallel task
+	 */
+	struct FBatchAnalysisBlock
+	{
+		FSpectrumAnalyzer SpectrumAnalyzer;
+		TArray64<float> FFTReal;
+		TArray64<float> FFTImaginary;
+		TArray64<float> MagnitudeSpectrum;
+	};
+
+	/**
+	 * Copy the PCM data of the sound wave, mixing it down to mono
+	 *
+	 * @return Whether the PCM data has been copied successfully or not
+	 */
+	bool CopyMonoPCMData(UImportedSoundWave* ImportedSoundWave, TArray64<float>& MonoPCMData, int32& SampleRate)
+	{
+		FScopeLock Lock(&*ImportedSoundWave->DataGuard);
+
+		if (!ImportedSoundWave->GetPCMBuffer().IsValid())
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze the sound wave: PCM buffer is invalid"));
+			return false;
+		}
+
+		const int32 NumChannels = ImportedSoundWave->NumChannels;
+		if (NumChannels <= 0)
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze the sound wave: the number of channels is '%d', expected > '0'"), NumChannels);
+			return false;
+		}
+
+		const float* PCMData = ImportedSoundWave->GetPCMBuffer().PCMData.GetView().GetData();
+		const int64 NumOfFrames = static_cast<int64>(ImportedSoundWave->GetPCMBuffer().PCMData.GetView().Num()) / NumChannels;
+
+		SampleRate = ImportedSoundWave->GetSampleRate();
+		MonoPCMData.SetNumUninitialized(NumOfFrames);
+
+		UAudioChannelsLibrary::DownmixToMono(PCMData, NumOfFrames, NumChannels, MonoPCMData.GetData());
+
+		return true;
+	}
+}
+
+void UAudioAnalysisBatch::AnalyzeSoundWaveAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask, const FOnSoundWaveAnalyzed& Result)
+{
+	AnalyzeSoundWaveAsync(ImportedSoundWave, FrameSize, HopSize, WindowType, FeatureMask, FOnSoundWaveAnalyzedNative::CreateLambda([Result](bool bSucceeded, const FAudioAnalysisFeatureTracks& FeatureTracks)
+	{
+		Result.ExecuteIfBound(bSucceeded, FeatureTracks);
+	}));
+}
+
+void UAudioAnalysisBatch::AnalyzeSoundWaveAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask, const FOnSoundWaveAnalyzedNative& Result)
+{
+	// The onset and beat detection objects can only be created on the game thread
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakImportedSoundWave = MakeWeakObjectPtr(ImportedSoundWave), FrameSize, HopSize, WindowType, FeatureMask, Result]()
+		{
+			AnalyzeSoundWaveAsync(WeakImportedSoundWave.Get(), FrameSize, HopSize, WindowType, FeatureMask, Result);
+		});
+		return;
+	}
+
+	if (!ImportedSoundWave)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze the sound wave: the specified sound wave is invalid"));
+		Result.ExecuteIfBound(false, FAudioAnalysisFeatureTracks());
+		return;
+	}
+
+	TUniquePtr<FBatchAnalysisObjects> Objects = MakeUnique<FBatchAnalysisObjects>();
+	Objects->ImportedSoundWave.Reset(ImportedSoundWave);
+	Objects->BeatDetection.Reset(UBeatDetection::CreateBeatDetection());
+	Objects->OnsetDetection.Reset(UOnsetDetection::CreateOnsetDetection(FrameSize));
+	Objects->OnsetDetection->SetComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode::PhasorPrediction);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Objects = MoveTemp(Objects), FrameSize, HopSize, WindowType, FeatureMask, Result]() mutable
+	{
+		FAudioAnalysisFeatureTracks FeatureTracks;
+		bool bSucceeded = false;
+
+		TArray64<float> MonoPCMData;
+		int32 SampleRate;
+
+		if (CopyMonoPCMData(Objects->ImportedSoundWave.Get(), MonoPCMData, SampleRate))
+		{
+			bSucceeded = AnalyzeAudioFrames(MonoPCMData.GetData(), MonoPCMData.Num(), SampleRate, FrameSize, HopSize, WindowType, FeatureMask,
+			                                Objects->BeatDetection.Get(), Objects->OnsetDetection.Get(), FeatureTracks);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Objects = MoveTemp(Objects), FeatureTracks = MoveTemp(FeatureTracks), bSucceeded, Result]() mutable
+		{
+			Objects.Reset();
+			Result.ExecuteIfBound(bSucceeded, FeatureTracks);
+		});
+	});
+}
+
+void UAudioAnalysisBatch::AnalyzeSoundWaveToCacheAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask, const FString& CacheDirectory, const FOnAnalysisCacheLoaded& Result)
+{
+	AnalyzeSoundWaveToCacheAsync(ImportedSoundWave, FrameSize, HopSize, WindowType, FeatureMask, CacheDirectory, FOnAnalysisCacheLoadedNative::CreateLambda([Result](bool bSucceeded, UAudioAnalysisCache* AnalysisCache)
+	{
+		Result.ExecuteIfBound(bSucceeded, AnalysisCache);
+	}));
+}
+
+void UAudioAnalysisBatch::AnalyzeSoundWaveToCacheAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask, const FString& CacheDirectory, const FOnAnalysisCacheLoadedNative& Result)
+{
+	// The onset and beat detection objects and the cache object can only be created on the game thread
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakImportedSoundWave = MakeWeakObjectPtr(ImportedSoundWave), FrameSize, HopSize, WindowType, FeatureMask, CacheDirectory, Result]()
+		{
+			AnalyzeSoundWaveToCacheAsync(WeakImportedSoundWave.Get(), FrameSize, HopSize, WindowType, FeatureMask, CacheDirectory, Result);
+		});
+		return;
+	}
+
+	if (!ImportedSoundWave)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze the sound wave to the cache: the specified sound wave is invalid"));
+		Result.ExecuteIfBound(false, nullptr);
+		return;
+	}
+
+	TUniquePtr<FBatchAnalysisObjects> Objects = MakeUnique<FBatchAnalysisObjects>();
+	Objects->ImportedSoundWave.Reset(ImportedSoundWave);
+	Objects->BeatDetection.Reset(UBeatDetection::CreateBeatDetection());
+	Objects->OnsetDetection.Reset(UOnsetDetection::CreateOnsetDetection(FrameSize));
+	Objects->OnsetDetection->SetComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode::PhasorPrediction);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Objects = MoveTemp(Objects), FrameSize, HopSize, WindowType, FeatureMask, CacheDirectory, Result]() mutable
+	{
+		FString CacheFilePath;
+		bool bSucceeded = false;
+
+		TArray64<float> MonoPCMData;
+		int32 SampleRate;
+
+		if (CopyMonoPCMData(Objects->ImportedSoundWave.Get(), MonoPCMData, SampleRate))
+		{
+			const uint64 CacheKey = UAudioAnalysisCache::ComputeCacheKey(MonoPCMData.GetData(), MonoPCMData.Num(), SampleRate, FrameSize, HopSize, WindowType, FeatureMask);
+			CacheFilePath = UAudioAnalysisCache::GetCacheFilePath(CacheDirectory, CacheKey);
+
+			uint64 ExistingCacheKey;
+			if (UAudioAnalysisCache::ReadCacheKey(CacheFilePath, ExistingCacheKey) && ExistingCacheKey == CacheKey)
+			{
+				UE_LOG(LogAudioAnalysis, Log, TEXT("Reusing the analysis cache '%s'"), *CacheFilePath);
+				bSucceeded = true;
+			}
+			else
+			{
+				FAudioAnalysisFeatureTracks FeatureTracks;
+				bSucceeded = AnalyzeAudioFrames(MonoPCMData.GetData(), MonoPCMData.Num(), SampleRate, FrameSize, HopSize, WindowType, FeatureMask,
+				                                Objects->BeatDetection.Get(), Objects->OnsetDetection.Get(), FeatureTracks)
+					&& UAudioAnalysisCache::WriteCache(FeatureTracks, WindowType, CacheKey, CacheFilePath);
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Objects = MoveTemp(Objects), CacheFilePath = MoveTemp(CacheFilePath), bSucceeded, Result]() mutable
+		{
+			Objects.Reset();
+
+			UAudioAnalysisCache* AnalysisCache = bSucceeded ? UAudioAnalysisCache::LoadCache(CacheFilePath) : nullptr;
+			Result.ExecuteIfBound(AnalysisCache != nullptr, AnalysisCache);
+		});
+	});
+}
+
+bool UAudioAnalysisBatch::AnalyzeAudioFrames(const float* AudioFrames, int64 NumOfFrames, int32 SampleRate, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask,
+                                             UBeatDetection* BeatDetection, UOnsetDetection* OnsetDetection, FAudioAnalysisFeatureTracks& FeatureTracks)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_AnalyzeAudioFrames);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_AnalyzeAudioFrames);
+
+	if (FrameSize <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze audio frames: the frame size is '%lld', expected > '0'"), FrameSize);
+		return false;
+	}
+
+	if (HopSize <= 0 || HopSize > FrameSize)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze audio frames: the hop size is '%lld', expected > '0' and <= '%lld' (the frame size)"), HopSize, FrameSize);
+		return false;
+	}
+
+	if (!AudioFrames || NumOfFrames < FrameSize)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze audio frames: the number of audio frames is '%lld', expected >= '%lld' (the frame size)"), NumOfFrames, FrameSize);
+		return false;
+	}
+
+	const int64 NumOfHops = (NumOfFrames - FrameSize) / HopSize + 1;
+
+	if (NumOfHops > TNumericLimits<int32>::Max())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze audio frames: Array with int32 size (max length: %d) cannot fit the number of hops (%lld)"), TNumericLimits<int32>::Max(), NumOfHops);
+		return false;
+	}
+
+	auto HasFeature = [FeatureMask](EAudioAnalysisFeature Feature)
+	{
+		return (FeatureMask & (1 << static_cast<int32>(Feature))) != 0;
+	};
+
+	const bool bBeats = HasFeature(EAudioAnalysisFeature::Beats);
+	const bool bSubbands = HasFeature(EAudioAnalysisFeature::Subbands);
+	const bool bSpectralDifference = HasFeature(EAudioAnalysisFeature::SpectralDifference);
+	const bool bSpectralDifferenceHWR = HasFeature(EAudioAnalysisFeature::SpectralDifferenceHWR);
+	const bool bComplexSpectralDifference = HasFeature(EAudioAnalysisFeature::ComplexSpectralDifference);
+	const bool bEnergyDifference = HasFeature(EAudioAnalysisFeature::EnergyDifference);
+
+	if (((bBeats || bSubbands) && !BeatDetection) || ((bSpectralDifference || bSpectralDifferenceHWR || bComplexSpectralDifference) && !OnsetDetection))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze audio frames: the onset or beat detection required by the feature mask is invalid"));
+		return false;
+	}
+
+	const bool bTimeDomainFeatures = HasFeature(EAudioAnalysisFeature::RootMeanSquare) || HasFeature(EAudioAnalysisFeature::PeakEnergy) || HasFeature(EAudioAnalysisFeature::ZeroCrossingRate);
+
+	// The spectral features are computed together in a single pass over each magnitude spectrum
+	int32 SpectralFeatureMask = 0;
+	SpectralFeatureMask |= HasFeature(EAudioAnalysisFeature::SpectralCentroid) ? 1 << static_cast<int32>(ESpectralFeature::Centroid) : 0;
+	SpectralFeatureMask |= HasFeature(EAudioAnalysisFeature::SpectralFlatness) ? 1 << static_cast<int32>(ESpectralFeature::Flatness) : 0;
+	SpectralFeatureMask |= HasFeature(EAudioAnalysisFeature::SpectralCrest) ? 1 << static_cast<int32>(ESpectralFeature::Crest) : 0;
+	SpectralFeatureMask |= HasFeature(EAudioAnalysisFeature::SpectralRolloff) ? 1 << static_cast<int32>(ESpectralFeature::Rolloff) : 0;
+	SpectralFeatureMask |= HasFeature(EAudioAnalysisFeature::SpectralKurtosis) ? 1 << static_cast<int32>(ESpectralFeature::Kurtosis) : 0;
+
+	const bool bFrequencyDomainFeatures = SpectralFeatureMask != 0 || HasFeature(EAudioAnalysisFeature::HighFrequencyContent);
+
+	// The stateful passes read the spectra of the chunk after the parallel part
+	const bool bKeepMagnitudeSpectrum = bBeats || bSubbands || bSpectralDifference || bSpectralDifferenceHWR;
+	const bool bSpectrum = bFrequencyDomainFeatures || bKeepMagnitudeSpectrum || bComplexSpectralDifference;
+
+	const int64 MagnitudeSpectrumSize = FrameSize / 2;
+
+	FeatureTracks = FAudioAnalysisFeatureTracks();
+	FeatureTracks.FrameSize = FrameSize;
+	FeatureTracks.HopSize = HopSize;
+	FeatureTracks.SampleRate = SampleRate;
+	FeatureTracks.NumOfHops = NumOfHops;
+	FeatureTracks.FeatureMask = FeatureMask & AllAudioAnalysisFeatures;
+
+	if (bSubbands)
+	{
+		const int64 NumOfSubbands = BeatDetection->GetFFTSubbands().Num();
+
+		if (NumOfHops * NumOfSubbands > TNumericLimits<int32>::Max())
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to analyze audio frames: Array with int32 size (max length: %d) cannot fit the subbands of all the hops (%lld)"), TNumericLimits<int32>::Max(), NumOfHops * NumOfSubbands);
+			return false;
+		}
+
+		FeatureTracks.NumOfSubbands = NumOfSubbands;
+		FeatureTracks.FFTSubbands.SetNumZeroed(static_cast<int32>(NumOfHops * NumOfSubbands));
+	}
+
+	auto InitializeTrack = [&HasFeature, NumOfHops](EAudioAnalysisFeature Feature, auto& Track)
+	{
+		if (HasFeature(Feature))
+		{
+			Track.SetNumZeroed(static_cast<int32>(NumOfHops));
+		}
+	};
+
+	InitializeTrack(EAudioAnalysisFeature::RootMeanSquare, FeatureTracks.RootMeanSquare);
+	InitializeTrack(EAudioAnalysisFeature::PeakEnergy, FeatureTracks.PeakEnergy);
+	InitializeTrack(EAudioAnalysisFeature::ZeroCrossingRate, FeatureTracks.ZeroCrossingRate);
+	InitializeTrack(EAudioAnalysisFeature::SpectralCentroid, FeatureTracks.SpectralCentroid);
+	InitializeTrack(EAudioAnalysisFeature::SpectralFlatness, FeatureTracks.SpectralFlatness);
+	InitializeTrack(EAudioAnalysisFeature::SpectralCrest, FeatureTracks.SpectralCrest);
+	InitializeTrack(EAudioAnalysisFeature::SpectralRolloff, FeatureTracks.SpectralRolloff);
+	InitializeTrack(EAudioAnalysisFeature::SpectralKurtosis, FeatureTracks.SpectralKurtosis);
+	InitializeTrack(EAudioAnalysisFeature::EnergyDifference, FeatureTracks.EnergyDifference);
+	InitializeTrack(EAudioAnalysisFeature::SpectralDifference, FeatureTracks.SpectralDifference);
+	InitializeTrack(EAudioAnalysisFeature::SpectralDifferenceHWR, FeatureTracks.SpectralDifferenceHWR);
+	InitializeTrack(EAudioAnalysisFeature::ComplexSpectralDifference, FeatureTracks.ComplexSpectralDifference);
+	InitializeTrack(EAudioAnalysisFeature::HighFrequencyContent, FeatureTracks.HighFrequencyContent);
+	InitializeTrack(EAudioAnalysisFeature::Beats, FeatureTracks.IsKick);
+	InitializeTrack(EAudioAnalysisFeature::Beats, FeatureTracks.IsSnare);
+	InitializeTrack(EAudioAnalysisFeature::Beats, FeatureTracks.IsHiHat);
+
+	const FWindowPtr WindowFunction = FWindowCache::Get().FindOrCreateWindow(FrameSize, WindowType);
+
+	// Hops are processed in chunks, so that only the spectra of a single chunk are kept for the sequential sweep
+	const int32 NumOfBlocks = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	const int64 HopsPerChunk = NumOfBlocks * HopsPerBlock;
+
+	TArray<FBatchAnalysisBlock> Blocks;
+	Blocks.SetNum(NumOfBlocks);
+
+	for (FBatchAnalysisBlock& Block : Blocks)
+	{
+		if (bSpectrum)
+		{
+			if (!Block.SpectrumAnalyzer.Configure(FrameSize))
+			{
+				return false;
+			}
+
+			Block.FFTReal.SetNumZeroed(FrameSize);
+			Block.FFTImaginary.SetNumZeroed(FrameSize);
+			Block.MagnitudeSpectrum.SetNumZeroed(MagnitudeSpectrumSize);
+		}
+	}
+
+	// The spectra needed by the sequential sweep are written by the FFT directly into the chunk storage
+	TArray64<float> ChunkMagnitudeSpectra, ChunkFFTReal, ChunkFFTImaginary, ChunkEnergies;
+
+	if (bKeepMagnitudeSpectrum)
+	{
+		ChunkMagnitudeSpectra.SetNumUninitialized(HopsPerChunk * MagnitudeSpectrumSize);
+	}
+
+	if (bComplexSpectralDifference)
+	{
+		ChunkFFTReal.SetNumUninitialized(HopsPerChunk * FrameSize);
+		ChunkFFTImaginary.SetNumUninitialized(HopsPerChunk * FrameSize);
+	}
+
+	if (bEnergyDifference)
+	{
+		ChunkEnergies.SetNumUninitialized(HopsPerChunk);
+	}
+
+	float PreviousEnergySum = 0;
+
+	for (int64 ChunkStartHop = 0; ChunkStartHop < NumOfHops; ChunkStartHop += HopsPerChunk)
+	{
+		const int64 NumOfChunkHops = FMath::Min(HopsPerChunk, NumOfHops - ChunkStartHop);
+		const int32 NumOfChunkBlocks = static_cast<int32>(FMath::DivideAndRoundUp(NumOfChunkHops, HopsPerBlock));
+
+		// The FFT and the stateless features of each frame do not depend on the other frames
+		ParallelFor(NumOfChunkBlocks, [&](int32 BlockIndex)
+		{
+			FBatchAnalysisBlock& Block = Blocks[BlockIndex];
+
+			const int64 BlockEndHop = FMath::Min((BlockIndex + 1) * HopsPerBlock, NumOfChunkHops);
+
+			for (int64 ChunkHopIndex = BlockIndex * HopsPerBlock; ChunkHopIndex < BlockEndHop; ++ChunkHopIndex)
+			{
+				const int64 HopIndex = ChunkStartHop + ChunkHopIndex;
+				const int32 TrackIndex = static_cast<int32>(HopIndex);
+				const TArrayView64<const float> HopAudioFrames(AudioFrames + HopIndex * HopSize, FrameSize);
+
+				if (bTimeDomainFeatures || bEnergyDifference)
+				{
+					// A single pass computes all the time domain features, including the energy sum of the energy difference
+					const FTimeDomainFeatureSet TimeDomainFeatures = UCoreTimeDomainFeatures::GetTimeDomainFeatures(HopAudioFrames);
+
+					if (HasFeature(EAudioAnalysisFeature::RootMeanSquare))
+					{
+						FeatureTracks.RootMeanSquare[TrackIndex] = TimeDomainFeatures.RootMeanSquare;
+					}
+					if (HasFeature(EAudioAnalysisFeature::PeakEnergy))
+					{
+						FeatureTracks.PeakEnergy[TrackIndex] = TimeDomainFeatures.PeakEnergy;
+					}
+					if (HasFeature(EAudioAnalysisFeature::ZeroCrossingRate))
+					{
+						FeatureTracks.ZeroCrossingRate[TrackIndex] = TimeDomainFeatures.ZeroCrossingRate;
+					}
+					if (bEnergyDifference)
+					{
+						ChunkEnergies[ChunkHopIndex] = TimeDomainFeatures.SumOfSquares;
+					}
+				}
+
+				if (!bSpectrum)
+				{
+					continue;
+				}
+
+				float* FFTReal = bComplexSpectralDifference ? ChunkFFTReal.GetData() + ChunkHopIndex * FrameSize : Block.FFTReal.GetData();
+				float* FFTImaginary = bComplexSpectralDifference ? ChunkFFTImaginary.GetData() + ChunkHopIndex * FrameSize : Block.FFTImaginary.GetData();
+				float* MagnitudeSpectrumData = bKeepMagnitudeSpectrum ? ChunkMagnitudeSpectra.GetData() + ChunkHopIndex * MagnitudeSpectrumSize : Block.MagnitudeSpectrum.GetData();
+
+				Block.SpectrumAnalyzer.Process(HopAudioFrames.GetData(), WindowFunction->GetData(), FFTReal, FFTImaginary, MagnitudeSpectrumData);
+
+				const TArrayView64<const float> MagnitudeSpectrum(MagnitudeSpectrumData, MagnitudeSpectrumSize);
+
+				if (SpectralFeatureMask != 0)
+				{
+					const FSpectralFeatureSet SpectralFeatures = UCoreFrequencyDomainFeatures::GetSpectralFeatures(MagnitudeSpectrum, SpectralFeatureMask);
+
+					if (SpectralFeatures.HasFeature(ESpectralFeature::Centroid))
+					{
+						FeatureTracks.SpectralCentroid[TrackIndex] = SpectralFeatures.SpectralCentroid;
+					}
+					if (SpectralFeatures.HasFeature(ESpectralFeature::Flatness))
+					{
+						FeatureTracks.SpectralFlatness[TrackIndex] = SpectralFeatures.SpectralFlatness;
+					}
+					if (SpectralFeatures.HasFeature(ESpectralFeature::Crest))
+					{
+						FeatureTracks.SpectralCrest[TrackIndex] = SpectralFeatures.SpectralCrest;
+					}
+					if (SpectralFeatures.HasFeature(ESpectralFeature::Rolloff))
+					{
+						FeatureTracks.SpectralRolloff[TrackIndex] = SpectralFeatures.SpectralRolloff;
+					}
+					if (SpectralFeatures.HasFeature(ESpectralFeature::Kurtosis))
+					{
+						FeatureTracks.SpectralKurtosis[TrackIndex] = SpectralFeatures.SpectralKurtosis;
+					}
+				}
+				if (HasFeature(EAudioAnalysisFeature::HighFrequencyContent))
+				{
+					FeatureTracks.HighFrequencyContent[TrackIndex] = UOnsetDetection::GetHighFrequencyContent(MagnitudeSpectrum);
+				}
+			}
+		});
+
+		// Onset and beat detection depend on the previous frames, so they are processed in order
+		for (int64 ChunkHopIndex = 0; ChunkHopIndex < NumOfChunkHops; ++ChunkHopIndex)
+		{
+			const int32 TrackIndex = static_cast<int32>(ChunkStartHop + ChunkHopIndex);
+
+			if (bEnergyDifference)
+			{
+				// Same as UOnsetDetection::GetEnergyDifference, but from the energy sums computed in parallel
+				const float Difference = ChunkEnergies[ChunkHopIndex] - PreviousEnergySum;
+				PreviousEnergySum = ChunkEnergies[ChunkHopIndex];
+				FeatureTracks.EnergyDifference[TrackIndex] = Difference > 0 ? Difference : 0;
+			}
+
+			if (bKeepMagnitudeSpectrum)
+			{
+				const TArrayView64<const float> MagnitudeSpectrum(ChunkMagnitudeSpectra.GetData() + ChunkHopIndex * MagnitudeSpectrumSize, MagnitudeSpectrumSize);
+
+				if (bSpectralDifference)
+				{
+					FeatureTracks.SpectralDifference[TrackIndex] = OnsetDetection->GetSpectralDifference(MagnitudeSpectrum);
+				}
+				if (bSpectralDifferenceHWR)
+				{
+					FeatureTracks.SpectralDifferenceHWR[TrackIndex] = OnsetDetection->GetSpectralDifferenceHWR(MagnitudeSpectrum);
+				}
+				if (bBeats || bSubbands)
+				{
+					BeatDetection->ProcessMagnitude(MagnitudeSpectrum);
+				}
+				if (bBeats)
+				{
+					FeatureTracks.IsKick[TrackIndex] = BeatDetection->IsKick();
+					FeatureTracks.IsSnare[TrackIndex] = BeatDetection->IsSnare();
+					FeatureTracks.IsHiHat[TrackIndex] = BeatDetection->IsHiHat();
+				}
+				if (bSubbands)
+				{
+					const TArrayView64<const float> Subbands = BeatDetection->GetFFTSubbands();
+					FMemory::Memcpy(FeatureTracks.FFTSubbands.GetData() + TrackIndex * FeatureTracks.NumOfSubbands, Subbands.GetData(), sizeof(float) * Subbands.Num());
+				}
+			}
+
+			if (bComplexSpectralDifference)
+			{
+				const TArrayView64<const float> FFTReal(ChunkFFTReal.GetData() + ChunkHopIndex * FrameSize, FrameSize);
+				const TArrayView64<const float> FFTImaginary(ChunkFFTImaginary.GetData() + ChunkHopIndex * FrameSize, FrameSize);
+
+				FeatureTracks.ComplexSpectralDifference[TrackIndex] = OnsetDetection->GetComplexSpectralDifference(FFTReal, FFTImaginary);
+			}
+		}
+	}
+
+	UE_LOG(LogAudioAnalysis, Log, TEXT("Analyzed '%lld' hops of '%lld' audio frames (frame size: '%lld', hop size: '%lld')"), NumOfHops, NumOfFrames, FrameSize, HopSize);
+
+	return true;
+}
@@ -0,0 +1,605 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisCache.h"
+#include "AudioAnalysisToolsDefines.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/Paths.h"
+#include "Templates/UniquePtr.h"
+
+namespace
+{
+	/** Identifies the cache files */
+	constexpr uint32 CacheMagic = 0x43544141; // "AATC"
+
+	/** Incremented whenever the layout of the cache file or the analysis changes, which invalidates the existing cache files */
+	constexpr uint32 CacheVersion = 1;
+
+	/** The alignment of each section of the cache file */
+	constexpr int64 CacheSectionAlignment = 16;
+
+	/** The number of features stored as float tracks. These are all the features preceding the beats */
+	constexpr int32 NumOfFloatFeatures = static_cast<int32>(EAudioAnalysisFeature::Beats);
+
+	/** The flags stored per hop */
+	constexpr uint8 KickFlag = 1 << 0;
+	constexpr uint8 SnareFlag = 1 << 1;
+	constexpr uint8 HiHatFlag = 1 << 2;
+	constexpr uint8 OnsetFlag = 1 << 3;
+
+	/** The number of hops on each side of a hop averaged to get the onset threshold */
+	constexpr int64 OnsetMeanRadius = 8;
+
+	/** How many times an onset detection function value has to exceed the surrounding mean to be picked as an onset */
+	constexpr float OnsetThresholdScale = 1.5f;
+
+	/** The maximum value of a quantized subband */
+	constexpr float MaxQuantizedSubband = TNumericLimits<uint16>::Max();
+
+	/**
+	 * The header of the cache file. All the values are stored little-endian, like on all the supported platforms
+	 */
+	struct FAudioAnalysisCacheHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint64 CacheKey;
+		int64 FrameSize;
+		int64 HopSize;
+		int64 NumOfHops;
+		int64 NumOfSubbands;
+		int32 SampleRate;
+		int32 FeatureMask;
+		uint32 WindowType;
+		uint32 Reserved;
+
+		/** Offsets of the sections from the start of the file. 0 if the section is absent */
+		int64 FeatureOffsets[NumOfFloatFeatures];
+		int64 SubbandScalesOffset;
+		int64 SubbandsOffset;
+		int64 FlagsOffset;
+
+		/** The size of the whole file */
+		int64 DataSize;
+
+		/** Keeps the section following the header aligned */
+		int64 Padding;
+	};
+
+	static_assert(sizeof(FAudioAnalysisCacheHeader) % CacheSectionAlignment == 0, "The cache header must keep the sections aligned");
+
+	/** Get the float track of the feature, or nullptr if the feature is not stored as a float track */
+	const TArray<float>* GetFloatTrack(const FAudioAnalysisFeatureTracks& FeatureTracks, EAudioAnalysisFeature Feature)
+	{
+		switch (Feature)
+		{
+		case EAudioAnalysisFeature::RootMeanSquare: return &FeatureTracks.RootMeanSquare;
+		case EAudioAnalysisFeature::PeakEnergy: return &FeatureTracks.PeakEnergy;
+		case EAudioAnalysisFeature::ZeroCrossingRate: return &FeatureTracks.ZeroCrossingRate;
+		case EAudioAnalysisFeature::SpectralCentroid: return &FeatureTracks.SpectralCentroid;
+		case EAudioAnalysisFeature::SpectralFlatness: return &FeatureTracks.SpectralFlatness;
+		case EAudioAnalysisFeature::SpectralCrest: return &FeatureTracks.SpectralCrest;
+		case EAudioAnalysisFeature::SpectralRolloff: return &FeatureTracks.SpectralRolloff;
+		case EAudioAnalysisFeature::SpectralKurtosis: return &FeatureTracks.SpectralKurtosis;
+		case EAudioAnalysisFeature::EnergyDifference: return &FeatureTracks.EnergyDifference;
+		case EAudioAnalysisFeature::SpectralDifference: return &FeatureTracks.SpectralDifference;
+		case EAudioAnalysisFeature::SpectralDifferenceHWR: return &FeatureTracks.SpectralDifferenceHWR;
+		case EAudioAnalysisFeature::ComplexSpectralDifference: return &FeatureTracks.ComplexSpectralDifference;
+		case EAudioAnalysisFeature::HighFrequencyContent: return &FeatureTracks.HighFrequencyContent;
+		default: return nullptr;
+		}
+	}
+
+	/**
+	 * Pick onsets as the local maxima of the onset detection function exceeding the mean of the surrounding hops
+	 *
+	 * @param DetectionFunction The onset detection function per hop
+	 * @param Flags The flags per hop to set the onset flag in
+	 */
+	void PickOnsets(const TArray<float>& DetectionFunction, TArray64<uint8>& Flags)
+	{
+		const int64 NumOfHops = DetectionFunction.Num();
+
+		// Prefix sums make the mean of any window a single subtraction
+		TArray64<double> PrefixSums;
+		PrefixSums.SetNumUninitialized(NumOfHops + 1);
+		PrefixSums[0] = 0;
+		for (int64 HopIndex = 0; HopIndex < NumOfHops; ++HopIndex)
+		{
+			PrefixSums[HopIndex + 1] = PrefixSums[HopIndex] + DetectionFunction[HopIndex];
+		}
+
+		for (int64 HopIndex = 1; HopIndex + 1 < NumOfHops; ++HopIndex)
+		{
+			const float Value = DetectionFunction[HopIndex];
+
+			if (Value <= DetectionFunction[HopIndex - 1] || Value < DetectionFunction[HopIndex + 1])
+			{
+				continue;
+			}
+
+			const int64 WindowStart = FMath::Max<int64>(HopIndex - OnsetMeanRadius, 0);
+			const int64 WindowEnd = FMath::Min<int64>(HopIndex + OnsetMeanRadius + 1, NumOfHops);
+			const double Mean = (PrefixSums[WindowEnd] - PrefixSums[WindowStart]) / (WindowEnd - WindowStart);
+
+			if (Value > Mean * OnsetThresholdScale)
+			{
+				Flags[HopIndex] |= OnsetFlag;
+			}
+		}
+	}
+
+	/**
+	 * Open the file for mapping
+	 *
+	 * @return The mapped file handle, or nullptr if the platform does not support mapping the file
+	 */
+	TUniquePtr<IMappedFileHandle> OpenMappedFile(const FString& FilePath)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+#if UE_VERSION_OLDER_THAN(5, 3, 0)
+		return TUniquePtr<IMappedFileHandle>(PlatformFile.OpenMapped(*FilePath));
+#else
+		FOpenMappedResult Result = PlatformFile.OpenMappedEx(*FilePath);
+		return Result.HasValue() ? Result.StealValue() : TUniquePtr<IMappedFileHandle>();
+#endif
+	}
+}
+
+UAudioAnalysisCache::UAudioAnalysisCache()
+	: Data(nullptr),
+	  DataSize(0),
+	  SubbandScalesOffset(0),
+	  SubbandsOffset(0),
+	  FlagsOffset(0),
+	  CacheKey(0),
+	  FrameSize(0),
+	  HopSize(0),
+	  SampleRate(0),
+	  NumOfHops(0),
+	  NumOfSubbands(0),
+	  FeatureMask(0),
+	  WindowType(EAnalysisWindowType::HanningWindow)
+{
+}
+
+void UAudioAnalysisCache::BeginDestroy()
+{
+	Data = nullptr;
+	DataSize = 0;
+
+	// The region has to be unmapped before the file is closed
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	FileData.Empty();
+
+	Super::BeginDestroy();
+}
+
+uint64 UAudioAnalysisCache::ComputeCacheKey(const float* AudioFrames, int64 NumOfFrames, int32 SampleRate, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask)
+{
+	// CityHash takes 32-bit lengths, so the PCM data is hashed in chained chunks
+	constexpr int64 MaxChunkSize = 1 << 30;
+
+	const char* Bytes = reinterpret_cast<const char*>(AudioFrames);
+	int64 NumOfBytes = NumOfFrames * static_cast<int64>(sizeof(float));
+
+	uint64 Hash = CacheVersion;
+	do
+	{
+		const int64 ChunkSize = FMath::Min(NumOfBytes, MaxChunkSize);
+		Hash = CityHash64WithSeed(Bytes, static_cast<uint32>(ChunkSize), Hash);
+		Bytes += ChunkSize;
+		NumOfBytes -= ChunkSize;
+	}
+	while (NumOfBytes > 0);
+
+	const int64 Settings[] = {NumOfFrames, SampleRate, FrameSize, HopSize, static_cast<int64>(WindowType), FeatureMask & AllAudioAnalysisFeatures};
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Settings), sizeof(Settings), Hash);
+}
+
+FString UAudioAnalysisCache::GetCacheFilePath(const FString& CacheDirectory, uint64 CacheKey)
+{
+	const FString Directory = CacheDirectory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AudioAnalysisCache")) : CacheDirectory;
+	return FPaths::Combine(Directory, FString::Printf(TEXT("%016llx.aacache"), CacheKey));
+}
+
+bool UAudioAnalysisCache::WriteCache(const FAudioAnalysisFeatureTracks& FeatureTracks, EAnalysisWindowType WindowType, uint64 CacheKey, const FString& FilePath)
+{
+	const int64 NumOfHops = FeatureTracks.NumOfHops;
+
+	if (NumOfHops <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to write the analysis cache: the number of hops is '%lld', expected > '0'"), NumOfHops);
+		return false;
+	}
+
+	const bool bSubbands = FeatureTracks.HasFeature(EAudioAnalysisFeature::Subbands) && FeatureTracks.NumOfSubbands > 0 && FeatureTracks.FFTSubbands.Num() == NumOfHops * FeatureTracks.NumOfSubbands;
+	const int64 NumOfSubbands = bSubbands ? FeatureTracks.NumOfSubbands : 0;
+
+	FAudioAnalysisCacheHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = CacheMagic;
+	Header.Version = CacheVersion;
+	Header.CacheKey = CacheKey;
+	Header.FrameSize = FeatureTracks.FrameSize;
+	Header.HopSize = FeatureTracks.HopSize;
+	Header.NumOfHops = NumOfHops;
+	Header.NumOfSubbands = NumOfSubbands;
+	Header.SampleRate = FeatureTracks.SampleRate;
+	Header.FeatureMask = FeatureTracks.FeatureMask;
+	Header.WindowType = static_cast<uint32>(WindowType);
+
+	// Lay out the sections one after another, each aligned
+	int64 Offset = sizeof(FAudioAnalysisCacheHeader);
+	auto AllocateSection = [&Offset](int64 SectionSize)
+	{
+		const int64 SectionOffset = Offset;
+		Offset = Align(Offset + SectionSize, CacheSectionAlignment);
+		return SectionOffset;
+	};
+
+	for (int32 FeatureIndex = 0; FeatureIndex < NumOfFloatFeatures; ++FeatureIndex)
+	{
+		const EAudioAnalysisFeature Feature = static_cast<EAudioAnalysisFeature>(FeatureIndex);
+		if (FeatureTracks.HasFeature(Feature) && GetFloatTrack(FeatureTracks, Feature)->Num() == NumOfHops)
+		{
+			Header.FeatureOffsets[FeatureIndex] = AllocateSection(NumOfHops * sizeof(float));
+		}
+	}
+
+	if (bSubbands)
+	{
+		Header.SubbandScalesOffset = AllocateSection(NumOfSubbands * sizeof(float));
+		Header.SubbandsOffset = AllocateSection(NumOfHops * NumOfSubbands * sizeof(uint16));
+	}
+
+	Header.FlagsOffset = AllocateSection(NumOfHops * sizeof(uint8));
+	Header.DataSize = Offset;
+
+	TArray64<uint8> CacheData;
+	CacheData.SetNumZeroed(Header.DataSize);
+	FMemory::Memcpy(CacheData.GetData(), &Header, sizeof(Header));
+
+	for (int32 FeatureIndex = 0; FeatureIndex < NumOfFloatFeatures; ++FeatureIndex)
+	{
+		if (Header.FeatureOffsets[FeatureIndex] != 0)
+		{
+			const TArray<float>& Track = *GetFloatTrack(FeatureTracks, static_cast<EAudioAnalysisFeature>(FeatureIndex));
+			FMemory::Memcpy(CacheData.GetData() + Header.FeatureOffsets[FeatureIndex], Track.GetData(), NumOfHops * sizeof(float));
+		}
+	}
+
+	if (bSubbands)
+	{
+		float* SubbandScales = reinterpret_cast<float*>(CacheData.GetData() + Header.SubbandScalesOffset);
+		uint16* QuantizedSubbands = reinterpret_cast<uint16*>(CacheData.GetData() + Header.SubbandsOffset);
+		const float* Subbands = FeatureTracks.FFTSubbands.GetData();
+
+		// Each subband is quantized relative to its own maximum, so quiet high subbands keep their resolution next to loud low ones
+		for (int64 SubbandIndex = 0; SubbandIndex < NumOfSubbands; ++SubbandIndex)
+		{
+			float MaxSubband = 0;
+			for (int64 HopIndex = 0; HopIndex < NumOfHops; ++HopIndex)
+			{
+				MaxSubband = FMath::Max(MaxSubband, Subbands[HopIndex * NumOfSubbands + SubbandIndex]);
+			}
+
+			const float Scale = MaxSubband > 0 ? MaxSubband / MaxQuantizedSubband : 0;
+			const float InvScale = Scale > 0 ? 1.f / Scale : 0;
+			SubbandScales[SubbandIndex] = Scale;
+
+			for (int64 HopIndex = 0; HopIndex < NumOfHops; ++HopIndex)
+			{
+				const float Subband = FMath::Max(Subbands[HopIndex * NumOfSubbands + SubbandIndex], 0.f);
+				QuantizedSubbands[HopIndex * NumOfSubbands + SubbandIndex] = static_cast<uint16>(FMath::Min(FMath::RoundToFloat(Subband * InvScale), MaxQuantizedSubband));
+			}
+		}
+	}
+
+	{
+		TArray64<uint8> Flags;
+		Flags.SetNumZeroed(NumOfHops);
+
+		if (FeatureTracks.HasFeature(EAudioAnalysisFeature::Beats) && FeatureTracks.IsKick.Num() == NumOfHops && FeatureTracks.IsSnare.Num() == NumOfHops && FeatureTracks.IsHiHat.Num() == NumOfHops)
+		{
+			for (int64 HopIndex = 0; HopIndex < NumOfHops; ++HopIndex)
+			{
+				const int32 TrackIndex = static_cast<int32>(HopIndex);
+				Flags[HopIndex] |= (FeatureTracks.IsKick[TrackIndex] ? KickFlag : 0) | (FeatureTracks.IsSnare[TrackIndex] ? SnareFlag : 0) | (FeatureTracks.IsHiHat[TrackIndex] ? HiHatFlag : 0);
+			}
+		}
+
+		// The most selective detection function available is used for picking the onsets
+		for (const EAudioAnalysisFeature DetectionFunction : {EAudioAnalysisFeature::ComplexSpectralDifference, EAudioAnalysisFeature::SpectralDifferenceHWR, EAudioAnalysisFeature::SpectralDifference, EAudioAnalysisFeature::HighFrequencyContent, EAudioAnalysisFeature::EnergyDifference})
+		{
+			if (Header.FeatureOffsets[static_cast<int32>(DetectionFunction)] != 0)
+			{
+				PickOnsets(*GetFloatTrack(FeatureTracks, DetectionFunction), Flags);
+				break;
+			}
+		}
+
+		FMemory::Memcpy(CacheData.GetData() + Header.FlagsOffset, Flags.GetData(), NumOfHops);
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath)))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to write the analysis cache: failed to create the directory of '%s'"), *FilePath);
+		return false;
+	}
+
+	// The cache is written next to the destination and moved over it afterwards, so a partially written file is never mapped
+	const FString TemporaryFilePath = FilePath + TEXT(".tmp");
+	{
+		TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*TemporaryFilePath));
+		if (!FileHandle.IsValid() || !FileHandle->Write(CacheData.GetData(), CacheData.Num()))
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to write the analysis cache: failed to write '%s'"), *TemporaryFilePath);
+			FileHandle.Reset();
+			PlatformFile.DeleteFile(*TemporaryFilePath);
+			return false;
+		}
+	}
+
+	PlatformFile.DeleteFile(*FilePath);
+	if (!PlatformFile.MoveFile(*FilePath, *TemporaryFilePath))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to write the analysis cache: failed to move '%s' to '%s'"), *TemporaryFilePath, *FilePath);
+		PlatformFile.DeleteFile(*TemporaryFilePath);
+		return false;
+	}
+
+	UE_LOG(LogAudioAnalysis, Log, TEXT("Wrote the analysis cache '%s' of '%lld' hops ('%lld' bytes)"), *FilePath, NumOfHops, Header.DataSize);
+
+	return true;
+}
+
+bool UAudioAnalysisCache::ReadCacheKey(const FString& FilePath, uint64& CacheKey)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(*FilePath));
+	if (!FileHandle.IsValid())
+	{
+		return false;
+	}
+
+	FAudioAnalysisCacheHeader Header;
+	if (!FileHandle->Read(reinterpret_cast<uint8*>(&Header), sizeof(Header)))
+	{
+		return false;
+	}
+
+	if (Header.Magic != CacheMagic || Header.Version != CacheVersion || Header.DataSize != FileHandle->Size())
+	{
+		return false;
+	}
+
+	CacheKey = Header.CacheKey;
+	return true;
+}
+
+UAudioAnalysisCache* UAudioAnalysisCache::LoadCache(const FString& FilePath)
+{
+	UAudioAnalysisCache* AnalysisCache = NewObject<UAudioAnalysisCache>();
+
+	AnalysisCache->MappedFile = OpenMappedFile(FilePath);
+
+	if (AnalysisCache->MappedFile.IsValid())
+	{
+		AnalysisCache->MappedRegion.Reset(AnalysisCache->MappedFile->MapRegion(0, AnalysisCache->MappedFile->GetFileSize()));
+	}
+
+	if (AnalysisCache->MappedRegion.IsValid())
+	{
+		if (!AnalysisCache->InitializeFromData(AnalysisCache->MappedRegion->GetMappedPtr(), AnalysisCache->MappedRegion->GetMappedSize()))
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to load the analysis cache: '%s' is not a valid analysis cache"), *FilePath);
+			return nullptr;
+		}
+		return AnalysisCache;
+	}
+
+	// Some platform files (e.g. pak files) do not support mapping, so the file is read into memory instead
+	AnalysisCache->MappedRegion.Reset();
+	AnalysisCache->MappedFile.Reset();
+
+	TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to load the analysis cache: failed to open '%s'"), *FilePath);
+		return nullptr;
+	}
+
+	AnalysisCache->FileData.SetNumUninitialized(FileHandle->Size());
+	if (!FileHandle->Read(AnalysisCache->FileData.GetData(), AnalysisCache->FileData.Num()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to load the analysis cache: failed to read '%s'"), *FilePath);
+		return nullptr;
+	}
+
+	if (!AnalysisCache->InitializeFromData(AnalysisCache->FileData.GetData(), AnalysisCache->FileData.Num()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to load the analysis cache: '%s' is not a valid analysis cache"), *FilePath);
+		return nullptr;
+	}
+
+	return AnalysisCache;
+}
+
+bool UAudioAnalysisCache::InitializeFromData(const uint8* InData, int64 InDataSize)
+{
+	if (!InData || InDataSize < static_cast<int64>(sizeof(FAudioAnalysisCacheHeader)))
+	{
+		return false;
+	}
+
+	FAudioAnalysisCacheHeader Header;
+	FMemory::Memcpy(&Header, InData, sizeof(Header));
+
+	if (Header.Magic != CacheMagic || Header.Version != CacheVersion || Header.DataSize != InDataSize)
+	{
+		return false;
+	}
+
+	// Bounding the counts by the data size first keeps the section size computations below from overflowing
+	if (Header.FrameSize <= 0 || Header.HopSize <= 0 || Header.SampleRate <= 0 || Header.NumOfHops <= 0 || Header.NumOfHops > InDataSize
+		|| Header.NumOfSubbands < 0 || Header.NumOfSubbands > InDataSize || Header.WindowType > static_cast<uint32>(EAnalysisWindowType::TukeyWindow))
+	{
+		return false;
+	}
+
+	auto IsValidSection = [&Header, InDataSize](int64 SectionOffset, int64 SectionSize)
+	{
+		return SectionOffset >= static_cast<int64>(sizeof(FAudioAnalysisCacheHeader)) && SectionOffset % CacheSectionAlignment == 0 && SectionSize <= InDataSize - SectionOffset;
+	};
+
+	FeatureOffsets.SetNumZeroed(NumOfFloatFeatures);
+
+	for (int32 FeatureIndex = 0; FeatureIndex < NumOfFloatFeatures; ++FeatureIndex)
+	{
+		const int64 FeatureOffset = Header.FeatureOffsets[FeatureIndex];
+		if (FeatureOffset != 0)
+		{
+			if (!IsValidSection(FeatureOffset, Header.NumOfHops * static_cast<int64>(sizeof(float))))
+			{
+				return false;
+			}
+			FeatureOffsets[FeatureIndex] = FeatureOffset;
+		}
+	}
+
+	if (Header.NumOfSubbands > 0)
+	{
+		if (!IsValidSection(Header.SubbandScalesOffset, Header.NumOfSubbands * static_cast<int64>(sizeof(float)))
+			|| Header.NumOfHops > InDataSize / Header.NumOfSubbands
+			|| !IsValidSection(Header.SubbandsOffset, Header.NumOfHops * Header.NumOfSubbands * static_cast<int64>(sizeof(uint16))))
+		{
+			return false;
+		}
+	}
+
+	if (!IsValidSection(Header.FlagsOffset, Header.NumOfHops))
+	{
+		return false;
+	}
+
+	Data = InData;
+	DataSize = InDataSize;
+	SubbandScalesOffset = Header.SubbandScalesOffset;
+	SubbandsOffset = Header.SubbandsOffset;
+	FlagsOffset = Header.FlagsOffset;
+	CacheKey = Header.CacheKey;
+	FrameSize = Header.FrameSize;
+	HopSize = Header.HopSize;
+	SampleRate = Header.SampleRate;
+	NumOfHops = Header.NumOfHops;
+	NumOfSubbands = Header.NumOfSubbands;
+	FeatureMask = Header.FeatureMask;
+	WindowType = static_cast<EAnalysisWindowType>(Header.WindowType);
+
+	return true;
+}
+
+int64 UAudioAnalysisCache::GetHopIndexByTime(float Time) const
+{
+	if (!Data || Time < 0)
+	{
+		return -1;
+	}
+
+	const int64 HopIndex = static_cast<int64>(FMath::FloorToDouble(static_cast<double>(Time) * SampleRate / HopSize));
+	return HopIndex < NumOfHops ? HopIndex : -1;
+}
+
+float UAudioAnalysisCache::GetFeatureByTime(EAudioAnalysisFeature Feature, float Time) const
+{
+	const TArrayView64<const float> FeatureTrack = GetFeatureTrack(Feature);
+	const int64 HopIndex = GetHopIndexByTime(Time);
+
+	return FeatureTrack.Num() > 0 && HopIndex >= 0 ? FeatureTrack[HopIndex] : 0;
+}
+
+TArrayView64<const float> UAudioAnalysisCache::GetFeatureTrack(EAudioAnalysisFeature Feature) const
+{
+	const int32 FeatureIndex = static_cast<int32>(Feature);
+
+	if (!Data || FeatureIndex >= NumOfFloatFeatures || FeatureOffsets[FeatureIndex] == 0)
+	{
+		return TArrayView64<const float>();
+	}
+
+	return TArrayView64<const float>(reinterpret_cast<const float*>(Data + FeatureOffsets[FeatureIndex]), NumOfHops);
+}
+
+bool UAudioAnalysisCache::HasFlagByTime(uint8 Flag, float Time) const
+{
+	const int64 HopIndex = GetHopIndexByTime(Time);
+	return HopIndex >= 0 && (Data[FlagsOffset + HopIndex] & Flag) != 0;
+}
+
+bool UAudioAnalysisCache::IsKickByTime(float Time) const
+{
+	return HasFlagByTime(KickFlag, Time);
+}
+
+bool UAudioAnalysisCache::IsSnareByTime(float Time) const
+{
+	return HasFlagByTime(SnareFlag, Time);
+}
+
+bool UAudioAnalysisCache::IsHiHatByTime(float Time) const
+{
+	return HasFlagByTime(HiHatFlag, Time);
+}
+
+bool UAudioAnalysisCache::IsOnsetByTime(float Time) const
+{
+	return HasFlagByTime(OnsetFlag, Time);
+}
+
+float UAudioAnalysisCache::GetSubbandByTime(int64 Subband, float Time) const
+{
+	if (!(Subband >= 0 && Subband < NumOfSubbands))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the subband: the subband is '%lld', expected >= '0' and < '%lld'"), Subband, NumOfSubbands);
+		return 0;
+	}
+
+	const int64 HopIndex = GetHopIndexByTime(Time);
+	if (HopIndex < 0)
+	{
+		return 0;
+	}
+
+	const float* SubbandScales = reinterpret_cast<const float*>(Data + SubbandScalesOffset);
+	const uint16* QuantizedSubbands = reinterpret_cast<const uint16*>(Data + SubbandsOffset);
+
+	return QuantizedSubbands[HopIndex * NumOfSubbands + Subband] * SubbandScales[Subband];
+}
+
+bool UAudioAnalysisCache::GetSubbandsByTime(float Time, TArray<float>& Subbands) const
+{
+	const int64 HopIndex = GetHopIndexByTime(Time);
+	if (NumOfSubbands <= 0 || HopIndex < 0)
+	{
+		return false;
+	}
+
+	const float* SubbandScales = reinterpret_cast<const float*>(Data + SubbandScalesOffset);
+	const uint16* QuantizedSubbands = reinterpret_cast<const uint16*>(Data + SubbandsOffset) + HopIndex * NumOfSubbands;
+
+	Subbands.SetNumUninitialized(static_cast<int32>(NumOfSubbands));
+	for (int64 SubbandIndex = 0; SubbandIndex < NumOfSubbands; ++SubbandIndex)
+	{
+		Subbands[SubbandIndex] = QuantizedSubbands[SubbandIndex] * SubbandScales[SubbandIndex];
+	}
+
+	return true;
+}
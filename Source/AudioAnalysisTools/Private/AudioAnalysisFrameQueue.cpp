@@ -0,0 +1,184 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisFrameQueue.h"
+#include "AudioAnalysisToolsDefines.h"
+
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+FAudioFrameRequest::FAudioFrameRequest()
+	: NumChannels(0),
+	  bProcessToBeatDetection(true),
+	  QueuedCycles(0)
+{
+}
+
+void FAudioFrameRequest::Complete(int64 FrameIndex)
+{
+	if (Promise.IsValid())
+	{
+		Promise->SetValue(FrameIndex);
+		Promise.Reset();
+	}
+}
+
+FAudioFrameQueue::FAudioFrameQueue(int32 Capacity)
+	: Head(0),
+	  Count(0),
+	  NumDropped(0)
+{
+	Reset(Capacity);
+}
+
+void FAudioFrameQueue::Reset(int32 Capacity)
+{
+	TArray<FAudioFrameRequest> DroppedSlots;
+
+	{
+		FScopeLock Lock(&QueueGuard);
+
+		DroppedSlots = MoveTemp(Slots);
+		NumDropped += Count;
+
+		Slots.SetNum(FMath::Max(Capacity, 0));
+		Head = 0;
+		Count = 0;
+	}
+
+	// The promises are fulfilled outside of the lock, since their continuations may push again
+	for (FAudioFrameRequest& DroppedRequest : DroppedSlots)
+	{
+		DroppedRequest.Complete(-1);
+	}
+}
+
+bool FAudioFrameQueue::Push(FAudioFrameRequest&& Request)
+{
+	FAudioFrameRequest DroppedRequest;
+	bool bDropped = false;
+
+	{
+		FScopeLock Lock(&QueueGuard);
+
+		const int32 Capacity = Slots.Num();
+		if (Capacity == 0)
+		{
+			DroppedRequest = MoveTemp(Request);
+			bDropped = true;
+		}
+		else
+		{
+			// The oldest request is the least relevant one for real-time analysis, so it makes room for the newest one
+			if (Count == Capacity)
+			{
+				DroppedRequest = MoveTemp(Slots[Head]);
+				Head = (Head + 1) % Capacity;
+				--Count;
+				bDropped = true;
+			}
+
+			Slots[(Head + Count) % Capacity] = MoveTemp(Request);
+			++Count;
+		}
+
+		if (bDropped)
+		{
+			++NumDropped;
+		}
+	}
+
+	if (bDropped)
+	{
+		UE_LOG(LogAudioAnalysis, Verbose, TEXT("The audio frame queue is full: dropped the oldest request of '%d' audio frames"), DroppedRequest.AudioFrames.Num());
+		DroppedRequest.Complete(-1);
+	}
+
+	return bDropped;
+}
+
+bool FAudioFrameQueue::Pop(FAudioFrameRequest& OutRequest)
+{
+	FScopeLock Lock(&QueueGuard);
+
+	if (Count == 0)
+	{
+		return false;
+	}
+
+	OutRequest = MoveTemp(Slots[Head]);
+	Head = (Head + 1) % Slots.Num();
+	--Count;
+
+	return true;
+}
+
+int32 FAudioFrameQueue::Num() const
+{
+	FScopeLock Lock(&QueueGuard);
+	return Count;
+}
+
+int32 FAudioFrameQueue::GetCapacity() const
+{
+	FScopeLock Lock(&QueueGuard);
+	return Slots.Num();
+}
+
+int64 FAudioFrameQueue::GetNumDropped() const
+{
+	FScopeLock Lock(&QueueGuard);
+	return NumDropped;
+}
+
+FAudioAnalysisThread::FAudioAnalysisThread(const TCHAR* ThreadName, TFunction<void()> InWorkFunction)
+	: WorkFunction(MoveTemp(InWorkFunction)),
+	  WakeUpEvent(FPlatformProcess::GetSynchEventFromPool(false)),
+	  bStopRequested(false),
+	  Thread(nullptr)
+{
+	Thread = FRunnableThread::Create(this, ThreadName, 0, TPri_AboveNormal);
+}
+
+FAudioAnalysisThread::~FAudioAnalysisThread()
+{
+	if (Thread)
+	{
+		// Calls Stop and waits for Run to return
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+	WakeUpEvent = nullptr;
+}
+
+void FAudioAnalysisThread::WakeUp()
+{
+	WakeUpEvent->Trigger();
+}
+
+uint32 FAudioAnalysisThread::Run()
+{
+	while (true)
+	{
+		WakeUpEvent->Wait();
+
+		if (bStopRequested)
+		{
+			break;
+		}
+
+		WorkFunction();
+	}
+
+	return 0;
+}
+
+void FAudioAnalysisThread::Stop()
+{
+	bStopRequested = true;
+	WakeUpEvent->Trigger();
+}
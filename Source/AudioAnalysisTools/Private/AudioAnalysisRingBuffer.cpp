@@ -0,0 +1,91 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisRingBuffer.h"
+
+FAudioAnalysisRingBuffer::FAudioAnalysisRingBuffer()
+	: IndexMask(0),
+	  WriteIndex(0),
+	  ReadIndex(0)
+{
+}
+
+void FAudioAnalysisRingBuffer::Reset(int64 Capacity)
+{
+	const int64 PowerOfTwoCapacity = Capacity > 0 ? static_cast<int64>(FMath::RoundUpToPowerOfTwo64(static_cast<uint64>(Capacity))) : 0;
+
+	Buffer.SetNumZeroed(PowerOfTwoCapacity);
+	IndexMask = PowerOfTwoCapacity - 1;
+
+	WriteIndex.store(0);
+	ReadIndex.store(0);
+}
+
+int64 FAudioAnalysisRingBuffer::Push(const float* Samples, int64 NumSamples)
+{
+	const int64 CurrentWriteIndex = WriteIndex.load(std::memory_order_relaxed);
+	const int64 CurrentReadIndex = ReadIndex.load(std::memory_order_acquire);
+
+	const int64 NumFree = Buffer.Num() - (CurrentWriteIndex - CurrentReadIndex);
+	const int64 NumToPush = FMath::Min(NumSamples, NumFree);
+
+	if (NumToPush <= 0)
+	{
+		return 0;
+	}
+
+	// The samples may wrap around the end of the buffer, so they are copied in up to two parts
+	const int64 StartIndex = CurrentWriteIndex & IndexMask;
+	const int64 NumFirstPart = FMath::Min(NumToPush, Buffer.Num() - StartIndex);
+
+	FMemory::Memcpy(Buffer.GetData() + StartIndex, Samples, sizeof(float) * NumFirstPart);
+	FMemory::Memcpy(Buffer.GetData(), Samples + NumFirstPart, sizeof(float) * (NumToPush - NumFirstPart));
+
+	// Publish the samples to the consumer only after they have been written
+	WriteIndex.store(CurrentWriteIndex + NumToPush, std::memory_order_release);
+
+	return NumToPush;
+}
+
+int64 FAudioAnalysisRingBuffer::Peek(float* OutSamples, int64 NumSamples) const
+{
+	const int64 CurrentReadIndex = ReadIndex.load(std::memory_order_relaxed);
+	const int64 CurrentWriteIndex = WriteIndex.load(std::memory_order_acquire);
+
+	const int64 NumToCopy = FMath::Min(NumSamples, CurrentWriteIndex - CurrentReadIndex);
+
+	if (NumToCopy <= 0)
+	{
+		return 0;
+	}
+
+	const int64 StartIndex = CurrentReadIndex & IndexMask;
+	const int64 NumFirstPart = FMath::Min(NumToCopy, Buffer.Num() - StartIndex);
+
+	FMemory::Memcpy(OutSamples, Buffer.GetData() + StartIndex, sizeof(float) * NumFirstPart);
+	FMemory::Memcpy(OutSamples + NumFirstPart, Buffer.GetData(), sizeof(float) * (NumToCopy - NumFirstPart));
+
+	return NumToCopy;
+}
+
+int64 FAudioAnalysisRingBuffer::Discard(int64 NumSamples)
+{
+	const int64 CurrentReadIndex = ReadIndex.load(std::memory_order_relaxed);
+	const int64 CurrentWriteIndex = WriteIndex.load(std::memory_order_acquire);
+
+	const int64 NumToDiscard = FMath::Min(NumSamples, CurrentWriteIndex - CurrentReadIndex);
+
+	if (NumToDiscard <= 0)
+	{
+		return 0;
+	}
+
+	// Hand the space back to the producer only after the samples have been read
+	ReadIndex.store(CurrentReadIndex + NumToDiscard, std::memory_order_release);
+
+	return NumToDiscard;
+}
+
+int64 FAudioAnalysisRingBuffer::GetNumAvailable() const
+{
+	return WriteIndex.load(std::memory_order_acquire) - ReadIndex.load(std::memory_order_acquire);
+}
@@ -0,0 +1,43 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisSnapshot.h"
+
+FAudioAnalysisSnapshot::FAudioAnalysisSnapshot()
+	: SequenceNumber(-1),
+	  bIsKick(false),
+	  bIsSnare(false),
+	  bIsHiHat(false),
+	  bTimeDomainFeaturesComputed(false)
+{
+}
+
+FAudioAnalysisSnapshotBuffer::FAudioAnalysisSnapshotBuffer()
+	: WriteIndex(0),
+	  ReadIndex(2),
+	  PublishedState(1),
+	  PublishedSequenceNumber(-1)
+{
+}
+
+void FAudioAnalysisSnapshotBuffer::Publish()
+{
+	const int64 SequenceNumber = Snapshots[WriteIndex].SequenceNumber;
+
+	// Release the filled snapshot to the reader and take over the previously published one, which the reader has either skipped or not acquired
+	const int32 PreviousState = PublishedState.exchange(WriteIndex | FreshSnapshotFlag, std::memory_order_acq_rel);
+	WriteIndex = PreviousState & SnapshotIndexMask;
+
+	PublishedSequenceNumber.store(SequenceNumber, std::memory_order_release);
+}
+
+FAudioAnalysisSnapshot& FAudioAnalysisSnapshotBuffer::GetReadSnapshot()
+{
+	// Keep the current snapshot unless a newer one has been published since the last call
+	if (PublishedState.load(std::memory_order_relaxed) & FreshSnapshotFlag)
+	{
+		const int32 PreviousState = PublishedState.exchange(ReadIndex, std::memory_order_acq_rel);
+		ReadIndex = PreviousState & SnapshotIndexMask;
+	}
+
+	return Snapshots[ReadIndex];
+}
@@ -0,0 +1,311 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisSubmixCapture.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "AudioAnalysisToolsLibrary.h"
+#include "AudioChannelsLibrary.h"
+
+#include "AudioDevice.h"
+#include "AudioDeviceManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Sound/AudioSettings.h"
+#include "Sound/SoundSubmix.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/ScopeLock.h"
+
+#include <atomic>
+
+namespace
+{
+	/** The number of audio frames the downmix buffer holds if the audio device does not report its callback size */
+	constexpr int64 DefaultDownmixBufferSize = 1024;
+}
+
+/**
+ * Submix buffer listener pushing the rendered audio into the streaming buffer of an analyzer on the audio render thread
+ */
+class FAudioAnalysisSubmixListener : public ISubmixBufferListener
+{
+public:
+	FAudioAnalysisSubmixListener();
+
+	//~ Begin ISubmixBufferListener Interface
+	virtual void OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock) override;
+#if !UE_VERSION_OLDER_THAN(5, 4, 0)
+	virtual const FString& GetListenerName() const override;
+#endif
+	//~ End ISubmixBufferListener Interface
+
+	/**
+	 * Set the analyzer to push the rendered audio to
+	 *
+	 * @param InAnalyzer The analyzer, or nullptr to stop pushing. Once this returns, the previous analyzer is no longer accessed and is detached as the streaming producer
+	 * @param DownmixBufferSize The number of audio frames of the downmix buffer, usually the callback size of the audio device. Larger rendered buffers are downmixed in parts
+	 * @return Whether the analyzer has been attached as the streaming producer or not. Always true for nullptr
+	 */
+	bool SetAnalyzer(UAudioAnalysisToolsLibrary* InAnalyzer, int64 DownmixBufferSize = 0);
+
+	/** The audio clock of the first captured audio frame, in seconds. Negative until the first buffer is captured */
+	std::atomic<double> StartAudioClock;
+
+	/** The sample rate of the captured audio. 0 until the first buffer is captured */
+	std::atomic<int32> CapturedSampleRate;
+
+	/** The number of audio frames pushed to the analyzer since it was set, excluding the dropped ones */
+	std::atomic<int64> NumOfCapturedFrames;
+
+	/** The number of rendered audio frames the full streaming buffer dropped since the analyzer was set */
+	std::atomic<int64> NumOfDroppedFrames;
+
+	/** The number of audio frames already pushed to the streaming buffer of the analyzer when it was set, which the capture does not cover */
+	std::atomic<int64> StartStreamedFrame;
+
+private:
+	/** The analyzer to push the rendered audio to */
+	UAudioAnalysisToolsLibrary* Analyzer;
+
+	/** Guards the analyzer against being cleared while the rendered audio is pushed. Only contended when the capture stops */
+	FCriticalSection AnalyzerGuard;
+
+	/** Mono downmix of the rendered audio. Allocated when the analyzer is set, so the render thread never allocates */
+	TArray64<float> DownmixedAudioFrames;
+};
+
+FAudioAnalysisSubmixListener::FAudioAnalysisSubmixListener()
+	: StartAudioClock(-1),
+	  CapturedSampleRate(0),
+	  NumOfCapturedFrames(0),
+	  NumOfDroppedFrames(0),
+	  StartStreamedFrame(0),
+	  Analyzer(nullptr)
+{
+}
+
+void FAudioAnalysisSubmixListener::OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_SubmixCapture);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_SubmixCapture);
+
+	FScopeLock Lock(&AnalyzerGuard);
+
+	if (!Analyzer || !Analyzer->IsStreaming() || NumChannels <= 0)
+	{
+		return;
+	}
+
+	const int64 NumOfFrames = NumSamples / NumChannels;
+
+	if (StartAudioClock.load(std::memory_order_relaxed) < 0)
+	{
+		CapturedSampleRate.store(SampleRate, std::memory_order_relaxed);
+		StartAudioClock.store(AudioClock, std::memory_order_release);
+	}
+
+	// Multichannel audio is downmixed in parts of the preallocated buffer, so a buffer larger than the callback size does not allocate either
+	const int64 MaxNumOfPartFrames = NumChannels > 1 ? DownmixedAudioFrames.Num() : NumOfFrames;
+
+	for (int64 StartFrame = 0; StartFrame < NumOfFrames; StartFrame += MaxNumOfPartFrames)
+	{
+		const int64 NumOfPartFrames = FMath::Min<int64>(NumOfFrames - StartFrame, MaxNumOfPartFrames);
+		const float* MonoAudioFrames = AudioData + StartFrame;
+
+		if (NumChannels > 1)
+		{
+			UAudioChannelsLibrary::DownmixToMono(AudioData + StartFrame * NumChannels, NumOfPartFrames, NumChannels, DownmixedAudioFrames.GetData());
+			MonoAudioFrames = DownmixedAudioFrames.GetData();
+		}
+
+		// The render thread must not log, and the dropped audio frames are counted so the audio clock stays aligned after an overflow
+		const int64 NumOfPushedFrames = Analyzer->TryPushAudioFrames64(MonoAudioFrames, NumOfPartFrames);
+		NumOfDroppedFrames.fetch_add(NumOfPartFrames - NumOfPushedFrames, std::memory_order_relaxed);
+		NumOfCapturedFrames.fetch_add(NumOfPushedFrames, std::memory_order_release);
+	}
+}
+
+#if !UE_VERSION_OLDER_THAN(5, 4, 0)
+const FString& FAudioAnalysisSubmixListener::GetListenerName() const
+{
+	static const FString ListenerName(TEXT("AudioAnalysisSubmixListener"));
+	return ListenerName;
+}
+#endif
+
+bool FAudioAnalysisSubmixListener::SetAnalyzer(UAudioAnalysisToolsLibrary* InAnalyzer, int64 DownmixBufferSize)
+{
+	FScopeLock Lock(&AnalyzerGuard);
+
+	// The render thread cannot be pushing while the guard is held, so the previous analyzer may reallocate its streaming buffer once detached
+	if (Analyzer)
+	{
+		Analyzer->DetachStreamingProducer();
+		Analyzer = nullptr;
+	}
+
+	if (InAnalyzer)
+	{
+		if (!InAnalyzer->AttachStreamingProducer())
+		{
+			return false;
+		}
+
+		DownmixedAudioFrames.SetNumUninitialized(DownmixBufferSize > 0 ? DownmixBufferSize : DefaultDownmixBufferSize);
+	}
+
+	Analyzer = InAnalyzer;
+	StartAudioClock = -1;
+	CapturedSampleRate = 0;
+	NumOfCapturedFrames = 0;
+	NumOfDroppedFrames = 0;
+
+	// The streaming buffer may already hold audio frames pushed before the capture, which come first in the hops
+	StartStreamedFrame = Analyzer ? Analyzer->GetNumOfStreamedFrames() : 0;
+
+	return true;
+}
+
+UAudioAnalysisSubmixCapture::UAudioAnalysisSubmixCapture()
+	: Analyzer(nullptr),
+	  CapturedSubmix(nullptr),
+	  CapturedDeviceId(INDEX_NONE)
+{
+}
+
+void UAudioAnalysisSubmixCapture::BeginDestroy()
+{
+	StopCapture();
+
+	Super::BeginDestroy();
+}
+
+UAudioAnalysisSubmixCapture* UAudioAnalysisSubmixCapture::CreateSubmixCapture(UAudioAnalysisToolsLibrary* Analyzer)
+{
+	if (!Analyzer)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the submix capture: the specified analyzer is invalid"));
+		return nullptr;
+	}
+
+	UAudioAnalysisSubmixCapture* SubmixCapture = NewObject<UAudioAnalysisSubmixCapture>();
+	SubmixCapture->Analyzer = Analyzer;
+	return SubmixCapture;
+}
+
+bool UAudioAnalysisSubmixCapture::StartCapture(const UObject* WorldContextObject, USoundSubmix* Submix)
+{
+	if (IsCapturing())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to start the submix capture: the capture is already started"));
+		return false;
+	}
+
+	if (!Analyzer || !Analyzer->IsStreaming())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to start the submix capture: the analyzer is invalid or its streaming mode is disabled"));
+		return false;
+	}
+
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+	FAudioDevice* AudioDevice = World ? World->GetAudioDeviceRaw() : nullptr;
+
+	if (!AudioDevice)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to start the submix capture: no audio device is available for the world"));
+		return false;
+	}
+
+	if (!Submix)
+	{
+		Submix = Cast<USoundSubmix>(GetDefault<UAudioSettings>()->MasterSubmix.TryLoad());
+
+		if (!Submix)
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to start the submix capture: the main submix is unavailable"));
+			return false;
+		}
+	}
+
+	if (!Listener.IsValid())
+	{
+		Listener = MakeShared<FAudioAnalysisSubmixListener, ESPMode::ThreadSafe>();
+	}
+	if (!Listener->SetAnalyzer(Analyzer, AudioDevice->GetBufferLength()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to start the submix capture: the analyzer cannot be attached as the streaming producer"));
+		return false;
+	}
+
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+	AudioDevice->RegisterSubmixBufferListener(Listener.Get(), Submix);
+#else
+	AudioDevice->RegisterSubmixBufferListener(Listener.ToSharedRef(), *Submix);
+#endif
+
+	CapturedSubmix = Submix;
+	CapturedDeviceId = AudioDevice->DeviceID;
+
+	return true;
+}
+
+void UAudioAnalysisSubmixCapture::StopCapture()
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	FAudioDeviceManager* AudioDeviceManager = GEngine ? GEngine->GetAudioDeviceManager() : nullptr;
+	FAudioDevice* AudioDevice = AudioDeviceManager ? AudioDeviceManager->GetAudioDeviceRaw(CapturedDeviceId) : nullptr;
+
+	if (AudioDevice)
+	{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+		AudioDevice->UnregisterSubmixBufferListener(Listener.Get(), CapturedSubmix);
+#else
+		AudioDevice->UnregisterSubmixBufferListener(Listener.ToSharedRef(), *CapturedSubmix);
+#endif
+	}
+
+	// The unregistration is processed on the audio render thread later, so the listener stops pushing right away instead
+	Listener->SetAnalyzer(nullptr);
+
+	CapturedSubmix = nullptr;
+	CapturedDeviceId = INDEX_NONE;
+}
+
+bool UAudioAnalysisSubmixCapture::IsCapturing() const
+{
+	return CapturedSubmix != nullptr;
+}
+
+double UAudioAnalysisSubmixCapture::GetAudioClockOfFrame(int64 StreamedFrameIndex) const
+{
+	if (!Listener.IsValid())
+	{
+		return -1;
+	}
+
+	const double StartAudioClock = Listener->StartAudioClock.load(std::memory_order_acquire);
+	const int32 SampleRate = Listener->CapturedSampleRate.load(std::memory_order_relaxed);
+	const int64 CapturedFrameIndex = StreamedFrameIndex - Listener->StartStreamedFrame.load(std::memory_order_relaxed);
+
+	if (StartAudioClock < 0 || SampleRate <= 0 || CapturedFrameIndex < 0)
+	{
+		return -1;
+	}
+
+	// The dropped audio frames were rendered but never streamed, so they are skipped on the render timeline
+	const int64 RenderedFrameIndex = CapturedFrameIndex + Listener->NumOfDroppedFrames.load(std::memory_order_relaxed);
+
+	return StartAudioClock + static_cast<double>(RenderedFrameIndex) / SampleRate;
+}
+
+int64 UAudioAnalysisSubmixCapture::GetNumOfCapturedFrames() const
+{
+	return Listener.IsValid() ? Listener->NumOfCapturedFrames.load(std::memory_order_acquire) : 0;
+}
+
+int64 UAudioAnalysisSubmixCapture::GetNumOfDroppedFrames() const
+{
+	return Listener.IsValid() ? Listener->NumOfDroppedFrames.load(std::memory_order_relaxed) : 0;
+}
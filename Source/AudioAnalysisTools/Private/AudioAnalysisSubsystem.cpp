@@ -0,0 +1,179 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisSubsystem.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "AudioAnalysisToolsLibrary.h"
+
+#include "Engine/Engine.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+UAudioAnalysisSubsystem::UAudioAnalysisSubsystem()
+	: bBatchRunning(false),
+	  bInitialized(false)
+{
+}
+
+UAudioAnalysisSubsystem* UAudioAnalysisSubsystem::Get()
+{
+	return GEngine ? GEngine->GetEngineSubsystem<UAudioAnalysisSubsystem>() : nullptr;
+}
+
+void UAudioAnalysisSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	bInitialized = true;
+}
+
+void UAudioAnalysisSubsystem::Deinitialize()
+{
+	bInitialized = false;
+
+	// The running batch accesses the batch jobs and the analyzers, so it has to finish first
+	if (BatchTask.IsValid())
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(BatchTask);
+		BatchTask = nullptr;
+	}
+
+	Analyzers.Empty();
+	BatchJobs.Empty();
+	BatchAnalyzers.Empty();
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UAudioAnalysisSubsystem::GetTickableTickType() const
+{
+	// The class default object must never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UAudioAnalysisSubsystem::IsTickable() const
+{
+	return bInitialized && Analyzers.Num() > 0;
+}
+
+TStatId UAudioAnalysisSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAudioAnalysisSubsystem, STATGROUP_Tickables);
+}
+
+void UAudioAnalysisSubsystem::RegisterAnalyzer(UAudioAnalysisToolsLibrary* Analyzer)
+{
+	if (!Analyzer)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to register the analyzer: the specified analyzer is invalid"));
+		return;
+	}
+
+	Analyzers.AddUnique(Analyzer);
+}
+
+void UAudioAnalysisSubsystem::UnregisterAnalyzer(UAudioAnalysisToolsLibrary* Analyzer)
+{
+	Analyzers.Remove(Analyzer);
+}
+
+bool UAudioAnalysisSubsystem::IsAnalyzerRegistered(const UAudioAnalysisToolsLibrary* Analyzer) const
+{
+	return Analyzer && Analyzers.Contains(Analyzer);
+}
+
+void UAudioAnalysisSubsystem::Tick(float DeltaTime)
+{
+	// The previous batch is still being analyzed. The pending audio frames stay with the analyzers, the most recent ones replacing the older ones, until the next tick
+	if (bBatchRunning)
+	{
+		return;
+	}
+
+	Analyzers.RemoveAll([](const TWeakObjectPtr<UAudioAnalysisToolsLibrary>& Analyzer)
+	{
+		return !Analyzer.IsValid();
+	});
+
+	int32 NumOfJobs = 0;
+	const uint64 QueuedCycles = FPlatformTime::Cycles64();
+
+	BatchAnalyzers.Reset();
+
+	for (const TWeakObjectPtr<UAudioAnalysisToolsLibrary>& WeakAnalyzer : Analyzers)
+	{
+		UAudioAnalysisToolsLibrary* Analyzer = WeakAnalyzer.Get();
+
+		if (Analyzer->PendingAudioFrames.Num() <= 0)
+		{
+			continue;
+		}
+
+		if (NumOfJobs == BatchJobs.Num())
+		{
+			BatchJobs.AddDefaulted();
+		}
+
+		FBatchJob& BatchJob = BatchJobs[NumOfJobs++];
+		BatchJob.Analyzer = Analyzer;
+		BatchAnalyzers.Add(Analyzer);
+		BatchJob.bProcessToBeatDetection = Analyzer->bPendingBeatDetection;
+		BatchJob.QueuedCycles = QueuedCycles;
+
+		// The analyzer gets the audio frames array of a previous batch to fill next, so no allocation is needed in a steady state
+		Swap(BatchJob.AudioFrames, Analyzer->PendingAudioFrames);
+		Analyzer->PendingAudioFrames.Reset();
+	}
+
+	if (NumOfJobs == 0)
+	{
+		return;
+	}
+
+	// Analyzers of the same frame size end up in adjacent jobs, so each worker mostly runs FFTs of one size on one shared plan
+	Sort(BatchJobs.GetData(), NumOfJobs, [](const FBatchJob& A, const FBatchJob& B)
+	{
+		return A.AudioFrames.Num() < B.AudioFrames.Num();
+	});
+
+	INC_DWORD_STAT_BY(STAT_AudioAnalysis_BatchedAnalyzers, NumOfJobs);
+
+	bBatchRunning = true;
+
+	// Deinitialize waits for the task, so the subsystem outlives it without resolving a weak pointer off the game thread
+	BatchTask = FFunctionGraphTask::CreateAndDispatchWhenReady([this, NumOfJobs]()
+	{
+		ProcessBatch(NumOfJobs);
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundHiPriTask);
+}
+
+void UAudioAnalysisSubsystem::ProcessBatch(int32 NumOfJobs)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_ProcessBatch);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_ProcessBatch);
+
+	// Contiguous ranges of jobs are handed to each worker, which keeps the jobs of the same frame size together
+	ParallelFor(NumOfJobs, [this](int32 JobIndex)
+	{
+		const FBatchJob& BatchJob = BatchJobs[JobIndex];
+
+		AudioAnalysisTrace::TraceQueueLatency(BatchJob.Analyzer->GetUniqueID(), BatchJob.QueuedCycles);
+		BatchJob.Analyzer->ProcessAudioFrames(TArrayView64<const float>(BatchJob.AudioFrames), BatchJob.bProcessToBeatDetection);
+	});
+
+	bBatchRunning = false;
+
+	AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), NumOfJobs]()
+	{
+		if (WeakThis.IsValid())
+		{
+			// The analyzers of the batch may be garbage collected again, unless a new batch has already taken them
+			if (!WeakThis->bBatchRunning)
+			{
+				WeakThis->BatchAnalyzers.Reset();
+			}
+
+			WeakThis->OnAnalysisBatchProcessedNative.Broadcast(NumOfJobs);
+			WeakThis->OnAnalysisBatchProcessed.Broadcast(NumOfJobs);
+		}
+	});
+}
@@ -3,6 +3,16 @@
 #include "AudioAnalysisTools.h"
 
 #include "AudioAnalysisToolsDefines.h"
+#include "Analyzers/FFTPlanCache.h"
+#include "Analyzers/MelFrequencyFeatures.h"
+#include "WindowsLibrary.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Trace/Trace.h"
+
+/** Trace channels are available since UE 4.26 */
+#define AUDIO_ANALYSIS_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_VERSION_OLDER_THAN(4, 26, 0))
 
 #define LOCTEXT_NAMESPACE "FAudioAnalysisToolsModule"
 
@@ -12,6 +22,9 @@ void FAudioAnalysisToolsModule::StartupModule()
 
 void FAudioAnalysisToolsModule::ShutdownModule()
 {
+	FFFTPlanCache::Get().ReleaseUnusedPlans();
+	FWindowCache::Get().ReleaseUnusedWindows();
+	FMelFilterbankCache::Get().ReleaseUnusedFilterbanks();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -19,3 +32,68 @@ void FAudioAnalysisToolsModule::ShutdownModule()
 IMPLEMENT_MODULE(FAudioAnalysisToolsModule, AudioAnalysisTools)
 
 DEFINE_LOG_CATEGORY(LogAudioAnalysis);
+
+DEFINE_STAT(STAT_AudioAnalysis_ProcessAudioFrames);
+DEFINE_STAT(STAT_AudioAnalysis_ProcessStreamingBuffer);
+DEFINE_STAT(STAT_AudioAnalysis_ProcessBatch);
+DEFINE_STAT(STAT_AudioAnalysis_AnalyzeAudioFrames);
+DEFINE_STAT(STAT_AudioAnalysis_PerformFFT);
+DEFINE_STAT(STAT_AudioAnalysis_FFTTransform);
+DEFINE_STAT(STAT_AudioAnalysis_BeatDetectionUpdate);
+DEFINE_STAT(STAT_AudioAnalysis_BandTriggerUpdate);
+DEFINE_STAT(STAT_AudioAnalysis_TempoEstimation);
+DEFINE_STAT(STAT_AudioAnalysis_MultiResolutionUpdate);
+DEFINE_STAT(STAT_AudioAnalysis_GetFeature);
+DEFINE_STAT(STAT_AudioAnalysis_SubmixCapture);
+DEFINE_STAT(STAT_AudioAnalysis_ProcessedFrames);
+DEFINE_STAT(STAT_AudioAnalysis_BatchedAnalyzers);
+DEFINE_STAT(STAT_AudioAnalysis_FFTPlans);
+DEFINE_STAT(STAT_AudioAnalysis_WindowTables);
+DEFINE_STAT(STAT_AudioAnalysis_QueueLatency);
+DEFINE_STAT(STAT_AudioAnalysis_FFTPlanMemory);
+DEFINE_STAT(STAT_AudioAnalysis_WindowTableMemory);
+DEFINE_STAT(STAT_AudioAnalysis_BufferMemory);
+
+#if AUDIO_ANALYSIS_TRACE_ENABLED
+UE_TRACE_CHANNEL(AudioAnalysisChannel)
+
+UE_TRACE_EVENT_BEGIN(AudioAnalysis, QueueLatency)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, QueuedCycle)
+	UE_TRACE_EVENT_FIELD(uint32, AnalyzerId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(AudioAnalysis, FrameProcessed)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(int64, FrameSize)
+	UE_TRACE_EVENT_FIELD(uint32, AnalyzerId)
+UE_TRACE_EVENT_END()
+#endif
+
+void AudioAnalysisTrace::TraceQueueLatency(uint32 AnalyzerId, uint64 QueuedCycles)
+{
+	const uint64 Cycles = FPlatformTime::Cycles64();
+
+	SET_FLOAT_STAT(STAT_AudioAnalysis_QueueLatency, FPlatformTime::ToMilliseconds64(Cycles - QueuedCycles));
+
+#if AUDIO_ANALYSIS_TRACE_ENABLED
+	UE_TRACE_LOG(AudioAnalysis, QueueLatency, AudioAnalysisChannel)
+		<< QueueLatency.Cycle(Cycles)
+		<< QueueLatency.QueuedCycle(QueuedCycles)
+		<< QueueLatency.AnalyzerId(AnalyzerId);
+#endif
+}
+
+void AudioAnalysisTrace::TraceFrameProcessed(uint32 AnalyzerId, uint64 StartCycles, int64 FrameSize)
+{
+	INC_DWORD_STAT(STAT_AudioAnalysis_ProcessedFrames);
+
+#if AUDIO_ANALYSIS_TRACE_ENABLED
+	UE_TRACE_LOG(AudioAnalysis, FrameProcessed, AudioAnalysisChannel)
+		<< FrameProcessed.Cycle(FPlatformTime::Cycles64())
+		<< FrameProcessed.StartCycle(StartCycles)
+		<< FrameProcessed.FrameSize(FrameSize)
+		<< FrameProcessed.AnalyzerId(AnalyzerId);
+#endif
+}
@@ -2,30 +2,116 @@
 
 #include "AudioAnalysisToolsLibrary.h"
 #include "AudioAnalysisToolsDefines.h"
+#include "AudioAnalysisSubsystem.h"
 
 #include "Analyzers/CoreFrequencyDomainFeatures.h"
 #include "Analyzers/CoreTimeDomainFeatures.h"
 #include "Analyzers/BeatDetection.h"
 #include "Analyzers/OnsetDetection.h"
+#include "Analyzers/MelFrequencyFeatures.h"
 
 #include "Analyzers/FFTAudioAnalyzer.h"
 
 #include "Async/Async.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
 #include "Misc/ScopeLock.h"
 
+namespace
+{
+	/**
+	 * Copy the data into the array, reusing the allocation of the array if it is large enough
+	 *
+	 * @return Whether the data fits into the array or not
+	 */
+	bool CopyToArray(TArrayView64<const float> Data, TArray<float>& OutArray)
+	{
+		if (Data.Num() > TNumericLimits<int32>::Max())
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to copy the analysis data: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), static_cast<int64>(Data.Num()));
+			return false;
+		}
+
+		OutArray.Reset(static_cast<int32>(Data.Num()));
+		OutArray.Append(Data.GetData(), static_cast<int32>(Data.Num()));
+		return true;
+	}
+
+	/**
+	 * Hand the working array over to the snapshot of the writer by swapping the arrays instead of copying them
+	 * The working array takes over the previous allocation of the snapshot array, and its contents are overwritten by the next analysis
+	 */
+	void SwapIntoSnapshot(TArray64<float>& WorkingArray, TArray64<float>& SnapshotArray)
+	{
+		const int64 NumOfElements = WorkingArray.Num();
+		Swap(WorkingArray, SnapshotArray);
+
+		// Only reallocates when the frame size has changed since the snapshot array was last filled
+		WorkingArray.SetNumUninitialized(NumOfElements);
+	}
+}
+
 UAudioAnalysisToolsLibrary::UAudioAnalysisToolsLibrary()
-	: FFTConfigured(false)
+	: ProcessingPolicy(EAudioProcessingPolicy::TaskPipe),
+	  FrameQueue(DefaultFrameQueueCapacity),
+	  bFrameQueueProcessingScheduled(false),
+	  NumFrameQueueTasksInFlight(0),
+	  FrameQueueTasksDoneEvent(FPlatformProcess::GetSynchEventFromPool(false)),
+	  bFrameQueueShutdown(false),
+	  NumProcessedFrames(0),
+	  FFTConfigured(false),
+	  FFTExecutionPolicy(EFFTExecutionPolicy::Inline),
+	  FFTParallelThreshold(DefaultFFTParallelThreshold),
+	  bPendingBeatDetection(true),
+	  StreamingHopSize(0),
+	  bStreamingBeatDetection(true),
+	  bStreamingProcessingScheduled(false),
+	  NumStreamingHops(0),
+	  StreamingFrameSize(0),
+	  NumDroppedStreamingFrames(0),
+	  bStreamingOverflowLogged(false),
+	  bStreamingProducerAttached(false),
+	  ChannelMode(EAudioChannelMode::Interleaved),
+	  SelectedChannel(0),
+	  ReportedBufferMemory(0)
+{
+}
+
+UAudioAnalysisToolsLibrary::~UAudioAnalysisToolsLibrary()
 {
+	FPlatformProcess::ReturnSynchEventToPool(FrameQueueTasksDoneEvent);
+	FrameQueueTasksDoneEvent = nullptr;
 }
 
 void UAudioAnalysisToolsLibrary::BeginDestroy()
 {
+	// The dedicated thread accesses the analyzer directly, so it is stopped before anything is released
+	bFrameQueueShutdown = true;
+	AnalysisThread.Reset();
+
+	Super::BeginDestroy();
+}
+
+bool UAudioAnalysisToolsLibrary::IsReadyForFinishDestroy()
+{
+	// A frame queue task may still be draining the queue, which uses the queue and the FFT until it exits
+	return Super::IsReadyForFinishDestroy() && NumFrameQueueTasksInFlight.load() == 0;
+}
+
+void UAudioAnalysisToolsLibrary::FinishDestroy()
+{
+	FrameQueue.Reset(0);
+
 	if (FFTConfigured)
 	{
 		FreeFFT();
 	}
 
-	Super::BeginDestroy();
+	DEC_MEMORY_STAT_BY(STAT_AudioAnalysis_BufferMemory, ReportedBufferMemory);
+	ReportedBufferMemory = 0;
+
+	Super::FinishDestroy();
 }
 
 UAudioAnalysisToolsLibrary* UAudioAnalysisToolsLibrary::CreateAudioAnalysisTools(int64 FrameSize, EAnalysisWindowType WindowType)
@@ -50,6 +136,20 @@ bool UAudioAnalysisToolsLibrary::GetAudioByFrameSize(UImportedSoundWave* Importe
 
 bool UAudioAnalysisToolsLibrary::GetAudioByFrameRange(UImportedSoundWave* ImportedSoundWave, int64 StartFrame, int64 EndFrame, TArray<float>& AudioFrames)
 {
+	return ViewAudioByFrameRange(ImportedSoundWave, StartFrame, EndFrame, [&AudioFrames](TArrayView64<const float> PCMData)
+	{
+		AudioFrames = TArray<float>(PCMData.GetData(), PCMData.Num());
+	});
+}
+
+bool UAudioAnalysisToolsLibrary::ViewAudioByFrameRange(UImportedSoundWave* ImportedSoundWave, int64 StartFrame, int64 EndFrame, TFunctionRef<void(TArrayView64<const float>)> Visitor)
+{
+	if (!ImportedSoundWave)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the frame data: the specified sound wave is invalid"));
+		return false;
+	}
+
 	if (!(StartFrame >= 0 && StartFrame < EndFrame))
 	{
 		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the frame data: start frame is '%lld', expected >= '0.0' and < '%lld'"), StartFrame, EndFrame);
@@ -87,9 +187,10 @@ bool UAudioAnalysisToolsLibrary::GetAudioByFrameRange(UImportedSoundWave* Import
 		return false;
 	}
 
-	if (RetrievedPCMDataSize > static_cast<int64>(ImportedSoundWave->GetPCMBuffer().PCMData.GetView().Num()))
+	// The view must not reach past the end of the PCM data, since the data is read in place
+	if (StartFrame * NumChannels + RetrievedPCMDataSize > static_cast<int64>(ImportedSoundWave->GetPCMBuffer().PCMData.GetView().Num()))
 	{
-		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the PCM Data: retrieved PCM Data size (%lld) must be less than the total size (%lld)"), RetrievedPCMDataSize, static_cast<int64>(ImportedSoundWave->GetPCMBuffer().PCMData.GetView().Num()));
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the PCM Data: retrieved PCM Data size (%lld) must be less than the total size (%lld)"), StartFrame * NumChannels + RetrievedPCMDataSize, static_cast<int64>(ImportedSoundWave->GetPCMBuffer().PCMData.GetView().Num()));
 		return false;
 	}
 
@@ -99,7 +200,7 @@ bool UAudioAnalysisToolsLibrary::GetAudioByFrameRange(UImportedSoundWave* Import
 		return false;
 	}
 
-	AudioFrames = TArray<float>(RetrievedPCMData, RetrievedPCMDataSize);
+	Visitor(TArrayView64<const float>(RetrievedPCMData, RetrievedPCMDataSize));
 	return true;
 }
 
@@ -177,74 +278,175 @@ void UAudioAnalysisToolsLibrary::Initialize(int64 FrameSize, EAnalysisWindowType
 	OnsetDetection = UOnsetDetection::CreateOnsetDetection(FrameSize);
 	check(OnsetDetection);
 
+	// The snapshot always holds the FFT of real audio frames, so only its non-redundant half is needed
+	OnsetDetection->SetComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode::PhasorPrediction);
+
 	WindowType = InWindowType;
 
 	UpdateFrameSize(FrameSize);
+
+	// The reader sees zeroed results until the first audio frames are processed
+	PublishSnapshot();
 }
 
 TArray<float> UAudioAnalysisToolsLibrary::GetMagnitudeSpectrum() const
 {
-	if (MagnitudeSpectrum.Num() > TNumericLimits<int32>::Max())
+	const TArray64<float>& MagnitudeSpectrumSnapshot = GetSnapshot().MagnitudeSpectrum;
+
+	if (MagnitudeSpectrumSnapshot.Num() > TNumericLimits<int32>::Max())
 	{
-		UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to get Magnitude Spectrum Real: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), MagnitudeSpectrum.Num());
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to get Magnitude Spectrum Real: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), MagnitudeSpectrumSnapshot.Num());
 		return TArray<float>();
 	}
 
-	return TArray<float>(MagnitudeSpectrum);
+	return TArray<float>(MagnitudeSpectrumSnapshot);
+}
+
+TArray64<float> UAudioAnalysisToolsLibrary::GetMagnitudeSpectrum64() const
+{
+	return GetSnapshot().MagnitudeSpectrum;
 }
 
-const TArray64<float>& UAudioAnalysisToolsLibrary::GetMagnitudeSpectrum64() const
+bool UAudioAnalysisToolsLibrary::GetMagnitudeSpectrum(TArray<float>& OutMagnitudeSpectrum) const
 {
-	return MagnitudeSpectrum;
+	return CopyToArray(GetSnapshot().MagnitudeSpectrum, OutMagnitudeSpectrum);
 }
 
 TArray<float> UAudioAnalysisToolsLibrary::GetFFTReal() const
 {
-	if (FFTReal.Num() > TNumericLimits<int32>::Max())
+	const TArray64<float>& FFTRealSnapshot = GetSnapshot().FFTReal;
+
+	if (FFTRealSnapshot.Num() > TNumericLimits<int32>::Max())
 	{
-		UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to get FFT Real: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), FFTReal.Num());
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to get FFT Real: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), FFTRealSnapshot.Num());
 		return TArray<float>();
 	}
 
-	return TArray<float>(FFTReal);
+	return TArray<float>(FFTRealSnapshot);
+}
+
+TArray64<float> UAudioAnalysisToolsLibrary::GetFFTReal64() const
+{
+	return GetSnapshot().FFTReal;
 }
 
-const TArray64<float>& UAudioAnalysisToolsLibrary::GetFFTReal64() const
+bool UAudioAnalysisToolsLibrary::GetFFTReal(TArray<float>& OutFFTReal) const
 {
-	return FFTReal;
+	return CopyToArray(GetSnapshot().FFTReal, OutFFTReal);
 }
 
 TArray<float> UAudioAnalysisToolsLibrary::GetFFTImaginary() const
 {
-	if (FFTImaginary.Num() > TNumericLimits<int32>::Max())
+	const TArray64<float>& FFTImaginarySnapshot = GetSnapshot().FFTImaginary;
+
+	if (FFTImaginarySnapshot.Num() > TNumericLimits<int32>::Max())
 	{
-		UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to get FFT Imaginary: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), FFTReal.Num());
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to get FFT Imaginary: Array with int32 size (max length: %d) cannot fit int64 size data (retrieved length: %lld)"), TNumericLimits<int32>::Max(), FFTImaginarySnapshot.Num());
 		return TArray<float>();
 	}
 
-	return TArray<float>(FFTImaginary);
+	return TArray<float>(FFTImaginarySnapshot);
+}
+
+TArray64<float> UAudioAnalysisToolsLibrary::GetFFTImaginary64() const
+{
+	return GetSnapshot().FFTImaginary;
+}
+
+bool UAudioAnalysisToolsLibrary::GetFFTImaginary(TArray<float>& OutFFTImaginary) const
+{
+	return CopyToArray(GetSnapshot().FFTImaginary, OutFFTImaginary);
+}
+
+int64 UAudioAnalysisToolsLibrary::GetLatestFrameIndex() const
+{
+	return SnapshotBuffer.GetPublishedSequenceNumber();
+}
+
+const FAudioAnalysisSnapshot& UAudioAnalysisToolsLibrary::GetLatestSnapshot() const
+{
+	return GetSnapshot();
+}
+
+FAudioAnalysisSnapshot& UAudioAnalysisToolsLibrary::GetSnapshot() const
+{
+	return SnapshotBuffer.GetReadSnapshot();
+}
+
+void UAudioAnalysisToolsLibrary::PublishSnapshot()
+{
+	FAudioAnalysisSnapshot& Snapshot = SnapshotBuffer.GetWriteSnapshot();
+
+	// The working arrays are fully rewritten by each analysis, so they are swapped into the snapshot rather than copied
+	// The snapshot of the writer is never seen by the reader, so the arrays it hands back are free to be overwritten
+	Snapshot.SequenceNumber = NumProcessedFrames++;
+	SwapIntoSnapshot(CurrentAudioFrames, Snapshot.AudioFrames);
+	SwapIntoSnapshot(MagnitudeSpectrum, Snapshot.MagnitudeSpectrum);
+	SwapIntoSnapshot(FFTReal, Snapshot.FFTReal);
+	SwapIntoSnapshot(FFTImaginary, Snapshot.FFTImaginary);
+
+	const TArrayView64<const float> BeatSubbands = BeatDetection->GetFFTSubbands();
+	Snapshot.BeatSubbands.Reset();
+	Snapshot.BeatSubbands.Append(BeatSubbands.GetData(), BeatSubbands.Num());
+
+	const TArrayView64<const uint64> BeatMask = BeatDetection->GetBeatMask();
+	Snapshot.BeatMask.Reset();
+	Snapshot.BeatMask.Append(BeatMask.GetData(), BeatMask.Num());
+
+	Snapshot.bIsKick = BeatDetection->IsKick();
+	Snapshot.bIsSnare = BeatDetection->IsSnare();
+	Snapshot.bIsHiHat = BeatDetection->IsHiHat();
+
+	// The spectral and time domain features are computed by the reader on demand
+	Snapshot.SpectralFeatures = FSpectralFeatureSet();
+	Snapshot.bTimeDomainFeaturesComputed = false;
+
+	SnapshotBuffer.Publish();
+
+	UpdateBufferMemoryStat();
 }
 
-const TArray64<float>& UAudioAnalysisToolsLibrary::GetFFTImaginary64() const
+void UAudioAnalysisToolsLibrary::UpdateBufferMemoryStat()
 {
-	return FFTImaginary;
+#if STATS
+	// The snapshots all have the shape of the one owned by the writer, and the reader's snapshot must not be touched from here
+	const int64 BufferMemory = CurrentAudioFrames.GetAllocatedSize() + FFTReal.GetAllocatedSize() + FFTImaginary.GetAllocatedSize() + MagnitudeSpectrum.GetAllocatedSize()
+		+ StreamingBuffer.GetCapacity() * static_cast<int64>(sizeof(float)) + 3 * static_cast<int64>(SnapshotBuffer.GetWriteSnapshot().GetAllocatedSize());
+
+	if (BufferMemory != ReportedBufferMemory)
+	{
+		INC_MEMORY_STAT_BY(STAT_AudioAnalysis_BufferMemory, BufferMemory);
+		DEC_MEMORY_STAT_BY(STAT_AudioAnalysis_BufferMemory, ReportedBufferMemory);
+		ReportedBufferMemory = BufferMemory;
+	}
+#endif
 }
 
 void UAudioAnalysisToolsLibrary::ProcessAudioFrames(TArray<float> AudioFrames, bool bProcessToBeatDetection)
 {
-	if (IsInGameThread())
+	FAudioFrameRequest Request;
+	Request.AudioFrames = MoveTemp(AudioFrames);
+	Request.bProcessToBeatDetection = bProcessToBeatDetection;
+	SubmitFrameRequest(MoveTemp(Request));
+}
+
+TFuture<int64> UAudioAnalysisToolsLibrary::ProcessAudioFramesAsync(TArray<float> AudioFrames, bool bProcessToBeatDetection)
+{
+	FAudioFrameRequest Request;
+	Request.AudioFrames = MoveTemp(AudioFrames);
+	Request.bProcessToBeatDetection = bProcessToBeatDetection;
+	Request.Promise = MakeUnique<TPromise<int64>>();
+
+	TFuture<int64> Future = Request.Promise->GetFuture();
+	SubmitFrameRequest(MoveTemp(Request));
+	return Future;
+}
+
+void UAudioAnalysisToolsLibrary::ProcessAudioFrames(TArrayView64<const float> AudioFrames, bool bProcessToBeatDetection)
+{
+	if (AudioFrames.Num() <= 0)
 	{
-		AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), AudioFrames = MoveTemp(AudioFrames), bProcessToBeatDetection]() mutable 
-		{
-			if (WeakThis.IsValid())
-			{
-				WeakThis->ProcessAudioFrames(MoveTemp(AudioFrames), bProcessToBeatDetection);
-			}
-			else
-			{
-				UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to process audio frames because the AudioAnalysisToolsLibrary has been destroyed"));
-			}
-		});
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process audio frames: the number of audio frames is '%lld', expected > '0'"), static_cast<int64>(AudioFrames.Num()));
 		return;
 	}
 
@@ -254,7 +456,335 @@ void UAudioAnalysisToolsLibrary::ProcessAudioFrames(TArray<float> AudioFrames, b
 	{
 		UpdateFrameSize(AudioFrames.Num());
 	}
-	CurrentAudioFrames = MoveTemp(AudioFrames);
+	FMemory::Memcpy(CurrentAudioFrames.GetData(), AudioFrames.GetData(), sizeof(float) * AudioFrames.Num());
+
+	ProcessCurrentAudioFrames(bProcessToBeatDetection);
+}
+
+void UAudioAnalysisToolsLibrary::ProcessInterleavedAudioFrames(TArray<float> AudioFrames, int32 NumChannels, bool bProcessToBeatDetection)
+{
+	if (NumChannels <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process interleaved audio frames: the number of channels is '%d', expected > '0'"), NumChannels);
+		return;
+	}
+
+	FAudioFrameRequest Request;
+	Request.AudioFrames = MoveTemp(AudioFrames);
+	Request.NumChannels = NumChannels;
+	Request.bProcessToBeatDetection = bProcessToBeatDetection;
+	SubmitFrameRequest(MoveTemp(Request));
+}
+
+TFuture<int64> UAudioAnalysisToolsLibrary::ProcessInterleavedAudioFramesAsync(TArray<float> AudioFrames, int32 NumChannels, bool bProcessToBeatDetection)
+{
+	if (NumChannels <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process interleaved audio frames: the number of channels is '%d', expected > '0'"), NumChannels);
+		TPromise<int64> Promise;
+		Promise.SetValue(-1);
+		return Promise.GetFuture();
+	}
+
+	FAudioFrameRequest Request;
+	Request.AudioFrames = MoveTemp(AudioFrames);
+	Request.NumChannels = NumChannels;
+	Request.bProcessToBeatDetection = bProcessToBeatDetection;
+	Request.Promise = MakeUnique<TPromise<int64>>();
+
+	TFuture<int64> Future = Request.Promise->GetFuture();
+	SubmitFrameRequest(MoveTemp(Request));
+	return Future;
+}
+
+void UAudioAnalysisToolsLibrary::ProcessInterleavedAudioFrames(TArrayView64<const float> AudioFrames, int32 NumChannels, bool bProcessToBeatDetection)
+{
+	if (NumChannels <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process interleaved audio frames: the number of channels is '%d', expected > '0'"), NumChannels);
+		return;
+	}
+
+	FScopeLock Lock(&DataGuard);
+
+	if (ChannelMode == EAudioChannelMode::Interleaved || NumChannels == 1)
+	{
+		ProcessAudioFrames(AudioFrames, bProcessToBeatDetection);
+		return;
+	}
+
+	if (ChannelMode == EAudioChannelMode::SingleChannel && SelectedChannel >= NumChannels)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process interleaved audio frames: the selected channel is '%d', expected < '%d'"), SelectedChannel, NumChannels);
+		return;
+	}
+
+	const int64 NumOfFrames = AudioFrames.Num() / NumChannels;
+
+	if (NumOfFrames <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process interleaved audio frames: the number of audio frames is '%lld', expected > '0'"), NumOfFrames);
+		return;
+	}
+
+	if (NumOfFrames != CurrentAudioFrames.Num())
+	{
+		UpdateFrameSize(NumOfFrames);
+	}
+
+	CopyChannelsToCurrentAudioFrames(AudioFrames.GetData(), NumChannels);
+
+	ProcessCurrentAudioFrames(bProcessToBeatDetection);
+}
+
+void UAudioAnalysisToolsLibrary::SetChannelMode(EAudioChannelMode InChannelMode, int32 Channel)
+{
+	if (Channel < 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to set the channel mode: the channel is '%d', expected >= '0'"), Channel);
+		return;
+	}
+
+	FScopeLock Lock(&DataGuard);
+
+	ChannelMode = InChannelMode;
+	SelectedChannel = Channel;
+}
+
+void UAudioAnalysisToolsLibrary::SetProcessingPolicy(EAudioProcessingPolicy InProcessingPolicy, int32 QueueCapacity)
+{
+	if (!IsInGameThread())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to set the processing policy: the processing policy must be set from the game thread"));
+		return;
+	}
+
+	if (QueueCapacity <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to set the processing policy: the queue capacity is '%d', expected > '0'"), QueueCapacity);
+		return;
+	}
+
+	// The thread is stopped and the running task awaited first, so the queue has no consumer while it is reset and the next task cannot overlap the previous one
+	AnalysisThread.Reset();
+	WaitForFrameQueueTasks();
+	FrameQueue.Reset(QueueCapacity);
+
+	ProcessingPolicy = InProcessingPolicy;
+
+	if (ProcessingPolicy == EAudioProcessingPolicy::DedicatedThread)
+	{
+		AnalysisThread = MakeUnique<FAudioAnalysisThread>(TEXT("AudioAnalysisThread"), [this]()
+		{
+			ProcessFrameQueue();
+		});
+	}
+}
+
+int64 UAudioAnalysisToolsLibrary::GetNumDroppedFrameRequests() const
+{
+	return FrameQueue.GetNumDropped();
+}
+
+void UAudioAnalysisToolsLibrary::SubmitFrameRequest(FAudioFrameRequest&& Request)
+{
+	// Frames submitted from other threads are already off the game thread, so they are processed right away like before
+	if (ProcessingPolicy == EAudioProcessingPolicy::Inline || !IsInGameThread())
+	{
+		CompleteFrameRequest(Request, ProcessFrameRequest(Request));
+		return;
+	}
+
+	Request.QueuedCycles = FPlatformTime::Cycles64();
+	FrameQueue.Push(MoveTemp(Request));
+
+	if (ProcessingPolicy == EAudioProcessingPolicy::DedicatedThread && AnalysisThread.IsValid())
+	{
+		AnalysisThread->WakeUp();
+	}
+	else
+	{
+		ScheduleFrameQueueProcessing();
+	}
+}
+
+int64 UAudioAnalysisToolsLibrary::ProcessFrameRequest(const FAudioFrameRequest& Request)
+{
+	FScopeLock Lock(&DataGuard);
+
+	const int64 NumProcessedFramesBefore = NumProcessedFrames;
+
+	if (Request.NumChannels > 0)
+	{
+		ProcessInterleavedAudioFrames(TArrayView64<const float>(Request.AudioFrames), Request.NumChannels, Request.bProcessToBeatDetection);
+	}
+	else
+	{
+		ProcessAudioFrames(TArrayView64<const float>(Request.AudioFrames), Request.bProcessToBeatDetection);
+	}
+
+	// A snapshot is published for each processed frame, so an unchanged count means the frames have been rejected
+	return NumProcessedFrames > NumProcessedFramesBefore ? NumProcessedFrames - 1 : -1;
+}
+
+void UAudioAnalysisToolsLibrary::CompleteFrameRequest(FAudioFrameRequest& Request, int64 FrameIndex)
+{
+	Request.Complete(FrameIndex);
+
+	if (FrameIndex < 0)
+	{
+		return;
+	}
+
+	if (IsInGameThread())
+	{
+		OnAudioFramesProcessedNative.Broadcast(FrameIndex);
+		OnAudioFramesProcessed.Broadcast(FrameIndex);
+		return;
+	}
+
+	AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), FrameIndex]()
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->OnAudioFramesProcessedNative.Broadcast(FrameIndex);
+			WeakThis->OnAudioFramesProcessed.Broadcast(FrameIndex);
+		}
+	});
+}
+
+void UAudioAnalysisToolsLibrary::ScheduleFrameQueueProcessing()
+{
+	// Only one task processes the queue at a time, so the frames of this analyzer are processed in submission order without piling up tasks
+	if (bFrameQueueProcessingScheduled.exchange(true))
+	{
+		return;
+	}
+
+	// The analyzer is kept from finishing its destruction while the task is in flight, so the task can use it without resolving a weak pointer off the game thread
+	NumFrameQueueTasksInFlight.fetch_add(1);
+
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [this]()
+	{
+		do
+		{
+			ProcessFrameQueue();
+			bFrameQueueProcessingScheduled = false;
+		}
+		// Requests pushed after the queue was found empty but before the flag was cleared have not scheduled a new task, so they are handled here
+		while (!bFrameQueueShutdown && FrameQueue.Num() > 0 && !bFrameQueueProcessingScheduled.exchange(true));
+
+		if (NumFrameQueueTasksInFlight.fetch_sub(1) == 1)
+		{
+			FrameQueueTasksDoneEvent->Trigger();
+		}
+	});
+}
+
+void UAudioAnalysisToolsLibrary::WaitForFrameQueueTasks()
+{
+	// The event may have been triggered by an earlier task, so the counter is checked again after each wake up
+	while (NumFrameQueueTasksInFlight.load() > 0)
+	{
+		FrameQueueTasksDoneEvent->Wait();
+	}
+}
+
+void UAudioAnalysisToolsLibrary::ProcessFrameQueue()
+{
+	FAudioFrameRequest Request;
+
+	while (!bFrameQueueShutdown && FrameQueue.Pop(Request))
+	{
+		AudioAnalysisTrace::TraceQueueLatency(GetUniqueID(), Request.QueuedCycles);
+		CompleteFrameRequest(Request, ProcessFrameRequest(Request));
+	}
+}
+
+bool UAudioAnalysisToolsLibrary::QueueAudioFrames(const TArray<float>& AudioFrames, bool bProcessToBeatDetection)
+{
+	if (!IsInGameThread())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to queue audio frames: audio frames must be queued from the game thread"));
+		return false;
+	}
+
+	if (AudioFrames.Num() <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to queue audio frames: the number of audio frames is '%d', expected > '0'"), AudioFrames.Num());
+		return false;
+	}
+
+	UAudioAnalysisSubsystem* Subsystem = UAudioAnalysisSubsystem::Get();
+	if (!Subsystem)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to queue audio frames: the AudioAnalysisSubsystem is unavailable"));
+		return false;
+	}
+
+	Subsystem->RegisterAnalyzer(this);
+
+	// Reuses the allocation the subsystem handed back after the previous batch
+	PendingAudioFrames.Reset();
+	PendingAudioFrames.Append(AudioFrames.GetData(), AudioFrames.Num());
+	bPendingBeatDetection = bProcessToBeatDetection;
+
+	return true;
+}
+
+bool UAudioAnalysisToolsLibrary::ProcessAudioByCurrentTime(UImportedSoundWave* ImportedSoundWave, bool bProcessToBeatDetection)
+{
+	if (!ImportedSoundWave)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process audio by current time: the specified sound wave is invalid"));
+		return false;
+	}
+
+	FScopeLock Lock(&DataGuard);
+
+	const int64 FrameSize = CurrentAudioFrames.Num();
+	const int32 NumChannels = FMath::Max(ImportedSoundWave->NumChannels, 1);
+	const bool bInterleaved = ChannelMode == EAudioChannelMode::Interleaved || NumChannels == 1;
+
+	if (ChannelMode == EAudioChannelMode::SingleChannel && NumChannels > 1 && SelectedChannel >= NumChannels)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process audio by current time: the selected channel is '%d', expected < '%d'"), SelectedChannel, NumChannels);
+		return false;
+	}
+
+	// Enough frames to cover the frame size of interleaved samples, or the frame size of frames to mix down or extract the channel from
+	const int64 StartFrame = ImportedSoundWave->GetNumOfPlayedFrames();
+	const int64 EndFrame = StartFrame + (bInterleaved ? FMath::DivideAndRoundUp<int64>(FrameSize, NumChannels) : FrameSize);
+
+	// The samples are copied straight from the PCM data into the current audio frames, so the frame size is kept as is
+	const bool bRetrieved = ViewAudioByFrameRange(ImportedSoundWave, StartFrame, EndFrame, [this, FrameSize, NumChannels, bInterleaved](TArrayView64<const float> PCMData)
+	{
+		if (bInterleaved)
+		{
+			FMemory::Memcpy(CurrentAudioFrames.GetData(), PCMData.GetData(), sizeof(float) * FrameSize);
+		}
+		else
+		{
+			CopyChannelsToCurrentAudioFrames(PCMData.GetData(), NumChannels);
+		}
+	});
+
+	if (!bRetrieved)
+	{
+		return false;
+	}
+
+	ProcessCurrentAudioFrames(bProcessToBeatDetection);
+
+	return true;
+}
+
+void UAudioAnalysisToolsLibrary::ProcessCurrentAudioFrames(bool bProcessToBeatDetection)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_ProcessAudioFrames);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_ProcessAudioFrames);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
 
 	PerformFFT();
 
@@ -262,6 +792,22 @@ void UAudioAnalysisToolsLibrary::ProcessAudioFrames(TArray<float> AudioFrames, b
 	{
 		BeatDetection->ProcessMagnitude(MagnitudeSpectrum);
 	}
+
+	PublishSnapshot();
+
+	AudioAnalysisTrace::TraceFrameProcessed(GetUniqueID(), StartCycles, CurrentAudioFrames.Num());
+}
+
+void UAudioAnalysisToolsLibrary::CopyChannelsToCurrentAudioFrames(const float* InterleavedAudioFrames, int32 NumChannels)
+{
+	if (ChannelMode == EAudioChannelMode::SingleChannel)
+	{
+		UAudioChannelsLibrary::ExtractChannel(InterleavedAudioFrames, CurrentAudioFrames.Num(), NumChannels, SelectedChannel, CurrentAudioFrames.GetData());
+	}
+	else
+	{
+		UAudioChannelsLibrary::DownmixToMono(InterleavedAudioFrames, CurrentAudioFrames.Num(), NumChannels, CurrentAudioFrames.GetData());
+	}
 }
 
 void UAudioAnalysisToolsLibrary::UpdateFrameSize(int64 FrameSize)
@@ -270,7 +816,8 @@ void UAudioAnalysisToolsLibrary::UpdateFrameSize(int64 FrameSize)
 
 	CurrentAudioFrames.SetNum(FrameSize);
 
-	WindowFunction = UWindowsLibrary::CreateWindowByType(FrameSize, WindowType);
+	// The window is shared through the window cache, so switching between frame sizes does not regenerate it
+	WindowFunction = FWindowCache::Get().FindOrCreateWindow(FrameSize, WindowType);
 
 	FFTReal.SetNum(FrameSize);
 	FFTImaginary.SetNum(FrameSize);
@@ -279,170 +826,510 @@ void UAudioAnalysisToolsLibrary::UpdateFrameSize(int64 FrameSize)
 	ConfigureFFT();
 }
 
+void UAudioAnalysisToolsLibrary::SetFFTExecutionPolicy(EFFTExecutionPolicy InExecutionPolicy, int64 InParallelThreshold)
+{
+	if (InParallelThreshold <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to set the FFT execution policy: the parallel threshold is '%lld', expected > '0'"), InParallelThreshold);
+		return;
+	}
+
+	FScopeLock Lock(&DataGuard);
+
+	FFTExecutionPolicy = InExecutionPolicy;
+	FFTParallelThreshold = InParallelThreshold;
+}
+
+void UAudioAnalysisToolsLibrary::EnableStreaming(int64 HopSize, bool bProcessToBeatDetection, int64 BufferCapacity)
+{
+	FScopeLock Lock(&DataGuard);
+
+	if (bStreamingProducerAttached)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to enable streaming: a streaming producer such as a submix capture is attached. Stop it first"));
+		return;
+	}
+
+	const int64 FrameSize = CurrentAudioFrames.Num();
+
+	if (HopSize <= 0 || HopSize > FrameSize)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to enable streaming: the hop size is '%lld', expected > '0' and <= '%lld' (the frame size)"), HopSize, FrameSize);
+		return;
+	}
+
+	if (BufferCapacity == 0)
+	{
+		BufferCapacity = 4 * FrameSize;
+	}
+
+	if (BufferCapacity < FrameSize)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to enable streaming: the buffer capacity is '%lld', expected >= '%lld' (the frame size)"), BufferCapacity, FrameSize);
+		return;
+	}
+
+	StreamingBuffer.Reset(BufferCapacity);
+	bStreamingBeatDetection = bProcessToBeatDetection;
+	NumStreamingHops = 0;
+	StreamingFrameSize = FrameSize;
+	NumDroppedStreamingFrames = 0;
+	bStreamingOverflowLogged = false;
+	StreamingHopSize = HopSize;
+
+	UpdateBufferMemoryStat();
+}
+
+void UAudioAnalysisToolsLibrary::DisableStreaming()
+{
+	FScopeLock Lock(&DataGuard);
+
+	if (bStreamingProducerAttached)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to disable streaming: a streaming producer such as a submix capture is attached. Stop it first"));
+		return;
+	}
+
+	StreamingHopSize = 0;
+	StreamingBuffer.Reset(0);
+
+	UpdateBufferMemoryStat();
+}
+
+bool UAudioAnalysisToolsLibrary::IsStreaming() const
+{
+	return StreamingHopSize > 0;
+}
+
+bool UAudioAnalysisToolsLibrary::PushAudioFrames(const TArray<float>& AudioFrames)
+{
+	return PushAudioFrames64(AudioFrames.GetData(), AudioFrames.Num());
+}
+
+bool UAudioAnalysisToolsLibrary::PushAudioFrames64(const float* AudioFrames, int64 NumOfFrames)
+{
+	if (!IsStreaming())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to push audio frames: the streaming mode is disabled"));
+		return false;
+	}
+
+	const int64 NumOfPushedFrames = TryPushAudioFrames64(AudioFrames, NumOfFrames);
+
+	if (NumOfPushedFrames < NumOfFrames)
+	{
+		// A sustained overflow drops audio frames on every push, so it is logged once until the buffer has room again
+		if (!bStreamingOverflowLogged.exchange(true))
+		{
+			UE_LOG(LogAudioAnalysis, Warning, TEXT("The streaming buffer is full: dropped '%lld' of '%lld' audio frames. Further drops are counted by GetNumOfDroppedStreamingFrames"), NumOfFrames - NumOfPushedFrames, NumOfFrames);
+		}
+		return false;
+	}
+
+	bStreamingOverflowLogged = false;
+	return true;
+}
+
+int64 UAudioAnalysisToolsLibrary::TryPushAudioFrames64(const float* AudioFrames, int64 NumOfFrames)
+{
+	if (!IsStreaming())
+	{
+		return 0;
+	}
+
+	const int64 NumOfPushedFrames = StreamingBuffer.Push(AudioFrames, NumOfFrames);
+
+	if (NumOfPushedFrames < NumOfFrames)
+	{
+		NumDroppedStreamingFrames.fetch_add(NumOfFrames - NumOfPushedFrames, std::memory_order_relaxed);
+	}
+
+	// Only whole frames are analyzed, so scheduling the analysis earlier would only queue tasks with nothing to do
+	if (NumOfPushedFrames > 0 && StreamingBuffer.GetNumAvailable() >= StreamingFrameSize.load(std::memory_order_relaxed))
+	{
+		ScheduleStreamingProcessing();
+	}
+
+	return NumOfPushedFrames;
+}
+
+int64 UAudioAnalysisToolsLibrary::GetNumOfDroppedStreamingFrames() const
+{
+	return NumDroppedStreamingFrames.load(std::memory_order_relaxed);
+}
+
+int64 UAudioAnalysisToolsLibrary::GetNumOfStreamedFrames() const
+{
+	return StreamingBuffer.GetNumPushed();
+}
+
+bool UAudioAnalysisToolsLibrary::AttachStreamingProducer()
+{
+	FScopeLock Lock(&DataGuard);
+
+	if (!IsStreaming())
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to attach the streaming producer: the streaming mode is disabled"));
+		return false;
+	}
+
+	if (bStreamingProducerAttached)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to attach the streaming producer: another producer is attached, while the streaming buffer supports a single producer"));
+		return false;
+	}
+
+	bStreamingProducerAttached = true;
+	return true;
+}
+
+void UAudioAnalysisToolsLibrary::DetachStreamingProducer()
+{
+	FScopeLock Lock(&DataGuard);
+
+	bStreamingProducerAttached = false;
+}
+
+bool UAudioAnalysisToolsLibrary::IsStreamingProducerAttached() const
+{
+	FScopeLock Lock(&DataGuard);
+
+	return bStreamingProducerAttached;
+}
+
+void UAudioAnalysisToolsLibrary::ScheduleStreamingProcessing()
+{
+	// Only one analysis runs at a time, since the streaming buffer has a single consumer
+	if (bStreamingProcessingScheduled.exchange(true))
+	{
+		return;
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundHiPriTask, [WeakThis = MakeWeakObjectPtr(this), QueuedCycles = FPlatformTime::Cycles64()]()
+	{
+		if (WeakThis.IsValid())
+		{
+			AudioAnalysisTrace::TraceQueueLatency(WeakThis->GetUniqueID(), QueuedCycles);
+			WeakThis->ProcessStreamingBuffer();
+		}
+		else
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Failed to process the streamed audio frames because the AudioAnalysisToolsLibrary has been destroyed"));
+		}
+	});
+}
+
+void UAudioAnalysisToolsLibrary::ProcessStreamingBuffer()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_ProcessStreamingBuffer);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_ProcessStreamingBuffer);
+
+	int64 FrameSize;
+
+	do
+	{
+		{
+			FScopeLock Lock(&DataGuard);
+
+			FrameSize = CurrentAudioFrames.Num();
+			const int64 HopSize = FMath::Min<int64>(StreamingHopSize, FrameSize);
+
+			if (HopSize > 0 && FrameSize > StreamingBuffer.GetCapacity())
+			{
+				UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to process the streamed audio frames: the frame size ('%lld') exceeds the streaming buffer capacity ('%lld'). Enable streaming again after changing the frame size"), FrameSize, StreamingBuffer.GetCapacity());
+			}
+			else if (HopSize > 0)
+			{
+				// Each hop re-reads the overlapping part of the previous frame, so the samples are only discarded by the hop size
+				while (StreamingBuffer.GetNumAvailable() >= FrameSize)
+				{
+					StreamingBuffer.Peek(CurrentAudioFrames.GetData(), FrameSize);
+
+					ProcessCurrentAudioFrames(bStreamingBeatDetection);
+
+					StreamingBuffer.Discard(HopSize);
+
+					const int64 HopIndex = NumStreamingHops++;
+					AsyncTask(ENamedThreads::GameThread, [WeakThis = MakeWeakObjectPtr(this), HopIndex]()
+					{
+						if (WeakThis.IsValid())
+						{
+							WeakThis->OnStreamingFrameProcessedNative.Broadcast(HopIndex);
+							WeakThis->OnStreamingFrameProcessed.Broadcast(HopIndex);
+						}
+					});
+				}
+			}
+		}
+
+		bStreamingProcessingScheduled = false;
+	}
+	// Frames pushed after the last check but before the flag was cleared have not scheduled a new analysis, so they are handled here
+	while (IsStreaming() && FrameSize > 0 && StreamingBuffer.GetNumAvailable() >= FrameSize && !bStreamingProcessingScheduled.exchange(true));
+}
+
 bool UAudioAnalysisToolsLibrary::IsBeat(int64 Subband) const
 {
-	check(BeatDetection);
-	return BeatDetection->IsBeat(Subband);
+	const FAudioAnalysisSnapshot& Snapshot = GetSnapshot();
+
+	// Prevent out of array exception
+	if (!(Subband >= 0 && Subband < Snapshot.BeatSubbands.Num()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot detect a beat: FFT sub-band is '%lld', expected >= '0' and < '%lld' (the sub-band size)"), Subband, Snapshot.BeatSubbands.Num());
+		return false;
+	}
+
+	return UBeatDetection::CountBeats(Snapshot.BeatMask, Subband, Subband) > 0;
 }
 
 bool UAudioAnalysisToolsLibrary::IsKick() const
 {
-	check(BeatDetection);
-	return BeatDetection->IsKick();
+	return GetSnapshot().bIsKick;
 }
 
 bool UAudioAnalysisToolsLibrary::IsSnare() const
 {
-	check(BeatDetection);
-	return BeatDetection->IsSnare();
+	return GetSnapshot().bIsSnare;
 }
 
 bool UAudioAnalysisToolsLibrary::IsHiHat() const
 {
-	check(BeatDetection);
-	return BeatDetection->IsHiHat();
+	return GetSnapshot().bIsHiHat;
 }
 
 bool UAudioAnalysisToolsLibrary::IsBeatRange(int64 Low, int64 High, int64 Threshold) const
 {
-	check(BeatDetection);
-	return BeatDetection->IsBeatRange(Low, High, Threshold);
+	const FAudioAnalysisSnapshot& Snapshot = GetSnapshot();
+	const int64 FFTSubbandSize = Snapshot.BeatSubbands.Num();
+
+	if (!(Low >= 0 && Low < FFTSubbandSize))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot detect if the beat is in range: the low sub-band is '%lld', expected to be >= '0' and < '%lld'"), Low, FFTSubbandSize);
+		return false;
+	}
+
+	if (!(High >= 0 && High < FFTSubbandSize))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot detect if the beat is in range: the high sub-band is '%lld', expected to be >= '0', < '%lld'"), High, FFTSubbandSize);
+		return false;
+	}
+
+	if (!(High > Low))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot detect if the beat is in range: the high sub-band ('%lld') must be greater than the low sub-band ('%lld')"), High, Low);
+		return false;
+	}
+
+	return UBeatDetection::CountBeats(Snapshot.BeatMask, Low, High) > Threshold;
 }
 
 float UAudioAnalysisToolsLibrary::GetBand(int64 Subband) const
 {
-	check(BeatDetection);
-	return BeatDetection->GetBand(Subband);
+	const FAudioAnalysisSnapshot& Snapshot = GetSnapshot();
+
+	if (!(Subband >= 0 && Subband < Snapshot.BeatSubbands.Num()))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Cannot obtain FFT sub-band: the specified sub-band is '%lld', but it is expected to be >= '0' and < '%lld'"), Subband, Snapshot.BeatSubbands.Num());
+		return -1;
+	}
+
+	return Snapshot.BeatSubbands[Subband];
 }
 
 float UAudioAnalysisToolsLibrary::GetRootMeanSquare()
 {
-	return UCoreTimeDomainFeatures::GetRootMeanSquare(CurrentAudioFrames);
+	return GetTimeDomainFeatures().RootMeanSquare;
 }
 
 float UAudioAnalysisToolsLibrary::GetPeakEnergy()
 {
-	return UCoreTimeDomainFeatures::GetPeakEnergy(CurrentAudioFrames);
+	return GetTimeDomainFeatures().PeakEnergy;
 }
 
 float UAudioAnalysisToolsLibrary::GetZeroCrossingRate()
 {
-	return UCoreTimeDomainFeatures::GetZeroCrossingRate(CurrentAudioFrames);
+	return GetTimeDomainFeatures().ZeroCrossingRate;
+}
+
+FTimeDomainFeatureSet UAudioAnalysisToolsLibrary::GetTimeDomainFeatures()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetTimeDomainFeatures);
+
+	// The snapshot is owned by the reader, so the features can be cached in it without locking
+	FAudioAnalysisSnapshot& Snapshot = GetSnapshot();
+
+	if (!Snapshot.bTimeDomainFeaturesComputed)
+	{
+		Snapshot.TimeDomainFeatures = UCoreTimeDomainFeatures::GetTimeDomainFeatures(Snapshot.AudioFrames);
+		Snapshot.bTimeDomainFeaturesComputed = true;
+	}
+
+	return Snapshot.TimeDomainFeatures;
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralCentroid()
 {
-	return UCoreFrequencyDomainFeatures::GetSpectralCentroid(MagnitudeSpectrum);
+	return GetSpectralFeatures(1 << static_cast<int32>(ESpectralFeature::Centroid)).SpectralCentroid;
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralFlatness()
 {
-	return UCoreFrequencyDomainFeatures::GetSpectralFlatness(MagnitudeSpectrum);
+	return GetSpectralFeatures(1 << static_cast<int32>(ESpectralFeature::Flatness)).SpectralFlatness;
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralCrest()
 {
-	return UCoreFrequencyDomainFeatures::GetSpectralCrest(MagnitudeSpectrum);
+	return GetSpectralFeatures(1 << static_cast<int32>(ESpectralFeature::Crest)).SpectralCrest;
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralRolloff()
 {
-	return UCoreFrequencyDomainFeatures::GetSpectralRolloff(MagnitudeSpectrum);
+	return GetSpectralFeatures(1 << static_cast<int32>(ESpectralFeature::Rolloff)).SpectralRolloff;
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralKurtosis()
 {
-	return UCoreFrequencyDomainFeatures::GetSpectralKurtosis(MagnitudeSpectrum);
+	return GetSpectralFeatures(1 << static_cast<int32>(ESpectralFeature::Kurtosis)).SpectralKurtosis;
+}
+
+FSpectralFeatureSet UAudioAnalysisToolsLibrary::GetSpectralFeatures(int32 FeatureMask)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetSpectralFeatures);
+
+	// The snapshot is owned by the reader, so the features can be cached in it without locking
+	FAudioAnalysisSnapshot& Snapshot = GetSnapshot();
+
+	// Only the features not requested since the snapshot was published are computed
+	const int32 MissingFeatureMask = FeatureMask & AllSpectralFeatures & ~Snapshot.SpectralFeatures.FeatureMask;
+
+	if (MissingFeatureMask != 0)
+	{
+		Snapshot.SpectralFeatures.Merge(UCoreFrequencyDomainFeatures::GetSpectralFeatures(Snapshot.MagnitudeSpectrum, MissingFeatureMask));
+	}
+
+	return Snapshot.SpectralFeatures;
 }
 
 float UAudioAnalysisToolsLibrary::GetEnergyDifference()
 {
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetEnergyDifference);
+
 	check(OnsetDetection);
-	return OnsetDetection->GetEnergyDifference(CurrentAudioFrames);
+
+	// The sum of squares is shared with the other time domain features of the same frame
+	return OnsetDetection->GetEnergyDifferenceFromSum(GetTimeDomainFeatures().SumOfSquares);
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralDifference()
 {
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetSpectralDifference);
+
 	check(OnsetDetection);
-	return OnsetDetection->GetSpectralDifference(MagnitudeSpectrum);
+	return OnsetDetection->GetSpectralDifference(GetSnapshot().MagnitudeSpectrum);
 }
 
 float UAudioAnalysisToolsLibrary::GetSpectralDifferenceHWR()
 {
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetSpectralDifferenceHWR);
+
 	check(OnsetDetection);
-	return OnsetDetection->GetSpectralDifferenceHWR(MagnitudeSpectrum);
+	return OnsetDetection->GetSpectralDifferenceHWR(GetSnapshot().MagnitudeSpectrum);
 }
 
 float UAudioAnalysisToolsLibrary::GetComplexSpectralDifference()
 {
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetComplexSpectralDifference);
+
 	check(OnsetDetection);
-	return OnsetDetection->GetComplexSpectralDifference(FFTReal, FFTImaginary);
+	const FAudioAnalysisSnapshot& Snapshot = GetSnapshot();
+	return OnsetDetection->GetComplexSpectralDifference(Snapshot.FFTReal, Snapshot.FFTImaginary);
 }
 
 float UAudioAnalysisToolsLibrary::GetHighFrequencyContent()
 {
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetHighFrequencyContent);
+
 	check(OnsetDetection);
-	return OnsetDetection->GetHighFrequencyContent(MagnitudeSpectrum);
+	return OnsetDetection->GetHighFrequencyContent(GetSnapshot().MagnitudeSpectrum);
 }
 
-void UAudioAnalysisToolsLibrary::ConfigureFFT()
+TArray<float> UAudioAnalysisToolsLibrary::GetMelBandEnergies(int32 SampleRate, int32 NumOfBands)
 {
-	if (FFTConfigured)
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetMelBandEnergies);
+
+	if (NumOfBands <= 0)
 	{
-		FreeFFT();
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the Mel band energies: the number of bands is '%d', expected > '0'"), NumOfBands);
+		return TArray<float>();
 	}
 
-	const int64 FrameSize = CurrentAudioFrames.Num();
+	TArray<float> BandEnergies;
+	BandEnergies.SetNumUninitialized(NumOfBands);
 
-	FFT_InSamples = new FFTComplexSamples[FrameSize];
-	FFT_OutSamples = new FFTComplexSamples[FrameSize];
-	FFT_Configuration = UFFTAudioAnalyzer::PerformFFTAlloc(FrameSize, 0, nullptr, nullptr);
+	// The filterbank runs on the magnitude spectrum of the snapshot directly, without copying it
+	if (!UMelFrequencyFeatures::GetMelBandEnergies(GetSnapshot().MagnitudeSpectrum, SampleRate, BandEnergies))
+	{
+		return TArray<float>();
+	}
 
-	FFTConfigured = true;
+	return BandEnergies;
 }
 
-void UAudioAnalysisToolsLibrary::FreeFFT()
+TArray<float> UAudioAnalysisToolsLibrary::GetMFCC(int32 SampleRate, int32 NumOfBands, int32 NumOfCoefficients)
 {
-	// Free the Kiss FFT configuration
-	FMemory::Free(FFT_Configuration);
-
-	delete[] FFT_InSamples;
-	delete[] FFT_OutSamples;
-
-	FFT_Configuration = nullptr;
-	FFT_InSamples = nullptr;
-	FFT_OutSamples = nullptr;
-}
+	SCOPE_CYCLE_COUNTER(STAT_AudioAnalysis_GetFeature);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AudioAnalysis_GetMFCC);
 
-void UAudioAnalysisToolsLibrary::PerformFFT()
-{
-	if (!FFT_InSamples || !FFT_OutSamples || !FFT_Configuration)
+	if (NumOfCoefficients <= 0)
 	{
-		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to perform FFT analysis because the buffers are invalid"));
-		return;
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to get the MFCC: the number of coefficients is '%d', expected > '0'"), NumOfCoefficients);
+		return TArray<float>();
 	}
 
-	const int64 FrameSize = CurrentAudioFrames.Num();
+	TArray<float> Coefficients;
+	Coefficients.SetNumUninitialized(NumOfCoefficients);
 
-	for (int64 Index = 0; Index < FrameSize; ++Index)
+	if (!UMelFrequencyFeatures::GetMFCC(GetSnapshot().MagnitudeSpectrum, SampleRate, NumOfBands, Coefficients))
 	{
-		FFT_InSamples[Index].Real = CurrentAudioFrames[Index] * WindowFunction[Index];
-		FFT_InSamples[Index].Imaginary = 0.0;
+		return TArray<float>();
 	}
 
-	// Execute kiss fft
-	UFFTAudioAnalyzer::PerformFFT(FFT_Configuration, FFT_InSamples, FFT_OutSamples);
+	return Coefficients;
+}
 
-	// Store real and imaginary parts of FFT
-	for (int64 Index = 0; Index < FrameSize; ++Index)
+void UAudioAnalysisToolsLibrary::ConfigureFFT()
+{
+	if (FFTConfigured)
 	{
-		FFTReal[Index] = FFT_OutSamples[Index].Real;
-		FFTImaginary[Index] = FFT_OutSamples[Index].Imaginary;
+		FreeFFT();
 	}
 
-	// Calculate the magnitude spectrum
-	for (int64 Index = 0; Index < FrameSize / 2; ++Index)
+	FFTConfigured = SpectrumAnalyzer.Configure(CurrentAudioFrames.Num());
+}
+
+void UAudioAnalysisToolsLibrary::FreeFFT()
+{
+	SpectrumAnalyzer.Reset();
+	FFTConfigured = false;
+}
+
+void UAudioAnalysisToolsLibrary::PerformFFT()
+{
+	if (!WindowFunction.IsValid())
 	{
-		MagnitudeSpectrum[Index] = FMath::Sqrt(FMath::Pow(FFTReal[Index], 2) + FMath::Pow(FFTImaginary[Index], 2));
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to perform FFT analysis because the window function is invalid"));
+		return;
 	}
+
+	const bool bParallel = UFFTAudioAnalyzer::ShouldRunInParallel(FFTExecutionPolicy, CurrentAudioFrames.Num(), FFTParallelThreshold);
+
+	SpectrumAnalyzer.Process(CurrentAudioFrames.GetData(), WindowFunction->GetData(), FFTReal.GetData(), FFTImaginary.GetData(), MagnitudeSpectrum.GetData(), bParallel);
 }
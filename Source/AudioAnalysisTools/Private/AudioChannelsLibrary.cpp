@@ -0,0 +1,146 @@
+// Georgy Treshchev 2024.
+
+#include "AudioChannelsLibrary.h"
+#include "AudioAnalysisToolsDefines.h"
+
+#include "Math/VectorRegister.h"
+#include "Misc/EngineVersionComparison.h"
+
+#if UE_VERSION_OLDER_THAN(5, 0, 0)
+using VectorRegister4Float = VectorRegister;
+#endif
+
+TArray<float> UAudioChannelsLibrary::DownmixToMono(const TArray<float>& InterleavedAudioFrames, int32 NumChannels)
+{
+	if (NumChannels <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to mix down to mono: the number of channels is '%d', expected > '0'"), NumChannels);
+		return TArray<float>();
+	}
+
+	const int32 NumOfFrames = InterleavedAudioFrames.Num() / NumChannels;
+
+	TArray<float> MonoAudioFrames;
+	MonoAudioFrames.SetNumUninitialized(NumOfFrames);
+	DownmixToMono(InterleavedAudioFrames.GetData(), NumOfFrames, NumChannels, MonoAudioFrames.GetData());
+
+	return MonoAudioFrames;
+}
+
+void UAudioChannelsLibrary::DownmixToMono(const float* RESTRICT InterleavedAudioFrames, int64 NumOfFrames, int32 NumChannels, float* RESTRICT MonoAudioFrames)
+{
+	if (NumChannels == 1)
+	{
+		FMemory::Memcpy(MonoAudioFrames, InterleavedAudioFrames, sizeof(float) * NumOfFrames);
+		return;
+	}
+
+	int64 FrameIndex = 0;
+
+	if (NumChannels == 2)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		const VectorRegister4Float ChannelGain = VectorSetFloat1(0.5f);
+
+		for (; FrameIndex + 4 <= NumOfFrames; FrameIndex += 4)
+		{
+			const VectorRegister4Float FirstFrames = VectorLoad(InterleavedAudioFrames + FrameIndex * 2);
+			const VectorRegister4Float SecondFrames = VectorLoad(InterleavedAudioFrames + FrameIndex * 2 + 4);
+
+			// Gather the left and the right samples of the four frames
+			const VectorRegister4Float LeftSamples = VectorShuffle(FirstFrames, SecondFrames, 0, 2, 0, 2);
+			const VectorRegister4Float RightSamples = VectorShuffle(FirstFrames, SecondFrames, 1, 3, 1, 3);
+
+			VectorStore(VectorMultiply(VectorAdd(LeftSamples, RightSamples), ChannelGain), MonoAudioFrames + FrameIndex);
+		}
+#endif
+
+		for (; FrameIndex < NumOfFrames; ++FrameIndex)
+		{
+			MonoAudioFrames[FrameIndex] = (InterleavedAudioFrames[FrameIndex * 2] + InterleavedAudioFrames[FrameIndex * 2 + 1]) * 0.5f;
+		}
+		return;
+	}
+
+	const float ChannelGain = 1.f / NumChannels;
+
+	for (; FrameIndex < NumOfFrames; ++FrameIndex)
+	{
+		const float* InterleavedFrame = InterleavedAudioFrames + FrameIndex * NumChannels;
+
+		float MonoSample = 0;
+		for (int32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
+		{
+			MonoSample += InterleavedFrame[ChannelIndex];
+		}
+
+		MonoAudioFrames[FrameIndex] = MonoSample * ChannelGain;
+	}
+}
+
+TArray<float> UAudioChannelsLibrary::ExtractChannel(const TArray<float>& InterleavedAudioFrames, int32 NumChannels, int32 Channel)
+{
+	if (NumChannels <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to extract the channel: the number of channels is '%d', expected > '0'"), NumChannels);
+		return TArray<float>();
+	}
+
+	if (!(Channel >= 0 && Channel < NumChannels))
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to extract the channel: the channel is '%d', expected >= '0' and < '%d'"), Channel, NumChannels);
+		return TArray<float>();
+	}
+
+	const int32 NumOfFrames = InterleavedAudioFrames.Num() / NumChannels;
+
+	TArray<float> ChannelAudioFrames;
+	ChannelAudioFrames.SetNumUninitialized(NumOfFrames);
+	ExtractChannel(InterleavedAudioFrames.GetData(), NumOfFrames, NumChannels, Channel, ChannelAudioFrames.GetData());
+
+	return ChannelAudioFrames;
+}
+
+void UAudioChannelsLibrary::ExtractChannel(const float* RESTRICT InterleavedAudioFrames, int64 NumOfFrames, int32 NumChannels, int32 Channel, float* RESTRICT ChannelAudioFrames)
+{
+	const float* ChannelSamples = InterleavedAudioFrames + Channel;
+
+	for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+	{
+		ChannelAudioFrames[FrameIndex] = ChannelSamples[FrameIndex * NumChannels];
+	}
+}
+
+void UAudioChannelsLibrary::Deinterleave(const float* InterleavedAudioFrames, int64 NumOfFrames, int32 NumChannels, TArray<TArray64<float>>& ChannelAudioFrames)
+{
+	ChannelAudioFrames.SetNum(NumChannels);
+
+	for (TArray64<float>& SingleChannelAudioFrames : ChannelAudioFrames)
+	{
+		SingleChannelAudioFrames.SetNumUninitialized(NumOfFrames);
+	}
+
+	// Stereo is the common case, so its two output streams are written in a single pass
+	if (NumChannels == 2)
+	{
+		float* RESTRICT LeftAudioFrames = ChannelAudioFrames[0].GetData();
+		float* RESTRICT RightAudioFrames = ChannelAudioFrames[1].GetData();
+
+		for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+		{
+			LeftAudioFrames[FrameIndex] = InterleavedAudioFrames[FrameIndex * 2];
+			RightAudioFrames[FrameIndex] = InterleavedAudioFrames[FrameIndex * 2 + 1];
+		}
+		return;
+	}
+
+	for (int64 FrameIndex = 0; FrameIndex < NumOfFrames; ++FrameIndex)
+	{
+		const float* InterleavedFrame = InterleavedAudioFrames + FrameIndex * NumChannels;
+
+		for (int32 ChannelIndex = 0; ChannelIndex < NumChannels; ++ChannelIndex)
+		{
+			ChannelAudioFrames[ChannelIndex][FrameIndex] = InterleavedFrame[ChannelIndex];
+		}
+	}
+}
@@ -0,0 +1,632 @@
+// Georgy Treshchev 2024.
+
+#include "AudioAnalysisToolsDefines.h"
+#include "AudioAnalysisToolsLibrary.h"
+
+#include "Analyzers/BandTriggerDetector.h"
+#include "Analyzers/BeatDetection.h"
+#include "Analyzers/CoreFrequencyDomainFeatures.h"
+#include "Analyzers/CoreTimeDomainFeatures.h"
+#include "Analyzers/FFTAudioAnalyzer.h"
+#include "Analyzers/FFTPlanCache.h"
+#include "Analyzers/MelFrequencyFeatures.h"
+#include "Analyzers/OnsetDetection.h"
+#include "Analyzers/SpectrumAnalyzer.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/MemoryBase.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#if UE_VERSION_OLDER_THAN(5, 5, 0)
+#define AUDIO_ANALYSIS_BENCHMARK_FLAGS (EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+#define AUDIO_ANALYSIS_TEST_FLAGS (EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+#else
+#define AUDIO_ANALYSIS_BENCHMARK_FLAGS (EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+#define AUDIO_ANALYSIS_TEST_FLAGS (EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+#endif
+
+namespace AudioAnalysisBenchmarks
+{
+	/** The minimum time each benchmark is measured for */
+	constexpr double MinMeasureSeconds = 0.05;
+
+	/** The minimum number of measured iterations of each benchmark */
+	constexpr int64 MinIterations = 16;
+
+	/** The number of iterations run before measuring, so that lazily allocated scratch memory and caches are warmed up */
+	constexpr int64 WarmUpIterations = 4;
+
+	/** The maximum error of the FFT relative to the largest magnitude of the reference DFT */
+	constexpr double MaxRelativeFFTError = 1e-4;
+
+	/** The FFT sizes: powers of two, 3 * 2^k, 4410 (100 ms at 44.1 kHz) and primes */
+	const int64 FFTSizes[] = {256, 512, 1024, 2048, 4096, 8192, 384, 768, 1536, 3072, 6144, 4410, 257, 1021, 4099};
+
+	/** The sample rate and the hop size of the band trigger detector benchmark */
+	constexpr int32 BandTriggerSampleRate = 44100;
+	constexpr int64 BandTriggerHopSize = 128;
+
+	/** The history lengths of the beat detection benchmark */
+	const int64 EnergyHistorySizes[] = {11, 41, 86, 172, 344};
+
+	/**
+	 * Counts the allocations made by the benchmark thread, forwarding all the calls to the allocator in use
+	 * Installed as GMalloc while a benchmark is measured. The allocations made by the inlined allocator fast paths of some configurations bypass it
+	 */
+	class FAllocationCounter final : public FMalloc
+	{
+	public:
+		void Begin()
+		{
+			ThreadId = FPlatformTLS::GetCurrentThreadId();
+			NumAllocations = 0;
+			InnerMalloc = GMalloc;
+			GMalloc = this;
+		}
+
+		int64 End()
+		{
+			GMalloc = InnerMalloc;
+			return NumAllocations;
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			InnerMalloc->Free(Original);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return InnerMalloc->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return InnerMalloc->QuantizeSize(Count, Alignment);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			InnerMalloc->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return InnerMalloc->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			return InnerMalloc->ValidateHeap();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("AudioAnalysisAllocationCounter");
+		}
+
+	private:
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				++NumAllocations;
+			}
+		}
+
+		FMalloc* InnerMalloc = nullptr;
+		uint32 ThreadId = 0;
+		int64 NumAllocations = 0;
+	};
+
+	/** Never destroyed, since other threads may still be calling it right after it has been uninstalled */
+	FAllocationCounter& GetAllocationCounter()
+	{
+		static FAllocationCounter* AllocationCounter = new FAllocationCounter();
+		return *AllocationCounter;
+	}
+
+	/**
+	 * Result of a single benchmark
+	 */
+	struct FBenchmarkResult
+	{
+		FString Name;
+		int64 Size;
+		int64 Iterations;
+		double NanosecondsPerFrame;
+		double AllocationsPerFrame;
+	};
+
+	/**
+	 * Measure the given function, each call processing a single frame
+	 *
+	 * @param Name The name of the benchmark
+	 * @param Size The size of the processed frame
+	 * @param Function The function to measure
+	 * @return The benchmark result
+	 */
+	template <typename FunctionType>
+	FBenchmarkResult Measure(const FString& Name, int64 Size, FunctionType&& Function)
+	{
+		for (int64 Iteration = 0; Iteration < WarmUpIterations; ++Iteration)
+		{
+			Function();
+		}
+
+		FAllocationCounter& AllocationCounter = GetAllocationCounter();
+		AllocationCounter.Begin();
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		uint64 EndCycles;
+		int64 Iterations = 0;
+
+		do
+		{
+			Function();
+			++Iterations;
+			EndCycles = FPlatformTime::Cycles64();
+		}
+		while (Iterations < MinIterations || FPlatformTime::ToSeconds64(EndCycles - StartCycles) < MinMeasureSeconds);
+
+		const int64 NumAllocations = AllocationCounter.End();
+
+		FBenchmarkResult Result;
+		Result.Name = Name;
+		Result.Size = Size;
+		Result.Iterations = Iterations;
+		Result.NanosecondsPerFrame = FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1e9 / Iterations;
+		Result.AllocationsPerFrame = static_cast<double>(NumAllocations) / Iterations;
+		return Result;
+	}
+
+	/**
+	 * Log the results and save them as CSV and JSON to the AudioAnalysisBenchmarks directory of the project saved directory
+	 *
+	 * @param Test The running test
+	 * @param ReportName The name of the report files
+	 * @param Results The benchmark results
+	 */
+	void SaveReport(FAutomationTestBase& Test, const FString& ReportName, const TArray<FBenchmarkResult>& Results)
+	{
+		FString CSV = TEXT("Name,Size,Iterations,NanosecondsPerFrame,AllocationsPerFrame\n");
+		FString JSON = TEXT("[\n");
+
+		for (int32 ResultIndex = 0; ResultIndex < Results.Num(); ++ResultIndex)
+		{
+			const FBenchmarkResult& Result = Results[ResultIndex];
+
+			CSV += FString::Printf(TEXT("%s,%lld,%lld,%.1f,%.3f\n"), *Result.Name, Result.Size, Result.Iterations, Result.NanosecondsPerFrame, Result.AllocationsPerFrame);
+			JSON += FString::Printf(TEXT("\t{\"name\": \"%s\", \"size\": %lld, \"iterations\": %lld, \"ns_per_frame\": %.1f, \"allocations_per_frame\": %.3f}%s\n"),
+			                        *Result.Name, Result.Size, Result.Iterations, Result.NanosecondsPerFrame, Result.AllocationsPerFrame, ResultIndex + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+
+			Test.AddInfo(FString::Printf(TEXT("%s (size %lld): %.1f ns/frame, %.3f allocations/frame"), *Result.Name, Result.Size, Result.NanosecondsPerFrame, Result.AllocationsPerFrame));
+		}
+
+		JSON += TEXT("]\n");
+
+		const FString ReportDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AudioAnalysisBenchmarks"));
+		const FString CSVPath = FPaths::Combine(ReportDirectory, ReportName + TEXT(".csv"));
+		const FString JSONPath = FPaths::Combine(ReportDirectory, ReportName + TEXT(".json"));
+
+		if (!FFileHelper::SaveStringToFile(CSV, *CSVPath) || !FFileHelper::SaveStringToFile(JSON, *JSONPath))
+		{
+			Test.AddWarning(FString::Printf(TEXT("Failed to save the benchmark report to '%s'"), *ReportDirectory));
+			return;
+		}
+
+		UE_LOG(LogAudioAnalysis, Log, TEXT("Saved the benchmark report to '%s' and '%s'"), *CSVPath, *JSONPath);
+	}
+
+	/** Fill the array with deterministic noise in the range from -1 to 1 */
+	void FillWithNoise(TArrayView64<float> Samples, int32 Seed)
+	{
+		FRandomStream RandomStream(Seed);
+		for (float& Sample : Samples)
+		{
+			Sample = RandomStream.FRandRange(-1.f, 1.f);
+		}
+	}
+
+	/**
+	 * Compute the reference DFT in double precision
+	 *
+	 * @param InReal The real parts of the input
+	 * @param InImaginary The imaginary parts of the input
+	 * @param OutReal The real parts of the DFT
+	 * @param OutImaginary The imaginary parts of the DFT
+	 */
+	void ComputeReferenceDFT(TArrayView64<const float> InReal, TArrayView64<const float> InImaginary, TArray64<double>& OutReal, TArray64<double>& OutImaginary)
+	{
+		const int64 NFFT = InReal.Num();
+
+		OutReal.SetNumZeroed(NFFT);
+		OutImaginary.SetNumZeroed(NFFT);
+
+		for (int64 Bin = 0; Bin < NFFT; ++Bin)
+		{
+			double SumReal = 0, SumImaginary = 0;
+			for (int64 Index = 0; Index < NFFT; ++Index)
+			{
+				// Bin * Index is wrapped by NFFT to keep the phase precise for large sizes
+				const double Phase = -2 * PI * static_cast<double>((Bin * Index) % NFFT) / NFFT;
+				const double Cos = FMath::Cos(Phase), Sin = FMath::Sin(Phase);
+
+				SumReal += InReal[Index] * Cos - InImaginary[Index] * Sin;
+				SumImaginary += InReal[Index] * Sin + InImaginary[Index] * Cos;
+			}
+			OutReal[Bin] = SumReal;
+			OutImaginary[Bin] = SumImaginary;
+		}
+	}
+
+	/**
+	 * Get the largest error of the FFT relative to the largest magnitude of the reference DFT
+	 */
+	double GetRelativeFFTError(const TArray64<double>& ReferenceReal, const TArray64<double>& ReferenceImaginary, TFunctionRef<float(int64)> GetReal, TFunctionRef<float(int64)> GetImaginary)
+	{
+		double MaxMagnitude = 0, MaxError = 0;
+
+		for (int64 Bin = 0; Bin < ReferenceReal.Num(); ++Bin)
+		{
+			MaxMagnitude = FMath::Max(MaxMagnitude, FMath::Sqrt(ReferenceReal[Bin] * ReferenceReal[Bin] + ReferenceImaginary[Bin] * ReferenceImaginary[Bin]));
+
+			const double ErrorReal = GetReal(Bin) - ReferenceReal[Bin];
+			const double ErrorImaginary = GetImaginary(Bin) - ReferenceImaginary[Bin];
+			MaxError = FMath::Max(MaxError, FMath::Sqrt(ErrorReal * ErrorReal + ErrorImaginary * ErrorImaginary));
+		}
+
+		return MaxMagnitude > 0 ? MaxError / MaxMagnitude : MaxError;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAudioAnalysisFFTBenchmark, "AudioAnalysisTools.Benchmarks.FFT", AUDIO_ANALYSIS_BENCHMARK_FLAGS)
+
+bool FAudioAnalysisFFTBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace AudioAnalysisBenchmarks;
+
+	TArray<FBenchmarkResult> Results;
+
+	for (const int64 NFFT : FFTSizes)
+	{
+		TArray64<float> InReal, InImaginary;
+		InReal.SetNumUninitialized(NFFT);
+		InImaginary.SetNumUninitialized(NFFT);
+		FillWithNoise(InReal, static_cast<int32>(NFFT));
+		FillWithNoise(InImaginary, static_cast<int32>(NFFT) + 1);
+
+		TArray64<double> ReferenceReal, ReferenceImaginary;
+		ComputeReferenceDFT(InReal, InImaginary, ReferenceReal, ReferenceImaginary);
+
+		// The complex mixed-radix FFT
+		{
+			const FFFTPlanPtr Plan = FFFTPlanCache::Get().FindOrCreatePlan(NFFT, false, false);
+			if (!TestTrue(FString::Printf(TEXT("Complex FFT plan of size %lld is valid"), NFFT), Plan.IsValid()))
+			{
+				continue;
+			}
+
+			TArray64<FFTComplexSamples> SamplesIn, SamplesOut, Scratch;
+			SamplesIn.SetNumUninitialized(NFFT);
+			SamplesOut.SetNumUninitialized(NFFT);
+			Scratch.SetNumUninitialized(Plan->GetState()->ScratchLength);
+
+			for (int64 Index = 0; Index < NFFT; ++Index)
+			{
+				SamplesIn[Index] = {InReal[Index], InImaginary[Index]};
+			}
+
+			UFFTAudioAnalyzer::PerformFFT(Plan->GetState(), SamplesIn.GetData(), SamplesOut.GetData(), false, Scratch.GetData());
+
+			const double Error = GetRelativeFFTError(ReferenceReal, ReferenceImaginary, [&SamplesOut](int64 Bin) { return SamplesOut[Bin].Real; }, [&SamplesOut](int64 Bin) { return SamplesOut[Bin].Imaginary; });
+			TestTrue(FString::Printf(TEXT("PerformFFT of size %lld matches the reference DFT (relative error %g)"), NFFT, Error), Error < MaxRelativeFFTError);
+
+			Results.Add(Measure(TEXT("PerformFFT"), NFFT, [&]()
+			{
+				UFFTAudioAnalyzer::PerformFFT(Plan->GetState(), SamplesIn.GetData(), SamplesOut.GetData(), false, Scratch.GetData());
+			}));
+		}
+
+		// The split-complex FFT used by the analyzers, real for even sizes
+		{
+			FSpectrumAnalyzer SpectrumAnalyzer;
+			if (!TestTrue(FString::Printf(TEXT("Spectrum analyzer of size %lld is configured"), NFFT), SpectrumAnalyzer.Configure(NFFT)))
+			{
+				continue;
+			}
+
+			TArray64<float> RectangularWindow, OutReal, OutImaginary, MagnitudeSpectrum;
+			RectangularWindow.Init(1.f, NFFT);
+			OutReal.SetNumZeroed(NFFT);
+			OutImaginary.SetNumZeroed(NFFT);
+			MagnitudeSpectrum.SetNumZeroed(NFFT / 2);
+
+			TArray64<float> ZeroImaginary;
+			ZeroImaginary.SetNumZeroed(NFFT);
+
+			TArray64<double> RealReferenceReal, RealReferenceImaginary;
+			ComputeReferenceDFT(InReal, ZeroImaginary, RealReferenceReal, RealReferenceImaginary);
+
+			SpectrumAnalyzer.Process(InReal.GetData(), RectangularWindow.GetData(), OutReal.GetData(), OutImaginary.GetData(), MagnitudeSpectrum.GetData());
+
+			const double Error = GetRelativeFFTError(RealReferenceReal, RealReferenceImaginary, [&OutReal](int64 Bin) { return OutReal[Bin]; }, [&OutImaginary](int64 Bin) { return OutImaginary[Bin]; });
+			TestTrue(FString::Printf(TEXT("Spectrum analyzer of size %lld matches the reference DFT (relative error %g)"), NFFT, Error), Error < MaxRelativeFFTError);
+
+			Results.Add(Measure(TEXT("SpectrumAnalyzer"), NFFT, [&]()
+			{
+				SpectrumAnalyzer.Process(InReal.GetData(), RectangularWindow.GetData(), OutReal.GetData(), OutImaginary.GetData(), MagnitudeSpectrum.GetData());
+			}));
+		}
+
+		// The sliding DFT band triggers with the default bands, over the same NFFT audio frames as one spectrum analyzer frame
+		// The bands are evaluated every BandTriggerHopSize audio frames, so matching that latency with FFTs costs NFFT / BandTriggerHopSize spectrum analyzer frames
+		{
+			const int64 HopSize = FMath::Min<int64>(BandTriggerHopSize, NFFT);
+
+			UBandTriggerDetector* BandTriggerDetector = UBandTriggerDetector::CreateBandTriggerDetector(BandTriggerSampleRate, TArray<FBandTriggerRange>(), NFFT, HopSize);
+			if (!TestNotNull(FString::Printf(TEXT("Band trigger detector of size %lld is created"), NFFT), BandTriggerDetector))
+			{
+				continue;
+			}
+
+			Results.Add(Measure(TEXT("BandTriggerDetector"), NFFT, [&]()
+			{
+				BandTriggerDetector->ProcessAudioFrames(TArrayView64<const float>(InReal));
+			}));
+		}
+	}
+
+	SaveReport(*this, TEXT("FFT"), Results);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAudioAnalysisRealFFTRoundTripTest, "AudioAnalysisTools.FFT.RealRoundTrip", AUDIO_ANALYSIS_TEST_FLAGS)
+
+bool FAudioAnalysisRealFFTRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace AudioAnalysisBenchmarks;
+
+	// The inverse real FFT is not implemented, so such a plan must be rejected instead of producing a wrong result
+	AddExpectedError(TEXT("the inverse real FFT is not supported"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("Unable to create the FFT plan with size"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestFalse(TEXT("Inverse real FFT plan is rejected"), FFFTPlanCache::Get().FindOrCreatePlan(1024, true, true).IsValid());
+
+	for (const int64 NFFT : FFTSizes)
+	{
+		if (NFFT % 2 != 0)
+		{
+			continue;
+		}
+
+		const FFFTPlanPtr ForwardPlan = FFFTPlanCache::Get().FindOrCreatePlan(NFFT, false, true);
+		const FFFTPlanPtr InversePlan = FFFTPlanCache::Get().FindOrCreatePlan(NFFT, true, false);
+		if (!TestTrue(FString::Printf(TEXT("Real FFT plans of size %lld are valid"), NFFT), ForwardPlan.IsValid() && InversePlan.IsValid()))
+		{
+			continue;
+		}
+
+		TArray64<float> Samples;
+		Samples.SetNumUninitialized(NFFT);
+		FillWithNoise(Samples, static_cast<int32>(NFFT));
+
+		const int64 NumOfBins = NFFT / 2 + 1;
+
+		TArray64<FFTComplexSamples> HalfSpectrum, Spectrum, RoundTrip;
+		HalfSpectrum.SetNumUninitialized(NumOfBins);
+		Spectrum.SetNumUninitialized(NFFT);
+		RoundTrip.SetNumUninitialized(NFFT);
+
+		UFFTAudioAnalyzer::PerformFFTReal(ForwardPlan->GetRealState(), Samples.GetData(), HalfSpectrum.GetData());
+
+		// Restore the redundant half of the spectrum from the Hermitian symmetry of the real input
+		for (int64 Bin = 0; Bin < NumOfBins; ++Bin)
+		{
+			Spectrum[Bin] = HalfSpectrum[Bin];
+		}
+		for (int64 Bin = NumOfBins; Bin < NFFT; ++Bin)
+		{
+			Spectrum[Bin] = {HalfSpectrum[NFFT - Bin].Real, -HalfSpectrum[NFFT - Bin].Imaginary};
+		}
+
+		UFFTAudioAnalyzer::PerformFFT(InversePlan->GetState(), Spectrum.GetData(), RoundTrip.GetData());
+
+		// The inverse FFT is not normalized
+		double MaxError = 0;
+		for (int64 Index = 0; Index < NFFT; ++Index)
+		{
+			MaxError = FMath::Max(MaxError, FMath::Abs(static_cast<double>(RoundTrip[Index].Real) / NFFT - Samples[Index]));
+			MaxError = FMath::Max(MaxError, FMath::Abs(static_cast<double>(RoundTrip[Index].Imaginary) / NFFT));
+		}
+
+		TestTrue(FString::Printf(TEXT("Real FFT of size %lld round-trips through the inverse FFT (error %g)"), NFFT, MaxError), MaxError < MaxRelativeFFTError);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAudioAnalysisProcessAudioFramesBenchmark, "AudioAnalysisTools.Benchmarks.ProcessAudioFrames", AUDIO_ANALYSIS_BENCHMARK_FLAGS)
+
+bool FAudioAnalysisProcessAudioFramesBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace AudioAnalysisBenchmarks;
+
+	TArray<FBenchmarkResult> Results;
+
+	for (const int64 FrameSize : FFTSizes)
+	{
+		UAudioAnalysisToolsLibrary* AudioAnalysisTools = UAudioAnalysisToolsLibrary::CreateAudioAnalysisTools(FrameSize, EAnalysisWindowType::HanningWindow);
+		if (!TestNotNull(TEXT("Audio analysis tools are created"), AudioAnalysisTools))
+		{
+			continue;
+		}
+
+		TArray64<float> AudioFrames;
+		AudioFrames.SetNumUninitialized(FrameSize);
+		FillWithNoise(AudioFrames, static_cast<int32>(FrameSize));
+
+		// The synchronous overload, so the measured latency is the whole processing including the beat detection and publishing the results
+		Results.Add(Measure(TEXT("ProcessAudioFrames"), FrameSize, [&]()
+		{
+			AudioAnalysisTools->ProcessAudioFrames(TArrayView64<const float>(AudioFrames), true);
+		}));
+
+		Results.Add(Measure(TEXT("ProcessAudioFramesWithoutBeatDetection"), FrameSize, [&]()
+		{
+			AudioAnalysisTools->ProcessAudioFrames(TArrayView64<const float>(AudioFrames), false);
+		}));
+	}
+
+	SaveReport(*this, TEXT("ProcessAudioFrames"), Results);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAudioAnalysisFeaturesBenchmark, "AudioAnalysisTools.Benchmarks.Features", AUDIO_ANALYSIS_BENCHMARK_FLAGS)
+
+bool FAudioAnalysisFeaturesBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace AudioAnalysisBenchmarks;
+
+	TArray<FBenchmarkResult> Results;
+
+	// A value is accumulated from each kernel, so the calls cannot be optimized away
+	float Accumulator = 0;
+
+	for (const int64 FrameSize : {512, 1024, 2048, 4096})
+	{
+		TArray64<float> AudioFrames;
+		AudioFrames.SetNumUninitialized(FrameSize);
+		FillWithNoise(AudioFrames, static_cast<int32>(FrameSize));
+
+		TArray64<float> MagnitudeSpectrum;
+		MagnitudeSpectrum.SetNumUninitialized(FrameSize / 2);
+		for (int64 Bin = 0; Bin < MagnitudeSpectrum.Num(); ++Bin)
+		{
+			MagnitudeSpectrum[Bin] = FMath::Abs(AudioFrames[Bin]) + 0.01f;
+		}
+
+		const TArrayView64<const float> AudioFramesView(AudioFrames);
+		const TArrayView64<const float> MagnitudeSpectrumView(MagnitudeSpectrum);
+
+		Results.Add(Measure(TEXT("GetRootMeanSquare"), FrameSize, [&]() { Accumulator += UCoreTimeDomainFeatures::GetRootMeanSquare(AudioFramesView); }));
+		Results.Add(Measure(TEXT("GetPeakEnergy"), FrameSize, [&]() { Accumulator += UCoreTimeDomainFeatures::GetPeakEnergy(AudioFramesView); }));
+		Results.Add(Measure(TEXT("GetZeroCrossingRate"), FrameSize, [&]() { Accumulator += UCoreTimeDomainFeatures::GetZeroCrossingRate(AudioFramesView); }));
+		Results.Add(Measure(TEXT("GetTimeDomainFeatures"), FrameSize, [&]() { Accumulator += UCoreTimeDomainFeatures::GetTimeDomainFeatures(AudioFramesView).RootMeanSquare; }));
+
+		Results.Add(Measure(TEXT("GetSpectralCentroid"), FrameSize, [&]() { Accumulator += UCoreFrequencyDomainFeatures::GetSpectralCentroid(MagnitudeSpectrumView); }));
+		Results.Add(Measure(TEXT("GetSpectralFlatness"), FrameSize, [&]() { Accumulator += UCoreFrequencyDomainFeatures::GetSpectralFlatness(MagnitudeSpectrumView); }));
+		Results.Add(Measure(TEXT("GetSpectralCrest"), FrameSize, [&]() { Accumulator += UCoreFrequencyDomainFeatures::GetSpectralCrest(MagnitudeSpectrumView); }));
+		Results.Add(Measure(TEXT("GetSpectralRolloff"), FrameSize, [&]() { Accumulator += UCoreFrequencyDomainFeatures::GetSpectralRolloff(MagnitudeSpectrumView); }));
+		Results.Add(Measure(TEXT("GetSpectralKurtosis"), FrameSize, [&]() { Accumulator += UCoreFrequencyDomainFeatures::GetSpectralKurtosis(MagnitudeSpectrumView); }));
+		Results.Add(Measure(TEXT("GetSpectralFeatures"), FrameSize, [&]() { Accumulator += UCoreFrequencyDomainFeatures::GetSpectralFeatures(MagnitudeSpectrumView).SpectralCentroid; }));
+
+		float MelBandEnergies[40];
+		float MFCC[13];
+		Results.Add(Measure(TEXT("GetMelBandEnergies"), FrameSize, [&]() { UMelFrequencyFeatures::GetMelBandEnergies(MagnitudeSpectrumView, 48000, MelBandEnergies); Accumulator += MelBandEnergies[0]; }));
+		Results.Add(Measure(TEXT("GetMFCC"), FrameSize, [&]() { UMelFrequencyFeatures::GetMFCC(MagnitudeSpectrumView, 48000, 40, MFCC); Accumulator += MFCC[0]; }));
+
+		// The complex spectral difference of the FFT of the frame in both modes
+		{
+			FSpectrumAnalyzer SpectrumAnalyzer;
+			SpectrumAnalyzer.Configure(FrameSize);
+
+			TArray64<float> Window, FFTReal, FFTImaginary, FFTMagnitudeSpectrum;
+			Window.Init(1.f, FrameSize);
+			FFTReal.SetNumZeroed(FrameSize);
+			FFTImaginary.SetNumZeroed(FrameSize);
+			FFTMagnitudeSpectrum.SetNumZeroed(FrameSize / 2);
+			SpectrumAnalyzer.Process(AudioFrames.GetData(), Window.GetData(), FFTReal.GetData(), FFTImaginary.GetData(), FFTMagnitudeSpectrum.GetData());
+
+			UOnsetDetection* OnsetDetection = UOnsetDetection::CreateOnsetDetection(FrameSize);
+
+			for (const EComplexSpectralDifferenceMode Mode : {EComplexSpectralDifferenceMode::PhaseUnwrapping, EComplexSpectralDifferenceMode::PhasorPrediction})
+			{
+				OnsetDetection->SetComplexSpectralDifferenceMode(Mode);
+				Results.Add(Measure(Mode == EComplexSpectralDifferenceMode::PhaseUnwrapping ? TEXT("GetComplexSpectralDifference") : TEXT("GetComplexSpectralDifferenceByPrediction"), FrameSize, [&]()
+				{
+					Accumulator += OnsetDetection->GetComplexSpectralDifference(TArrayView64<const float>(FFTReal), TArrayView64<const float>(FFTImaginary));
+				}));
+			}
+		}
+	}
+
+	TestTrue(TEXT("The feature kernels return finite values"), FMath::IsFinite(Accumulator));
+
+	SaveReport(*this, TEXT("Features"), Results);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAudioAnalysisBeatDetectionBenchmark, "AudioAnalysisTools.Benchmarks.BeatDetection", AUDIO_ANALYSIS_BENCHMARK_FLAGS)
+
+bool FAudioAnalysisBeatDetectionBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace AudioAnalysisBenchmarks;
+
+	TArray<FBenchmarkResult> Results;
+
+	constexpr int64 MagnitudeSpectrumSize = 512;
+
+	TArray64<float> MagnitudeSpectrum;
+	MagnitudeSpectrum.SetNumUninitialized(MagnitudeSpectrumSize);
+	FillWithNoise(MagnitudeSpectrum, 0);
+	for (float& Magnitude : MagnitudeSpectrum)
+	{
+		Magnitude = FMath::Abs(Magnitude);
+	}
+
+	for (const int64 EnergyHistorySize : EnergyHistorySizes)
+	{
+		UBeatDetection* BeatDetection = UBeatDetection::CreateBeatDetection(32, EnergyHistorySize);
+		if (!TestNotNull(TEXT("Beat detection is created"), BeatDetection))
+		{
+			continue;
+		}
+
+		// The size is the history length, since the cost per frame must not depend on it
+		Results.Add(Measure(TEXT("BeatDetectionUpdateFFT"), EnergyHistorySize, [&]()
+		{
+			BeatDetection->ProcessMagnitude(TArrayView64<const float>(MagnitudeSpectrum));
+		}));
+	}
+
+	SaveReport(*this, TEXT("BeatDetection"), Results);
+
+	return true;
+}
+
+#undef AUDIO_ANALYSIS_BENCHMARK_FLAGS
+#undef AUDIO_ANALYSIS_TEST_FLAGS
+
+#endif
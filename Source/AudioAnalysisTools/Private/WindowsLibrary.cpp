@@ -1,130 +1,259 @@
 // Georgy Treshchev 2024.
 
 #include "WindowsLibrary.h"
+#include "AudioAnalysisToolsDefines.h"
+#include "Misc/ScopeRWLock.h"
 
-TArray<float> UWindowsLibrary::CreateWindowByType(int32 FrameSize, EAnalysisWindowType WindowType)
+namespace
 {
-	return TArray<float>(CreateWindowByType(static_cast<int64>(FrameSize), WindowType));
-}
+	TArray64<float> GenerateHanningWindow(int64 FrameSize)
+	{
+		TArray64<float> Window;
+		Window.Init(0, FrameSize);
 
-TArray64<float> UWindowsLibrary::CreateWindowByType(int64 FrameSize, EAnalysisWindowType WindowType)
-{
-	switch (WindowType)
+		for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+		{
+			Window[Index] = 0.5 * (1 - FMath::Cos(2. * PI * (Index / static_cast<float>(FrameSize - 1))));
+		}
+
+		return Window;
+	}
+
+	TArray64<float> GenerateHammingWindow(int64 FrameSize)
+	{
+		TArray64<float> Window;
+		Window.Init(0, FrameSize);
+
+		for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+		{
+			Window[Index] = 0.54 - (0.46 * FMath::Cos(2. * PI * (static_cast<float>(Index) / static_cast<float>(FrameSize - 1))));
+		}
+
+		return Window;
+	}
+
+	TArray64<float> GenerateBlackmanWindow(int64 FrameSize)
+	{
+		TArray64<float> Window;
+		Window.Init(0, FrameSize);
+
+		const int64 FrameSizeMinusOne = FrameSize - 1;
+
+		for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+		{
+			Window[Index] = 0.42 - (0.5 * FMath::Cos(2. * PI * (static_cast<float>(Index) / FrameSizeMinusOne))) + (0.08 * FMath::Cos(4. * PI * (static_cast<float>(Index) / FrameSizeMinusOne)));
+		}
+
+		return Window;
+	}
+
+	TArray64<float> GenerateTukeyWindow(int64 FrameSize, float CosineFraction)
+	{
+		TArray64<float> Window;
+		Window.Init(0, FrameSize);
+
+		const int64 FrameSizeMinusOne = FrameSize - 1;
+
+		float Value = static_cast<float>(-1 * (FrameSize / 2)) + 1;
+
+		for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+		{
+			if (Value >= 0 && Value <= CosineFraction * (static_cast<float>(FrameSizeMinusOne) / 2))
+			{
+				Window[Index] = 1.0;
+			}
+			else if (Value <= 0 && Value >= -1 * CosineFraction * (static_cast<float>(FrameSizeMinusOne) / 2))
+			{
+				Window[Index] = 1.0;
+			}
+			else
+			{
+				Window[Index] = 0.5 * (1 + FMath::Cos(PI * (((2 * Value) / (CosineFraction * FrameSizeMinusOne)) - 1)));
+			}
+
+			Value += 1;
+		}
+
+		return Window;
+	}
+
+	TArray64<float> GenerateRectangularWindow(int64 FrameSize)
 	{
-	case EAnalysisWindowType::RectangularWindow: return CreateRectangularWindow(FrameSize);
-	case EAnalysisWindowType::HanningWindow: return CreateHanningWindow(FrameSize);
-	case EAnalysisWindowType::HammingWindow: return CreateHammingWindow(FrameSize);
-	case EAnalysisWindowType::BlackmanWindow: return CreateBlackmanWindow(FrameSize);
-	case EAnalysisWindowType::TukeyWindow: return CreateTukeyWindow(FrameSize);
-	default: return CreateRectangularWindow(FrameSize);
+		TArray64<float> Window;
+		Window.Init(0, FrameSize);
+
+		for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+		{
+			Window[Index] = 1.f;
+		}
+
+		return Window;
+	}
+
+	TArray64<float> GenerateWindow(int64 FrameSize, EAnalysisWindowType WindowType, float CosineFraction)
+	{
+		switch (WindowType)
+		{
+		case EAnalysisWindowType::HanningWindow: return GenerateHanningWindow(FrameSize);
+		case EAnalysisWindowType::HammingWindow: return GenerateHammingWindow(FrameSize);
+		case EAnalysisWindowType::BlackmanWindow: return GenerateBlackmanWindow(FrameSize);
+		case EAnalysisWindowType::TukeyWindow: return GenerateTukeyWindow(FrameSize, CosineFraction);
+		default: return GenerateRectangularWindow(FrameSize);
+		}
+	}
+
+	/**
+	 * Generate a new window array without caching it, since the caller owns the returned copy and arbitrary sizes would otherwise fill the cache
+	 */
+	template <typename ArrayType>
+	ArrayType CreateUncachedWindow(int64 FrameSize, EAnalysisWindowType WindowType, float CosineFraction = 0.5)
+	{
+		if (FrameSize <= 0)
+		{
+			UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the window: the frame size is '%lld', expected > '0'"), FrameSize);
+			return ArrayType();
+		}
+
+		const TArray64<float> Window = GenerateWindow(FrameSize, WindowType, CosineFraction);
+		return ArrayType(Window.GetData(), static_cast<typename ArrayType::SizeType>(Window.Num()));
 	}
 }
 
-TArray<float> UWindowsLibrary::CreateHanningWindow(int32 FrameSize)
+FWindowCache& FWindowCache::Get()
 {
-	return TArray<float>(CreateHanningWindow(static_cast<int64>(FrameSize)));
+	static FWindowCache WindowCache;
+	return WindowCache;
 }
 
-TArray64<float> UWindowsLibrary::CreateHanningWindow(int64 FrameSize)
+FWindowPtr FWindowCache::FindOrCreateWindow(int64 FrameSize, EAnalysisWindowType WindowType, float CosineFraction)
 {
-	TArray64<float> Window;
-	Window.Init(0, FrameSize);
+	if (FrameSize <= 0)
+	{
+		UE_LOG(LogAudioAnalysis, Error, TEXT("Unable to create the window: the frame size is '%lld', expected > '0'"), FrameSize);
+		return nullptr;
+	}
+
+	// The cosine fraction only shapes the Tukey window, so the other types share a single table per size
+	const TTuple<int64, EAnalysisWindowType, float> Key(FrameSize, WindowType, WindowType == EAnalysisWindowType::TukeyWindow ? CosineFraction : 0.f);
+
+	{
+		FReadScopeLock ReadLock(WindowsLock);
+		if (const FWindowPtr* FoundWindow = Windows.Find(Key))
+		{
+			return *FoundWindow;
+		}
+	}
+
+	FWriteScopeLock WriteLock(WindowsLock);
+
+	// Another thread may have created the window while the lock was released
+	if (const FWindowPtr* FoundWindow = Windows.Find(Key))
+	{
+		return *FoundWindow;
+	}
+
+	TArray64<float> Window = GenerateWindow(FrameSize, WindowType, CosineFraction);
+
+	INC_DWORD_STAT(STAT_AudioAnalysis_WindowTables);
+	INC_MEMORY_STAT_BY(STAT_AudioAnalysis_WindowTableMemory, Window.GetAllocatedSize());
 
-	for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+	// Analyzers fed with buffers of varying lengths would otherwise leave a window behind for every length they have seen
+	if (Windows.Num() >= MaxNumOfCachedWindows)
 	{
-		Window[Index] = 0.5 * (1 - FMath::Cos(2. * PI * (Index / static_cast<float>(FrameSize - 1))));
+		ReleaseUnusedWindowsLocked();
 	}
 
-	return Window;
+	FWindowPtr SharedWindow = MakeShared<const TArray64<float>, ESPMode::ThreadSafe>(MoveTemp(Window));
+	Windows.Add(Key, SharedWindow);
+	return SharedWindow;
 }
 
-TArray<float> UWindowsLibrary::CreateHammingWindow(int32 FrameSize)
+void FWindowCache::ReleaseUnusedWindows()
 {
-	return TArray<float>(CreateHammingWindow(static_cast<int64>(FrameSize)));
+	FWriteScopeLock WriteLock(WindowsLock);
+	ReleaseUnusedWindowsLocked();
 }
 
-TArray64<float> UWindowsLibrary::CreateHammingWindow(int64 FrameSize)
+void FWindowCache::ReleaseUnusedWindowsLocked()
 {
-	TArray64<float> Window;
-	Window.Init(0, FrameSize);
-
-	for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
+	for (auto It = Windows.CreateIterator(); It; ++It)
 	{
-		Window[Index] = 0.54 - (0.46 * FMath::Cos(2. * PI * (static_cast<float>(Index) / static_cast<float>(FrameSize - 1))));
+		if (It.Value().IsUnique())
+		{
+			DEC_DWORD_STAT(STAT_AudioAnalysis_WindowTables);
+			DEC_MEMORY_STAT_BY(STAT_AudioAnalysis_WindowTableMemory, It.Value()->GetAllocatedSize());
+			It.RemoveCurrent();
+		}
 	}
-
-	return Window;
 }
 
-TArray<float> UWindowsLibrary::CreateBlackmanWindow(int32 FrameSize)
+int32 FWindowCache::GetNumWindows() const
 {
-	return TArray<float>(CreateBlackmanWindow(static_cast<int64>(FrameSize)));
+	FReadScopeLock ReadLock(WindowsLock);
+	return Windows.Num();
 }
 
-TArray64<float> UWindowsLibrary::CreateBlackmanWindow(int64 FrameSize)
+TArray<float> UWindowsLibrary::CreateWindowByType(int32 FrameSize, EAnalysisWindowType WindowType)
 {
-	TArray64<float> Window;
-	Window.Init(0, FrameSize);
+	return CreateUncachedWindow<TArray<float>>(FrameSize, WindowType);
+}
 
-	const int64 FrameSizeMinusOne = FrameSize - 1;
+TArray64<float> UWindowsLibrary::CreateWindowByType(int64 FrameSize, EAnalysisWindowType WindowType)
+{
+	return CreateUncachedWindow<TArray64<float>>(FrameSize, WindowType);
+}
 
-	for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
-	{
-		Window[Index] = 0.42 - (0.5 * FMath::Cos(2. * PI * (static_cast<float>(Index) / FrameSizeMinusOne))) + (0.08 * FMath::Cos(4. * PI * (static_cast<float>(Index) / FrameSizeMinusOne)));
-	}
+FWindowPtr UWindowsLibrary::GetSharedWindow(int64 FrameSize, EAnalysisWindowType WindowType, float CosineFraction)
+{
+	return FWindowCache::Get().FindOrCreateWindow(FrameSize, WindowType, CosineFraction);
+}
 
-	return Window;
+TArray<float> UWindowsLibrary::CreateHanningWindow(int32 FrameSize)
+{
+	return CreateUncachedWindow<TArray<float>>(FrameSize, EAnalysisWindowType::HanningWindow);
 }
 
-TArray<float> UWindowsLibrary::CreateTukeyWindow(int32 FrameSize, float CosineFraction)
+TArray64<float> UWindowsLibrary::CreateHanningWindow(int64 FrameSize)
 {
-	return TArray<float>(CreateTukeyWindow(static_cast<int64>(FrameSize), CosineFraction));
+	return CreateUncachedWindow<TArray64<float>>(FrameSize, EAnalysisWindowType::HanningWindow);
 }
 
-TArray64<float> UWindowsLibrary::CreateTukeyWindow(int64 FrameSize, float CosineFraction)
+TArray<float> UWindowsLibrary::CreateHammingWindow(int32 FrameSize)
 {
-	TArray64<float> Window;
-	Window.Init(0, FrameSize);
+	return CreateUncachedWindow<TArray<float>>(FrameSize, EAnalysisWindowType::HammingWindow);
+}
 
-	const int64 FrameSizeMinusOne = FrameSize - 1;
+TArray64<float> UWindowsLibrary::CreateHammingWindow(int64 FrameSize)
+{
+	return CreateUncachedWindow<TArray64<float>>(FrameSize, EAnalysisWindowType::HammingWindow);
+}
 
-	float Value = static_cast<float>(-1 * (FrameSize / 2)) + 1;
+TArray<float> UWindowsLibrary::CreateBlackmanWindow(int32 FrameSize)
+{
+	return CreateUncachedWindow<TArray<float>>(FrameSize, EAnalysisWindowType::BlackmanWindow);
+}
 
-	for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
-	{
-		if (Value >= 0 && Value <= CosineFraction * (static_cast<float>(FrameSizeMinusOne) / 2))
-		{
-			Window[Index] = 1.0;
-		}
-		else if (Value <= 0 && Value >= -1 * CosineFraction * (static_cast<float>(FrameSizeMinusOne) / 2))
-		{
-			Window[Index] = 1.0;
-		}
-		else
-		{
-			Window[Index] = 0.5 * (1 + FMath::Cos(PI * (((2 * Value) / (CosineFraction * FrameSizeMinusOne)) - 1)));
-		}
+TArray64<float> UWindowsLibrary::CreateBlackmanWindow(int64 FrameSize)
+{
+	return CreateUncachedWindow<TArray64<float>>(FrameSize, EAnalysisWindowType::BlackmanWindow);
+}
 
-		Value += 1;
-	}
+TArray<float> UWindowsLibrary::CreateTukeyWindow(int32 FrameSize, float CosineFraction)
+{
+	return CreateUncachedWindow<TArray<float>>(FrameSize, EAnalysisWindowType::TukeyWindow, CosineFraction);
+}
 
-	return Window;
+TArray64<float> UWindowsLibrary::CreateTukeyWindow(int64 FrameSize, float CosineFraction)
+{
+	return CreateUncachedWindow<TArray64<float>>(FrameSize, EAnalysisWindowType::TukeyWindow, CosineFraction);
 }
 
 TArray<float> UWindowsLibrary::CreateRectangularWindow(int32 FrameSize)
 {
-	return TArray<float>(CreateRectangularWindow(static_cast<int64>(FrameSize)));
+	return CreateUncachedWindow<TArray<float>>(FrameSize, EAnalysisWindowType::RectangularWindow);
 }
 
 TArray64<float> UWindowsLibrary::CreateRectangularWindow(int64 FrameSize)
 {
-	TArray64<float> Window;
-	Window.Init(0, FrameSize);
-
-	for (TArray64<float>::SizeType Index = 0; Index < Window.Num(); ++Index)
-	{
-		Window[Index] = 1.f;
-	}
-
-	return Window;
+	return CreateUncachedWindow<TArray64<float>>(FrameSize, EAnalysisWindowType::RectangularWindow);
 }
@@ -0,0 +1,213 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "BandTriggerDetector.generated.h"
+
+class UBeatDetection;
+
+/**
+ * Frequency range of a band watched by the band trigger detector
+ */
+USTRUCT(BlueprintType, Category = "Band Trigger Detector")
+struct AUDIOANALYSISTOOLS_API FBandTriggerRange
+{
+	GENERATED_BODY()
+
+	FBandTriggerRange()
+		: LowFrequency(0),
+		  HighFrequency(0)
+	{
+	}
+
+	FBandTriggerRange(float InLowFrequency, float InHighFrequency)
+		: LowFrequency(InLowFrequency),
+		  HighFrequency(InHighFrequency)
+	{
+	}
+
+	/** The lowest frequency of the band in Hz */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Band Trigger Detector")
+	float LowFrequency;
+
+	/** The highest frequency of the band in Hz */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Band Trigger Detector")
+	float HighFrequency;
+};
+
+/**
+ * Low-latency beat triggers for a few frequency bands
+ * Instead of a full FFT per frame, a sliding DFT updates only the DFT bins of the configured bands on every incoming sample,
+ * and every hop the band magnitudes are compared to their energy history the same way as the FFT sub-bands of the beat detection
+ * A trigger registers within a hop of the audio instead of a whole frame, at a fraction of the cost of the FFT
+ * Each band has its own sliding window, the longest one up to the window size whose bins span the band in at most 4 bins, all of which are tracked
+ * So the cost does not grow with the band width: wide high bands such as a hi-hat get short windows with coarse bins, which also respond faster to transients,
+ * while narrow low bands such as a kick keep the full window for the frequency resolution they need
+ */
+UCLASS(BlueprintType, Category = "Band Trigger Detector")
+class AUDIOANALYSISTOOLS_API UBandTriggerDetector : public UObject
+{
+	GENERATED_BODY()
+
+	UBandTriggerDetector();
+
+public:
+	/**
+	 * Instantiates a Band Trigger Detector object
+	 *
+	 * @param SampleRate The sample rate of the audio
+	 * @param WindowSize The number of audio frames of the longest sliding DFT window. Defines the finest frequency resolution of the bands, SampleRate / WindowSize
+	 * @param HopSize The number of audio frames between two band evaluations. Defines the latency of the triggers
+	 * @param Bands The frequency ranges of the bands. The kick, snare and hi-hat bands if empty
+	 * @param EnergyHistoryDuration The duration of the energy history the bands are compared to, in seconds
+	 * @return The BandTriggerDetector object, or nullptr if the configuration is invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector", meta = (AutoCreateRefTerm = "Bands"))
+	static UBandTriggerDetector* CreateBandTriggerDetector(int32 SampleRate, const TArray<FBandTriggerRange>& Bands, int64 WindowSize = 1024, int64 HopSize = 128, float EnergyHistoryDuration = 1.f);
+
+	/**
+	 * Get the default bands: the kick, snare and hi-hat bands at the KICK_BAND, SNARE_BAND and HIHAT_BAND indexes
+	 */
+	UFUNCTION(BlueprintPure, Category = "Band Trigger Detector")
+	static TArray<FBandTriggerRange> GetDefaultBands();
+
+	/**
+	 * Process audio frames, evaluating the bands after every hop
+	 *
+	 * @param AudioFrames Mono audio frames in 32-bit float PCM format
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	void ProcessAudioFrames(const TArray<float>& AudioFrames);
+
+	/**
+	 * Process audio frames, evaluating the bands after every hop. Suitable for use with 64-bit data size and for array views without copies
+	 *
+	 * @param AudioFrames Mono audio frames in 32-bit float PCM format
+	 */
+	void ProcessAudioFrames(TArrayView64<const float> AudioFrames);
+
+	/**
+	 * Clear the sliding DFT and the energy history
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	void Reset();
+
+	/**
+	 * Whether there was a beat in the band at the last evaluation or not
+	 *
+	 * @param Band The band index
+	 * @return Whether there was a beat or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	bool IsBandTriggered(int32 Band) const;
+
+	/**
+	 * Whether there was a beat in the KICK_BAND band at the last evaluation or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	bool IsKick() const;
+
+	/**
+	 * Whether there was a beat in the SNARE_BAND band at the last evaluation or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	bool IsSnare() const;
+
+	/**
+	 * Whether there was a beat in the HIHAT_BAND band at the last evaluation or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	bool IsHiHat() const;
+
+	/**
+	 * Get the magnitude of the band at the last evaluation
+	 *
+	 * @param Band The band index
+	 * @return The average magnitude of the DFT bins of the band, or -1 if the band is out of range
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Band Trigger Detector")
+	float GetBandMagnitude(int32 Band) const;
+
+	/**
+	 * Get the magnitudes of all the bands at the last evaluation. Suitable for use with 64-bit data size
+	 */
+	TArrayView64<const float> GetBandMagnitudes() const { return BandMagnitudes; }
+
+	/** Get the number of bands */
+	UFUNCTION(BlueprintPure, Category = "Band Trigger Detector")
+	int32 GetNumOfBands() const { return Bands.Num(); }
+
+	/** Get the number of evaluations since the detector was created or reset */
+	UFUNCTION(BlueprintPure, Category = "Band Trigger Detector")
+	int64 GetNumOfEvaluations() const { return NumOfEvaluations; }
+
+protected:
+	/**
+	 * Validate the configuration and allocate the sliding DFT for it
+	 *
+	 * @return Whether the configuration is valid or not
+	 */
+	bool Configure(int32 InSampleRate, const TArray<FBandTriggerRange>& InBands, int64 InWindowSize, int64 InHopSize, float InEnergyHistoryDuration);
+
+	/**
+	 * Advance the sliding DFT bins by the given audio frames, which must not cross a hop boundary
+	 */
+	void UpdateBins(const float* AudioFrames, int64 NumOfFrames);
+
+	/** Compute the band magnitudes from the bins and compare them to the energy history */
+	void EvaluateBands();
+
+	/** The beat detection the band magnitudes are fed to, one sub-band per band */
+	UPROPERTY()
+	UBeatDetection* BeatDetection;
+
+	/** The configured bands */
+	TArray<FBandTriggerRange> Bands;
+
+	/** The offset of the first bin of each band in the bin arrays, plus the total number of bins */
+	TArray<int32> BandBinOffsets;
+
+	/** The number of audio frames of the sliding DFT window of each band, up to the window size */
+	TArray<int64> BandWindowSizes;
+
+	/** The damping of the audio frame leaving the window of each band, the damping factor to the power of the window size of the band */
+	TArray<float> BandWindowDampings;
+
+	/** The real part of the rotation of each bin per audio frame, damped */
+	TArray<double> BinRotationReal;
+
+	/** The imaginary part of the rotation of each bin per audio frame, damped */
+	TArray<double> BinRotationImaginary;
+
+	/** The real part of the current DFT of each bin */
+	TArray<double> BinReal;
+
+	/** The imaginary part of the current DFT of each bin */
+	TArray<double> BinImaginary;
+
+	/** The last WindowSize audio frames, as a ring shared by the windows of all the bands */
+	TArray64<float> Window;
+
+	/** The difference between each incoming audio frame and the damped audio frame leaving the window of a band, for the current block */
+	TArray64<float> FrameDeltas;
+
+	/** The band magnitudes of the last evaluation */
+	TArray64<float> BandMagnitudes;
+
+	/** The position of the oldest audio frame in the window */
+	int64 WindowPosition;
+
+	/** The number of audio frames processed since the last evaluation */
+	int64 FramesSinceEvaluation;
+
+	/** The number of evaluations since the detector was created or reset */
+	int64 NumOfEvaluations;
+
+	int32 SampleRate;
+	int64 WindowSize;
+	int64 HopSize;
+
+	/** The number of evaluations in the energy history */
+	int64 EnergyHistorySize;
+};
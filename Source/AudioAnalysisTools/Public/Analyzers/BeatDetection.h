@@ -9,6 +9,9 @@
 #define SNARE_BAND 1
 #define HIHAT_BAND 2
 
+/** Array of floats whose data starts at a cache line boundary */
+using FCacheAlignedFloatArray = TArray<float, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>>;
+
 /**
  * Beat detection
  */
@@ -56,11 +59,11 @@ public:
 	void ProcessMagnitude(const TArray<float>& MagnitudeSpectrum);
 
 	/**
-	 * Process magnitude spectrum. Suitable for use with 64-bit data size
+	 * Process magnitude spectrum. Suitable for use with 64-bit data size and for array views without copies
 	 * 
 	 * @param MagnitudeSpectrum An array containing the magnitude spectrum
 	 */
-	void ProcessMagnitude(const TArray64<float>& MagnitudeSpectrum);
+	void ProcessMagnitude(TArrayView64<const float> MagnitudeSpectrum);
 
 	/**
 	 * Calculate if there was beat in the processed magnitude spectrum
@@ -106,6 +109,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Beat Detection|Main")
 	bool IsBeatRange(int64 Low, int64 High, int64 Threshold) const;
 
+	/**
+	 * Get the beat mask, with the bit of each sub-band set if there was a beat in it
+	 *
+	 * @return The beat mask, with 64 sub-bands per word
+	 */
+	TArrayView64<const uint64> GetBeatMask() const { return BeatMask; }
+
+	/**
+	 * Count the beats of the given sub-bands span in the beat mask. The span is not validated
+	 *
+	 * @param InBeatMask The beat mask, with 64 sub-bands per word
+	 * @param Low Start FFT sub-band index
+	 * @param High End FFT sub-band index, inclusive
+	 * @return The number of sub-bands with a beat in the span
+	 */
+	static int64 CountBeats(TArrayView64<const uint64> InBeatMask, int64 Low, int64 High);
+
 	/**
 	 * Get the value of the specified sub-band
 	 * 
@@ -126,7 +146,7 @@ public:
 	 * Get FFT Sub-bands values. Suitable for use with 64-bit data size
 	 * @return FFT Sub-bands values
 	 */
-	const TArray64<float>& GetFFTSubbands() const { return FFTSubbands; }
+	TArrayView64<const float> GetFFTSubbands() const { return GetBandRow(SubbandsRow); }
 
 	/**
 	 * Get FFT Average Energy values
@@ -139,7 +159,7 @@ public:
 	 * Get FFT Average Energy values. Suitable for use with 64-bit data size
 	 * @return FFT Average Energy values
 	 */
-	const TArray64<float>& GetFFTAverageEnergy() const { return FFTAverageEnergy; }
+	TArrayView64<const float> GetFFTAverageEnergy() const { return GetBandRow(AverageEnergyRow); }
 
 	/**
 	 * Get FFT Variance values
@@ -152,7 +172,7 @@ public:
 	 * Get FFT Variance values. Suitable for use with 64-bit data size
 	 * @return FFT Variance values
 	 */
-	const TArray64<float>& GetFFTVariance() const { return FFTVariance; }
+	TArrayView64<const float> GetFFTVariance() const { return GetBandRow(VarianceRow); }
 
 	/**
 	 * Get FFT Beat values
@@ -165,7 +185,7 @@ public:
 	 * Get FFT Beat values. Suitable for use with 64-bit data size
 	 * @return FFT Beat values
 	 */
-	const TArray64<float>& GetFFTBeatValues() const { return FFTBeatValues; }
+	TArrayView64<const float> GetFFTBeatValues() const { return GetBandRow(BeatValuesRow); }
 
 protected:
 	/**
@@ -173,22 +193,54 @@ protected:
 	 * 
 	 * @param MagnitudeSpectrum An array containing the magnitude spectrum
 	 */
-	void UpdateFFT(const TArray64<float>& MagnitudeSpectrum);
+	void UpdateFFT(TArrayView64<const float> MagnitudeSpectrum);
+
+	/** Recompute the running sums of the energy history from scratch, discarding the accumulated rounding errors */
+	void RecomputeEnergyHistorySums();
+
+	/** Update the beat mask from the current sub-band values */
+	void UpdateBeatMask();
+
+	/**
+	 * Allocate the band rows and the energy history for the current sizes, keeping the energy history of the frames that still fit
+	 *
+	 * @return Whether the storage fits the sizes or not
+	 */
+	bool ResizeStorage();
+
+	/** Row of the raw value for each sub-band */
+	static constexpr int64 SubbandsRow = 0;
+
+	/** Row of the average sub-band energy value based on energy history */
+	static constexpr int64 AverageEnergyRow = 1;
+
+	/** Row of the sub-band variance value */
+	static constexpr int64 VarianceRow = 2;
+
+	/** Row of the normalized beat values for each sub-band */
+	static constexpr int64 BeatValuesRow = 3;
+
+	/** The number of rows of the per-band values */
+	static constexpr int64 NumBandRows = 4;
+
+	/** Get the per-band values of the given row */
+	TArrayView64<float> GetBandRow(int64 Row) { return TArrayView64<float>(BandRows.GetData() + Row * SubbandStride, FFTSubbandSize); }
+	TArrayView64<const float> GetBandRow(int64 Row) const { return TArrayView64<const float>(BandRows.GetData() + Row * SubbandStride, FFTSubbandSize); }
 
-	/** Raw value for each sub-band */
-	TArray64<float> FFTSubbands;
+	/** The number of floats between the starts of two consecutive rows of the band rows and the energy history. The sub-band size rounded up to whole cache lines */
+	int64 SubbandStride;
 
-	/** Average sub-band energy value based on energy history */
-	TArray64<float> FFTAverageEnergy;
+	/** The per-band values, one cache-aligned row each */
+	FCacheAlignedFloatArray BandRows;
 
-	/** Sub-band variance value */
-	TArray64<float> FFTVariance;
+	/** History of energy needed to "memorize" previous magnitudes. A ring of EnergyHistorySize cache-aligned rows, one per frame, so each frame writes a single contiguous row */
+	FCacheAlignedFloatArray EnergyHistory;
 
-	/** Normalized beat values for each sub-band */
-	TArray64<float> FFTBeatValues;
+	/** Running sum of the energy history of each sub-band, updated with the evicted and the added values on each frame */
+	TArray64<double> EnergyHistorySums;
 
-	/** History of energy needed to "memorize" previous magnitudes */
-	TArray64<TArray64<float>> EnergyHistory;
+	/** Whether there was a beat in each sub-band, with 64 sub-bands per word */
+	TArray64<uint64> BeatMask;
 
 	/** Current position to track energy history */
 	int64 HistoryPosition;
@@ -5,6 +5,96 @@
 #include "UObject/Object.h"
 #include "CoreFrequencyDomainFeatures.generated.h"
 
+/**
+ * Spectral features computed by the fused spectral feature extractor. Used as bit indices of the feature mask
+ */
+UENUM(BlueprintType, meta = (Bitflags))
+enum class ESpectralFeature : uint8
+{
+	Centroid,
+	Flatness,
+	Crest,
+	Rolloff,
+	Kurtosis,
+
+	Count UMETA(Hidden)
+};
+
+/** The feature mask containing all the spectral features */
+constexpr int32 AllSpectralFeatures = (1 << static_cast<int32>(ESpectralFeature::Count)) - 1;
+
+/**
+ * Spectral features of a single magnitude spectrum. Only the features in the feature mask are computed, the others are zeros
+ */
+USTRUCT(BlueprintType, Category = "Core Frequency Domain Features")
+struct AUDIOANALYSISTOOLS_API FSpectralFeatureSet
+{
+	GENERATED_BODY()
+
+	FSpectralFeatureSet()
+		: FeatureMask(0),
+		  SpectralCentroid(0),
+		  SpectralFlatness(0),
+		  SpectralCrest(0),
+		  SpectralRolloff(0),
+		  SpectralKurtosis(0)
+	{
+	}
+
+	/** The mask of the computed features, see ESpectralFeature */
+	UPROPERTY(BlueprintReadOnly, Category = "Core Frequency Domain Features", meta = (Bitmask, BitmaskEnum = "ESpectralFeature"))
+	int32 FeatureMask;
+
+	/** The spectral centroid as an index value */
+	UPROPERTY(BlueprintReadOnly, Category = "Core Frequency Domain Features")
+	float SpectralCentroid;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Core Frequency Domain Features")
+	float SpectralFlatness;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Core Frequency Domain Features")
+	float SpectralCrest;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Core Frequency Domain Features")
+	float SpectralRolloff;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Core Frequency Domain Features")
+	float SpectralKurtosis;
+
+	/** Whether the given feature has been computed or not */
+	bool HasFeature(ESpectralFeature Feature) const
+	{
+		return (FeatureMask & (1 << static_cast<int32>(Feature))) != 0;
+	}
+
+	/** Copy the features computed in the other set, which are computed from the same magnitude spectrum */
+	void Merge(const FSpectralFeatureSet& Other)
+	{
+		if (Other.HasFeature(ESpectralFeature::Centroid))
+		{
+			SpectralCentroid = Other.SpectralCentroid;
+		}
+		if (Other.HasFeature(ESpectralFeature::Flatness))
+		{
+			SpectralFlatness = Other.SpectralFlatness;
+		}
+		if (Other.HasFeature(ESpectralFeature::Crest))
+		{
+			SpectralCrest = Other.SpectralCrest;
+		}
+		if (Other.HasFeature(ESpectralFeature::Rolloff))
+		{
+			SpectralRolloff = Other.SpectralRolloff;
+		}
+		if (Other.HasFeature(ESpectralFeature::Kurtosis))
+		{
+			SpectralKurtosis = Other.SpectralKurtosis;
+		}
+
+		FeatureMask |= Other.FeatureMask;
+	}
+};
+
 /**
  * Implementations of common frequency domain audio features
  */
@@ -27,12 +117,12 @@ public:
 	/**
 	 * Calculate the spectral centroid given the first half of the magnitude spectrum of an audio signal.
 	 * Do not pass the whole (i.e. mirrored) magnitude spectrum into this function or you will always get the middle index as the spectral centroid
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
 	 * @returns The spectral centroid as an index value
 	 */
-	static float GetSpectralCentroid(const TArray64<float>& MagnitudeSpectrum);
+	static float GetSpectralCentroid(TArrayView64<const float> MagnitudeSpectrum);
 
 	/**
 	 * Calculate the spectral flatness given the first half of the magnitude spectrum of an audio signal
@@ -45,12 +135,12 @@ public:
 
 	/**
 	 * Calculate the spectral flatness given the first half of the magnitude spectrum of an audio signal
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
 	 * @returns The spectral flatness
 	 */
-	static float GetSpectralFlatness(const TArray64<float>& MagnitudeSpectrum);
+	static float GetSpectralFlatness(TArrayView64<const float> MagnitudeSpectrum);
 
 	/**
 	 * Calculate the spectral crest given the first half of the magnitude spectrum of an audio signal
@@ -63,12 +153,12 @@ public:
 
 	/**
 	 * Calculate the spectral crest given the first half of the magnitude spectrum of an audio signal
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
 	 * @return The spectral crest
 	 */
-	static float GetSpectralCrest(const TArray64<float>& MagnitudeSpectrum);
+	static float GetSpectralCrest(TArrayView64<const float> MagnitudeSpectrum);
 
 	/**
 	 * Calculate the spectral rolloff given the first half of the magnitude spectrum of an audio signal
@@ -82,13 +172,13 @@ public:
 
 	/**
 	 * Calculate the spectral rolloff given the first half of the magnitude spectrum of an audio signal
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
 	 * @param Percentile The rolloff threshold
 	 * @return The spectral rolloff
 	 */
-	static float GetSpectralRolloff(const TArray64<float>& MagnitudeSpectrum, const float Percentile = 0.85);
+	static float GetSpectralRolloff(TArrayView64<const float> MagnitudeSpectrum, const float Percentile = 0.85);
 
 	/**
 	 * Calculate the spectral kurtosis given the first half of the magnitude spectrum of an audio signal
@@ -102,11 +192,45 @@ public:
 
 	/**
 	 * Calculate the spectral kurtosis given the first half of the magnitude spectrum of an audio signal
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
 	 * @return The spectral kurtosis
 	 * @note https://en.wikipedia.org/wiki/Kurtosis#Sample_kurtosis
 	 */
-	static float GetSpectralKurtosis(const TArray64<float>& MagnitudeSpectrum);
+	static float GetSpectralKurtosis(TArrayView64<const float> MagnitudeSpectrum);
+
+	/**
+	 * Calculate the requested spectral features given the first half of the magnitude spectrum of an audio signal
+	 * All the requested features are accumulated in a single pass over the spectrum, with an additional partial pass for the rolloff only
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param FeatureMask The mask of the features to compute, see ESpectralFeature
+	 * @param RolloffPercentile The rolloff threshold
+	 * @return The computed spectral features
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Core Frequency Domain Features")
+	static FSpectralFeatureSet GetSpectralFeatures(const TArray<float>& MagnitudeSpectrum, UPARAM(meta = (Bitmask, BitmaskEnum = "ESpectralFeature")) int32 FeatureMask = 31, const float RolloffPercentile = 0.85);
+
+	/**
+	 * Calculate the requested spectral features given the first half of the magnitude spectrum of an audio signal
+	 * Suitable for use with 64-bit data size and for array views without copies
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param FeatureMask The mask of the features to compute, see ESpectralFeature
+	 * @param RolloffPercentile The rolloff threshold
+	 * @return The computed spectral features
+	 */
+	static FSpectralFeatureSet GetSpectralFeatures(TArrayView64<const float> MagnitudeSpectrum, int32 FeatureMask = AllSpectralFeatures, const float RolloffPercentile = 0.85);
+
+	/**
+	 * Calculate the requested spectral features of a magnitude spectrum without copying it
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param NumOfBins The number of bins in the magnitude spectrum
+	 * @param FeatureMask The mask of the features to compute, see ESpectralFeature
+	 * @param RolloffPercentile The rolloff threshold
+	 * @return The computed spectral features
+	 */
+	static FSpectralFeatureSet GetSpectralFeatures(const float* MagnitudeSpectrum, int64 NumOfBins, int32 FeatureMask = AllSpectralFeatures, const float RolloffPercentile = 0.85);
 };
@@ -5,6 +5,39 @@
 #include "UObject/Object.h"
 #include "CoreTimeDomainFeatures.generated.h"
 
+/**
+ * Time domain features of a single audio frame, all computed in a single pass over the samples
+ */
+USTRUCT(BlueprintType, Category = "Core Time Domain Features")
+struct AUDIOANALYSISTOOLS_API FTimeDomainFeatureSet
+{
+	GENERATED_BODY()
+
+	FTimeDomainFeatureSet()
+		: SumOfSquares(0),
+		  RootMeanSquare(0),
+		  PeakEnergy(0),
+		  ZeroCrossingRate(0)
+	{
+	}
+
+	/** The sum of the squared samples, which is also the energy envelope */
+	UPROPERTY(BlueprintReadOnly, Category = "Core Time Domain Features")
+	float SumOfSquares;
+
+	/** The Root Mean Square (RMS) of the samples */
+	UPROPERTY(BlueprintReadOnly, Category = "Core Time Domain Features")
+	float RootMeanSquare;
+
+	/** The peak energy (max absolute value) of the samples */
+	UPROPERTY(BlueprintReadOnly, Category = "Core Time Domain Features")
+	float PeakEnergy;
+
+	/** The number of sign changes between successive samples */
+	UPROPERTY(BlueprintReadOnly, Category = "Core Time Domain Features")
+	float ZeroCrossingRate;
+};
+
 /**
  * Implementations of common time domain audio features
  */
@@ -25,12 +58,12 @@ public:
 
 	/**
 	 * Calculate the Root Mean Square (RMS) of an audio buffer in vector format
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 * 
 	 * @param AudioFrames An array containing audio frames in 32-bit float PCM format
 	 * @return The RMS value
 	 */
-	static float GetRootMeanSquare(const TArray64<float>& AudioFrames);
+	static float GetRootMeanSquare(TArrayView64<const float> AudioFrames);
 	
 	/**
 	 * Calculate the peak energy (max absolute value) in a time domain audio signal buffer in vector format
@@ -43,12 +76,12 @@ public:
 
 	/**
 	 * Calculate the peak energy (max absolute value) in a time domain audio signal buffer in vector format
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 * 
 	 * @param AudioFrames An array containing audio frame in 32-bit float PCM format
 	 * @return The peak energy value
 	 */
-	static float GetPeakEnergy(const TArray64<float>& AudioFrames);
+	static float GetPeakEnergy(TArrayView64<const float> AudioFrames);
 
 	/**
 	 * Calculate the zero crossing rate of a time domain audio signal buffer
@@ -61,10 +94,28 @@ public:
 
 	/**
 	 * Calculate the zero crossing rate of a time domain audio signal buffer
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param AudioFrames An array containing audio frame in 32-bit float PCM format
 	 * @return The zero crossing rate
 	 */
-	static float GetZeroCrossingRate(const TArray64<float>& AudioFrames);
+	static float GetZeroCrossingRate(TArrayView64<const float> AudioFrames);
+
+	/**
+	 * Calculate the sum of squares, the RMS, the peak energy and the zero crossing rate of a time domain audio signal buffer in a single vectorized pass
+	 *
+	 * @param AudioFrames An array containing audio frame in 32-bit float PCM format
+	 * @return The time domain features
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Core Time Domain Features")
+	static FTimeDomainFeatureSet GetTimeDomainFeatures(const TArray<float>& AudioFrames);
+
+	/**
+	 * Calculate the sum of squares, the RMS, the peak energy and the zero crossing rate of a time domain audio signal buffer in a single vectorized pass
+	 * Suitable for use with 64-bit data size and for array views without copies
+	 *
+	 * @param AudioFrames An array containing audio frame in 32-bit float PCM format
+	 * @return The time domain features
+	 */
+	static FTimeDomainFeatureSet GetTimeDomainFeatures(TArrayView64<const float> AudioFrames);
 };
@@ -14,14 +14,74 @@ struct FFTComplexSamples
 
 constexpr int32 MaxFactors = 32;
 
+/** The default minimum FFT size to run in parallel with EFFTExecutionPolicy::ParallelAboveThreshold */
+constexpr int64 DefaultFFTParallelThreshold = 65536;
+
+/**
+ * Execution policy of a single FFT
+ */
+UENUM(BlueprintType)
+enum class EFFTExecutionPolicy : uint8
+{
+	/** Run the whole FFT on the calling thread. Best for typical frame sizes, since independent frames and analyzers are already processed in parallel */
+	Inline,
+
+	/** Split the first FFT stage across worker threads, but only when the FFT size is at least the parallel threshold */
+	ParallelAboveThreshold
+};
+
 struct FFTStateStruct
 {
 	int64 NFFT;
 	int64 Inverse;
+
+	/** The number of complex samples of scratch memory needed to perform the FFT (in place and in parallel included), see PerformFFT */
+	int64 ScratchLength;
+
 	int64 Factors[2 * MaxFactors];
 	FFTComplexSamples Twiddles[1];
 };
 
+/**
+ * State of the real-input FFT. N real samples are packed into an N/2 complex FFT (SubState),
+ * and the result is split into the N/2 + 1 non-redundant bins using the super twiddles
+ */
+struct FFTRealStateStruct
+{
+	FFTStateStruct* SubState;
+	FFTComplexSamples* SuperTwiddles;
+};
+
+/**
+ * Split-complex (SoA) view of an FFT state, used by the vectorized FFT engine
+ * Twiddles are stored contiguously per stage, so that the butterflies can be vectorized across the stage length
+ */
+struct FFTSplitStateStruct
+{
+	const FFTStateStruct* State;
+	int64 NumStages;
+	int64 StageTwiddleOffsets[MaxFactors];
+	float* StageTwiddlesReal;
+	float* StageTwiddlesImaginary;
+
+	/** The number of floats of scratch memory needed to perform the FFT, see PerformFFTSplit */
+	int64 ScratchLength;
+
+	/**
+	 * Power-of-two split state used by the Bluestein (chirp-z) algorithm when the FFT size has a large prime factor
+	 * nullptr when the mixed-radix stages are used
+	 */
+	FFTSplitStateStruct* BluesteinState;
+
+	/** Bluestein chirp, NFFT values */
+	float* ChirpReal;
+	float* ChirpImaginary;
+
+	/** FFT of the Bluestein chirp filter, scaled by the inverse of the Bluestein FFT size */
+	float* ChirpFilterReal;
+	float* ChirpFilterImaginary;
+};
+
 /**
  * FFT Analyzer. Based on https://github.com/mborgerding/kissfft
  */
@@ -31,9 +91,89 @@ class AUDIOANALYSISTOOLS_API UFFTAudioAnalyzer : public UObject
 	GENERATED_BODY()
 
 public:
-	static void PerformFFT(FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut);
+	/**
+	 * Perform the complex FFT
+	 *
+	 * @param FFTState The FFT state allocated with PerformFFTAlloc
+	 * @param SamplesIn NFFT complex samples
+	 * @param SamplesOut NFFT complex samples
+	 * @param bParallel Whether to split the first FFT stage across worker threads or not. Only worth it for very large FFTs
+	 * @param Scratch FFTState->ScratchLength complex samples of scratch memory. If nullptr, the scratch memory of the calling thread is used,
+	 * which is only allocated the first time a larger FFT is performed on the thread
+	 */
+	static void PerformFFT(const FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut, bool bParallel = false, FFTComplexSamples* Scratch = nullptr);
 
 	static FFTStateStruct* PerformFFTAlloc(int64 NFFT, int64 Inverse_FFT, void* MemoryPtr, int64* MemoryLength);
 	
-	static void PerformFFTStride(FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut, int64 Stride);
+	static void PerformFFTStride(const FFTStateStruct* FFTState, const FFTComplexSamples* SamplesIn, FFTComplexSamples* SamplesOut, int64 Stride, bool bParallel = false, FFTComplexSamples* Scratch = nullptr);
+
+	/**
+	 * Perform the real-input FFT
+	 *
+	 * @param FFTRealState The real FFT state allocated with PerformFFTRealAlloc
+	 * @param SamplesIn NFFT real samples
+	 * @param SamplesOut NFFT / 2 + 1 complex samples (the non-redundant half of the spectrum)
+	 * @param bParallel Whether to split the first FFT stage across worker threads or not. Only worth it for very large FFTs
+	 * @param Scratch FFTRealState->SubState->ScratchLength complex samples of scratch memory. If nullptr, the scratch memory of the calling thread is used
+	 */
+	static void PerformFFTReal(const FFTRealStateStruct* FFTRealState, const float* SamplesIn, FFTComplexSamples* SamplesOut, bool bParallel = false, FFTComplexSamples* Scratch = nullptr);
+
+	/**
+	 * Resolve whether an FFT of the given size should run in parallel under the given execution policy
+	 *
+	 * @param ExecutionPolicy The execution policy
+	 * @param NFFT The FFT size
+	 * @param ParallelThreshold The minimum FFT size to run in parallel with EFFTExecutionPolicy::ParallelAboveThreshold
+	 * @return Whether the FFT should run in parallel or not
+	 */
+	static bool ShouldRunInParallel(EFFTExecutionPolicy ExecutionPolicy, int64 NFFT, int64 ParallelThreshold);
+
+	/**
+	 * Perform the complex FFT on split-complex (SoA) data using the vectorized engine
+	 *
+	 * @param FFTSplitState The split FFT state allocated with PerformFFTSplitAlloc
+	 * @param InReal NFFT real parts of the input
+	 * @param InImaginary NFFT imaginary parts of the input
+	 * @param OutReal NFFT real parts of the output. Must not overlap with the input
+	 * @param OutImaginary NFFT imaginary parts of the output. Must not overlap with the input
+	 * @param bParallel Whether to split the first FFT stage across worker threads or not. Only worth it for very large FFTs
+	 * @param Scratch FFTSplitState->ScratchLength floats of scratch memory. If nullptr, the scratch memory of the calling thread is used,
+	 * which is only allocated the first time a larger FFT is performed on the thread
+	 */
+	static void PerformFFTSplit(const FFTSplitStateStruct* FFTSplitState, const float* InReal, const float* InImaginary, float* OutReal, float* OutImaginary, bool bParallel = false, float* Scratch = nullptr);
+
+	/**
+	 * Perform the real-input FFT on split-complex (SoA) data using the vectorized engine
+	 *
+	 * @param FFTRealState The real FFT state allocated with PerformFFTRealAlloc
+	 * @param FFTSplitState The split FFT state allocated with PerformFFTSplitAlloc for the sub state of FFTRealState
+	 * @param InEven NFFT / 2 even-indexed real samples
+	 * @param InOdd NFFT / 2 odd-indexed real samples
+	 * @param OutReal NFFT / 2 + 1 real parts of the non-redundant half of the spectrum. Must not overlap with the input
+	 * @param OutImaginary NFFT / 2 + 1 imaginary parts of the non-redundant half of the spectrum. Must not overlap with the input
+	 * @param bParallel Whether to split the first FFT stage across worker threads or not. Only worth it for very large FFTs
+	 * @param Scratch FFTSplitState->ScratchLength floats of scratch memory. If nullptr, the scratch memory of the calling thread is used
+	 */
+	static void PerformFFTRealSplit(const FFTRealStateStruct* FFTRealState, const FFTSplitStateStruct* FFTSplitState, const float* InEven, const float* InOdd, float* OutReal, float* OutImaginary, bool bParallel = false, float* Scratch = nullptr);
+
+	/**
+	 * Allocate the split FFT state for the given FFT state. The FFT state must outlive the split state
+	 * If the FFT size has a prime factor large enough for the generic butterfly to dominate, the Bluestein algorithm is set up instead,
+	 * so that any FFT size runs in O(N log N)
+	 * Follows the same memory conventions as PerformFFTAlloc
+	 */
+	static FFTSplitStateStruct* PerformFFTSplitAlloc(const FFTStateStruct* FFTState, void* MemoryPtr, int64* MemoryLength);
+
+	/**
+	 * Whether the split FFT engine uses the vector (SSE/NEON) butterfly kernels or the scalar fallback
+	 * Selected once at startup, see au.AudioAnalysis.FFT.VectorKernels
+	 */
+	static bool IsUsingVectorKernels();
+
+	/**
+	 * Allocate the real-input FFT state. NFFT must be even
+	 * Only the forward FFT is supported, a non-zero Inverse_FFT is rejected and nullptr is returned
+	 * Follows the same memory conventions as PerformFFTAlloc
+	 */
+	static FFTRealStateStruct* PerformFFTRealAlloc(int64 NFFT, int64 Inverse_FFT, void* MemoryPtr, int64* MemoryLength);
 };
@@ -0,0 +1,138 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "HAL/CriticalSection.h"
+
+struct FFTStateStruct;
+struct FFTRealStateStruct;
+struct FFTSplitStateStruct;
+
+/**
+ * Immutable FFT plan containing the precomputed twiddles and factors for the given size and direction
+ * Plans are shared between analyzers, so they must never be modified after creation
+ */
+class AUDIOANALYSISTOOLS_API FFFTPlan
+{
+public:
+	/**
+	 * Create the FFT plan
+	 *
+	 * @param NFFT The FFT size
+	 * @param bInverse Whether the plan performs the inverse FFT or not
+	 * @param bReal Whether the plan performs the real-input FFT or not. NFFT must be even in this case
+	 */
+	FFFTPlan(int64 NFFT, bool bInverse, bool bReal);
+	~FFFTPlan();
+
+	FFFTPlan(const FFFTPlan&) = delete;
+	FFFTPlan& operator=(const FFFTPlan&) = delete;
+
+	/** Whether the plan has been created successfully or not */
+	bool IsValid() const { return (bReal ? RealState != nullptr : State != nullptr) && SplitState != nullptr; }
+
+	/** Get the FFT size */
+	int64 GetSize() const { return NFFT; }
+
+	/** Whether the plan performs the inverse FFT or not */
+	bool IsInverse() const { return bInverse; }
+
+	/** Whether the plan performs the real-input FFT or not */
+	bool IsReal() const { return bReal; }
+
+	/** Get the complex FFT state. Valid for complex plans only */
+	const FFTStateStruct* GetState() const { return State; }
+
+	/** Get the real FFT state. Valid for real plans only */
+	const FFTRealStateStruct* GetRealState() const { return RealState; }
+
+	/** Get the split-complex state used by the vectorized engine. For real plans, it is built for the half-sized complex sub state */
+	const FFTSplitStateStruct* GetSplitState() const { return SplitState; }
+
+	/**
+	 * Get the number of floats of scratch memory needed by the split-complex FFT of this plan
+	 * Plans are shared between threads, so each user allocates its own scratch memory once and passes it to the FFT
+	 */
+	int64 GetSplitScratchLength() const;
+
+	/** Get the number of bytes allocated by the plan */
+	int64 GetAllocatedSize() const { return AllocatedSize; }
+
+private:
+	int64 NFFT;
+	bool bInverse;
+	bool bReal;
+
+	/** The number of bytes of the states */
+	int64 AllocatedSize;
+
+	FFTStateStruct* State;
+	FFTRealStateStruct* RealState;
+	FFTSplitStateStruct* SplitState;
+};
+
+using FFFTPlanPtr = TSharedPtr<const FFFTPlan, ESPMode::ThreadSafe>;
+
+/**
+ * Process-wide, thread-safe cache of FFT plans keyed by size and direction
+ * Analyzers with the same frame size share a single set of twiddles and factors
+ * Plans no longer referenced outside of the cache are kept for reuse, until the cache holds MaxNumOfCachedPlans plans and a new one is created
+ */
+class AUDIOANALYSISTOOLS_API FFFTPlanCache
+{
+public:
+	/** The number of cached plans above which the plans no longer referenced outside of the cache are released when a new plan is created */
+	static constexpr int32 MaxNumOfCachedPlans = 16;
+
+	/** Get the global plan cache */
+	static FFFTPlanCache& Get();
+
+	/**
+	 * Find the plan with the given parameters or create it if it does not exist yet
+	 *
+	 * @param NFFT The FFT size
+	 * @param bInverse Whether the plan performs the inverse FFT or not
+	 * @param bReal Whether the plan performs the real-input FFT or not
+	 * @return The shared plan, or nullptr if the plan could not be created
+	 */
+	FFFTPlanPtr FindOrCreatePlan(int64 NFFT, bool bInverse = false, bool bReal = false);
+
+	/**
+	 * Release the plans that are no longer referenced outside of the cache
+	 */
+	void ReleaseUnusedPlans();
+
+	/**
+	 * Get the number of cached plans
+	 */
+	int32 GetNumPlans() const;
+
+private:
+	/** Release the plans that are no longer referenced outside of the cache. Must be called under the write lock */
+	void ReleaseUnusedPlansLocked();
+
+	struct FPlanKey
+	{
+		int64 NFFT;
+		bool bInverse;
+		bool bReal;
+
+		bool operator==(const FPlanKey& Other) const
+		{
+			return NFFT == Other.NFFT && bInverse == Other.bInverse && bReal == Other.bReal;
+		}
+
+		friend uint32 GetTypeHash(const FPlanKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.NFFT), GetTypeHash(static_cast<uint8>(Key.bInverse) | static_cast<uint8>(Key.bReal) << 1));
+		}
+	};
+
+	/** Cached plans. The cache holds a reference to keep the plans alive when analyzers change their frame size back and forth */
+	TMap<FPlanKey, FFFTPlanPtr> Plans;
+
+	/** Guards the plans map. Lookups are far more frequent than insertions */
+	mutable FRWLock PlansLock;
+};
@@ -0,0 +1,54 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Streaming decimation by two with a linear-phase half-band FIR filter
+ * Every other coefficient of a half-band filter is zero and the filter is symmetric, so each output sample costs only NumOfTaps / 4 + 1 multiplications
+ * The filter is a Blackman-windowed sinc with the cutoff at half the Nyquist frequency of the input
+ */
+class AUDIOANALYSISTOOLS_API FHalfBandDecimator
+{
+public:
+	/** The number of taps of the filter, including the zeros. Of the form 4k + 3, so the outermost taps are not zeros */
+	static constexpr int32 NumOfTaps = 31;
+
+	/** The delay of the filter in input samples */
+	static constexpr int32 Delay = (NumOfTaps - 1) / 2;
+
+	FHalfBandDecimator();
+
+	/** Clear the filter history */
+	void Reset();
+
+	/**
+	 * Get the maximum number of output samples for the given number of input samples
+	 *
+	 * @param NumOfInput The number of input samples
+	 * @return The maximum number of output samples
+	 */
+	static int64 GetMaxNumOfOutput(int64 NumOfInput) { return (NumOfInput + 1) / 2; }
+
+	/**
+	 * Filter and decimate the next input samples. Allocation-free once the working memory has grown to the largest block
+	 * The input and the output may be the same memory, since each output sample is written after the input samples it depends on have been read
+	 *
+	 * @param Input The input samples
+	 * @param NumOfInput The number of input samples
+	 * @param Output At least GetMaxNumOfOutput(NumOfInput) output samples to fill
+	 * @return The number of output samples written
+	 */
+	int64 Process(const float* Input, int64 NumOfInput, float* Output);
+
+private:
+	/** The nonzero coefficients beside the center tap, from the innermost to the outermost. The center tap is 0.5 */
+	float Coefficients[(NumOfTaps + 1) / 4];
+
+	/** The last NumOfTaps - 1 input samples followed by the input samples of the current block */
+	TArray64<float> History;
+
+	/** Whether the next output is due after the first input sample of the next block (0) or after the second one (1) */
+	int32 Phase;
+};
@@ -0,0 +1,206 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "Templates/SharedPointer.h"
+#include "HAL/CriticalSection.h"
+#include "MelFrequencyFeatures.generated.h"
+
+/**
+ * Immutable Mel filterbank for magnitude spectra of the given size and sample rate
+ * Only the nonzero range of each triangular filter is stored, so applying the filterbank reads each bin at most twice
+ */
+class AUDIOANALYSISTOOLS_API FMelFilterbank
+{
+public:
+	/**
+	 * Create the filterbank of triangular filters evenly spaced on the Mel scale from 0 Hz to the Nyquist frequency
+	 *
+	 * @param NumOfBins The number of bins of the magnitude spectrum, half the frame size
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 */
+	FMelFilterbank(int64 NumOfBins, int32 SampleRate, int32 NumOfBands);
+
+	/**
+	 * Compute the energy of each Mel band, the filter weighted sum of the power spectrum. Allocation-free
+	 *
+	 * @param MagnitudeSpectrum NumOfBins values of the magnitude spectrum
+	 * @param OutBandEnergies NumOfBands energies to fill
+	 */
+	void Apply(const float* MagnitudeSpectrum, float* OutBandEnergies) const;
+
+	/** Get the number of bins of the magnitude spectrum */
+	int64 GetNumOfBins() const { return NumOfBins; }
+
+	/** Get the number of Mel bands */
+	int32 GetNumOfBands() const { return NumOfBands; }
+
+private:
+	int64 NumOfBins;
+	int32 SampleRate;
+	int32 NumOfBands;
+
+	/** The first bin of the nonzero range of each filter */
+	TArray<int64> FirstBins;
+
+	/** The offset of the weights of each filter, plus the total number of weights */
+	TArray<int32> WeightOffsets;
+
+	/** The nonzero weights of all the filters */
+	TArray<float> Weights;
+};
+
+/**
+ * Immutable table of the orthonormal DCT-II turning log Mel band energies into Mel-frequency cepstral coefficients
+ */
+class AUDIOANALYSISTOOLS_API FMelDCT
+{
+public:
+	/**
+	 * Create the DCT table
+	 *
+	 * @param NumOfBands The number of Mel bands
+	 * @param NumOfCoefficients The number of cepstral coefficients
+	 */
+	FMelDCT(int32 NumOfBands, int32 NumOfCoefficients);
+
+	/**
+	 * Compute the cepstral coefficients of the log Mel band energies. Allocation-free
+	 *
+	 * @param LogBandEnergies NumOfBands log energies
+	 * @param OutCoefficients NumOfCoefficients coefficients to fill
+	 */
+	void Apply(const float* LogBandEnergies, float* OutCoefficients) const;
+
+	/** Get the number of Mel bands */
+	int32 GetNumOfBands() const { return NumOfBands; }
+
+	/** Get the number of cepstral coefficients */
+	int32 GetNumOfCoefficients() const { return NumOfCoefficients; }
+
+private:
+	int32 NumOfBands;
+	int32 NumOfCoefficients;
+
+	/** The cosine basis, one row of NumOfBands values per coefficient */
+	TArray<float> Table;
+};
+
+using FMelFilterbankPtr = TSharedPtr<const FMelFilterbank, ESPMode::ThreadSafe>;
+using FMelDCTPtr = TSharedPtr<const FMelDCT, ESPMode::ThreadSafe>;
+
+/**
+ * Process-wide, thread-safe cache of Mel filterbanks and DCT tables, so they are built once per configuration
+ * Tables no longer referenced outside of the cache are kept for reuse, until the cache holds MaxNumOfCachedFilterbanks filterbanks
+ * or MaxNumOfCachedDCTs DCT tables and a new one is created
+ */
+class AUDIOANALYSISTOOLS_API FMelFilterbankCache
+{
+public:
+	/** The number of cached filterbanks above which the filterbanks no longer referenced outside of the cache are released when a new filterbank is created */
+	static constexpr int32 MaxNumOfCachedFilterbanks = 16;
+
+	/** The number of cached DCT tables above which the DCT tables no longer referenced outside of the cache are released when a new DCT table is created */
+	static constexpr int32 MaxNumOfCachedDCTs = 16;
+
+	/** Get the global Mel filterbank cache */
+	static FMelFilterbankCache& Get();
+
+	/**
+	 * Find the filterbank with the given parameters or create it if it does not exist yet
+	 *
+	 * @param NumOfBins The number of bins of the magnitude spectrum, half the frame size
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 * @return The shared filterbank, or nullptr if the parameters are invalid
+	 */
+	FMelFilterbankPtr FindOrCreateFilterbank(int64 NumOfBins, int32 SampleRate, int32 NumOfBands);
+
+	/**
+	 * Find the DCT table with the given parameters or create it if it does not exist yet
+	 *
+	 * @param NumOfBands The number of Mel bands
+	 * @param NumOfCoefficients The number of cepstral coefficients
+	 * @return The shared DCT table, or nullptr if the parameters are invalid
+	 */
+	FMelDCTPtr FindOrCreateDCT(int32 NumOfBands, int32 NumOfCoefficients);
+
+	/**
+	 * Release the filterbanks and the DCT tables that are no longer referenced outside of the cache
+	 */
+	void ReleaseUnusedFilterbanks();
+
+private:
+	/** Release the filterbanks that are no longer referenced outside of the cache. Must be called under the write lock */
+	void ReleaseUnusedFilterbanksLocked();
+
+	/** Release the DCT tables that are no longer referenced outside of the cache. Must be called under the write lock */
+	void ReleaseUnusedDCTsLocked();
+
+	/** Cached filterbanks keyed by the number of bins, the sample rate and the number of bands */
+	TMap<TTuple<int64, int32, int32>, FMelFilterbankPtr> Filterbanks;
+
+	/** Cached DCT tables keyed by the number of bands and the number of coefficients */
+	TMap<TTuple<int32, int32>, FMelDCTPtr> DCTs;
+
+	/** Guards the maps. Lookups are far more frequent than insertions */
+	mutable FRWLock CacheLock;
+};
+
+/**
+ * Mel band energies and Mel-frequency cepstral coefficients (MFCC) of the magnitude spectrum, for voice activity detection and timbre classification
+ */
+UCLASS(BlueprintType, Category = "Mel Frequency Features")
+class AUDIOANALYSISTOOLS_API UMelFrequencyFeatures : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Calculate the energies of the Mel bands given the first half of the magnitude spectrum of an audio signal
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 * @return The energy of each Mel band, or an empty array if the parameters are invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mel Frequency Features")
+	static TArray<float> GetMelBandEnergies(const TArray<float>& MagnitudeSpectrum, int32 SampleRate, int32 NumOfBands = 40);
+
+	/**
+	 * Calculate the energies of the Mel bands given the first half of the magnitude spectrum of an audio signal
+	 * Suitable for use with 64-bit data size and for calculating without allocations
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param OutBandEnergies The energy of each Mel band to fill. The number of bands is its size
+	 * @return Whether the energies have been calculated or not
+	 */
+	static bool GetMelBandEnergies(TArrayView64<const float> MagnitudeSpectrum, int32 SampleRate, TArrayView<float> OutBandEnergies);
+
+	/**
+	 * Calculate the Mel-frequency cepstral coefficients given the first half of the magnitude spectrum of an audio signal
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 * @param NumOfCoefficients The number of cepstral coefficients, up to the number of bands
+	 * @return The cepstral coefficients, or an empty array if the parameters are invalid
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Get MFCC"), Category = "Mel Frequency Features")
+	static TArray<float> GetMFCC(const TArray<float>& MagnitudeSpectrum, int32 SampleRate, int32 NumOfBands = 40, int32 NumOfCoefficients = 13);
+
+	/**
+	 * Calculate the Mel-frequency cepstral coefficients given the first half of the magnitude spectrum of an audio signal
+	 * Suitable for use with 64-bit data size and for calculating without allocations
+	 *
+	 * @param MagnitudeSpectrum The first half of the magnitude spectrum (i.e. not mirrored)
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 * @param OutCoefficients The cepstral coefficients to fill. The number of coefficients is its size, up to the number of bands
+	 * @return Whether the coefficients have been calculated or not
+	 */
+	static bool GetMFCC(TArrayView64<const float> MagnitudeSpectrum, int32 SampleRate, int32 NumOfBands, TArrayView<float> OutCoefficients);
+};
@@ -0,0 +1,202 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "Analyzers/HalfBandDecimator.h"
+#include "Analyzers/SpectrumAnalyzer.h"
+#include "WindowsLibrary.h"
+#include "MultiResolutionAnalyzer.generated.h"
+
+class UBeatDetection;
+class UOnsetDetection;
+
+/**
+ * Multi-rate spectral analysis of a mono audio stream
+ * The low band is decimated by a chain of half-band filters and analyzed by a small FFT for the kick and snare beat detection,
+ * which gives the frequency resolution of a FFT that many times larger at the full sample rate for a fraction of its cost
+ * A separate short FFT at the full sample rate feeds the onset detection functions and the hi-hat beat detection, which need time resolution rather than frequency resolution
+ */
+UCLASS(BlueprintType, Category = "Multi Resolution Analyzer")
+class AUDIOANALYSISTOOLS_API UMultiResolutionAnalyzer : public UObject
+{
+	GENERATED_BODY()
+
+	UMultiResolutionAnalyzer();
+
+public:
+	/**
+	 * Instantiates a Multi Resolution Analyzer object
+	 *
+	 * @param SampleRate The sample rate of the audio
+	 * @param NumOfDecimationStages The number of decimations by two of the low band. The low band sample rate is SampleRate / 2^NumOfDecimationStages
+	 * @param LowBandFrameSize The number of low band audio frames in each FFT of the low band
+	 * @param LowBandHopSize The number of low band audio frames between two FFTs of the low band
+	 * @param OnsetFrameSize The number of audio frames in each FFT of the onset detection
+	 * @param OnsetHopSize The number of audio frames between two FFTs of the onset detection
+	 * @param WindowType The window function applied before both FFTs
+	 * @param EnergyHistoryDuration The duration of the energy history of the beat detection, in seconds
+	 * @return The MultiResolutionAnalyzer object, or nullptr if the configuration is invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multi Resolution Analyzer")
+	static UMultiResolutionAnalyzer* CreateMultiResolutionAnalyzer(int32 SampleRate, int32 NumOfDecimationStages = 3, int64 LowBandFrameSize = 1024, int64 LowBandHopSize = 128,
+		int64 OnsetFrameSize = 512, int64 OnsetHopSize = 256, EAnalysisWindowType WindowType = EAnalysisWindowType::HanningWindow, float EnergyHistoryDuration = 1.f);
+
+	/**
+	 * Process audio frames, analyzing the low band and the onset frames after every hop of each
+	 *
+	 * @param AudioFrames Mono audio frames in 32-bit float PCM format
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multi Resolution Analyzer")
+	void ProcessAudioFrames(const TArray<float>& AudioFrames);
+
+	/**
+	 * Process audio frames, analyzing the low band and the onset frames after every hop of each. Suitable for use with 64-bit data size and for array views without copies
+	 *
+	 * @param AudioFrames Mono audio frames in 32-bit float PCM format
+	 */
+	void ProcessAudioFrames(TArrayView64<const float> AudioFrames);
+
+	/**
+	 * Clear the decimation filters, the frames, the energy history and the onset detection history
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multi Resolution Analyzer")
+	void Reset();
+
+	/**
+	 * Whether there was a kick beat in the low band at the last low band analysis or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multi Resolution Analyzer")
+	bool IsKick() const;
+
+	/**
+	 * Whether there was a snare beat in the low band at the last low band analysis or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multi Resolution Analyzer")
+	bool IsSnare() const;
+
+	/**
+	 * Whether there was a hi-hat beat in the full band at the last onset analysis or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multi Resolution Analyzer")
+	bool IsHiHat() const;
+
+	/** Get the high frequency content of the last onset frame */
+	UFUNCTION(BlueprintPure, Category = "Multi Resolution Analyzer")
+	float GetHighFrequencyContent() const { return HighFrequencyContent; }
+
+	/** Get the half-wave rectified spectral difference of the last onset frame */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Get Spectral Difference HWR"), Category = "Multi Resolution Analyzer")
+	float GetSpectralDifferenceHWR() const { return SpectralDifferenceHWR; }
+
+	/** Get the complex spectral difference of the last onset frame */
+	UFUNCTION(BlueprintPure, Category = "Multi Resolution Analyzer")
+	float GetComplexSpectralDifference() const { return ComplexSpectralDifference; }
+
+	/** Get the magnitude spectrum of the last low band frame. Suitable for use with 64-bit data size */
+	TArrayView64<const float> GetLowBandMagnitudeSpectrum() const { return LowBandMagnitudeSpectrum; }
+
+	/** Get the magnitude spectrum of the last onset frame. Suitable for use with 64-bit data size */
+	TArrayView64<const float> GetOnsetMagnitudeSpectrum() const { return OnsetMagnitudeSpectrum; }
+
+	/** Get the sample rate of the low band */
+	UFUNCTION(BlueprintPure, Category = "Multi Resolution Analyzer")
+	float GetLowBandSampleRate() const;
+
+	/** Get the number of low band frames analyzed since the analyzer was created or reset */
+	UFUNCTION(BlueprintPure, Category = "Multi Resolution Analyzer")
+	int64 GetNumOfLowBandFrames() const { return NumOfLowBandFrames; }
+
+	/** Get the number of onset frames analyzed since the analyzer was created or reset */
+	UFUNCTION(BlueprintPure, Category = "Multi Resolution Analyzer")
+	int64 GetNumOfOnsetFrames() const { return NumOfOnsetFrames; }
+
+protected:
+	/**
+	 * Validate the configuration and allocate the filters, the frames and the spectra for it
+	 *
+	 * @return Whether the configuration is valid or not
+	 */
+	bool Configure(int32 InSampleRate, int32 InNumOfDecimationStages, int64 InLowBandFrameSize, int64 InLowBandHopSize, int64 InOnsetFrameSize, int64 InOnsetHopSize,
+		EAnalysisWindowType InWindowType, float InEnergyHistoryDuration);
+
+	/**
+	 * Append audio frames to a sliding frame, calling the analysis after every hop
+	 *
+	 * @param AudioFrames The audio frames to append
+	 * @param NumOfFrames The number of audio frames to append
+	 * @param Frame The sliding frame, with the newest audio frames at the end
+	 * @param PendingFrames The number of audio frames appended since the last analysis of the frame
+	 * @param HopSize The number of audio frames between two analyses of the frame
+	 * @param Analyze The analysis of the frame
+	 */
+	template <typename AnalyzeType>
+	static void AppendToFrame(const float* AudioFrames, int64 NumOfFrames, TArray64<float>& Frame, int64& PendingFrames, int64 HopSize, AnalyzeType&& Analyze);
+
+	/** Compute the low band spectrum and feed it to the low band beat detection */
+	void AnalyzeLowBandFrame();
+
+	/** Compute the full band spectrum and feed it to the onset detection and the hi-hat beat detection */
+	void AnalyzeOnsetFrame();
+
+	/** The beat detection of the low band spectrum, for the kick and the snare */
+	UPROPERTY()
+	UBeatDetection* LowBandBeatDetection;
+
+	/** The beat detection of the onset spectrum, for the hi-hat the low band cannot see */
+	UPROPERTY()
+	UBeatDetection* HighBandBeatDetection;
+
+	/** The onset detection of the onset spectrum */
+	UPROPERTY()
+	UOnsetDetection* OnsetDetection;
+
+	/** The decimation chain of the low band, the first stage running at the full sample rate */
+	TArray<FHalfBandDecimator> Decimators;
+
+	/** The output of the odd and of the even decimation stages of the current block */
+	TArray64<float> DecimationBuffers[2];
+
+	FSpectrumAnalyzer LowBandSpectrumAnalyzer;
+	FSpectrumAnalyzer OnsetSpectrumAnalyzer;
+
+	FWindowPtr LowBandWindow;
+	FWindowPtr OnsetWindow;
+
+	/** The last LowBandFrameSize low band audio frames */
+	TArray64<float> LowBandFrame;
+
+	/** The last OnsetFrameSize audio frames */
+	TArray64<float> OnsetFrame;
+
+	TArray64<float> LowBandReal;
+	TArray64<float> LowBandImaginary;
+	TArray64<float> LowBandMagnitudeSpectrum;
+
+	TArray64<float> OnsetReal;
+	TArray64<float> OnsetImaginary;
+	TArray64<float> OnsetMagnitudeSpectrum;
+
+	/** The number of low band audio frames appended since the last low band analysis */
+	int64 PendingLowBandFrames;
+
+	/** The number of audio frames appended since the last onset analysis */
+	int64 PendingOnsetFrames;
+
+	int64 NumOfLowBandFrames;
+	int64 NumOfOnsetFrames;
+
+	float HighFrequencyContent;
+	float SpectralDifferenceHWR;
+	float ComplexSpectralDifference;
+
+	int32 SampleRate;
+	int64 LowBandHopSize;
+	int64 OnsetHopSize;
+
+	/** The number of low band analyses in the energy history of the low band beat detection */
+	int64 LowBandEnergyHistorySize;
+
+	/** The number of onset analyses in the energy history of the hi-hat beat detection */
+	int64 OnsetEnergyHistorySize;
+};
@@ -5,6 +5,22 @@
 #include "UObject/Object.h"
 #include "OnsetDetection.generated.h"
 
+/**
+ * How the complex spectral difference predicts the current frame from the previous two frames
+ */
+UENUM(BlueprintType, Category = "Onset Detection")
+enum class EComplexSpectralDifferenceMode : uint8
+{
+	/** The phases are computed with atan2 and unwrapped explicitly, over all the bins. Works with any complex spectrum */
+	PhaseUnwrapping,
+
+	/**
+	 * The predicted phase is computed from the unit phasors of the previous two frames with complex multiplication, without atan2 or sin,
+	 * over the non-redundant half of the spectrum only. The FFT must be of real audio frames, so its second half mirrors the first one
+	 */
+	PhasorPrediction
+};
+
 /**
  * Provides various functions to detect onset
  */
@@ -28,7 +44,8 @@ public:
 	static UOnsetDetection* CreateOnsetDetection(int64 FrameSize);
 
 	/**
-	 * Update the frame size
+	 * Update the frame size and clear the history of all onset detection functions
+	 * The magnitude spectrum based functions are sized to FrameSize / 2, the complex spectral difference to FrameSize
 	 *
 	 * @param FrameSize The frame size of internal buffers
 	 */
@@ -36,7 +53,8 @@ public:
 	void UpdateFrameSize(int32 FrameSize);
 
 	/**
-	 * Update the frame size. Suitable for use with 64-bit data size
+	 * Update the frame size and clear the history of all onset detection functions. Suitable for use with 64-bit data size
+	 * The magnitude spectrum based functions are sized to FrameSize / 2, the complex spectral difference to FrameSize
 	 *
 	 * @param FrameSize The frame size of internal buffers
 	 */
@@ -52,12 +70,12 @@ public:
 	float GetEnergyEnvelope(const TArray<float>& AudioFrames);
 
 	/**
-	 * Calculate the energy envelope. Suitable for use with 64-bit data size
+	 * Calculate the energy envelope. Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param AudioFrames An array containing audio frame in 32-bit float PCM format
 	 * @return The energy difference onset detection function sample for the frame
 	 */
-	float GetEnergyEnvelope(const TArray64<float>& AudioFrames);
+	float GetEnergyEnvelope(TArrayView64<const float> AudioFrames);
 
 	/**
 	 * Calculate the energy difference between the current and previous energy sum
@@ -70,12 +88,21 @@ public:
 
 	/**
 	 * Calculate the energy difference between the current and previous energy sum
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param AudioFrames An array containing audio frame in 32-bit float PCM format
 	 * @return The energy difference onset detection function sample for the frame
 	 */
-	float GetEnergyDifference(const TArray64<float>& AudioFrames);
+	float GetEnergyDifference(TArrayView64<const float> AudioFrames);
+
+	/**
+	 * Calculate the energy difference between the given and previous energy sum
+	 * Used when the sum of the squared samples is already known, for example from UCoreTimeDomainFeatures::GetTimeDomainFeatures
+	 *
+	 * @param EnergySum The sum of the squared samples of the frame
+	 * @return The energy difference onset detection function sample for the frame
+	 */
+	float GetEnergyDifferenceFromSum(float EnergySum);
 
 	/**
 	 * Calculate the spectral difference between the current and the previous magnitude spectrum
@@ -88,12 +115,12 @@ public:
 
 	/**
 	 * Calculate the spectral difference between the current and the previous magnitude spectrum
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum An array containing the magnitude spectrum
 	 * @return The spectral difference onset detection function sample
 	 */
-	float GetSpectralDifference(const TArray64<float>& MagnitudeSpectrum);
+	float GetSpectralDifference(TArrayView64<const float> MagnitudeSpectrum);
 
 	/**
 	 * Calculate the half wave rectified spectral difference between the current and the previous magnitude spectrum
@@ -106,12 +133,12 @@ public:
 
 	/**
 	 * Calculate the half wave rectified spectral difference between the current and the previous magnitude spectrum
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum An array containing the magnitude spectrum
 	 * @return The HWR spectral difference onset detection function sample
 	 */
-	float GetSpectralDifferenceHWR(const TArray64<float>& MagnitudeSpectrum);
+	float GetSpectralDifferenceHWR(TArrayView64<const float> MagnitudeSpectrum);
 
 	/**
 	 * Calculate the complex spectral difference from the real and imaginary parts of the FFT
@@ -125,13 +152,27 @@ public:
 
 	/**
 	 * Calculate the complex spectral difference from the real and imaginary parts of the FFT
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param FFTReal An array containing the real part of the FFT
 	 * @param FFTImaginary An array containing the imaginary part of the FFT
 	 * @return The complex spectral difference onset detection function sample
 	 */
-	float GetComplexSpectralDifference(const TArray64<float>& FFTReal, const TArray64<float>& FFTImaginary);
+	float GetComplexSpectralDifference(TArrayView64<const float> FFTReal, TArrayView64<const float> FFTImaginary);
+
+	/**
+	 * Set how the complex spectral difference is computed, clearing its history
+	 *
+	 * @param Mode The complex spectral difference mode
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Onset Detection")
+	void SetComplexSpectralDifferenceMode(EComplexSpectralDifferenceMode Mode);
+
+	/**
+	 * Get how the complex spectral difference is computed
+	 */
+	UFUNCTION(BlueprintPure, Category = "Onset Detection")
+	EComplexSpectralDifferenceMode GetComplexSpectralDifferenceMode() const { return ComplexSpectralDifferenceMode; }
 
 	/**
 	 * Calculate the high frequency content onset detection function from the magnitude spectrum
@@ -144,12 +185,12 @@ public:
 
 	/**
 	 * Calculate the high frequency content onset detection function from the magnitude spectrum
-	 * Suitable for use with 64-bit data size
+	 * Suitable for use with 64-bit data size and for array views without copies
 	 *
 	 * @param MagnitudeSpectrum An array containing the magnitude spectrum
 	 * @return The high frequency content onset detection function sample
 	 */
-	static float GetHighFrequencyContent(const TArray64<float>& MagnitudeSpectrum);
+	static float GetHighFrequencyContent(TArrayView64<const float> MagnitudeSpectrum);
 
 private:
 	/**
@@ -175,23 +216,117 @@ private:
 		return PhaseValue;
 	}
 
+	/**
+	 * History of an onset detection function comparing consecutive magnitude spectra
+	 */
+	struct FMagnitudeDifferenceState
+	{
+		/** The previous magnitude spectrum passed to the onset detection function */
+		TArray64<float> PrevMagnitudeSpectrum;
+
+		/** Size the history for the given spectrum size and clear it */
+		void Reset(int64 SpectrumSize)
+		{
+			PrevMagnitudeSpectrum.SetNumZeroed(SpectrumSize);
+		}
+
+		/** Get the spectrum size the history is sized for */
+		int64 Num() const
+		{
+			return PrevMagnitudeSpectrum.Num();
+		}
+	};
+
+	/**
+	 * History of the complex spectral difference onset detection function
+	 */
+	struct FComplexSpectralDifferenceState
+	{
+		/** The previous phase spectrum passed to the last complex spectral difference call */
+		TArray64<float> PrevPhaseSpectrum;
+
+		/** The second previous phase spectrum passed to the last complex spectral difference call */
+		TArray64<float> PrevPhaseSpectrum2;
+
+		/** The previous magnitude spectrum passed to the last complex spectral difference call */
+		TArray64<float> PrevMagnitudeSpectrum;
+
+		/** Size the history for the given FFT size and clear it */
+		void Reset(int64 FFTSize)
+		{
+			PrevPhaseSpectrum.SetNumZeroed(FFTSize);
+			PrevPhaseSpectrum2.SetNumZeroed(FFTSize);
+			PrevMagnitudeSpectrum.SetNumZeroed(FFTSize);
+		}
+
+		/** Get the FFT size the history is sized for */
+		int64 Num() const
+		{
+			return PrevMagnitudeSpectrum.Num();
+		}
+	};
+
+	/**
+	 * History of the complex spectral difference onset detection function in the phasor prediction mode, for the non-redundant bins only
+	 */
+	struct FPhasorPredictionState
+	{
+		/** The unit phasor of each bin of the previous frame */
+		TArray64<float> PrevPhasorReal;
+		TArray64<float> PrevPhasorImaginary;
+
+		/** The unit phasor of each bin of the second previous frame */
+		TArray64<float> PrevPhasorReal2;
+		TArray64<float> PrevPhasorImaginary2;
+
+		/** The magnitude of each bin of the previous frame */
+		TArray64<float> PrevMagnitudeSpectrum;
+
+		/** The FFT size the history is sized for */
+		int64 FFTSize = 0;
+
+		/** Size the history for the given FFT size and clear it. The phasors are reset to a zero phase, as the phases of the phase unwrapping mode */
+		void Reset(int64 InFFTSize)
+		{
+			FFTSize = InFFTSize;
+
+			const int64 NumOfBins = FFTSize > 0 ? FFTSize / 2 + 1 : 0;
+			PrevPhasorReal.Init(1, NumOfBins);
+			PrevPhasorImaginary.SetNumZeroed(NumOfBins);
+			PrevPhasorReal2.Init(1, NumOfBins);
+			PrevPhasorImaginary2.SetNumZeroed(NumOfBins);
+			PrevMagnitudeSpectrum.SetNumZeroed(NumOfBins);
+		}
+
+		/** Get the FFT size the history is sized for */
+		int64 Num() const
+		{
+			return FFTSize;
+		}
+	};
+
+	/**
+	 * Calculate the complex spectral difference in the phasor prediction mode
+	 */
+	float GetComplexSpectralDifferenceByPrediction(TArrayView64<const float> FFTReal, TArrayView64<const float> FFTImaginary);
+
 	/** Holds the previous energy sum for the energy difference onset detection function */
 	float PreviousEnergySum;
 
-	/** An array containing the previous magnitude spectrum passed to the last spectral difference call */
-	TArray64<float> PrevMagnitudeSpectrum_SpectralDifference;
+	/** History of the spectral difference onset detection function */
+	FMagnitudeDifferenceState SpectralDifferenceState;
 
-	/** An array containing the previous magnitude spectrum passed to the last spectral difference (half wave rectified) call */
-	TArray64<float> PrevMagnitudeSpectrum_SpectralDifferenceHWR;
+	/** History of the half wave rectified spectral difference onset detection function */
+	FMagnitudeDifferenceState SpectralDifferenceHWRState;
 
-	/** An array containing the previous phase spectrum passed to the last complex spectral difference call */
-	TArray64<float> PrevPhaseSpectrum_ComplexSpectralDifference;
+	/** History of the complex spectral difference onset detection function */
+	FComplexSpectralDifferenceState ComplexSpectralDifferenceState;
 
-	/** An array containing the second previous phase spectrum passed to the last complex spectral difference call */
-	TArray64<float> PrevPhaseSpectrum2_ComplexSpectralDifference;
+	/** History of the complex spectral difference onset detection function in the phasor prediction mode */
+	FPhasorPredictionState PhasorPredictionState;
 
-	/** An array containing the previous magnitude spectrum passed to the last complex spectral difference call */
-	TArray64<float> PrevMagnitudeSpectrum_ComplexSpectralDifference;
+	/** How the complex spectral difference is computed */
+	EComplexSpectralDifferenceMode ComplexSpectralDifferenceMode;
 
 	int64 FrameSize;
 };
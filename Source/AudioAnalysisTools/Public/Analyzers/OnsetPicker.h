@@ -0,0 +1,120 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "Analyzers/SlidingMedian.h"
+#include "OnsetPicker.generated.h"
+
+/** Static delegate broadcast when an onset has been picked */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnOnsetPickedNative, float, float);
+
+/** Dynamic delegate broadcast when an onset has been picked */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnOnsetPicked, float, Timestamp, float, Strength);
+
+/**
+ * Streaming peak picking of an onset detection function, such as the functions of UOnsetDetection
+ * A sample is an onset if it is a local maximum above the adaptive threshold Offset + MedianWeight * median + MeanWeight * mean of the last WindowSize samples,
+ * and at least MinInterval seconds after the previous onset. The median and the mean are maintained incrementally,
+ * so the thresholding costs O(log WindowSize) per sample and does not allocate
+ */
+UCLASS(BlueprintType, Category = "Onset Picker")
+class AUDIOANALYSISTOOLS_API UOnsetPicker : public UObject
+{
+	GENERATED_BODY()
+
+	UOnsetPicker();
+
+public:
+	/**
+	 * Instantiates an Onset Picker object
+	 *
+	 * @param OnsetFunctionRate The number of onset detection function samples per second, usually the sample rate divided by the hop size of the analyzed frames
+	 * @param WindowSize The number of the latest onset detection function samples the threshold is computed over
+	 * @param MedianWeight The weight of the median in the threshold
+	 * @param MeanWeight The weight of the mean in the threshold
+	 * @param Offset The constant part of the threshold, suppressing onsets in near silence
+	 * @param MinInterval The minimum time between two onsets in seconds
+	 * @return The OnsetPicker object, or nullptr if the parameters are invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Onset Picker")
+	static UOnsetPicker* CreateOnsetPicker(float OnsetFunctionRate, int32 WindowSize = 16, float MedianWeight = 1, float MeanWeight = 0.5f, float Offset = 0, float MinInterval = 0.05f);
+
+	/**
+	 * Add the next onset detection function sample
+	 * A sample is confirmed to be a peak only once the next sample is added, so an onset is reported with a delay of one sample, but timestamped at its own sample
+	 *
+	 * @param OnsetValue The onset detection function sample of the latest analyzed frame
+	 * @return Whether an onset has been picked at the previous sample or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Onset Picker")
+	bool ProcessOnsetValue(float OnsetValue);
+
+	/**
+	 * Clear the threshold window and the picked onsets
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Onset Picker")
+	void Reset();
+
+	/** Get the time of the last picked onset in seconds since the picker was created or reset, or -1 if no onset has been picked yet */
+	UFUNCTION(BlueprintPure, Category = "Onset Picker")
+	float GetLastOnsetTime() const { return LastOnsetTime; }
+
+	/** Get the onset detection function value of the last picked onset */
+	UFUNCTION(BlueprintPure, Category = "Onset Picker")
+	float GetLastOnsetStrength() const { return LastOnsetStrength; }
+
+	/** Get the number of onsets picked since the picker was created or reset */
+	UFUNCTION(BlueprintPure, Category = "Onset Picker")
+	int64 GetNumOfOnsets() const { return NumOfOnsets; }
+
+	/** Get the threshold the latest candidate sample has been compared to */
+	UFUNCTION(BlueprintPure, Category = "Onset Picker")
+	float GetThreshold() const { return Threshold; }
+
+	/** Get the median of the threshold window */
+	UFUNCTION(BlueprintPure, Category = "Onset Picker")
+	float GetMedian() const { return SlidingMedian.GetMedian(); }
+
+	/** Get the mean of the threshold window */
+	UFUNCTION(BlueprintPure, Category = "Onset Picker")
+	float GetMean() const { return SlidingMedian.GetMean(); }
+
+	/** Bind to know when an onset has been picked. Broadcast on the thread adding the onset detection function samples */
+	UPROPERTY(BlueprintAssignable, Category = "Onset Picker|Delegates")
+	FOnOnsetPicked OnOnsetPicked;
+
+	/** Bind to know when an onset has been picked. Broadcast on the thread adding the onset detection function samples */
+	FOnOnsetPickedNative OnOnsetPickedNative;
+
+protected:
+	/** Median and mean of the threshold window */
+	FSlidingMedian SlidingMedian;
+
+	/** The sample before the candidate */
+	float PreviousValue;
+
+	/** The candidate sample, which is a peak if the next sample is not larger */
+	float CandidateValue;
+
+	/** The threshold of the candidate sample */
+	float Threshold;
+
+	/** The index of the candidate sample since the picker was created or reset */
+	int64 CandidateIndex;
+
+	/** The index of the last picked onset sample, or a large negative value if no onset has been picked yet */
+	int64 LastOnsetIndex;
+
+	float LastOnsetTime;
+	float LastOnsetStrength;
+	int64 NumOfOnsets;
+
+	float OnsetFunctionRate;
+	float MedianWeight;
+	float MeanWeight;
+	float Offset;
+
+	/** The minimum number of samples between two onsets */
+	int64 MinIntervalSamples;
+};
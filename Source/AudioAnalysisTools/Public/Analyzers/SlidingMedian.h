@@ -0,0 +1,106 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Median and mean of the last WindowSize values of a stream
+ * The window is split into a max-heap of the lower half and a min-heap of the upper half, and every slot of the window knows its heap position,
+ * so replacing the oldest value costs O(log WindowSize) and never allocates once configured
+ */
+class AUDIOANALYSISTOOLS_API FSlidingMedian
+{
+public:
+	FSlidingMedian();
+
+	/**
+	 * Allocate the window and clear it
+	 *
+	 * @param WindowSize The number of the latest values the median and the mean are computed over
+	 * @return Whether the window has been allocated or not
+	 */
+	bool Configure(int32 WindowSize);
+
+	/** Clear the window, keeping the allocation */
+	void Reset();
+
+	/**
+	 * Add the next value, replacing the oldest one once the window is full
+	 *
+	 * @param Value The value to add
+	 */
+	void Add(float Value);
+
+	/** Get the median of the values in the window, or 0 if the window is empty */
+	float GetMedian() const;
+
+	/** Get the mean of the values in the window, or 0 if the window is empty */
+	float GetMean() const { return NumOfValues > 0 ? static_cast<float>(Sum / NumOfValues) : 0; }
+
+	/** Get the number of values in the window, up to the window size */
+	int32 Num() const { return NumOfValues; }
+
+	/** Get the window size */
+	int32 GetWindowSize() const { return Values.Num(); }
+
+private:
+	/** The heap of the lower half of the values, with the largest of them on top */
+	static constexpr uint8 LowHeap = 0;
+
+	/** The heap of the upper half of the values, with the smallest of them on top */
+	static constexpr uint8 HighHeap = 1;
+
+	/** Whether the value of the first slot should be above the value of the second slot in the given heap or not */
+	bool IsHigherPriority(uint8 Heap, int32 FirstSlot, int32 SecondSlot) const
+	{
+		return Heap == LowHeap ? Values[FirstSlot] > Values[SecondSlot] : Values[FirstSlot] < Values[SecondSlot];
+	}
+
+	/** Insert the slot into the given heap */
+	void Push(uint8 Heap, int32 Slot);
+
+	/** Remove the slot from its heap */
+	void Remove(int32 Slot);
+
+	/** Move the heap entry at the given position towards the top or the bottom until the heap order holds */
+	void SiftUp(uint8 Heap, int32 HeapIndex);
+	void SiftDown(uint8 Heap, int32 HeapIndex);
+
+	/** Store the slot at the given heap position, keeping the position of the slot up to date */
+	void Place(uint8 Heap, int32 HeapIndex, int32 Slot)
+	{
+		Heaps[Heap][HeapIndex] = Slot;
+		SlotHeapIndices[Slot] = HeapIndex;
+	}
+
+	/** Move the top of the larger heap to the other one, so the low heap has as many values as the high heap or one more */
+	void Rebalance();
+
+	/** Recompute the sum of the window from scratch, discarding the accumulated rounding errors */
+	void RecomputeSum();
+
+	/** The values of the window, as a ring */
+	TArray<float> Values;
+
+	/** The heap each slot of the window belongs to */
+	TArray<uint8> SlotHeaps;
+
+	/** The position of each slot of the window in its heap */
+	TArray<int32> SlotHeapIndices;
+
+	/** The slots of the low and the high heap */
+	TArray<int32> Heaps[2];
+
+	/** The number of slots in the low and the high heap */
+	int32 HeapSizes[2];
+
+	/** The slot of the oldest value once the window is full, the next free slot otherwise */
+	int32 NextSlot;
+
+	/** The number of values in the window */
+	int32 NumOfValues;
+
+	/** Running sum of the values in the window */
+	double Sum;
+};
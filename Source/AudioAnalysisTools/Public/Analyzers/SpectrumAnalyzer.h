@@ -0,0 +1,56 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Analyzers/FFTPlanCache.h"
+
+/**
+ * Computes the FFT and the magnitude spectrum of windowed audio frames
+ * The FFT plan is shared through the plan cache, while the working memory is owned by each instance, so instances can run on different threads at the same time
+ */
+class AUDIOANALYSISTOOLS_API FSpectrumAnalyzer
+{
+public:
+	/**
+	 * Configure the analyzer for the given frame size. Real FFT is used for even frame sizes, complex FFT otherwise
+	 *
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @return Whether the analyzer has been configured successfully or not
+	 */
+	bool Configure(int64 FrameSize);
+
+	/** Release the FFT plan and the working memory */
+	void Reset();
+
+	/** Whether the analyzer is configured or not */
+	bool IsConfigured() const { return Plan.IsValid(); }
+
+	/** Get the configured frame size */
+	int64 GetFrameSize() const { return Plan.IsValid() ? Plan->GetSize() : 0; }
+
+	/**
+	 * Perform the FFT of the windowed audio frame and calculate its magnitude spectrum. Allocation-free
+	 *
+	 * @param AudioFrames FrameSize audio frames in 32-bit float PCM format
+	 * @param WindowFunction FrameSize values of the window function
+	 * @param OutReal FrameSize real parts of the FFT
+	 * @param OutImaginary FrameSize imaginary parts of the FFT
+	 * @param OutMagnitudeSpectrum FrameSize / 2 values of the magnitude spectrum
+	 * @param bParallel Whether to split the first FFT stage across worker threads or not. Only worth it for very large FFTs
+	 */
+	void Process(const float* AudioFrames, const float* WindowFunction, float* OutReal, float* OutImaginary, float* OutMagnitudeSpectrum, bool bParallel = false);
+
+private:
+	/** FFT plan shared with other analyzers of the same frame size. Real by default, complex for odd frame sizes only */
+	FFFTPlanPtr Plan;
+
+	/** Real parts of the FFT input. For the real FFT, these are the even windowed samples */
+	TArray64<float> InReal;
+
+	/** Imaginary parts of the FFT input. For the real FFT, these are the odd windowed samples, otherwise zeros */
+	TArray64<float> InImaginary;
+
+	/** Scratch memory of the FFT, sized from the plan */
+	TArray64<float> Scratch;
+};
@@ -0,0 +1,149 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "Analyzers/FFTAudioAnalyzer.h"
+#include "Analyzers/FFTPlanCache.h"
+#include "TempoEstimation.generated.h"
+
+/**
+ * Tempo (BPM) and beat phase estimation from an onset detection function, such as the HWR spectral difference of UOnsetDetection
+ * The onset detection function samples are kept in a ring buffer, and every few samples the tempo is re-estimated from its autocorrelation,
+ * computed in O(n log n) as the inverse FFT of the power spectrum of the zero-padded history
+ */
+UCLASS(BlueprintType, Category = "Tempo Estimation")
+class AUDIOANALYSISTOOLS_API UTempoEstimation : public UObject
+{
+	GENERATED_BODY()
+
+	UTempoEstimation();
+
+public:
+	/**
+	 * Instantiates a Tempo Estimation object
+	 *
+	 * @param OnsetFunctionRate The number of onset detection function samples per second, usually the sample rate divided by the hop size of the analyzed frames
+	 * @param HistorySize The number of onset detection function samples the tempo is estimated from. Should cover a few seconds
+	 * @param UpdateInterval The number of onset detection function samples between two tempo estimations
+	 * @param MinBPM The lowest detectable tempo
+	 * @param MaxBPM The highest detectable tempo
+	 * @return The TempoEstimation object, or nullptr if the parameters are invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Tempo Estimation")
+	static UTempoEstimation* CreateTempoEstimation(float OnsetFunctionRate, int64 HistorySize = 512, int64 UpdateInterval = 8, float MinBPM = 60, float MaxBPM = 200);
+
+	/**
+	 * Add the next onset detection function sample, re-estimating the tempo every UpdateInterval samples
+	 *
+	 * @param OnsetValue The onset detection function sample of the latest analyzed frame
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Tempo Estimation")
+	void ProcessOnsetValue(float OnsetValue);
+
+	/**
+	 * Clear the onset detection function history and the estimated tempo
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Tempo Estimation")
+	void Reset();
+
+	/**
+	 * Get the estimated tempo
+	 *
+	 * @return The tempo in beats per minute, or 0 if no tempo has been estimated yet
+	 */
+	UFUNCTION(BlueprintPure, Category = "Tempo Estimation")
+	float GetBPM() const { return BPM; }
+
+	/**
+	 * Get the position of the latest onset detection function sample within the current beat
+	 *
+	 * @return The beat phase from 0 (on the beat) to 1 (the next beat), advanced with every added sample between estimations
+	 */
+	UFUNCTION(BlueprintPure, Category = "Tempo Estimation")
+	float GetBeatPhase() const { return BeatPhase; }
+
+	/**
+	 * Get the confidence of the estimated tempo
+	 *
+	 * @return The autocorrelation at the beat period relative to the autocorrelation at zero lag, from 0 to 1
+	 */
+	UFUNCTION(BlueprintPure, Category = "Tempo Estimation")
+	float GetConfidence() const { return Confidence; }
+
+	/**
+	 * Get the estimated beat period
+	 *
+	 * @return The beat period in onset detection function samples, or 0 if no tempo has been estimated yet
+	 */
+	UFUNCTION(BlueprintPure, Category = "Tempo Estimation")
+	float GetBeatPeriod() const { return BeatPeriod; }
+
+	/**
+	 * Get the autocorrelation of the last estimation, normalized by the zero lag. Suitable for use with 64-bit data size
+	 */
+	TArrayView64<const float> GetAutocorrelation() const { return Autocorrelation; }
+
+protected:
+	/**
+	 * Validate the parameters and allocate the history and the FFT buffers
+	 *
+	 * @return Whether the parameters are valid or not
+	 */
+	bool Configure(float InOnsetFunctionRate, int64 InHistorySize, int64 InUpdateInterval, float InMinBPM, float InMaxBPM);
+
+	/** Re-estimate the tempo and the beat phase from the onset detection function history */
+	void EstimateTempo();
+
+	/** Compute the autocorrelation of the onset detection function history */
+	void ComputeAutocorrelation();
+
+	/** Find the offset of the latest beat, aligning a comb of the beat period with the onset detection function history */
+	void EstimateBeatPhase();
+
+	/** Get the onset detection function sample the given number of samples before the latest one */
+	float GetOnsetValue(int64 Age) const { return OnsetHistory[(HistoryPosition - 1 - Age + HistorySize) % HistorySize]; }
+
+	/** The forward FFT plan of the zero-padded history, shared through the plan cache */
+	FFFTPlanPtr ForwardPlan;
+
+	/** The inverse FFT plan of the power spectrum, shared through the plan cache */
+	FFFTPlanPtr InversePlan;
+
+	/** The onset detection function history, as a ring */
+	TArray64<float> OnsetHistory;
+
+	/** The zero-padded history, then the power spectrum */
+	TArray64<FFTComplexSamples> FFTInput;
+
+	/** The spectrum of the history, then the autocorrelation */
+	TArray64<FFTComplexSamples> FFTOutput;
+
+	/** Scratch memory of the FFTs */
+	TArray64<FFTComplexSamples> FFTScratch;
+
+	/** The autocorrelation of the last estimation up to the longest beat period, normalized by the zero lag */
+	TArray64<float> Autocorrelation;
+
+	/** The position of the oldest sample in the history */
+	int64 HistoryPosition;
+
+	/** The number of samples added since the history was cleared, up to the history size */
+	int64 NumOfOnsetValues;
+
+	/** The number of samples added since the last estimation */
+	int64 SamplesSinceEstimation;
+
+	/** The shortest and the longest beat period in onset detection function samples */
+	int64 MinLag;
+	int64 MaxLag;
+
+	float BPM;
+	float BeatPhase;
+	float BeatPeriod;
+	float Confidence;
+
+	float OnsetFunctionRate;
+	int64 HistorySize;
+	int64 UpdateInterval;
+};
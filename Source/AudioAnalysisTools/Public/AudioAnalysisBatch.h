@@ -0,0 +1,244 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "WindowsLibrary.h"
+
+#include "AudioAnalysisBatch.generated.h"
+
+class UImportedSoundWave;
+class UBeatDetection;
+class UOnsetDetection;
+class UAudioAnalysisCache;
+
+/**
+ * Features computed by the batch analysis. Used as bit indices of the feature mask
+ */
+UENUM(BlueprintType, meta = (Bitflags))
+enum class EAudioAnalysisFeature : uint8
+{
+	RootMeanSquare,
+	PeakEnergy,
+	ZeroCrossingRate,
+	SpectralCentroid,
+	SpectralFlatness,
+	SpectralCrest,
+	SpectralRolloff,
+	SpectralKurtosis,
+	EnergyDifference,
+	SpectralDifference,
+	SpectralDifferenceHWR,
+	ComplexSpectralDifference,
+	HighFrequencyContent,
+
+	/** Kick, snare and hi-hat beats */
+	Beats,
+
+	/** FFT subbands of beat detection */
+	Subbands,
+
+	Count UMETA(Hidden)
+};
+
+/** The feature mask containing all the batch analysis features */
+constexpr int32 AllAudioAnalysisFeatures = (1 << static_cast<int32>(EAudioAnalysisFeature::Count)) - 1;
+
+/**
+ * Per-hop feature tracks of the analyzed audio. Only the tracks of the requested features are filled, the others are empty
+ */
+USTRUCT(BlueprintType, Category = "Audio Analysis Tools")
+struct AUDIOANALYSISTOOLS_API FAudioAnalysisFeatureTracks
+{
+	GENERATED_BODY()
+
+	FAudioAnalysisFeatureTracks();
+
+	/** The number of audio frames in each analyzed frame */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	int64 FrameSize;
+
+	/** The number of audio frames between two consecutive analyzed frames */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	int64 HopSize;
+
+	/** The sample rate of the analyzed audio */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	int32 SampleRate;
+
+	/** The number of analyzed frames (hops), which is the length of each filled track */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	int64 NumOfHops;
+
+	/** The mask of the computed features, see EAudioAnalysisFeature */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch", meta = (Bitmask, BitmaskEnum = "EAudioAnalysisFeature"))
+	int32 FeatureMask;
+
+	/** The number of FFT subbands per hop. 0 if the subbands have not been computed */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	int64 NumOfSubbands;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> RootMeanSquare;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> PeakEnergy;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> ZeroCrossingRate;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralCentroid;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralFlatness;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralCrest;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralRolloff;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralKurtosis;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> EnergyDifference;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralDifference;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> SpectralDifferenceHWR;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> ComplexSpectralDifference;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> HighFrequencyContent;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<bool> IsKick;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<bool> IsSnare;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<bool> IsHiHat;
+
+	/** The FFT subbands of all the hops, NumOfSubbands per hop stored one hop after another */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|Batch")
+	TArray<float> FFTSubbands;
+
+	/** Whether the given feature has been computed or not */
+	bool HasFeature(EAudioAnalysisFeature Feature) const
+	{
+		return (FeatureMask & (1 << static_cast<int32>(Feature))) != 0;
+	}
+
+	/**
+	 * Get the start time of the given hop, in seconds
+	 *
+	 * @param HopIndex The hop index
+	 * @return The start time of the hop
+	 */
+	float GetHopTime(int64 HopIndex) const
+	{
+		return SampleRate > 0 ? static_cast<float>(static_cast<double>(HopIndex * HopSize) / SampleRate) : 0.f;
+	}
+};
+
+/** Static delegate broadcast the result of the batch analysis */
+DECLARE_DELEGATE_TwoParams(FOnSoundWaveAnalyzedNative, bool, const FAudioAnalysisFeatureTracks&);
+
+/** Dynamic delegate broadcast the result of the batch analysis */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnSoundWaveAnalyzed, bool, bSucceeded, const FAudioAnalysisFeatureTracks&, FeatureTracks);
+
+/** Static delegate broadcast the analysis cache loaded by the batch analysis */
+DECLARE_DELEGATE_TwoParams(FOnAnalysisCacheLoadedNative, bool, UAudioAnalysisCache*);
+
+/** Dynamic delegate broadcast the analysis cache loaded by the batch analysis */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnAnalysisCacheLoaded, bool, bSucceeded, UAudioAnalysisCache*, AnalysisCache);
+
+/**
+ * Offline analysis of whole sound waves
+ * The FFT and the stateless features are computed for blocks of frames in parallel, followed by a cheap sequential sweep for onset and beat detection
+ */
+UCLASS(BlueprintType, Category = "Audio Analysis Tools")
+class AUDIOANALYSISTOOLS_API UAudioAnalysisBatch : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Analyze the whole sound wave in the background, using all the worker threads
+	 * Multichannel audio is mixed down to mono. Onset and beat detection use their default settings
+	 *
+	 * @param ImportedSoundWave Sound wave to analyze
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames. Must be in the range from 1 to the frame size
+	 * @param WindowType The type of window function to use
+	 * @param FeatureMask The mask of the features to compute, see EAudioAnalysisFeature
+	 * @param Result Delegate broadcasting the result on the game thread
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Batch")
+	static void AnalyzeSoundWaveAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, UPARAM(meta = (Bitmask, BitmaskEnum = "EAudioAnalysisFeature")) int32 FeatureMask, const FOnSoundWaveAnalyzed& Result);
+
+	/**
+	 * Analyze the whole sound wave in the background, using all the worker threads. Suitable for use in C++
+	 *
+	 * @param ImportedSoundWave Sound wave to analyze
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames. Must be in the range from 1 to the frame size
+	 * @param WindowType The type of window function to use
+	 * @param FeatureMask The mask of the features to compute, see EAudioAnalysisFeature
+	 * @param Result Delegate broadcasting the result on the game thread
+	 */
+	static void AnalyzeSoundWaveAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask, const FOnSoundWaveAnalyzedNative& Result);
+
+	/**
+	 * Analyze mono audio on the calling thread, using all the worker threads
+	 *
+	 * @param AudioFrames Mono audio frames in 32-bit float PCM format
+	 * @param NumOfFrames The number of audio frames
+	 * @param SampleRate The sample rate of the audio
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames. Must be in the range from 1 to the frame size
+	 * @param WindowType The type of window function to use
+	 * @param FeatureMask The mask of the features to compute, see EAudioAnalysisFeature
+	 * @param BeatDetection Beat detection to process the frames to, if beats are requested. Exclusively used by this call
+	 * @param OnsetDetection Onset detection to process the frames to, if onset detection functions are requested. Exclusively used by this call
+	 * @param FeatureTracks The computed feature tracks
+	 * @return Whether the analysis succeeded or not
+	 */
+	static bool AnalyzeAudioFrames(const float* AudioFrames, int64 NumOfFrames, int32 SampleRate, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask,
+	                               UBeatDetection* BeatDetection, UOnsetDetection* OnsetDetection, FAudioAnalysisFeatureTracks& FeatureTracks);
+
+	/**
+	 * Analyze the whole sound wave into a serialized analysis cache, or reuse the cache written by a previous analysis of the same audio with the same settings
+	 * The cache file is named after the hash of the PCM data and the analysis settings, so a changed sound wave or changed settings are analyzed again
+	 *
+	 * @param ImportedSoundWave Sound wave to analyze
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames. Must be in the range from 1 to the frame size
+	 * @param WindowType The type of window function to use
+	 * @param FeatureMask The mask of the features to compute, see EAudioAnalysisFeature
+	 * @param CacheDirectory The directory of the cache files. The AudioAnalysisCache directory of the project saved directory if empty
+	 * @param Result Delegate broadcasting the memory-mapped cache on the game thread
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Batch")
+	static void AnalyzeSoundWaveToCacheAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, UPARAM(meta = (Bitmask, BitmaskEnum = "EAudioAnalysisFeature")) int32 FeatureMask, const FString& CacheDirectory, const FOnAnalysisCacheLoaded& Result);
+
+	/**
+	 * Analyze the whole sound wave into a serialized analysis cache, or reuse the cache written by a previous analysis of the same audio with the same settings. Suitable for use in C++
+	 *
+	 * @param ImportedSoundWave Sound wave to analyze
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames. Must be in the range from 1 to the frame size
+	 * @param WindowType The type of window function to use
+	 * @param FeatureMask The mask of the features to compute, see EAudioAnalysisFeature
+	 * @param CacheDirectory The directory of the cache files. The AudioAnalysisCache directory of the project saved directory if empty
+	 * @param Result Delegate broadcasting the memory-mapped cache on the game thread
+	 */
+	static void AnalyzeSoundWaveToCacheAsync(UImportedSoundWave* ImportedSoundWave, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask, const FString& CacheDirectory, const FOnAnalysisCacheLoadedNative& Result);
+};
@@ -0,0 +1,231 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+#include "AudioAnalysisBatch.h"
+#include "WindowsLibrary.h"
+#include "Async/MappedFileHandle.h"
+
+#include "AudioAnalysisCache.generated.h"
+
+/**
+ * Precomputed analysis of a sound wave, read from a compact binary cache file
+ * The file is memory-mapped, so loading it does not read or copy the tracks, and playback becomes a lookup of the hop by the playback time instead of a live FFT
+ * The cache is immutable once loaded, so it can be read from any thread
+ *
+ * The file consists of a header followed by 16-byte aligned sections: a float track per computed feature, the FFT subbands quantized to 16 bits with a scale per subband and a byte of beat and onset flags per hop
+ */
+UCLASS(BlueprintType, Category = "Audio Analysis Tools")
+class AUDIOANALYSISTOOLS_API UAudioAnalysisCache : public UObject
+{
+	GENERATED_BODY()
+
+	UAudioAnalysisCache();
+
+public:
+	//~ Begin UObject Interface
+	virtual void BeginDestroy() override;
+	//~ End UObject Interface
+
+	/**
+	 * Compute the key of the cache of the given audio analyzed with the given settings
+	 *
+	 * @param AudioFrames Mono audio frames in 32-bit float PCM format
+	 * @param NumOfFrames The number of audio frames
+	 * @param SampleRate The sample rate of the audio
+	 * @param FrameSize The number of audio frames in each analyzed frame
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames
+	 * @param WindowType The type of window function
+	 * @param FeatureMask The mask of the features, see EAudioAnalysisFeature
+	 * @return The hash of the PCM data and the analysis settings
+	 */
+	static uint64 ComputeCacheKey(const float* AudioFrames, int64 NumOfFrames, int32 SampleRate, int64 FrameSize, int64 HopSize, EAnalysisWindowType WindowType, int32 FeatureMask);
+
+	/**
+	 * Get the path of the cache file with the given key
+	 *
+	 * @param CacheDirectory The directory of the cache files. The AudioAnalysisCache directory of the project saved directory if empty
+	 * @param CacheKey The key of the cache
+	 * @return The path of the cache file
+	 */
+	static FString GetCacheFilePath(const FString& CacheDirectory, uint64 CacheKey);
+
+	/**
+	 * Serialize the feature tracks into a cache file. Onset flags are picked from the first computed onset detection function
+	 *
+	 * @param FeatureTracks The feature tracks to serialize
+	 * @param WindowType The type of window function the feature tracks have been computed with
+	 * @param CacheKey The key of the cache, see ComputeCacheKey
+	 * @param FilePath The path of the cache file to write
+	 * @return Whether the cache file has been written successfully or not
+	 */
+	static bool WriteCache(const FAudioAnalysisFeatureTracks& FeatureTracks, EAnalysisWindowType WindowType, uint64 CacheKey, const FString& FilePath);
+
+	/**
+	 * Read the key of the cache file without mapping the tracks
+	 *
+	 * @param FilePath The path of the cache file
+	 * @param CacheKey The key of the cache
+	 * @return Whether the cache file exists and has a valid header or not
+	 */
+	static bool ReadCacheKey(const FString& FilePath, uint64& CacheKey);
+
+	/**
+	 * Load the cache file by mapping it into memory
+	 *
+	 * @param FilePath The path of the cache file
+	 * @return The loaded cache, or nullptr if the file is missing or invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Cache")
+	static UAudioAnalysisCache* LoadCache(const FString& FilePath);
+
+	/**
+	 * Get the index of the hop analyzed at the given playback time
+	 *
+	 * @param Time The playback time in seconds
+	 * @return The hop index, or -1 if the time is outside of the analyzed audio
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	int64 GetHopIndexByTime(float Time) const;
+
+	/**
+	 * Get the value of the feature at the given playback time
+	 *
+	 * @param Feature The feature. Beats and subbands are read with the dedicated functions
+	 * @param Time The playback time in seconds
+	 * @return The value of the feature, or 0 if the feature has not been cached or the time is outside of the analyzed audio
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	float GetFeatureByTime(EAudioAnalysisFeature Feature, float Time) const;
+
+	/**
+	 * Get the whole track of the feature straight from the mapped file. Suitable for use in C++
+	 *
+	 * @param Feature The feature. Beats and subbands are read with the dedicated functions
+	 * @return The values of the feature per hop, or an empty view if the feature has not been cached
+	 */
+	TArrayView64<const float> GetFeatureTrack(EAudioAnalysisFeature Feature) const;
+
+	/**
+	 * Whether a kick beat has been detected at the given playback time or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	bool IsKickByTime(float Time) const;
+
+	/**
+	 * Whether a snare beat has been detected at the given playback time or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	bool IsSnareByTime(float Time) const;
+
+	/**
+	 * Whether a hi-hat beat has been detected at the given playback time or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	bool IsHiHatByTime(float Time) const;
+
+	/**
+	 * Whether an onset has been detected at the given playback time or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	bool IsOnsetByTime(float Time) const;
+
+	/**
+	 * Get the FFT subband at the given playback time
+	 *
+	 * @param Subband The subband index
+	 * @param Time The playback time in seconds
+	 * @return The dequantized value of the subband, or 0 if the subbands have not been cached or the time is outside of the analyzed audio
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	float GetSubbandByTime(int64 Subband, float Time) const;
+
+	/**
+	 * Get all the FFT subbands at the given playback time
+	 *
+	 * @param Time The playback time in seconds
+	 * @param Subbands The dequantized values of the subbands
+	 * @return Whether the subbands have been retrieved or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Cache")
+	bool GetSubbandsByTime(float Time, TArray<float>& Subbands) const;
+
+	/** Get the key of the cache */
+	uint64 GetCacheKey() const { return CacheKey; }
+
+	/** Get the number of audio frames in each analyzed frame */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	int64 GetFrameSize() const { return FrameSize; }
+
+	/** Get the number of audio frames between two consecutive analyzed frames */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	int64 GetHopSize() const { return HopSize; }
+
+	/** Get the sample rate of the analyzed audio */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	int32 GetSampleRate() const { return SampleRate; }
+
+	/** Get the number of analyzed hops */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	int64 GetNumOfHops() const { return NumOfHops; }
+
+	/** Get the number of FFT subbands per hop. 0 if the subbands have not been cached */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	int64 GetNumOfSubbands() const { return NumOfSubbands; }
+
+	/** Get the mask of the cached features, see EAudioAnalysisFeature */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache", meta = (Bitmask, BitmaskEnum = "EAudioAnalysisFeature"))
+	int32 GetFeatureMask() const { return FeatureMask; }
+
+	/** Get the window type the features have been computed with */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Cache")
+	EAnalysisWindowType GetWindowType() const { return WindowType; }
+
+private:
+	/**
+	 * Validate the mapped data and read the header into the members
+	 *
+	 * @return Whether the data is a valid cache or not
+	 */
+	bool InitializeFromData(const uint8* InData, int64 InDataSize);
+
+	/** Whether the given flag is set for the hop at the given playback time or not */
+	bool HasFlagByTime(uint8 Flag, float Time) const;
+
+	/** The mapped file. Null if mapping is not supported and the file has been read into memory */
+	TUniquePtr<IMappedFileHandle> MappedFile;
+
+	/** The mapped region of the whole file */
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** The file contents if mapping is not supported */
+	TArray64<uint8> FileData;
+
+	/** The cache data, either mapped or read into memory */
+	const uint8* Data;
+
+	/** The size of the cache data */
+	int64 DataSize;
+
+	/** Offsets of the float track of each feature in the data. 0 if the feature has not been cached */
+	TArray<int64> FeatureOffsets;
+
+	/** Offset of the dequantization scale of each subband */
+	int64 SubbandScalesOffset;
+
+	/** Offset of the quantized subbands */
+	int64 SubbandsOffset;
+
+	/** Offset of the beat and onset flags */
+	int64 FlagsOffset;
+
+	uint64 CacheKey;
+	int64 FrameSize;
+	int64 HopSize;
+	int32 SampleRate;
+	int64 NumOfHops;
+	int64 NumOfSubbands;
+	int32 FeatureMask;
+	EAnalysisWindowType WindowType;
+};
@@ -0,0 +1,149 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "Templates/UniquePtr.h"
+
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+
+/**
+ * Audio frames submitted for processing
+ */
+struct AUDIOANALYSISTOOLS_API FAudioFrameRequest
+{
+	FAudioFrameRequest();
+
+	/** Audio frames in 32-bit float PCM format */
+	TArray<float> AudioFrames;
+
+	/** The number of interleaved channels of the audio frames, or 0 for mono audio frames */
+	int32 NumChannels;
+
+	/** Whether to process the audio frames to beat detection or not */
+	bool bProcessToBeatDetection;
+
+	/** The cycles (FPlatformTime::Cycles64) when the request was submitted */
+	uint64 QueuedCycles;
+
+	/** Fulfilled with the index of the processed frame, or -1 if the request has been dropped or could not be processed. Optional */
+	TUniquePtr<TPromise<int64>> Promise;
+
+	/**
+	 * Fulfill the promise, if any
+	 *
+	 * @param FrameIndex The index of the processed frame, or -1 if the request has been dropped or could not be processed
+	 */
+	void Complete(int64 FrameIndex);
+};
+
+/**
+ * Bounded queue of audio frame requests. When the queue is full, the oldest request is dropped, so a burst of requests cannot pile up latency
+ * Any thread can push, while a single consumer pops. The queue is only locked to move a request in or out
+ */
+class AUDIOANALYSISTOOLS_API FAudioFrameQueue
+{
+public:
+	/**
+	 * @param Capacity The maximum number of pending requests
+	 */
+	explicit FAudioFrameQueue(int32 Capacity);
+
+	FAudioFrameQueue(const FAudioFrameQueue&) = delete;
+	FAudioFrameQueue& operator=(const FAudioFrameQueue&) = delete;
+
+	/**
+	 * Drop all the pending requests and change the capacity
+	 *
+	 * @param Capacity The maximum number of pending requests
+	 */
+	void Reset(int32 Capacity);
+
+	/**
+	 * Push the request, dropping the oldest pending request if the queue is full
+	 *
+	 * @param Request The request to push
+	 * @return Whether a pending request has been dropped to make room or not
+	 */
+	bool Push(FAudioFrameRequest&& Request);
+
+	/**
+	 * Pop the oldest pending request. Consumer thread only
+	 *
+	 * @param OutRequest The popped request
+	 * @return Whether a request has been popped or not
+	 */
+	bool Pop(FAudioFrameRequest& OutRequest);
+
+	/** Get the number of pending requests */
+	int32 Num() const;
+
+	/** Get the maximum number of pending requests */
+	int32 GetCapacity() const;
+
+	/** Get the number of requests dropped since the queue was created */
+	int64 GetNumDropped() const;
+
+private:
+	/** The pending requests. Count requests starting at Head, wrapping around */
+	TArray<FAudioFrameRequest> Slots;
+
+	/** The slot of the oldest pending request */
+	int32 Head;
+
+	/** The number of pending requests */
+	int32 Count;
+
+	/** The number of requests dropped since the queue was created */
+	int64 NumDropped;
+
+	/** Guards the slots and the counters */
+	mutable FCriticalSection QueueGuard;
+};
+
+/**
+ * Thread owned by an analyzer, running the work function each time it is woken up
+ */
+class AUDIOANALYSISTOOLS_API FAudioAnalysisThread : public FRunnable
+{
+public:
+	/**
+	 * Create and start the thread
+	 *
+	 * @param ThreadName The name of the thread
+	 * @param InWorkFunction The function to run each time the thread is woken up
+	 */
+	FAudioAnalysisThread(const TCHAR* ThreadName, TFunction<void()> InWorkFunction);
+
+	/** Stop the thread, waiting for the work function to return */
+	virtual ~FAudioAnalysisThread() override;
+
+	/**
+	 * Wake the thread up to run the work function. A wake-up while the work function is running makes it run once more, so no work is missed
+	 */
+	void WakeUp();
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+private:
+	/** The function to run each time the thread is woken up */
+	TFunction<void()> WorkFunction;
+
+	/** Auto-reset event the thread waits for */
+	FEvent* WakeUpEvent;
+
+	/** Whether the thread has been requested to stop or not */
+	std::atomic<bool> bStopRequested;
+
+	/** The running thread */
+	FRunnableThread* Thread;
+};
@@ -0,0 +1,74 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Lock-free single-producer single-consumer ring buffer of audio samples
+ * One thread pushes the samples, while another thread peeks and discards them, without any locking
+ */
+class AUDIOANALYSISTOOLS_API FAudioAnalysisRingBuffer
+{
+public:
+	FAudioAnalysisRingBuffer();
+
+	FAudioAnalysisRingBuffer(const FAudioAnalysisRingBuffer&) = delete;
+	FAudioAnalysisRingBuffer& operator=(const FAudioAnalysisRingBuffer&) = delete;
+
+	/**
+	 * Reallocate the buffer and discard all the samples. Must not be called while pushing or consuming
+	 *
+	 * @param Capacity The minimum number of samples the buffer can hold. Rounded up to the power of two
+	 */
+	void Reset(int64 Capacity);
+
+	/**
+	 * Push the samples to the buffer. Producer thread only
+	 *
+	 * @param Samples The samples to push
+	 * @param NumSamples The number of samples to push
+	 * @return The number of pushed samples, which is less than NumSamples if the buffer is full
+	 */
+	int64 Push(const float* Samples, int64 NumSamples);
+
+	/**
+	 * Copy the oldest samples without consuming them. Consumer thread only
+	 *
+	 * @param OutSamples The samples to fill
+	 * @param NumSamples The number of samples to copy
+	 * @return The number of copied samples, which is less than NumSamples if not enough samples are available
+	 */
+	int64 Peek(float* OutSamples, int64 NumSamples) const;
+
+	/**
+	 * Consume the oldest samples. Consumer thread only
+	 *
+	 * @param NumSamples The number of samples to consume
+	 * @return The number of consumed samples, which is less than NumSamples if not enough samples are available
+	 */
+	int64 Discard(int64 NumSamples);
+
+	/** Get the number of samples available to the consumer */
+	int64 GetNumAvailable() const;
+
+	/** Get the total number of samples pushed since the buffer was reset */
+	int64 GetNumPushed() const { return WriteIndex.load(std::memory_order_acquire); }
+
+	/** Get the number of samples the buffer can hold */
+	int64 GetCapacity() const { return Buffer.Num(); }
+
+private:
+	/** Sample storage. The size is a power of two, so that the indices are wrapped with a mask */
+	TArray64<float> Buffer;
+
+	/** Mask to wrap the indices into the buffer */
+	int64 IndexMask;
+
+	/** The total number of pushed samples. Written by the producer only */
+	std::atomic<int64> WriteIndex;
+
+	/** The total number of consumed samples. Written by the consumer only */
+	std::atomic<int64> ReadIndex;
+};
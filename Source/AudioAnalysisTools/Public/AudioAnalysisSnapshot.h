@@ -0,0 +1,127 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Analyzers/CoreFrequencyDomainFeatures.h"
+#include "Analyzers/CoreTimeDomainFeatures.h"
+
+#include <atomic>
+
+/**
+ * Analysis results of a single processed audio frame
+ * Filled by the analysis worker and read-only for the reader, except for the spectral features computed on demand by the reader
+ */
+struct AUDIOANALYSISTOOLS_API FAudioAnalysisSnapshot
+{
+	FAudioAnalysisSnapshot();
+
+	/** The number of audio frames processed before this one. -1 if no audio frame has been processed yet */
+	int64 SequenceNumber;
+
+	/** The processed audio frames */
+	TArray64<float> AudioFrames;
+
+	/** The magnitude spectrum of the processed audio frames */
+	TArray64<float> MagnitudeSpectrum;
+
+	/** The real part of the FFT of the processed audio frames */
+	TArray64<float> FFTReal;
+
+	/** The imaginary part of the FFT of the processed audio frames */
+	TArray64<float> FFTImaginary;
+
+	/** The value of each beat detection sub-band */
+	TArray64<float> BeatSubbands;
+
+	/** Whether there was a beat in each beat detection sub-band or not, with 64 sub-bands per word */
+	TArray64<uint64> BeatMask;
+
+	/** Whether there was a kick beat or not */
+	bool bIsKick;
+
+	/** Whether there was a snare drum beat or not */
+	bool bIsSnare;
+
+	/** Whether there was a hi-hat beat or not */
+	bool bIsHiHat;
+
+	/** The spectral features of the magnitude spectrum computed so far. Computed by the reader on demand */
+	FSpectralFeatureSet SpectralFeatures;
+
+	/** The time domain features of the audio frames. Computed by the reader on demand */
+	FTimeDomainFeatureSet TimeDomainFeatures;
+
+	/** Whether the time domain features have been computed or not */
+	bool bTimeDomainFeaturesComputed;
+
+	/** Get the number of bytes allocated by the snapshot arrays */
+	SIZE_T GetAllocatedSize() const
+	{
+		return AudioFrames.GetAllocatedSize() + MagnitudeSpectrum.GetAllocatedSize() + FFTReal.GetAllocatedSize() + FFTImaginary.GetAllocatedSize() + BeatSubbands.GetAllocatedSize() + BeatMask.GetAllocatedSize();
+	}
+};
+
+/**
+ * Triple buffer of analysis snapshots, passing the most recent snapshot from a single writer to a single reader
+ * Neither side ever waits for the other: the writer fills its own snapshot while the reader keeps the one it has acquired, and published snapshots are exchanged atomically
+ */
+class AUDIOANALYSISTOOLS_API FAudioAnalysisSnapshotBuffer
+{
+public:
+	FAudioAnalysisSnapshotBuffer();
+
+	/**
+	 * Get the snapshot to fill. Exclusively owned by the writer until it is published
+	 *
+	 * @return The snapshot to fill
+	 */
+	FAudioAnalysisSnapshot& GetWriteSnapshot()
+	{
+		return Snapshots[WriteIndex];
+	}
+
+	/**
+	 * Publish the filled snapshot to the reader. The writer continues with the snapshot the reader has not acquired
+	 */
+	void Publish();
+
+	/**
+	 * Get the most recently published snapshot. Exclusively owned by the reader until its next call
+	 *
+	 * @return The most recently published snapshot
+	 */
+	FAudioAnalysisSnapshot& GetReadSnapshot();
+
+	/**
+	 * Get the sequence number of the most recently published snapshot. Can be called from any thread
+	 *
+	 * @return The sequence number, or -1 if no snapshot has been published yet
+	 */
+	int64 GetPublishedSequenceNumber() const
+	{
+		return PublishedSequenceNumber.load(std::memory_order_acquire);
+	}
+
+private:
+	/** Marks the published snapshot as not yet acquired by the reader */
+	static constexpr int32 FreshSnapshotFlag = 4;
+
+	/** Extracts the snapshot index from the published state */
+	static constexpr int32 SnapshotIndexMask = 3;
+
+	/** The snapshots, each owned by the writer, the reader or the published state */
+	FAudioAnalysisSnapshot Snapshots[3];
+
+	/** The index of the snapshot owned by the writer */
+	int32 WriteIndex;
+
+	/** The index of the snapshot owned by the reader */
+	int32 ReadIndex;
+
+	/** The index of the published snapshot, combined with FreshSnapshotFlag */
+	std::atomic<int32> PublishedState;
+
+	/** The sequence number of the most recently published snapshot */
+	std::atomic<int64> PublishedSequenceNumber;
+};
@@ -0,0 +1,97 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+
+#include "AudioAnalysisSubmixCapture.generated.h"
+
+class FAudioAnalysisSubmixListener;
+class UAudioAnalysisToolsLibrary;
+class USoundSubmix;
+
+/**
+ * Captures the audio rendered to a submix and analyzes it with the streaming mode of an analyzer
+ * The audio is pushed on the audio render thread as soon as it is mixed, so no polling from the game thread, no copies under the sound wave lock and no Runtime Audio Importer sound wave is needed
+ * Multichannel audio is mixed down to mono
+ */
+UCLASS(BlueprintType, Category = "Audio Analysis Tools")
+class AUDIOANALYSISTOOLS_API UAudioAnalysisSubmixCapture : public UObject
+{
+	GENERATED_BODY()
+
+	UAudioAnalysisSubmixCapture();
+
+public:
+	//~ Begin UObject Interface
+	virtual void BeginDestroy() override;
+	//~ End UObject Interface
+
+	/**
+	 * Instantiates a submix capture
+	 *
+	 * @param Analyzer The analyzer to analyze the captured audio with. Its streaming mode must be enabled before starting the capture, and cannot be toggled until the capture stops
+	 * @return The submix capture object
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Capture")
+	static UAudioAnalysisSubmixCapture* CreateSubmixCapture(UAudioAnalysisToolsLibrary* Analyzer);
+
+	/**
+	 * Start capturing the audio rendered to the submix
+	 *
+	 * @param WorldContextObject Object of the world whose audio device renders the submix
+	 * @param Submix The submix to capture. The main submix if not specified
+	 * @return Whether the capture has been started or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Capture", meta = (WorldContext = "WorldContextObject"))
+	bool StartCapture(const UObject* WorldContextObject, USoundSubmix* Submix = nullptr);
+
+	/**
+	 * Stop capturing. The audio already pushed to the streaming buffer is still analyzed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Capture")
+	void StopCapture();
+
+	/**
+	 * Whether the audio is being captured or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Capture")
+	bool IsCapturing() const;
+
+	/**
+	 * Get the audio clock of the given streamed audio frame, to align the analysis with the audio render timeline. Suitable for use in C++
+	 * The first audio frame of the streaming hop with index HopIndex is HopIndex * HopSize. The audio frames dropped by the full streaming buffer are skipped,
+	 * so the clock is exact for the audio frames pushed after the latest drop
+	 *
+	 * @param StreamedFrameIndex The index of the audio frame since the streaming mode of the analyzer was enabled
+	 * @return The audio clock of the audio frame in seconds, or a negative value if no audio has been captured yet or the audio frame was pushed before the capture started
+	 */
+	double GetAudioClockOfFrame(int64 StreamedFrameIndex) const;
+
+	/**
+	 * Get the number of audio frames pushed to the analyzer since the capture started, excluding the dropped ones
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Capture")
+	int64 GetNumOfCapturedFrames() const;
+
+	/**
+	 * Get the number of rendered audio frames dropped since the capture started because the streaming buffer of the analyzer was full
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Capture")
+	int64 GetNumOfDroppedFrames() const;
+
+	/** The analyzer the captured audio is analyzed with */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio Analysis Tools|References")
+	UAudioAnalysisToolsLibrary* Analyzer;
+
+private:
+	/** The listener registered to the audio device */
+	TSharedPtr<FAudioAnalysisSubmixListener, ESPMode::ThreadSafe> Listener;
+
+	/** The captured submix. Kept referenced while capturing */
+	UPROPERTY()
+	USoundSubmix* CapturedSubmix;
+
+	/** The ID of the audio device rendering the captured submix */
+	uint32 CapturedDeviceId;
+};
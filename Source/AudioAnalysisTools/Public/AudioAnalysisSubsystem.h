@@ -0,0 +1,122 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "Subsystems/EngineSubsystem.h"
+#include "Tickable.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include <atomic>
+
+#include "AudioAnalysisSubsystem.generated.h"
+
+class UAudioAnalysisToolsLibrary;
+
+/** Static delegate broadcast when a batch of queued audio frames has been analyzed */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAnalysisBatchProcessedNative, int32);
+
+/** Dynamic delegate broadcast when a batch of queued audio frames has been analyzed */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAnalysisBatchProcessed, int32, NumOfAnalyzers);
+
+/**
+ * Analyzes the audio frames queued to many Audio Analysis Tools objects at once
+ * Each tick, the pending audio frames of all the registered analyzers are collected on the game thread and analyzed as a single batch over the worker threads,
+ * instead of a separate background task per analyzer. Analyzers of the same frame size are processed next to each other, sharing the same FFT plan
+ */
+UCLASS(Category = "Audio Analysis Tools")
+class AUDIOANALYSISTOOLS_API UAudioAnalysisSubsystem : public UEngineSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+	UAudioAnalysisSubsystem();
+
+public:
+	/**
+	 * Get the subsystem
+	 *
+	 * @return The subsystem, or nullptr if the engine is not initialized
+	 */
+	static UAudioAnalysisSubsystem* Get();
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+	/**
+	 * Register the analyzer, so its queued audio frames are analyzed in the batches
+	 *
+	 * @param Analyzer The analyzer to register
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Subsystem")
+	void RegisterAnalyzer(UAudioAnalysisToolsLibrary* Analyzer);
+
+	/**
+	 * Unregister the analyzer. Its queued audio frames that have not yet been collected are not analyzed
+	 *
+	 * @param Analyzer The analyzer to unregister
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Subsystem")
+	void UnregisterAnalyzer(UAudioAnalysisToolsLibrary* Analyzer);
+
+	/**
+	 * Whether the analyzer is registered or not
+	 *
+	 * @param Analyzer The analyzer to check
+	 * @return Whether the analyzer is registered or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Subsystem")
+	bool IsAnalyzerRegistered(const UAudioAnalysisToolsLibrary* Analyzer) const;
+
+	/** Bind to know when a batch has been analyzed. Broadcast on the game thread with the number of analyzers in the batch */
+	UPROPERTY(BlueprintAssignable, Category = "Audio Analysis Tools|Delegates")
+	FOnAnalysisBatchProcessed OnAnalysisBatchProcessed;
+
+	/** Bind to know when a batch has been analyzed. Broadcast on the game thread with the number of analyzers in the batch */
+	FOnAnalysisBatchProcessedNative OnAnalysisBatchProcessedNative;
+
+private:
+	/** Audio frames of a single analyzer collected into the batch */
+	struct FBatchJob
+	{
+		/** The analyzer resolved on the game thread. Kept alive by the batch analyzers until the batch completes */
+		UAudioAnalysisToolsLibrary* Analyzer = nullptr;
+
+		/** The collected audio frames. Swapped with the pending audio frames of the analyzer, so both allocations are reused between batches */
+		TArray64<float> AudioFrames;
+
+		bool bProcessToBeatDetection = true;
+
+		/** The cycles when the job was collected on the game thread, for tracing the queue latency */
+		uint64 QueuedCycles = 0;
+	};
+
+	/** Analyze the collected batch jobs over the worker threads */
+	void ProcessBatch(int32 NumOfJobs);
+
+	/** The registered analyzers */
+	TArray<TWeakObjectPtr<UAudioAnalysisToolsLibrary>> Analyzers;
+
+	/** The jobs of the current batch, sorted by the frame size. Only the first jobs collected in the current batch are valid, the rest keep their allocations for the next batches */
+	TArray<FBatchJob> BatchJobs;
+
+	/** The analyzers of the current batch, referenced so they are not garbage collected while the worker threads process them. Accessed on the game thread only */
+	UPROPERTY()
+	TArray<UAudioAnalysisToolsLibrary*> BatchAnalyzers;
+
+	/** Whether the current batch is being analyzed or not. The batch jobs are owned by the worker threads while it is set */
+	std::atomic<bool> bBatchRunning;
+
+	/** The task analyzing the current batch, to wait for before the batch jobs are released */
+	FGraphEventRef BatchTask;
+
+	/** Whether the subsystem has been initialized and not yet deinitialized */
+	bool bInitialized;
+};
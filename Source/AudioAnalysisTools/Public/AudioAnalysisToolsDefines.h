@@ -7,5 +7,55 @@
 #include "Logging/LogCategory.h"
 #include "Logging/LogMacros.h"
 #include "Logging/LogVerbosity.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogAudioAnalysis, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("Audio Analysis"), STATGROUP_AudioAnalysis, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Audio Frames"), STAT_AudioAnalysis_ProcessAudioFrames, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Streaming Buffer"), STAT_AudioAnalysis_ProcessStreamingBuffer, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Batch"), STAT_AudioAnalysis_ProcessBatch, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Analyze Audio Frames (Offline)"), STAT_AudioAnalysis_AnalyzeAudioFrames, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Perform FFT"), STAT_AudioAnalysis_PerformFFT, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FFT Transform"), STAT_AudioAnalysis_FFTTransform, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Beat Detection Update"), STAT_AudioAnalysis_BeatDetectionUpdate, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Band Trigger Update"), STAT_AudioAnalysis_BandTriggerUpdate, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tempo Estimation"), STAT_AudioAnalysis_TempoEstimation, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Multi-Resolution Update"), STAT_AudioAnalysis_MultiResolutionUpdate, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Feature"), STAT_AudioAnalysis_GetFeature, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Submix Capture"), STAT_AudioAnalysis_SubmixCapture, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Processed Frames"), STAT_AudioAnalysis_ProcessedFrames, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched Analyzers"), STAT_AudioAnalysis_BatchedAnalyzers, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("FFT Plans"), STAT_AudioAnalysis_FFTPlans, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Window Tables"), STAT_AudioAnalysis_WindowTables, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Last Queue Latency (ms)"), STAT_AudioAnalysis_QueueLatency, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("FFT Plan Memory"), STAT_AudioAnalysis_FFTPlanMemory, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Window Table Memory"), STAT_AudioAnalysis_WindowTableMemory, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Analyzer Buffer Memory"), STAT_AudioAnalysis_BufferMemory, STATGROUP_AudioAnalysis, AUDIOANALYSISTOOLS_API);
+
+/**
+ * Events of the AudioAnalysis trace channel, for Unreal Insights captures. Enable with -trace=AudioAnalysis
+ */
+namespace AudioAnalysisTrace
+{
+	/**
+	 * Trace the time an analysis job waited from being queued until a worker thread started it
+	 *
+	 * @param AnalyzerId The unique ID of the analyzer object
+	 * @param QueuedCycles The cycles (FPlatformTime::Cycles64) when the job was queued
+	 */
+	AUDIOANALYSISTOOLS_API void TraceQueueLatency(uint32 AnalyzerId, uint64 QueuedCycles);
+
+	/**
+	 * Trace the processing of a single audio frame by an analyzer, so the cost can be attributed per analyzer
+	 *
+	 * @param AnalyzerId The unique ID of the analyzer object
+	 * @param StartCycles The cycles (FPlatformTime::Cycles64) when the processing started
+	 * @param FrameSize The number of audio frames processed
+	 */
+	AUDIOANALYSISTOOLS_API void TraceFrameProcessed(uint32 AnalyzerId, uint64 StartCycles, int64 FrameSize);
+}
@@ -5,9 +5,14 @@
 #include "UObject/Object.h"
 #include "Sound/ImportedSoundWave.h"
 #include "WindowsLibrary.h"
-
-struct FFTStateStruct;
-struct FFTComplexSamples;
+#include "AudioChannelsLibrary.h"
+#include "Analyzers/CoreFrequencyDomainFeatures.h"
+#include "Analyzers/CoreTimeDomainFeatures.h"
+#include "Analyzers/FFTAudioAnalyzer.h"
+#include "Analyzers/SpectrumAnalyzer.h"
+#include "AudioAnalysisRingBuffer.h"
+#include "AudioAnalysisFrameQueue.h"
+#include "AudioAnalysisSnapshot.h"
 
 #include "AudioAnalysisToolsLibrary.generated.h"
 
@@ -15,6 +20,38 @@ class UBeatDetection;
 class UEnvelopeAnalysis;
 class UOnsetDetection;
 
+/** Static delegate broadcast when a streamed audio frame has been analyzed */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnStreamingFrameProcessedNative, int64);
+
+/** Dynamic delegate broadcast when a streamed audio frame has been analyzed */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStreamingFrameProcessed, int64, HopIndex);
+
+/** Static delegate broadcast when audio frames submitted with ProcessAudioFrames have been analyzed */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAudioFramesProcessedNative, int64);
+
+/** Dynamic delegate broadcast when audio frames submitted with ProcessAudioFrames have been analyzed */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAudioFramesProcessed, int64, FrameIndex);
+
+/** The default maximum number of audio frame requests waiting to be processed by the background policies */
+constexpr int32 DefaultFrameQueueCapacity = 4;
+
+/**
+ * How the audio frames submitted from the game thread with ProcessAudioFrames and ProcessInterleavedAudioFrames are processed
+ * Audio frames submitted from other threads are always processed on the calling thread
+ */
+UENUM(BlueprintType)
+enum class EAudioProcessingPolicy : uint8
+{
+	/** Process the audio frames by background tasks, one request at a time per analyzer and in submission order */
+	TaskPipe,
+
+	/** Process the audio frames synchronously on the calling thread, so the results are available as soon as the call returns */
+	Inline,
+
+	/** Process the audio frames on a thread owned by the analyzer, which avoids waiting for free task workers */
+	DedicatedThread
+};
+
 /**
  * Audio Analysis Tools object. Main class simplifying the analysis of audio data.
  * Works in conjunction with the Runtime Audio Importer plugin.
@@ -25,9 +62,12 @@ class AUDIOANALYSISTOOLS_API UAudioAnalysisToolsLibrary : public UObject
 	GENERATED_BODY()
 	
 	UAudioAnalysisToolsLibrary();
+	virtual ~UAudioAnalysisToolsLibrary() override;
 	
 	//~ Begin UObject Interface
 	virtual void BeginDestroy() override;
+	virtual bool IsReadyForFinishDestroy() override;
+	virtual void FinishDestroy() override;
 	//~ End UObject Interface
 
 public:
@@ -41,7 +81,7 @@ public:
 	static UAudioAnalysisToolsLibrary* CreateAudioAnalysisTools(int64 FrameSize = 4096, EAnalysisWindowType WindowType = EAnalysisWindowType::HanningWindow);
 
 	/**
-	 * Process audio frames
+	 * Process audio frames according to the processing policy, followed by OnAudioFramesProcessed
 	 * 
 	 * @param AudioFrames An array containing audio frames in 32-bit float PCM format
 	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
@@ -49,6 +89,169 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Main")
 	void ProcessAudioFrames(TArray<float> AudioFrames, bool bProcessToBeatDetection = true);
 
+	/**
+	 * Process audio frames according to the processing policy, followed by OnAudioFramesProcessed
+	 *
+	 * @param AudioFrames An array containing audio frames in 32-bit float PCM format
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 * @return The future index of the processed frame (see GetLatestFrameIndex), or -1 if the frames have been dropped or could not be processed
+	 */
+	TFuture<int64> ProcessAudioFramesAsync(TArray<float> AudioFrames, bool bProcessToBeatDetection = true);
+
+	/**
+	 * Process audio frames on the calling thread. Suitable for use with 64-bit data size and for processing audio owned by the caller without copies
+	 * The audio frames are copied once into the reused internal buffer, so the view only needs to stay valid for the duration of the call
+	 *
+	 * @param AudioFrames Audio frames in 32-bit float PCM format
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 */
+	void ProcessAudioFrames(TArrayView64<const float> AudioFrames, bool bProcessToBeatDetection = true);
+
+	/**
+	 * Process interleaved multichannel audio frames according to the channel mode and the processing policy, followed by OnAudioFramesProcessed
+	 * 
+	 * @param AudioFrames An array containing interleaved audio frames in 32-bit float PCM format
+	 * @param NumChannels The number of channels
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Main")
+	void ProcessInterleavedAudioFrames(TArray<float> AudioFrames, int32 NumChannels, bool bProcessToBeatDetection = true);
+
+	/**
+	 * Process interleaved multichannel audio frames according to the channel mode and the processing policy, followed by OnAudioFramesProcessed
+	 *
+	 * @param AudioFrames An array containing interleaved audio frames in 32-bit float PCM format
+	 * @param NumChannels The number of channels
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 * @return The future index of the processed frame (see GetLatestFrameIndex), or -1 if the frames have been dropped or could not be processed
+	 */
+	TFuture<int64> ProcessInterleavedAudioFramesAsync(TArray<float> AudioFrames, int32 NumChannels, bool bProcessToBeatDetection = true);
+
+	/**
+	 * Process interleaved multichannel audio frames according to the channel mode on the calling thread. Suitable for use with 64-bit data size and for processing audio owned by the caller without copies
+	 * The channels are mixed down or extracted straight into the reused internal buffer, so multichannel audio is not copied twice
+	 *
+	 * @param AudioFrames Interleaved audio frames in 32-bit float PCM format
+	 * @param NumChannels The number of channels
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 */
+	void ProcessInterleavedAudioFrames(TArrayView64<const float> AudioFrames, int32 NumChannels, bool bProcessToBeatDetection = true);
+
+	/**
+	 * Set how multichannel audio is processed by ProcessInterleavedAudioFrames and ProcessAudioByCurrentTime
+	 * To analyze each channel separately, de-interleave the audio once with UAudioChannelsLibrary::Deinterleave and process each channel with its own analyzer
+	 *
+	 * @param InChannelMode The channel mode. Interleaved by default, which analyzes the interleaved samples as if they were mono
+	 * @param Channel The index of the channel to analyze with the SingleChannel mode
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Main")
+	void SetChannelMode(EAudioChannelMode InChannelMode = EAudioChannelMode::DownmixToMono, int32 Channel = 0);
+
+	/**
+	 * Set how the audio frames submitted from the game thread with ProcessAudioFrames and ProcessInterleavedAudioFrames are processed
+	 * Requests still waiting to be processed are dropped. Must be called from the game thread
+	 *
+	 * @param InProcessingPolicy The processing policy. TaskPipe by default
+	 * @param QueueCapacity The maximum number of requests waiting to be processed by the TaskPipe and DedicatedThread policies. The oldest request is dropped when a new one does not fit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Main")
+	void SetProcessingPolicy(EAudioProcessingPolicy InProcessingPolicy = EAudioProcessingPolicy::TaskPipe, int32 QueueCapacity = 4);
+
+	/** Get how the audio frames submitted from the game thread are processed */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Main")
+	EAudioProcessingPolicy GetProcessingPolicy() const { return ProcessingPolicy; }
+
+	/** Get the number of audio frame requests dropped because the processing could not keep up */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Main")
+	int64 GetNumDroppedFrameRequests() const;
+
+	/** Bind to know when audio frames submitted with ProcessAudioFrames or ProcessInterleavedAudioFrames have been analyzed. Broadcast on the game thread with the index of the processed frame */
+	UPROPERTY(BlueprintAssignable, Category = "Audio Analysis Tools|Delegates")
+	FOnAudioFramesProcessed OnAudioFramesProcessed;
+
+	/** Bind to know when audio frames submitted with ProcessAudioFrames or ProcessInterleavedAudioFrames have been analyzed. Broadcast on the game thread with the index of the processed frame */
+	FOnAudioFramesProcessedNative OnAudioFramesProcessedNative;
+
+private:
+	/**
+	 * Process the request on the calling thread or hand it over to the background processing, according to the processing policy
+	 *
+	 * @param Request The request to process
+	 */
+	void SubmitFrameRequest(FAudioFrameRequest&& Request);
+
+	/**
+	 * Process the audio frames of the request on the calling thread
+	 *
+	 * @param Request The request to process
+	 * @return The index of the processed frame, or -1 if the frames could not be processed
+	 */
+	int64 ProcessFrameRequest(const FAudioFrameRequest& Request);
+
+	/**
+	 * Fulfill the promise of the processed request and broadcast OnAudioFramesProcessed on the game thread
+	 *
+	 * @param Request The processed request
+	 * @param FrameIndex The index of the processed frame, or -1 if the frames could not be processed
+	 */
+	void CompleteFrameRequest(FAudioFrameRequest& Request, int64 FrameIndex);
+
+	/** Schedule the processing of the frame queue in the background, unless it is already scheduled */
+	void ScheduleFrameQueueProcessing();
+
+	/** Process every request in the frame queue */
+	void ProcessFrameQueue();
+
+	/** Wait until no frame queue task is scheduled or running. Game thread only, since it is the only thread scheduling them */
+	void WaitForFrameQueueTasks();
+
+	/** How the audio frames submitted from the game thread are processed */
+	EAudioProcessingPolicy ProcessingPolicy;
+
+	/** The requests waiting to be processed by the TaskPipe and DedicatedThread policies */
+	FAudioFrameQueue FrameQueue;
+
+	/** Whether the processing of the frame queue is scheduled or running with the TaskPipe policy */
+	std::atomic<bool> bFrameQueueProcessingScheduled;
+
+	/** The number of frame queue tasks scheduled or running. Counted before a task is queued, so the analyzer is not torn down before the task exits */
+	std::atomic<int32> NumFrameQueueTasksInFlight;
+
+	/** Triggered when the last frame queue task in flight exits */
+	FEvent* FrameQueueTasksDoneEvent;
+
+	/** Set once the analyzer begins to be destroyed, so the background processing stops popping requests */
+	std::atomic<bool> bFrameQueueShutdown;
+
+	/** The thread processing the frame queue with the DedicatedThread policy */
+	TUniquePtr<FAudioAnalysisThread> AnalysisThread;
+
+public:
+
+	/**
+	 * Queue audio frames to be processed by UAudioAnalysisSubsystem on the next tick, in a single batch with the frames queued to other analyzers
+	 * Registers the analyzer with the subsystem if needed. Only the most recently queued audio frames are processed if several are queued before the batch collects them
+	 * Must be called from the game thread
+	 *
+	 * @param AudioFrames An array containing audio frames in 32-bit float PCM format
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 * @return Whether the audio frames have been queued or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Main")
+	bool QueueAudioFrames(const TArray<float>& AudioFrames, bool bProcessToBeatDetection = true);
+
+	/**
+	 * Process audio from imported sound wave by current playback time on the calling thread
+	 * Reads the frame size audio frames starting from the current playback time of the sound wave directly from its PCM data, without intermediate arrays
+	 * Multichannel audio is processed according to the channel mode. With the Interleaved mode, the samples are read interleaved like GetAudioByCurrentTime does
+	 *
+	 * @param ImportedSoundWave Sound wave to extract audio data
+	 * @param bProcessToBeatDetection Whether to process audio frame to beat detection or not
+	 * @return Whether the audio frames have been processed or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Main")
+	bool ProcessAudioByCurrentTime(UImportedSoundWave* ImportedSoundWave, bool bProcessToBeatDetection = true);
+
 	/**
 	 * Get audio from imported sound wave by current playback time
 	 * Gets the audio data starting from the current playback time of the sound wave with the size of FrameSize
@@ -81,6 +284,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Advanced")
 	static bool GetAudioByFrameRange(UImportedSoundWave* ImportedSoundWave, int64 StartFrame, int64 EndFrame, TArray<float>& AudioFrames);
 
+	/**
+	 * View audio of imported sound wave by frame range (from StartFrame to EndFrame frames) without copying it
+	 * The sound wave data is locked while the visitor is executed, so the view must not be used after the visitor returns
+	 *
+	 * @param ImportedSoundWave Sound wave to extract audio data
+	 * @param StartFrame Start frame size for extracting audio data
+	 * @param EndFrame End frame size for extracting audio data
+	 * @param Visitor Function receiving the view of the audio frames in 32-bit float PCM format
+	 * @return Whether the visitor has been executed or not
+	 */
+	static bool ViewAudioByFrameRange(UImportedSoundWave* ImportedSoundWave, int64 StartFrame, int64 EndFrame, TFunctionRef<void(TArrayView64<const float>)> Visitor);
+
 	/**
 	 * Get audio from imported sound wave by time length
 	 * Gets the audio data starting from the current playing time of the sound wave with the size of the AudioFrames equal to the input TimeLength
@@ -112,6 +327,107 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Advanced")
 	void UpdateFrameSize(int64 FrameSize);
 
+	/**
+	 * Set the execution policy of the FFT performed on each processed audio frame
+	 *
+	 * @param ExecutionPolicy The execution policy. Inline is recommended, since independent frames and analyzers are already processed in parallel
+	 * @param ParallelThreshold The minimum frame size to split the FFT across worker threads with the ParallelAboveThreshold policy
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set FFT Execution Policy"), Category = "Audio Analysis Tools|Advanced")
+	void SetFFTExecutionPolicy(EFFTExecutionPolicy ExecutionPolicy = EFFTExecutionPolicy::Inline, int64 ParallelThreshold = 65536);
+
+	/**
+	 * Enable the streaming mode, in which audio of arbitrary length is pushed with PushAudioFrames and analyzed every HopSize frames
+	 * Consecutive analyzed frames overlap by FrameSize - HopSize frames (e.g. 75% overlap with HopSize = FrameSize / 4), which improves the time resolution of onset and beat detection
+	 * Discards all the pushed but not yet analyzed audio frames. Must not be called while audio frames are being pushed, and is rejected while a streaming producer is attached
+	 *
+	 * @param HopSize The number of audio frames between two consecutive analyzed frames. Must be in the range from 1 to the frame size
+	 * @param bProcessToBeatDetection Whether to process the analyzed frames to beat detection or not
+	 * @param BufferCapacity The number of audio frames the streaming buffer can hold. Four frame sizes if 0
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Streaming")
+	void EnableStreaming(int64 HopSize = 1024, bool bProcessToBeatDetection = true, int64 BufferCapacity = 0);
+
+	/**
+	 * Disable the streaming mode and discard all the pushed but not yet analyzed audio frames
+	 * Must not be called while audio frames are being pushed, and is rejected while a streaming producer is attached
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Streaming")
+	void DisableStreaming();
+
+	/**
+	 * Whether the streaming mode is enabled or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Streaming")
+	bool IsStreaming() const;
+
+	/**
+	 * Push audio frames of arbitrary length to the streaming buffer. Every complete hop is analyzed in the background, followed by OnStreamingFrameProcessed
+	 * Audio frames must be pushed from a single thread at a time. The frames that do not fit into the streaming buffer are dropped
+	 *
+	 * @param AudioFrames An array containing audio frames in 32-bit float PCM format
+	 * @return Whether all the audio frames have been pushed or not
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Streaming")
+	bool PushAudioFrames(const TArray<float>& AudioFrames);
+
+	/**
+	 * Push audio frames of arbitrary length to the streaming buffer. Suitable for use with 64-bit data size and for calling from the audio thread without copies
+	 *
+	 * @param AudioFrames Audio frames in 32-bit float PCM format
+	 * @param NumOfFrames The number of audio frames
+	 * @return Whether all the audio frames have been pushed or not
+	 */
+	bool PushAudioFrames64(const float* AudioFrames, int64 NumOfFrames);
+
+	/**
+	 * Push audio frames to the streaming buffer without logging, for real-time threads such as the audio render thread
+	 * The audio frames that do not fit into the streaming buffer are dropped and counted, and the analysis is only scheduled once a whole frame is buffered
+	 *
+	 * @param AudioFrames Audio frames in 32-bit float PCM format
+	 * @param NumOfFrames The number of audio frames
+	 * @return The number of pushed audio frames, or 0 if the streaming mode is disabled
+	 */
+	int64 TryPushAudioFrames64(const float* AudioFrames, int64 NumOfFrames);
+
+	/**
+	 * Get the number of audio frames dropped because the streaming buffer was full, since the streaming mode was enabled
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Streaming")
+	int64 GetNumOfDroppedStreamingFrames() const;
+
+	/**
+	 * Get the number of audio frames pushed to the streaming buffer since the streaming mode was enabled, excluding the dropped ones
+	 * The first audio frame of the hop with index HopIndex is the audio frame HopIndex * HopSize of this count
+	 */
+	int64 GetNumOfStreamedFrames() const;
+
+	/**
+	 * Attach the producer pushing audio frames from another thread, such as a submix capture
+	 * While it is attached, the streaming buffer is never reallocated, so enabling and disabling the streaming mode are rejected
+	 *
+	 * @return Whether the producer has been attached or not. Fails if the streaming mode is disabled or another producer is attached
+	 */
+	bool AttachStreamingProducer();
+
+	/**
+	 * Detach the producer attached with AttachStreamingProducer. It must no longer push audio frames
+	 */
+	void DetachStreamingProducer();
+
+	/**
+	 * Whether a streaming producer is attached or not
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Streaming")
+	bool IsStreamingProducerAttached() const;
+
+	/** Bind to know when a streamed audio frame has been analyzed. Broadcast on the game thread, so the analysis results may already belong to a later hop */
+	UPROPERTY(BlueprintAssignable, Category = "Audio Analysis Tools|Delegates")
+	FOnStreamingFrameProcessed OnStreamingFrameProcessed;
+
+	/** Bind to know when a streamed audio frame has been analyzed. Broadcast on the game thread, so the analysis results may already belong to a later hop */
+	FOnStreamingFrameProcessedNative OnStreamingFrameProcessedNative;
+
 private:
 	/**
 	 * Initialize Audio Analysis
@@ -132,10 +448,19 @@ public:
 
 	/**
 	 * Get magnitude spectrum. Suitable for use with 64-bit data size
+	 * Returns a copy, which stays valid after later getter calls. To read several arrays of the same frame without copies, use GetLatestSnapshot
 	 *
 	 * @return The current magnitude spectrum
 	 */
-	const TArray64<float>& GetMagnitudeSpectrum64() const;
+	TArray64<float> GetMagnitudeSpectrum64() const;
+
+	/**
+	 * Get magnitude spectrum into the caller-owned array, reusing its allocation
+	 *
+	 * @param OutMagnitudeSpectrum The array to fill with the current magnitude spectrum
+	 * @return Whether the magnitude spectrum has been retrieved or not
+	 */
+	bool GetMagnitudeSpectrum(TArray<float>& OutMagnitudeSpectrum) const;
 
 	/**
 	 * Get FFT Real
@@ -144,8 +469,22 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Get FFT Real"), Category = "Audio Analysis Tools|Analyzers|Advanced")
 	TArray<float> GetFFTReal() const;
-	
-	const TArray64<float>& GetFFTReal64() const;
+
+	/**
+	 * Get FFT Real. Suitable for use with 64-bit data size
+	 * Returns a copy, which stays valid after later getter calls. To read several arrays of the same frame without copies, use GetLatestSnapshot
+	 *
+	 * @return The current FFT Real
+	 */
+	TArray64<float> GetFFTReal64() const;
+
+	/**
+	 * Get FFT Real into the caller-owned array, reusing its allocation
+	 *
+	 * @param OutFFTReal The array to fill with the current FFT Real
+	 * @return Whether the FFT Real has been retrieved or not
+	 */
+	bool GetFFTReal(TArray<float>& OutFFTReal) const;
 
 	/**
 	 * Get FFT Imaginary
@@ -157,10 +496,49 @@ public:
 
 	/**
 	 * Get FFT Imaginary. Suitable for use with 64-bit data size
+	 * Returns a copy, which stays valid after later getter calls. To read several arrays of the same frame without copies, use GetLatestSnapshot
 	 *
 	 * @return The current FFT Imaginary
 	 */
-	const TArray64<float>& GetFFTImaginary64() const;
+	TArray64<float> GetFFTImaginary64() const;
+
+	/**
+	 * Get FFT Imaginary into the caller-owned array, reusing its allocation
+	 *
+	 * @param OutFFTImaginary The array to fill with the current FFT Imaginary
+	 * @return Whether the FFT Imaginary has been retrieved or not
+	 */
+	bool GetFFTImaginary(TArray<float>& OutFFTImaginary) const;
+
+	/**
+	 * Get the index of the most recently processed audio frame. Can be called from any thread
+	 *
+	 * @return The number of audio frames processed before the most recent one, or -1 if no audio frame has been processed yet
+	 */
+	UFUNCTION(BlueprintPure, Category = "Audio Analysis Tools|Analyzers|Advanced")
+	int64 GetLatestFrameIndex() const;
+
+	/**
+	 * Get the analysis results of the most recently processed audio frame. Suitable for use in C++
+	 * The getters of the analysis results never wait for the analysis, but must all be called from the same thread (usually the game thread)
+	 * The returned snapshot stays valid and unchanged until the next call to any of the getters
+	 *
+	 * @return The analysis results of the most recently processed audio frame
+	 */
+	const FAudioAnalysisSnapshot& GetLatestSnapshot() const;
+
+private:
+	/** Get the most recently published snapshot, owned by the reader until the next call */
+	FAudioAnalysisSnapshot& GetSnapshot() const;
+
+	/** Publish the analysis results of the current audio frame to the reader. Must be called under the data guard */
+	void PublishSnapshot();
+
+	/** Snapshots of the analysis results, written by the analysis and read by the getters without locking */
+	mutable FAudioAnalysisSnapshotBuffer SnapshotBuffer;
+
+	/** The number of audio frames processed so far */
+	int64 NumProcessedFrames;
 
 public:
 	/**
@@ -240,6 +618,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Analyzers|Core Time Domain Features")
 	float GetZeroCrossingRate();
 
+	/**
+	 * Calculate the sum of squares, the RMS, the peak energy and the zero crossing rate of the audio frame in a single pass
+	 * The features are cached until the next audio frame is processed, so the individual time domain feature getters and the energy difference do not compute them again
+	 *
+	 * @return The time domain features of the currently stored audio frame
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Analyzers|Core Time Domain Features")
+	FTimeDomainFeatureSet GetTimeDomainFeatures();
+
 	/**
 	 * Calculate the spectral centroid given the first half of the magnitude spectrum of an audio signal
 	 *
@@ -281,6 +668,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Analyzers|Core Frequency Domain Features")
 	float GetSpectralKurtosis();
 
+	/**
+	 * Calculate the requested spectral features of the magnitude spectrum in a single pass
+	 * The features are cached until the next audio frame is processed, so the individual spectral feature getters do not compute them again
+	 *
+	 * @param FeatureMask The mask of the features to compute, see ESpectralFeature
+	 * @return The spectral features of the magnitude spectrum
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Analyzers|Core Frequency Domain Features")
+	FSpectralFeatureSet GetSpectralFeatures(UPARAM(meta = (Bitmask, BitmaskEnum = "ESpectralFeature")) int32 FeatureMask = 31);
+
 	/**
 	 * Calculate the energy difference between the current and previous energy sum
 	 *
@@ -321,6 +718,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Analyzers|Onset Detection")
 	float GetHighFrequencyContent();
 
+	/**
+	 * Calculate the energies of the Mel bands of the current magnitude spectrum
+	 *
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 * @return The energy of each Mel band, or an empty array if the parameters are invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Analysis Tools|Analyzers|Mel Frequency Features")
+	TArray<float> GetMelBandEnergies(int32 SampleRate, int32 NumOfBands = 40);
+
+	/**
+	 * Calculate the Mel-frequency cepstral coefficients of the current magnitude spectrum
+	 *
+	 * @param SampleRate The sample rate of the analyzed audio
+	 * @param NumOfBands The number of Mel bands
+	 * @param NumOfCoefficients The number of cepstral coefficients, up to the number of bands
+	 * @return The cepstral coefficients, or an empty array if the parameters are invalid
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Get MFCC"), Category = "Audio Analysis Tools|Analyzers|Mel Frequency Features")
+	TArray<float> GetMFCC(int32 SampleRate, int32 NumOfBands = 40, int32 NumOfCoefficients = 13);
+
 private:
 	/** Configure the FFT implementation given the audio frame size) */
 	void ConfigureFFT();
@@ -334,30 +752,96 @@ private:
 	/** Perform the FFT on the current audio frame */
 	void PerformFFT();
 
-	/** FFT configuration */
-	FFTStateStruct* FFT_Configuration;
-
-	/** FFT input samples, in complex for */
-	FFTComplexSamples* FFT_InSamples;
-
-	/** FFT output samples, in complex form */
-	FFTComplexSamples* FFT_OutSamples;
+	/** Computes the FFT and the magnitude spectrum with the FFT plan shared with other analyzers of the same frame size */
+	FSpectrumAnalyzer SpectrumAnalyzer;
 
-	/** The real part of the FFT for the current audio frame */
+	/** The real part of the FFT for the current audio frame. Written by the split-complex FFT directly */
 	TArray64<float> FFTReal;
 
-	/** The imaginary part of the FFT for the current audio frame */
+	/** The imaginary part of the FFT for the current audio frame. Written by the split-complex FFT directly */
 	TArray64<float> FFTImaginary;
 
+	/** The execution policy of the FFT */
+	EFFTExecutionPolicy FFTExecutionPolicy;
+
+	/** The minimum frame size to run the FFT in parallel with EFFTExecutionPolicy::ParallelAboveThreshold */
+	int64 FFTParallelThreshold;
+
 private:
+	friend class UAudioAnalysisSubsystem;
+
+	/** The audio frames queued to be processed by the subsystem. Empty if nothing is queued. Accessed on the game thread only */
+	TArray64<float> PendingAudioFrames;
+
+	/** Whether to process the queued audio frames to beat detection or not */
+	bool bPendingBeatDetection;
+
+private:
+	/** Schedule the analysis of the streaming buffer in the background, unless it is already scheduled */
+	void ScheduleStreamingProcessing();
+
+	/** Analyze every complete hop in the streaming buffer */
+	void ProcessStreamingBuffer();
+
+	/** Lock-free buffer of the pushed audio frames. Filled by the pushing thread and consumed by the streaming analysis */
+	FAudioAnalysisRingBuffer StreamingBuffer;
+
+	/** The number of audio frames between two consecutive analyzed frames. 0 if the streaming mode is disabled */
+	std::atomic<int64> StreamingHopSize;
+
+	/** Whether to process the streamed frames to beat detection or not */
+	bool bStreamingBeatDetection;
+
+	/** Whether the streaming analysis is scheduled or running */
+	std::atomic<bool> bStreamingProcessingScheduled;
+
+	/** The number of hops analyzed since the streaming mode was enabled */
+	int64 NumStreamingHops;
+
+	/** The frame size when the streaming mode was enabled. The pushing thread schedules the analysis once this many audio frames are buffered */
+	std::atomic<int64> StreamingFrameSize;
+
+	/** The number of audio frames dropped since the streaming mode was enabled */
+	std::atomic<int64> NumDroppedStreamingFrames;
+
+	/** Whether the current overflow of the streaming buffer has been logged, so a sustained overflow is logged once */
+	std::atomic<bool> bStreamingOverflowLogged;
+
+	/** Whether a producer pushing from another thread is attached. Guarded by the data guard */
+	bool bStreamingProducerAttached;
+
+private:
+	/** Perform the FFT, beat detection and publish the snapshot of the current audio frames. Must be called under the data guard */
+	void ProcessCurrentAudioFrames(bool bProcessToBeatDetection);
+
+	/**
+	 * Mix down or extract the selected channel of the interleaved audio frames into the current audio frames, according to the channel mode. Must be called under the data guard
+	 *
+	 * @param InterleavedAudioFrames Interleaved audio frames, the frame size of frames of NumChannels samples each
+	 * @param NumChannels The number of channels
+	 */
+	void CopyChannelsToCurrentAudioFrames(const float* InterleavedAudioFrames, int32 NumChannels);
+
+	/** How multichannel audio is turned into the current audio frames */
+	EAudioChannelMode ChannelMode;
+
+	/** The channel analyzed with the SingleChannel mode */
+	int32 SelectedChannel;
+
+	/** Update the analyzer buffer memory stat with the buffers currently owned by this analyzer. Must be called under the data guard */
+	void UpdateBufferMemoryStat();
+
+	/** The number of bytes of the buffers of this analyzer reported to the analyzer buffer memory stat */
+	int64 ReportedBufferMemory;
+
 	/** The window type used in FFT analysis */
 	EAnalysisWindowType WindowType;
 
 	/** Current audio frames */
 	TArray64<float> CurrentAudioFrames;
 
-	/** The window function used in FFT processing */
-	TArray64<float> WindowFunction;
+	/** The window function used in FFT processing, shared with other analyzers of the same frame size and window type */
+	FWindowPtr WindowFunction;
 
 	/** The magnitude spectrum of the current audio frame */
 	TArray64<float> MagnitudeSpectrum;
@@ -0,0 +1,85 @@
+// Georgy Treshchev 2024.
+
+#pragma once
+
+#include "UObject/Object.h"
+
+#include "AudioChannelsLibrary.generated.h"
+
+/**
+ * How interleaved multichannel audio is turned into the audio frames to analyze
+ */
+UENUM(BlueprintType, Category = "Audio Channels Library")
+enum class EAudioChannelMode : uint8
+{
+	/** The interleaved samples are analyzed as they are, as if they were mono */
+	Interleaved,
+
+	/** The channels are averaged into mono. Multichannel audio costs the same as mono */
+	DownmixToMono,
+
+	/** Only the selected channel is analyzed */
+	SingleChannel
+};
+
+/**
+ * Library for converting between interleaved multichannel audio and the mono or per-channel audio frames to analyze
+ */
+UCLASS(BlueprintType, Category = "Audio Channels Library")
+class AUDIOANALYSISTOOLS_API UAudioChannelsLibrary : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Mix interleaved audio down to mono by averaging the channels
+	 *
+	 * @param InterleavedAudioFrames Interleaved audio frames in 32-bit float PCM format
+	 * @param NumChannels The number of channels
+	 * @return The mono audio frames
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Channels Library")
+	static TArray<float> DownmixToMono(const TArray<float>& InterleavedAudioFrames, int32 NumChannels);
+
+	/**
+	 * Mix interleaved audio down to mono by averaging the channels. Vectorized for stereo. Suitable for use with 64-bit data size and for mixing in place without allocations
+	 *
+	 * @param InterleavedAudioFrames Interleaved audio frames in 32-bit float PCM format, NumOfFrames * NumChannels samples
+	 * @param NumOfFrames The number of audio frames
+	 * @param NumChannels The number of channels
+	 * @param MonoAudioFrames The mono audio frames to fill, NumOfFrames samples. Must not overlap the interleaved audio frames
+	 */
+	static void DownmixToMono(const float* InterleavedAudioFrames, int64 NumOfFrames, int32 NumChannels, float* MonoAudioFrames);
+
+	/**
+	 * Extract a single channel of interleaved audio
+	 *
+	 * @param InterleavedAudioFrames Interleaved audio frames in 32-bit float PCM format
+	 * @param NumChannels The number of channels
+	 * @param Channel The index of the channel to extract
+	 * @return The audio frames of the channel
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Audio Channels Library")
+	static TArray<float> ExtractChannel(const TArray<float>& InterleavedAudioFrames, int32 NumChannels, int32 Channel);
+
+	/**
+	 * Extract a single channel of interleaved audio. Suitable for use with 64-bit data size and for extracting without allocations
+	 *
+	 * @param InterleavedAudioFrames Interleaved audio frames in 32-bit float PCM format, NumOfFrames * NumChannels samples
+	 * @param NumOfFrames The number of audio frames
+	 * @param NumChannels The number of channels
+	 * @param Channel The index of the channel to extract
+	 * @param ChannelAudioFrames The audio frames of the channel to fill, NumOfFrames samples
+	 */
+	static void ExtractChannel(const float* InterleavedAudioFrames, int64 NumOfFrames, int32 NumChannels, int32 Channel, float* ChannelAudioFrames);
+
+	/**
+	 * De-interleave audio into one contiguous buffer per channel in a single pass, for analyzing each channel with its own analyzer
+	 *
+	 * @param InterleavedAudioFrames Interleaved audio frames in 32-bit float PCM format, NumOfFrames * NumChannels samples
+	 * @param NumOfFrames The number of audio frames
+	 * @param NumChannels The number of channels
+	 * @param ChannelAudioFrames The audio frames of each channel. Resized to the number of channels and frames, reusing the existing allocations
+	 */
+	static void Deinterleave(const float* InterleavedAudioFrames, int64 NumOfFrames, int32 NumChannels, TArray<TArray64<float>>& ChannelAudioFrames);
+};
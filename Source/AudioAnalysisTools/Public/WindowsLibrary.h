@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include "UObject/Object.h"
+#include "Templates/SharedPointer.h"
+#include "HAL/CriticalSection.h"
 #include "WindowsLibrary.generated.h"
 
 /**
@@ -19,6 +22,53 @@ enum class EAnalysisWindowType : uint8
 	TukeyWindow
 };
 
+using FWindowPtr = TSharedPtr<const TArray64<float>, ESPMode::ThreadSafe>;
+
+/**
+ * Process-wide, thread-safe cache of window tables keyed by type, size and cosine fraction
+ * The tables are immutable and shared by all analyzers, so changing the frame size back and forth does not regenerate them
+ * Windows no longer referenced outside of the cache are kept for reuse, until the cache holds MaxNumOfCachedWindows windows and a new one is created
+ */
+class AUDIOANALYSISTOOLS_API FWindowCache
+{
+public:
+	/** The number of cached windows above which the windows no longer referenced outside of the cache are released when a new window is created */
+	static constexpr int32 MaxNumOfCachedWindows = 16;
+
+	/** Get the global window cache */
+	static FWindowCache& Get();
+
+	/**
+	 * Find the window with the given parameters or create it if it does not exist yet
+	 *
+	 * @param FrameSize The frame size of internal buffers
+	 * @param WindowType A type of the window
+	 * @param CosineFraction Cosine fraction (or Alpha) used for a Tukey window type. Ignored for the other types
+	 * @return The shared window, or nullptr if the parameters are invalid
+	 */
+	FWindowPtr FindOrCreateWindow(int64 FrameSize, EAnalysisWindowType WindowType, float CosineFraction = 0.5);
+
+	/**
+	 * Release the windows that are no longer referenced outside of the cache
+	 */
+	void ReleaseUnusedWindows();
+
+	/**
+	 * Get the number of cached windows
+	 */
+	int32 GetNumWindows() const;
+
+private:
+	/** Release the windows that are no longer referenced outside of the cache. Must be called under the write lock */
+	void ReleaseUnusedWindowsLocked();
+
+	/** Cached windows keyed by the frame size, the window type and the cosine fraction */
+	TMap<TTuple<int64, EAnalysisWindowType, float>, FWindowPtr> Windows;
+
+	/** Guards the windows map. Lookups are far more frequent than insertions */
+	mutable FRWLock WindowsLock;
+};
+
 /**
  * Library for creating windows functions of different types
  */
@@ -49,6 +99,16 @@ public:
 	 */
 	static TArray64<float> CreateWindowByType(int64 FrameSize, EAnalysisWindowType WindowType);
 
+	/**
+	 * Get the shared window with a specified type without copying it. It is used in spectral analysis
+	 *
+	 * @param FrameSize The frame size of internal buffers
+	 * @param WindowType A type of the window
+	 * @param CosineFraction Cosine fraction (or Alpha) used for a Tukey window type. Ignored for the other types
+	 * @return The immutable window with the specified type, or nullptr if the frame size is invalid
+	 */
+	static FWindowPtr GetSharedWindow(int64 FrameSize, EAnalysisWindowType WindowType, float CosineFraction = 0.5);
+
 	/**
 	 * Create a window with Hanning type. It is used in spectral analysis
 	 *